@@ -25,7 +25,8 @@ typedef enum {
     NODE_AWAIT_EXPR,  // await expression (MASTERPLAN: async/await)
     NODE_ARRAY_LITERAL,
     NODE_INDEX_EXPR,
-    NODE_INDEX_SET_EXPR
+    NODE_INDEX_SET_EXPR,
+    NODE_LOGICAL_EXPR   // && / || (short-circuit)
 } NodeType;
 
 typedef struct AstNode AstNode;
@@ -42,6 +43,14 @@ typedef struct {
     Token op;
 } BinaryExpr;
 
+// left && right, left || right: right only runs when left does not decide
+typedef struct {
+    AstNode main;
+    AstNode* left;
+    AstNode* right;
+    Token op;            // TOKEN_AND or TOKEN_OR
+} LogicalExpr;
+
 typedef struct {
     AstNode main;
     Token token; // For Number or String
@@ -121,6 +130,7 @@ typedef struct {
     Token returnType; // :: Type
     AstNode* body;
     int isAsync;  // MASTERPLAN: async function flag
+    const char* file; // Source path for debug info, NULL if unknown
 } FunctionDecl;
 
 // Structs
@@ -0,0 +1,24 @@
+#ifndef VANARIZE_COMPILER_OPTIMIZER_H
+#define VANARIZE_COMPILER_OPTIMIZER_H
+
+#include "Compiler/Ast.h"
+
+/**
+ * AST OPTIMIZER
+ *
+ * Runs once over the tree from Parser_ParseProgram, before Jit_Compile.
+ * Rewrites in place:
+ * - Constant folding: number, boolean and string literal expressions
+ *   ("1 + 2", "-3", "2.0 * 4 < 9", "\"a\" + \"b\"") become literals, using
+ *   the same int/double rules as CodeGen (int / int truncates).
+ * - Constant propagation: int and double locals initialised with a
+ *   constant and never assigned are replaced by that constant at each use.
+ * - Algebraic identities on numeric operands: x + 0, x - 0, x * 1, x / 1.
+ * - Dead branches: if (true/false) keeps only the taken branch.
+ *
+ * Strength reduction of x * 2^k to a shift happens in CodeGen, where the
+ * operand representation is known.
+ */
+void Optimizer_FoldProgram(AstNode* root);
+
+#endif // VANARIZE_COMPILER_OPTIMIZER_H
@@ -4,7 +4,14 @@
 #include "Compiler/Ast.h"
 
 void Parser_Init(const char* source);
+
+// Path of the main source, recorded in its declarations for debug info
+// (imported files record their own)
+void Parser_SetFile(const char* path);
 AstNode* Parser_ParseExpression(void);
 AstNode* Parser_ParseProgram(void);  // Parse entire program
 
+// Paths of the files imported so far (the program's source dependencies)
+const char* const* Parser_GetImports(int* outCount);
+
 #endif // VANARIZE_COMPILER_PARSER_H
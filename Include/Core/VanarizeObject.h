@@ -41,11 +41,23 @@ typedef struct {
     uint8_t data[];        // Packed data (flexible array)
 } ObjStruct;
 
+// Element storage of an array. Typed kinds hold raw numbers packed
+// contiguously; kinds whose elements are double bits come first so the
+// vectorizer can accept both with one compare.
+typedef enum {
+    ARRAY_VALUE,    // Value (NaN-boxed, any type)
+    ARRAY_FLOAT64,  // double[]
+    ARRAY_INT32,    // 32-bit ints (runtime only: int is 64-bit, so int[] is INT64)
+    ARRAY_INT64,    // int[], long[]
+    ARRAY_FLOAT32   // float[]
+} ArrayKind;
+
 typedef struct {
     Obj obj;
     int count;
     int capacity;
-    Value* elements; // Pointer to heap array of Values
+    ArrayKind kind;
+    void* elements; // Heap buffer of 'capacity' elements of the kind's size
 } ObjArray;
 
 // Helper to check object type
@@ -69,10 +81,18 @@ static inline char* AsCString(Value v) {
 
 // Array Implementation
 ObjArray* Runtime_NewArray(int capacity);
+ObjArray* Runtime_NewTypedArray(ArrayKind kind, int capacity);
 void Runtime_ArrayPush(ObjArray* arr, Value val);
 Value Runtime_ArrayGet(ObjArray* arr, int index);
 void Runtime_ArraySet(ObjArray* arr, int index, Value val);
 int Runtime_ArrayLength(ObjArray* arr);
 Value Runtime_ArrayPop(ObjArray* arr);
 
+// Unboxed element access for the JIT. Bits are in the register form of
+// 'as' (raw int64 for INT32/INT64, float bits, double bits); arrays of
+// another kind are converted element by element.
+uint64_t Runtime_ArrayGetRaw(ObjArray* arr, int index, ArrayKind as);
+void Runtime_ArraySetRaw(ObjArray* arr, int index, uint64_t bits, ArrayKind as);
+void Runtime_ArrayPushRaw(ObjArray* arr, uint64_t bits, ArrayKind as);
+
 #endif // VANARIZE_CORE_OBJECT_H
@@ -16,15 +16,46 @@ typedef enum {
     R12 = 12, R13 = 13, R14 = 14, R15 = 15
 } Register;
 
+// XMM Register enum (128-bit SSE registers)
+// XMM0-XMM7 are expression scratch / argument registers, XMM8-XMM15 are
+// handed out by the register map as homes for double/float locals.
+typedef enum {
+    XMM0 = 0, XMM1 = 1, XMM2 = 2, XMM3 = 3,
+    XMM4 = 4, XMM5 = 5, XMM6 = 6, XMM7 = 7,
+    XMM8 = 8, XMM9 = 9, XMM10 = 10, XMM11 = 11,
+    XMM12 = 12, XMM13 = 13, XMM14 = 14, XMM15 = 15
+} XmmRegister;
+
+// Condition codes (low nibble of Jcc / SETcc opcodes)
+typedef enum {
+    COND_B = 0x2, COND_AE = 0x3, COND_E = 0x4, COND_NE = 0x5,
+    COND_BE = 0x6, COND_A = 0x7, COND_P = 0xA, COND_NP = 0xB,
+    COND_L = 0xC, COND_GE = 0xD, COND_LE = 0xE, COND_G = 0xF
+} Condition;
+
 typedef struct {
     uint8_t* buffer;
     size_t capacity;
     size_t offset;
+    int growable;        // Owns a heap staging buffer that doubles when full
+
+    // Peephole window: the last instruction emitted, kept while nothing has
+    // been emitted after it and no label was taken (see Asm_Label)
+    int peepKind;
+    size_t peepStart;
+    size_t peepEnd;
+    int peepA, peepB;
 } Assembler;
 
 // Initialize assembler with a buffer
 void Asm_Init(Assembler* as, uint8_t* buffer, size_t capacity);
 
+// Initialize assembler with a growable heap buffer (see Jit_InstallCode)
+void Asm_InitDynamic(Assembler* as, size_t initialCapacity);
+
+// Release a growable buffer
+void Asm_Free(Assembler* as);
+
 // Emit single byte
 void Asm_Emit8(Assembler* as, uint8_t byte);
 
@@ -56,7 +87,8 @@ void Asm_Pop(Assembler* as, Register dst);
 // CALL r64 (Absolute call)
 void Asm_Call_Reg(Assembler* as, Register src);
 
-// MOV dst, imm64 (Pointer version)
+// MOV dst, imm64 (Pointer version). Always the full 10-byte form: the
+// immediate is the last 8 bytes, where a relocation can rewrite it.
 void Asm_Mov_Reg_Ptr(Assembler* as, Register dst, void* ptr);
 
 // MOV dst, [base + offset]
@@ -65,6 +97,30 @@ void Asm_Mov_Reg_Mem(Assembler* as, Register dst, Register base, int32_t offset)
 // MOV [base + offset], src
 void Asm_Mov_Mem_Reg(Assembler* as, Register base, int32_t offset, Register src);
 
+// LEA dst, [base + offset]
+void Asm_Lea_Reg_Mem(Assembler* as, Register dst, Register base, int32_t offset);
+
+// Array elements: [base + index*scale], scale 1, 2, 4 or 8
+// MOV r64, [..] / MOV r32, [..] (zero-extends) / MOVSXD r64, DWORD [..]
+void Asm_Mov_Reg_MemIndex(Assembler* as, Register dst, Register base, Register index, int scale);
+void Asm_Mov32_Reg_MemIndex(Assembler* as, Register dst, Register base, Register index, int scale);
+void Asm_Movsxd_Reg_MemIndex(Assembler* as, Register dst, Register base, Register index, int scale);
+// MOV [..], r64 / MOV DWORD [..], r32
+void Asm_Mov_MemIndex_Reg(Assembler* as, Register base, Register index, int scale, Register src);
+void Asm_Mov32_MemIndex_Reg(Assembler* as, Register base, Register index, int scale, Register src);
+
+// MOVSXD r64, DWORD [base + offset]
+void Asm_Movsxd_Reg_Mem(Assembler* as, Register dst, Register base, int32_t offset);
+
+// CMP DWORD [base + offset], imm8
+void Asm_Cmp_Mem32_Imm8(Assembler* as, Register base, int32_t offset, int8_t imm);
+
+// SUB DWORD [base + offset], imm8 (execution counters)
+void Asm_Sub_Mem32_Imm8(Assembler* as, Register base, int32_t offset, int8_t imm);
+
+// SUB r64, imm32
+void Asm_Sub_Reg_Imm(Assembler* as, Register dst, int32_t imm);
+
 // Integer Arithmetic (64-bit ALU)
 void Asm_Sub_Reg_Reg_64(Assembler* as, Register dst, Register src);
 void Asm_Imul_Reg_Reg_64(Assembler* as, Register dst, Register src);
@@ -79,6 +135,29 @@ void Asm_Cmp_Reg_Imm(Assembler* as, Register dst, int32_t imm);
 // CMP r64, r64
 void Asm_Cmp_Reg_Reg(Assembler* as, Register dst, Register src);
 
+// OR r64, r64
+void Asm_Or_Reg_Reg(Assembler* as, Register dst, Register src);
+
+// XOR r64, r64
+void Asm_Xor_Reg_Reg(Assembler* as, Register dst, Register src);
+
+// TEST r64, r64
+void Asm_Test_Reg_Reg(Assembler* as, Register a, Register b);
+
+// SETcc r8 / MOVZX r64, r8
+void Asm_Setcc(Assembler* as, Condition cond, Register dst);
+void Asm_Movzx_Reg_Reg8(Assembler* as, Register dst, Register src);
+
+// NEG r64
+void Asm_Neg_Reg(Assembler* as, Register reg);
+
+// SHL r64, imm8
+void Asm_Shl_Reg_Imm(Assembler* as, Register reg, uint8_t count);
+
+// CQO / IDIV r64 (signed RDX:RAX / src)
+void Asm_Cqo(Assembler* as);
+void Asm_Idiv_Reg(Assembler* as, Register src);
+
 // Jcc rel32
 void Asm_Je(Assembler* as, int32_t offset);
 void Asm_Jne(Assembler* as, int32_t offset);
@@ -86,13 +165,108 @@ void Asm_Jmp(Assembler* as, int32_t offset);
 void Asm_Jae(Assembler* as, int32_t offset);  // Jump if Above or Equal (unsigned >=)
 void Asm_Jge(Assembler* as, int32_t offset);  // Jump if Greater or Equal (signed >=)
 void Asm_Jl(Assembler* as, int32_t offset);   // Jump if Less (signed <)
+void Asm_Jcc(Assembler* as, Condition cond, int32_t offset);
 
 // Patching
 void Asm_Patch32(Assembler* as, size_t offset, int32_t value);
 
+/**
+ * Peephole rewrites happen at emission time, between an instruction and
+ * the one emitted right after it:
+ * - PUSH a; POP b        -> MOV b, a (nothing when a == b)
+ * - MOV r, r             -> nothing
+ * - ADD RSP, k; SUB RSP, k (either order, call alignment) -> nothing
+ * - MOVQ x, r; MOVQ r, x (either direction) -> the first only
+ * - MOV r, imm64         -> MOV r32, imm32 / MOV r64, simm32 when it fits
+ * Every offset used as a branch target must come from Asm_Label, which
+ * keeps instructions on either side of it apart.
+ */
+size_t Asm_Label(Assembler* as);
+
 // RET
 void Asm_Ret(Assembler* as);
 
+// ==================== SSE2 SCALAR INSTRUCTIONS ====================
+
+// MOVQ xmm, r64
+void Asm_Movq_Xmm_Reg(Assembler* as, XmmRegister dst, Register src);
+
+// MOVQ r64, xmm
+void Asm_Movq_Reg_Xmm(Assembler* as, Register dst, XmmRegister src);
+
+// MOVAPD xmm, xmm (full register copy)
+void Asm_Movapd_Xmm_Xmm(Assembler* as, XmmRegister dst, XmmRegister src);
+
+// MOVSD xmm, [base + offset]
+void Asm_Movsd_Xmm_Mem(Assembler* as, XmmRegister dst, Register base, int32_t offset);
+
+// MOVSD [base + offset], xmm
+void Asm_Movsd_Mem_Xmm(Assembler* as, Register base, int32_t offset, XmmRegister src);
+
+// MOVSS xmm, [base + offset]
+void Asm_Movss_Xmm_Mem(Assembler* as, XmmRegister dst, Register base, int32_t offset);
+
+// Scalar double arithmetic: dst = dst op src
+void Asm_Addsd(Assembler* as, XmmRegister dst, XmmRegister src);
+void Asm_Subsd(Assembler* as, XmmRegister dst, XmmRegister src);
+void Asm_Mulsd(Assembler* as, XmmRegister dst, XmmRegister src);
+void Asm_Divsd(Assembler* as, XmmRegister dst, XmmRegister src);
+
+// Scalar float arithmetic: dst = dst op src
+void Asm_Addss(Assembler* as, XmmRegister dst, XmmRegister src);
+void Asm_Subss(Assembler* as, XmmRegister dst, XmmRegister src);
+void Asm_Mulss(Assembler* as, XmmRegister dst, XmmRegister src);
+void Asm_Divss(Assembler* as, XmmRegister dst, XmmRegister src);
+
+// UCOMISD a, b (flags as for unsigned compare, PF=1 if unordered)
+void Asm_Ucomisd(Assembler* as, XmmRegister a, XmmRegister b);
+
+// UCOMISS a, b (single-precision, same flags)
+void Asm_Ucomiss(Assembler* as, XmmRegister a, XmmRegister b);
+
+// XORPD xmm, xmm
+void Asm_Xorpd(Assembler* as, XmmRegister dst, XmmRegister src);
+
+// Conversions (CVTT* truncate toward zero)
+void Asm_Cvtsi2sd_Xmm_Reg(Assembler* as, XmmRegister dst, Register src);
+void Asm_Cvttsd2si_Reg_Xmm(Assembler* as, Register dst, XmmRegister src);
+void Asm_Cvtsi2ss_Xmm_Reg(Assembler* as, XmmRegister dst, Register src);
+void Asm_Cvttss2si_Reg_Xmm(Assembler* as, Register dst, XmmRegister src);
+void Asm_Cvtsd2ss(Assembler* as, XmmRegister dst, XmmRegister src);
+void Asm_Cvtss2sd(Assembler* as, XmmRegister dst, XmmRegister src);
+
+// MOVD xmm, r32 / MOVD r32, xmm (single-precision bit moves)
+void Asm_Movd_Xmm_Reg(Assembler* as, XmmRegister dst, Register src);
+void Asm_Movd_Reg_Xmm(Assembler* as, Register dst, XmmRegister src);
+
+// ==================== SSE2 PACKED INSTRUCTIONS ====================
+
+// MOVUPD xmm, [base + index*8] / MOVUPD [base + index*8], xmm (2 doubles, unaligned)
+void Asm_Movupd_Xmm_Mem(Assembler* as, XmmRegister dst, Register base, Register index);
+void Asm_Movupd_Mem_Xmm(Assembler* as, Register base, Register index, XmmRegister src);
+
+// Packed double arithmetic: dst = dst op src (2 lanes)
+void Asm_Addpd(Assembler* as, XmmRegister dst, XmmRegister src);
+void Asm_Subpd(Assembler* as, XmmRegister dst, XmmRegister src);
+void Asm_Mulpd(Assembler* as, XmmRegister dst, XmmRegister src);
+void Asm_Divpd(Assembler* as, XmmRegister dst, XmmRegister src);
+
+// UNPCKLPD xmm, xmm (UNPCKLPD x, x splats the low double)
+void Asm_Unpcklpd(Assembler* as, XmmRegister dst, XmmRegister src);
+
+// MOVUPS xmm, [base + index*4] / MOVUPS [base + index*4], xmm (4 floats, unaligned)
+void Asm_Movups_Xmm_Mem(Assembler* as, XmmRegister dst, Register base, Register index);
+void Asm_Movups_Mem_Xmm(Assembler* as, Register base, Register index, XmmRegister src);
+
+// Packed float arithmetic: dst = dst op src (4 lanes)
+void Asm_Addps(Assembler* as, XmmRegister dst, XmmRegister src);
+void Asm_Subps(Assembler* as, XmmRegister dst, XmmRegister src);
+void Asm_Mulps(Assembler* as, XmmRegister dst, XmmRegister src);
+void Asm_Divps(Assembler* as, XmmRegister dst, XmmRegister src);
+
+// SHUFPS xmm, xmm, imm8 (SHUFPS x, x, 0 splats the low float)
+void Asm_Shufps(Assembler* as, XmmRegister dst, XmmRegister src, uint8_t imm);
+
 // ==================== AVX SIMD INSTRUCTIONS ====================
 
 // YMM Register enum (256-bit AVX registers)
@@ -110,11 +284,35 @@ void Asm_Vpaddd_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegiste
 // AVX: VADDPD ymm, ymm, ymm (Add 4 packed doubles)
 void Asm_Vaddpd_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegister src2);
 
-// AVX: VMOVDQU ymm, [mem] (Load 256 bits unaligned)
-void Asm_Vmovdqu_Ymm_Mem(Assembler* as, YmmRegister dst, void* mem);
+// AVX: VSUBPD/VMULPD/VDIVPD ymm, ymm, ymm (4 packed doubles)
+void Asm_Vsubpd_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegister src2);
+void Asm_Vmulpd_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegister src2);
+void Asm_Vdivpd_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegister src2);
+
+// AVX: VADDPS/VSUBPS/VMULPS/VDIVPS ymm, ymm, ymm (8 packed floats)
+void Asm_Vaddps_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegister src2);
+void Asm_Vsubps_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegister src2);
+void Asm_Vmulps_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegister src2);
+void Asm_Vdivps_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegister src2);
+
+// AVX2: VBROADCASTSD ymm, xmm (Splat one double to 4 lanes)
+void Asm_Vbroadcastsd_Ymm_Xmm(Assembler* as, YmmRegister dst, XmmRegister src);
+
+// AVX2: VBROADCASTSS ymm, xmm (Splat one float to 8 lanes)
+void Asm_Vbroadcastss_Ymm_Xmm(Assembler* as, YmmRegister dst, XmmRegister src);
+
+// AVX: VMOVDQU ymm, [base + index*8] (Load 256 bits unaligned)
+void Asm_Vmovdqu_Ymm_Mem(Assembler* as, YmmRegister dst, Register base, Register index);
+
+// AVX: VMOVDQU [base + index*8], ymm (Store 256 bits unaligned)
+void Asm_Vmovdqu_Mem_Ymm(Assembler* as, Register base, Register index, YmmRegister src);
+
+// AVX: VMOVUPS ymm, [base + index*4] / VMOVUPS [base + index*4], ymm (8 floats, unaligned)
+void Asm_Vmovups_Ymm_Mem(Assembler* as, YmmRegister dst, Register base, Register index);
+void Asm_Vmovups_Mem_Ymm(Assembler* as, Register base, Register index, YmmRegister src);
 
-// AVX: VMOVDQU [mem], ymm (Store 256 bits unaligned)
-void Asm_Vmovdqu_Mem_Ymm(Assembler* as, void* mem, YmmRegister src);
+// AVX: VZEROUPPER (Avoid AVX->SSE transition stalls)
+void Asm_Vzeroupper(Assembler* as);
 
 // AVX: VPXOR ymm, ymm, ymm (XOR - zero register for ints)
 void Asm_Vpxor_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegister src2);
@@ -10,4 +10,32 @@ typedef uint64_t (*JitFunction)(void);
 // Note: This allocates new executable memory every time.
 JitFunction Jit_Compile(AstNode* node);
 
+// Tiered compilation (on by default): functions start in a quick baseline
+// tier with execution counters and are recompiled optimized once hot.
+// Disabled, every function is compiled optimized up front.
+void Jit_SetTiering(int enabled);
+
+// Parallel compilation (1 by default: everything on the calling thread).
+// With more threads, Jit_Compile emits the declared functions on a worker
+// pool first and installs them in declaration order.
+void Jit_SetCompileThreads(int count);
+
+// Persistent code cache (see Jit/DiskCache.h). Jit_LoadCached returns Main
+// from a valid entry for this main source, or NULL on a miss. While the
+// cache is on, Jit_Compile keeps what it emits and Jit_StoreCached writes
+// it out, with the imports it depends on.
+JitFunction Jit_LoadCached(const char* source);
+void Jit_StoreCached(const char* source, const char* const* imports, int importCount);
+
+// Ahead-of-time compilation (vanarize --emit-obj). After Jit_BeginObject,
+// Jit_Compile compiles every function optimized and keeps it, and
+// Jit_WriteObject writes them to a relocatable ELF64 object with one global
+// symbol Vana_<name> per function. Runtime helpers are left undefined for
+// libvanarize.a (make lib); a C program calls VM_InitMemory and GC_Init
+// before the first Vana_ function. The code uses the CPU features of
+// Jit/CpuFeatures.h, which vanarize --emit-obj caps at sse2 unless
+// VANARIZE_ISA is set. Returns 0 on failure.
+void Jit_BeginObject(void);
+int Jit_WriteObject(const char* path);
+
 #endif // VANARIZE_JIT_CODEGEN_H
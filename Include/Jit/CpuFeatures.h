@@ -0,0 +1,47 @@
+#ifndef VANARIZE_JIT_CPUFEATURES_H
+#define VANARIZE_JIT_CPUFEATURES_H
+
+#include <stdint.h>
+
+/**
+ * CPU FEATURES
+ *
+ * Code is generated for the machine it runs on. CPUID is probed once, and
+ * the AVX family only counts when the OS saves YMM state (OSXSAVE, XCR0).
+ * SSE2 is part of x86-64 and is what every instruction choice falls back
+ * to, so code never uses an extension the CPU lacks.
+ *
+ * An ISA level caps the features below what the CPU has. It pins the code
+ * for objects (--emit-obj) and caches shared across a mixed fleet, and
+ * exercises the fallbacks on new hardware. Levels are cumulative:
+ *
+ *   sse2   x86-64 baseline
+ *   sse4   + SSE4.1, SSE4.2
+ *   avx2   + AVX, AVX2, FMA, BMI2
+ */
+
+typedef enum {
+    CPU_SSE4_1 = 1 << 0,
+    CPU_SSE4_2 = 1 << 1,
+    CPU_AVX    = 1 << 2,
+    CPU_AVX2   = 1 << 3,
+    CPU_FMA    = 1 << 4,
+    CPU_BMI2   = 1 << 5
+} CpuFeature;
+
+typedef enum {
+    CPU_ISA_SSE2,
+    CPU_ISA_SSE4,
+    CPU_ISA_AVX2
+} CpuIsaLevel;
+
+// Features code generation may use (CpuFeature bits): the CPU's, capped
+uint32_t Cpu_Features(void);
+
+// Caps the features at a level (default: none, everything the CPU has)
+void Cpu_SetIsaLevel(CpuIsaLevel level);
+
+// "sse2", "sse4" or "avx2"; returns 0 for anything else
+int Cpu_ParseIsaLevel(const char* name, CpuIsaLevel* outLevel);
+
+#endif // VANARIZE_JIT_CPUFEATURES_H
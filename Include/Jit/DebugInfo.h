@@ -0,0 +1,56 @@
+#ifndef VANARIZE_JIT_DEBUGINFO_H
+#define VANARIZE_JIT_DEBUGINFO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * DEBUGGER AND PROFILER SUPPORT
+ *
+ * JIT code lives in anonymous mappings, so external tools cannot name it.
+ * Every installed function can be published to:
+ *
+ * - the perf map, /tmp/perf-<pid>.map: one "<start> <size> <name>" line
+ *   per function, read by perf report/top for symbol names.
+ * - a jitdump, <dir>/jit-<pid>.dump: code bytes plus a line table per
+ *   function. `perf record -k 1` then `perf inject --jit` turns it into
+ *   ELF images so perf annotate shows Vanarize source lines.
+ * - GDB, through the JIT interface (__jit_debug_register_code): an
+ *   in-memory ELF symfile per function with its symbol, DWARF line table
+ *   and an .eh_frame for the RBP frame, so backtraces and `info line`
+ *   work through JIT frames, also when attaching to a running process.
+ * - the crash handler, which prints the JIT frames of a fatal signal
+ *   (or SIGQUIT, for a hung process) with their source lines.
+ *
+ * Each output is off unless enabled (VANARIZE_PERF_MAP, VANARIZE_JITDUMP,
+ * VANARIZE_GDB_JIT), except the crash handler (VANARIZE_NO_CRASH_HANDLER
+ * turns it off).
+ */
+
+// Code offset where a source line starts, in ascending offset order
+typedef struct {
+    uint32_t offset;
+    uint32_t line;
+} DebugLine;
+
+void Debug_EnablePerfMap(void);
+
+// Opens <dir>/jit-<pid>.dump; returns 0 if it cannot be created
+int Debug_EnableJitDump(const char* dir);
+
+// GDB JIT interface registration (off by default). Turning it off
+// unregisters and frees the symfiles registered so far.
+void Debug_SetGdbJit(int enabled);
+
+// Fatal signals and SIGQUIT print a backtrace of JIT frames, then take
+// their default action
+void Debug_InstallCrashHandler(void);
+
+// Whether registered code should carry line tables
+int Debug_WantsLines(void);
+
+// Publishes one installed function. file and lines may be NULL/0.
+void Debug_RegisterCode(const void* code, size_t size, const char* name, int nameLength,
+                        const char* file, const DebugLine* lines, int lineCount);
+
+#endif // VANARIZE_JIT_DEBUGINFO_H
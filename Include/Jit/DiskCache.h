@@ -0,0 +1,74 @@
+#ifndef VANARIZE_JIT_DISKCACHE_H
+#define VANARIZE_JIT_DISKCACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * PERSISTENT CODE CACHE
+ *
+ * Compiled programs are written to <dir>/<key>.vnc so later runs of the
+ * same script skip lexing, parsing and compilation. The key hashes the
+ * main file's contents, the CPU feature set and the identity of the
+ * vanarize binary; the entry also lists every imported file with its
+ * content hash, and is only used while all of them still match.
+ *
+ * An entry holds each function's machine code with the relocations that
+ * tie it to this process: runtime helper addresses (stored relative to
+ * the binary, which may load at another base), string constants, function
+ * objects and CALL/JMP rel32 links between functions. Loading maps the
+ * file, installs the code and applies the relocations.
+ */
+
+typedef enum {
+    CACHE_RELOC_IMAGE,      // imm64: address in the vanarize binary, value = offset from its anchor
+    CACHE_RELOC_CODE,       // imm64: entry point of unit `value`
+    CACHE_RELOC_STRING,     // imm64: boxed string constant `value`
+    CACHE_RELOC_FUNCTION,   // imm64: boxed function object for unit `value`
+    CACHE_RELOC_CALL        // rel32: CALL/JMP to unit `value`
+} CacheRelocKind;
+
+typedef struct {
+    uint32_t offset;        // Field offset within the unit's code
+    uint32_t kind;          // CacheRelocKind
+    int64_t value;
+} CacheReloc;
+
+typedef struct {
+    const char* name;
+    int nameLength;
+    int arity;
+    const uint8_t* code;
+    uint32_t size;
+    const CacheReloc* relocs;
+    int relocCount;
+} CacheUnit;
+
+typedef struct {
+    CacheUnit* units;
+    int unitCount;
+    const char** strings;   // String constants (not NUL-terminated)
+    uint32_t* stringLengths;
+    int stringCount;
+    void* mapping;          // Loaded entries point into the mapped file
+    size_t mappingSize;
+} CacheImage;
+
+// Enables the cache (off until a directory is set; created if missing)
+void DiskCache_SetDirectory(const char* dir);
+
+int DiskCache_Enabled(void);
+
+// Base that CACHE_RELOC_IMAGE values are relative to
+uintptr_t DiskCache_ImageAnchor(void);
+
+// Fills image from a valid entry for this source; returns 0 on a miss
+int DiskCache_Load(const char* source, CacheImage* image);
+
+// Writes image as the entry for this source and its imports
+void DiskCache_Store(const char* source, const char* const* imports, int importCount, const CacheImage* image);
+
+// Unmaps a loaded entry and frees its tables
+void DiskCache_Release(CacheImage* image);
+
+#endif // VANARIZE_JIT_DISKCACHE_H
@@ -0,0 +1,62 @@
+#ifndef VANARIZE_JIT_ELFWRITER_H
+#define VANARIZE_JIT_ELFWRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * RELOCATABLE ELF64 OUTPUT
+ *
+ * A minimal x86-64 ELF .o writer for ahead-of-time compilation
+ * (vanarize --emit-obj): a .text and a .data section with RELA
+ * relocations, a symbol table and an empty .note.GNU-stack so the linker
+ * keeps the stack non-executable.
+ *
+ * Symbol 0 is the null symbol and 1/2 are the section symbols of .text
+ * and .data; every symbol added after them is global, either defined in
+ * one of the sections or undefined (resolved at link time).
+ */
+
+typedef enum {
+    ELF_SECTION_TEXT,
+    ELF_SECTION_DATA,
+    ELF_SECTION_COUNT
+} ElfSection;
+
+#define ELF_SYMBOL_TEXT 1
+#define ELF_SYMBOL_DATA 2
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+} ElfBuffer;
+
+typedef struct {
+    ElfBuffer contents[ELF_SECTION_COUNT];
+    ElfBuffer relocs[ELF_SECTION_COUNT];    // Elf64_Rela against each section
+    ElfBuffer symbols;                      // Elf64_Sym, from the first global
+    ElfBuffer names;                        // .strtab
+    int symbolCount;                        // Including the null and section symbols
+} ElfObject;
+
+void Elf_Init(ElfObject* elf);
+void Elf_Free(ElfObject* elf);
+
+// Appends size bytes (zeros if bytes is NULL) at the next multiple of
+// align and returns their offset within the section
+size_t Elf_Append(ElfObject* elf, ElfSection section, const void* bytes, size_t size, size_t align);
+
+// Global function/object symbol at offset in section; returns its index
+int Elf_DefineSymbol(ElfObject* elf, const char* name, ElfSection section, size_t offset, size_t size);
+
+// Undefined global symbol, added once per name; returns its index
+int Elf_ImportSymbol(ElfObject* elf, const char* name);
+
+// RELA entry (R_X86_64_*) for the field at offset in section
+void Elf_AddReloc(ElfObject* elf, ElfSection section, size_t offset, uint32_t type, int symbol, int64_t addend);
+
+// Writes the object file; returns 0 on an I/O error
+int Elf_Write(const ElfObject* elf, const char* path);
+
+#endif // VANARIZE_JIT_ELFWRITER_H
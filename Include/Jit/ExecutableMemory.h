@@ -2,6 +2,7 @@
 #define VANARIZE_JIT_EXEC_MEM_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 // Allocates executable memory (PROT_READ | PROT_WRITE | PROT_EXEC)
 void* Jit_AllocExec(size_t size);
@@ -12,4 +13,70 @@ void Jit_ProtectExec(void* ptr, size_t size);
 // Free executable memory
 void Jit_FreeExec(void* ptr, size_t size);
 
+/**
+ * CODE CACHE
+ *
+ * Compiled functions are bump-allocated back to back into large regions
+ * (2 MB, one huge page when available). When a function does not
+ * fit in the rest of the current region a new region is chained in, sized
+ * to hold it if it is bigger than a region. Functions are emitted into a
+ * growable staging buffer first (Asm_InitDynamic), so their size is known
+ * before they are installed.
+ *
+ * Regions are committed inside one reserved window of JIT_CODE_RESERVE
+ * bytes, which keeps every function within CALL rel32 range of the others.
+ *
+ * Each region is a memfd mapped twice: read/execute where the code runs,
+ * and read/write at a fixed distance (Jit_WritableAddress) where it is
+ * installed and patched. No page is ever writable and executable, and no
+ * mprotect flip is needed. Without memfd support regions fall back to RWX
+ * and the writable address is the code address itself.
+ *
+ * Installing and patching are thread-safe: one lock covers the bump
+ * allocator, the entry table and patches. Code that is running may be
+ * patched only where the bytes change in one aligned 8-byte store:
+ * Jit_PatchRel32 does that for a rel32 inside an aligned 8-byte word
+ * (compiled call sites are padded to be), other rel32 fields must belong
+ * to code no thread runs yet.
+ */
+
+#define JIT_CODE_RESERVE (1024 * 1024 * 1024)
+#define JIT_CODE_REGION_SIZE (2 * 1024 * 1024)
+#define JIT_CODE_ALIGNMENT 16
+#define JIT_CODE_NAME_MAX 64
+
+typedef struct {
+    void* start;
+    size_t size;
+    char name[JIT_CODE_NAME_MAX];
+} JitCodeEntry;
+
+typedef struct {
+    int functionCount;
+    int regionCount;
+    size_t bytesUsed;       // Machine code (excluding alignment padding)
+    size_t bytesReserved;   // Sum of region sizes
+    int dualMapped;         // Regions are W^X memfd views
+} JitCodeStats;
+
+// Request MAP_HUGETLB regions (falls back to normal pages + THP hint)
+void Jit_SetHugePages(int enabled);
+
+// Copies finished machine code into the cache and returns its entry point
+void* Jit_InstallCode(const uint8_t* code, size_t size, const char* name, int nameLength);
+
+// Writes the rel32 of a CALL/JMP at site so it lands on target; atomic
+// for running code when its four bytes lie in one aligned 8-byte word
+void Jit_PatchRel32(uint8_t* site, const void* target);
+
+// Writable alias of an installed code address; all stores into the code
+// cache go through it
+void* Jit_WritableAddress(const void* code);
+
+// Per-function accounting, in install order. The table moves when it
+// grows: valid until the next Jit_InstallCode.
+const JitCodeEntry* Jit_GetCodeEntries(int* outCount);
+
+void Jit_GetCodeStats(JitCodeStats* outStats);
+
 #endif // VANARIZE_JIT_EXEC_MEM_H
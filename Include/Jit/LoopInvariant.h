@@ -0,0 +1,41 @@
+#ifndef VANARIZE_JIT_LOOPINVARIANT_H
+#define VANARIZE_JIT_LOOPINVARIANT_H
+
+#include "Compiler/Ast.h"
+
+/**
+ * LOOP-INVARIANT CODE MOTION (analysis)
+ *
+ * Finds the maximal subexpressions of a for-loop (condition, body,
+ * increment) whose value cannot change between iterations:
+ * - arithmetic, comparisons and unary operators over literals and locals
+ *   the loop never assigns or declares
+ * - struct field loads "p.f" when nothing in the loop stores to a field
+ *   named f and the loop makes no calls that could
+ * - "a.length()" when the loop makes no such calls and never pushes/pops
+ *
+ * The result is purely syntactic, so the register allocator (which gives
+ * the values a home spanning the loop) and CodeGen (which evaluates them
+ * once in the preheader) always agree on the list. Nested loops are left
+ * to their own analysis. Expressions that run only on some paths through
+ * the body (under an if, after a return) are taken only when evaluating
+ * them early can never fault.
+ */
+
+#define LICM_MAX_INVARIANTS 8
+
+// Fills out[] in visiting order and returns the count
+int Licm_FindInvariants(ForStmt* loop, AstNode** out, int max);
+
+/**
+ * Counted array loops
+ *
+ *     for (int i = k; i < a.length(); i = i + c) { ... }
+ *
+ * with integer literals k >= 0 and c >= 1, whose body never writes i or a
+ * and neither resizes arrays nor makes calls that could. Every a[i] in the
+ * body then indexes within [0, a.length()). Returns 1 and the two names.
+ */
+int Licm_FindCountedArrayLoop(ForStmt* loop, Token* induction, Token* array);
+
+#endif // VANARIZE_JIT_LOOPINVARIANT_H
@@ -0,0 +1,65 @@
+#ifndef VANARIZE_JIT_REGISTERMAP_H
+#define VANARIZE_JIT_REGISTERMAP_H
+
+#include <stdint.h>
+#include "Compiler/Ast.h"
+
+/**
+ * LINEAR SCAN REGISTER ALLOCATOR
+ *
+ * Runs once per function before emission. Every primitive local and
+ * parameter gets a live interval [start, end] over a linear numbering of
+ * the AST (same visiting order as CodeGen). Intervals that are live into a
+ * for-loop are stretched to the end of the loop so the register survives
+ * the back edge.
+ *
+ * Register classes:
+ * - GPR: int/long/boolean/byte/short/char -> RBX, R12-R15 (callee-saved)
+ * - XMM: double/float                      -> XMM8-XMM15 (caller-saved,
+ *        CodeGen saves the live ones around calls)
+ *
+ * Loop invariants found by Licm_FindInvariants get an interval spanning
+ * their loop when their representation is a known int or double.
+ *
+ * Object references (strings, structs, arrays) are never register
+ * allocated: the conservative GC only scans the machine stack.
+ */
+
+#define REGMAP_MAX_INTERVALS 256
+#define REGMAP_GPR_COUNT 5
+#define REGMAP_XMM_COUNT 8
+
+typedef enum {
+    REG_CLASS_NONE, // Stack only
+    REG_CLASS_GPR,
+    REG_CLASS_XMM
+} RegisterClass;
+
+typedef struct {
+    const void* key;        // VarDecl* for locals, Token* (params[i]) for parameters,
+                            // the expression node for hoisted loop invariants
+    Token name;
+    RegisterClass regClass;
+    int start;              // Linear position of the definition
+    int end;                // Linear position of the last use (loop-extended)
+    int reg;                // Physical Register / XmmRegister, -1 if spilled
+} LiveInterval;
+
+typedef struct {
+    LiveInterval intervals[REGMAP_MAX_INTERVALS];
+    int count;
+    uint32_t usedGprMask;   // Bit N set if Register N is handed out
+    uint32_t usedXmmMask;   // Bit N set if XmmRegister N is handed out
+    int spillCount;         // Intervals that wanted a register but lost
+} RegisterMap;
+
+// Register class for a declared type ("int", "double", ...)
+RegisterClass RegMap_ClassForType(const Token* typeName);
+
+// Computes live intervals for a function and runs linear scan over them
+void RegMap_Allocate(RegisterMap* map, FunctionDecl* func);
+
+// Returns the physical register assigned to a local/param, or -1 (stack)
+int RegMap_Lookup(const RegisterMap* map, const void* key, RegisterClass* outClass);
+
+#endif // VANARIZE_JIT_REGISTERMAP_H
@@ -234,6 +234,12 @@ Token Lexer_NextToken(void) {
             return match('=') ? makeToken(TOKEN_LESS_EQUAL) : makeToken(TOKEN_LESS);
         case '>':
             return match('=') ? makeToken(TOKEN_GREATER_EQUAL) : makeToken(TOKEN_GREATER);
+        case '&':
+            if (match('&')) return makeToken(TOKEN_AND);
+            break;
+        case '|':
+            if (match('|')) return makeToken(TOKEN_OR);
+            break;
         case '"': return string();
     }
 
@@ -0,0 +1,583 @@
+#include "Compiler/Optimizer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define OPT_MAX_SCOPE 256
+#define OPT_MAX_ASSIGNED 256
+
+// Integers beyond 2^53 do not survive the round trip through the literal text
+#define OPT_MAX_EXACT 9007199254740992.0
+
+// Scope tracking during the fold walk (mirrors CodeGen block scoping)
+typedef struct {
+    Token name;
+    Token typeName;
+    LiteralExpr* constant;  // Propagated value, NULL for ordinary locals
+} ScopeEntry;
+
+typedef struct {
+    ScopeEntry scope[OPT_MAX_SCOPE];
+    int scopeCount;
+    int scopeFloor;             // First entry visible from the current function
+    Token assigned[OPT_MAX_ASSIGNED];
+    int assignedBase;           // First name written in the current function
+    int assignedCount;
+    int assignedOverflow;       // Too many names: propagate nothing
+} FoldState;
+
+static AstNode* fold(FoldState* state, AstNode* node);
+
+static int tokenEquals(const Token* a, const Token* b) {
+    return a->length == b->length && memcmp(a->start, b->start, a->length) == 0;
+}
+
+static int tokenIs(const Token* t, const char* text) {
+    int len = (int)strlen(text);
+    return t->start != NULL && t->length == len && memcmp(t->start, text, len) == 0;
+}
+
+// ==================== LITERALS ====================
+
+static int isNumber(AstNode* node) {
+    return node && node->type == NODE_LITERAL_EXPR && ((LiteralExpr*)node)->token.type == TOKEN_NUMBER;
+}
+
+static int isBoolean(AstNode* node) {
+    if (!node || node->type != NODE_LITERAL_EXPR) return 0;
+    TokenType type = ((LiteralExpr*)node)->token.type;
+    return type == TOKEN_TRUE || type == TOKEN_FALSE;
+}
+
+static double numberValue(AstNode* node) {
+    LiteralExpr* lit = (LiteralExpr*)node;
+    char buffer[64];
+    int len = lit->token.length < 63 ? lit->token.length : 63;
+    memcpy(buffer, lit->token.start, len);
+    buffer[len] = '\0';
+    return strtod(buffer, NULL);
+}
+
+// Same rule as CodeGen: no '.' or exponent means an int literal
+static int isIntegral(AstNode* node) {
+    LiteralExpr* lit = (LiteralExpr*)node;
+    for (int i = 0; i < lit->token.length; i++) {
+        char c = lit->token.start[i];
+        if (c == '.' || c == 'e' || c == 'E') return 0;
+    }
+    return 1;
+}
+
+static int isIntegralValue(AstNode* node, double value) {
+    return isNumber(node) && isIntegral(node) && numberValue(node) == value;
+}
+
+static LiteralExpr* newLiteral(TokenType type, const char* text, int length, int line) {
+    LiteralExpr* node = malloc(sizeof(LiteralExpr));
+    node->main.type = NODE_LITERAL_EXPR;
+    node->token.type = type;
+    node->token.start = text;
+    node->token.length = length;
+    node->token.line = line;
+    return node;
+}
+
+// Returns NULL when the value has no exact literal spelling
+static AstNode* makeNumber(double value, int integral, int line) {
+    char buffer[64];
+    if (integral) {
+        if (fabs(value) > OPT_MAX_EXACT) return NULL;
+        snprintf(buffer, sizeof(buffer), "%lld", (long long)value);
+    } else {
+        if (!isfinite(value)) return NULL;
+        snprintf(buffer, sizeof(buffer), "%.17g", value);
+        if (!strpbrk(buffer, ".eE")) strcat(buffer, ".0");
+    }
+    int length = (int)strlen(buffer);
+    char* text = malloc(length + 1);
+    memcpy(text, buffer, length + 1);
+    return (AstNode*)newLiteral(TOKEN_NUMBER, text, length, line);
+}
+
+static AstNode* makeBoolean(int value, int line) {
+    return (AstNode*)newLiteral(value ? TOKEN_TRUE : TOKEN_FALSE,
+                                value ? "true" : "false", value ? 4 : 5, line);
+}
+
+// "a" + "b" -> "ab" (tokens keep their quotes, see NODE_STRING_LITERAL)
+static AstNode* makeString(StringExpr* left, StringExpr* right) {
+    int leftLen = left->token.length - 2;
+    int rightLen = right->token.length - 2;
+    char* text = malloc(leftLen + rightLen + 2);
+    text[0] = '"';
+    memcpy(text + 1, left->token.start + 1, leftLen);
+    memcpy(text + 1 + leftLen, right->token.start + 1, rightLen);
+    text[leftLen + rightLen + 1] = '"';
+
+    StringExpr* node = malloc(sizeof(StringExpr));
+    node->main.type = NODE_STRING_LITERAL;
+    node->token = left->token;
+    node->token.start = text;
+    node->token.length = leftLen + rightLen + 2;
+    return (AstNode*)node;
+}
+
+// ==================== SCOPES ====================
+
+static void collectAssigned(FoldState* state, AstNode* node) {
+    if (!node) return;
+    switch (node->type) {
+        case NODE_BLOCK: {
+            BlockStmt* block = (BlockStmt*)node;
+            for (int i = 0; i < block->count; i++) collectAssigned(state, block->statements[i]);
+            break;
+        }
+        case NODE_ASSIGNMENT_EXPR: {
+            AssignmentExpr* assign = (AssignmentExpr*)node;
+            if (state->assignedCount < OPT_MAX_ASSIGNED) {
+                state->assigned[state->assignedCount++] = assign->name;
+            } else {
+                state->assignedOverflow = 1;
+            }
+            collectAssigned(state, assign->value);
+            break;
+        }
+        case NODE_VAR_DECL:
+            collectAssigned(state, ((VarDecl*)node)->initializer);
+            break;
+        case NODE_SET_EXPR:
+            collectAssigned(state, ((SetExpr*)node)->object);
+            collectAssigned(state, ((SetExpr*)node)->value);
+            break;
+        case NODE_GET_EXPR:
+            collectAssigned(state, ((GetExpr*)node)->object);
+            break;
+        case NODE_CALL_EXPR: {
+            CallExpr* call = (CallExpr*)node;
+            collectAssigned(state, call->callee);
+            for (int i = 0; i < call->argCount; i++) collectAssigned(state, call->args[i]);
+            break;
+        }
+        case NODE_BINARY_EXPR:
+            collectAssigned(state, ((BinaryExpr*)node)->left);
+            collectAssigned(state, ((BinaryExpr*)node)->right);
+            break;
+        case NODE_LOGICAL_EXPR:
+            collectAssigned(state, ((LogicalExpr*)node)->left);
+            collectAssigned(state, ((LogicalExpr*)node)->right);
+            break;
+        case NODE_UNARY_EXPR:
+            collectAssigned(state, ((UnaryExpr*)node)->right);
+            break;
+        case NODE_AWAIT_EXPR:
+            collectAssigned(state, ((AwaitExpr*)node)->expression);
+            break;
+        case NODE_ARRAY_LITERAL: {
+            ArrayLiteral* lit = (ArrayLiteral*)node;
+            for (int i = 0; i < lit->count; i++) collectAssigned(state, lit->elements[i]);
+            break;
+        }
+        case NODE_INDEX_EXPR:
+            collectAssigned(state, ((IndexExpr*)node)->array);
+            collectAssigned(state, ((IndexExpr*)node)->index);
+            break;
+        case NODE_INDEX_SET_EXPR: {
+            IndexSetExpr* set = (IndexSetExpr*)node;
+            collectAssigned(state, set->array);
+            collectAssigned(state, set->index);
+            collectAssigned(state, set->value);
+            break;
+        }
+        case NODE_STRUCT_INIT: {
+            StructInit* init = (StructInit*)node;
+            for (int i = 0; i < init->fieldCount; i++) collectAssigned(state, init->values[i]);
+            break;
+        }
+        case NODE_IF_STMT: {
+            IfStmt* stmt = (IfStmt*)node;
+            collectAssigned(state, stmt->condition);
+            collectAssigned(state, stmt->thenBranch);
+            collectAssigned(state, stmt->elseBranch);
+            break;
+        }
+        case NODE_FOR_STMT: {
+            ForStmt* loop = (ForStmt*)node;
+            collectAssigned(state, loop->initializer);
+            collectAssigned(state, loop->condition);
+            collectAssigned(state, loop->increment);
+            collectAssigned(state, loop->body);
+            break;
+        }
+        case NODE_RETURN_STMT:
+            collectAssigned(state, ((ReturnStmt*)node)->returnValue);
+            break;
+        case NODE_FUNCTION_DECL:   // Nested declarations are folded separately
+        default:
+            break;
+    }
+}
+
+static int isAssigned(FoldState* state, Token* name) {
+    if (state->assignedOverflow) return 1;
+    for (int i = state->assignedBase; i < state->assignedCount; i++) {
+        if (tokenEquals(&state->assigned[i], name)) return 1;
+    }
+    return 0;
+}
+
+static void declare(FoldState* state, Token name, Token typeName, LiteralExpr* constant) {
+    if (state->scopeCount < OPT_MAX_SCOPE) {
+        state->scope[state->scopeCount].name = name;
+        state->scope[state->scopeCount].typeName = typeName;
+        state->scope[state->scopeCount].constant = constant;
+        state->scopeCount++;
+    } else {
+        // Out of room: hide every outer binding of this name instead
+        state->assignedOverflow = 1;
+    }
+}
+
+static ScopeEntry* lookup(FoldState* state, Token* name) {
+    if (state->assignedOverflow) return NULL;
+    // Scan backwards to honour shadowing
+    for (int i = state->scopeCount - 1; i >= state->scopeFloor; i--) {
+        if (tokenEquals(&state->scope[i].name, name)) return &state->scope[i];
+    }
+    return NULL;
+}
+
+// The constant an int/double declaration pins its name to, or NULL
+static LiteralExpr* declaredConstant(FoldState* state, VarDecl* decl) {
+    if (!isNumber(decl->initializer) || isAssigned(state, &decl->name)) return NULL;
+    double value = numberValue(decl->initializer);
+    int line = decl->name.line;
+    if (tokenIs(&decl->typeName, "int")) {
+        // Same truncation the declaration applies when it stores the value
+        if (isIntegral(decl->initializer)) return (LiteralExpr*)decl->initializer;
+        return (LiteralExpr*)makeNumber(trunc(value), 1, line);
+    }
+    if (tokenIs(&decl->typeName, "double")) {
+        if (!isIntegral(decl->initializer)) return (LiteralExpr*)decl->initializer;
+        return (LiteralExpr*)makeNumber(value, 0, line);
+    }
+    return NULL;
+}
+
+// Operands whose '+' can never turn into string concatenation
+static int isNumericExpr(FoldState* state, AstNode* node) {
+    switch (node->type) {
+        case NODE_LITERAL_EXPR: {
+            LiteralExpr* lit = (LiteralExpr*)node;
+            if (lit->token.type == TOKEN_NUMBER) return 1;
+            if (lit->token.type != TOKEN_IDENTIFIER) return 0;
+            ScopeEntry* entry = lookup(state, &lit->token);
+            if (!entry) return 0;
+            Token* t = &entry->typeName;
+            return tokenIs(t, "int") || tokenIs(t, "long") || tokenIs(t, "double") ||
+                   tokenIs(t, "float") || tokenIs(t, "byte") || tokenIs(t, "short") ||
+                   tokenIs(t, "char");
+        }
+        case NODE_BINARY_EXPR: {
+            BinaryExpr* bin = (BinaryExpr*)node;
+            TokenType op = bin->op.type;
+            if (op == TOKEN_MINUS || op == TOKEN_STAR || op == TOKEN_SLASH) return 1;
+            if (op == TOKEN_PLUS) return isNumericExpr(state, bin->left) && isNumericExpr(state, bin->right);
+            return 0;
+        }
+        case NODE_UNARY_EXPR:
+            return ((UnaryExpr*)node)->op.type == TOKEN_MINUS;
+        default:
+            return 0;
+    }
+}
+
+// ==================== FOLDING ====================
+
+static AstNode* foldUnary(UnaryExpr* unary) {
+    AstNode* right = unary->right;
+    int line = unary->op.line;
+    if (unary->op.type == TOKEN_MINUS && isNumber(right)) {
+        AstNode* folded = makeNumber(-numberValue(right), isIntegral(right), line);
+        if (folded) return folded;
+    }
+    if (unary->op.type == TOKEN_BANG && isBoolean(right)) {
+        return makeBoolean(((LiteralExpr*)right)->token.type == TOKEN_FALSE, line);
+    }
+    return (AstNode*)unary;
+}
+
+// A constant left side decides && / || or reduces it to a boolean right side
+static AstNode* foldLogical(LogicalExpr* logic) {
+    if (!isBoolean(logic->left)) return (AstNode*)logic;
+    int leftTrue = ((LiteralExpr*)logic->left)->token.type == TOKEN_TRUE;
+    int decides = logic->op.type == TOKEN_AND ? !leftTrue : leftTrue;
+    if (decides) return makeBoolean(leftTrue, logic->op.line);
+    if (isBoolean(logic->right)) return logic->right;
+    return (AstNode*)logic;
+}
+
+static AstNode* foldConstantBinary(BinaryExpr* bin) {
+    AstNode* left = bin->left;
+    AstNode* right = bin->right;
+    TokenType op = bin->op.type;
+    int line = bin->op.line;
+
+    if (op == TOKEN_PLUS && left->type == NODE_STRING_LITERAL && right->type == NODE_STRING_LITERAL) {
+        return makeString((StringExpr*)left, (StringExpr*)right);
+    }
+    if (!isNumber(left) || !isNumber(right)) return NULL;
+
+    double a = numberValue(left);
+    double b = numberValue(right);
+    // Integers past 2^53 are not exact as doubles; leave them to CodeGen
+    if (isIntegral(left) && isIntegral(right) && (fabs(a) > OPT_MAX_EXACT || fabs(b) > OPT_MAX_EXACT)) return NULL;
+    switch (op) {
+        case TOKEN_LESS:          return makeBoolean(a < b, line);
+        case TOKEN_LESS_EQUAL:    return makeBoolean(a <= b, line);
+        case TOKEN_GREATER:       return makeBoolean(a > b, line);
+        case TOKEN_GREATER_EQUAL: return makeBoolean(a >= b, line);
+        case TOKEN_EQUAL_EQUAL:   return makeBoolean(a == b, line);
+        case TOKEN_BANG_EQUAL:    return makeBoolean(a != b, line);
+        default: break;
+    }
+
+    if (isIntegral(left) && isIntegral(right)) {
+        // int op int stays int (64-bit, division truncates)
+        if (fabs(a) > OPT_MAX_EXACT || fabs(b) > OPT_MAX_EXACT) return NULL;
+        long long x = (long long)a, y = (long long)b, r;
+        switch (op) {
+            case TOKEN_PLUS:  r = x + y; break;
+            case TOKEN_MINUS: r = x - y; break;
+            case TOKEN_STAR:
+                if (__builtin_mul_overflow(x, y, &r)) return NULL;
+                break;
+            case TOKEN_SLASH:
+                if (y == 0) return NULL;
+                r = x / y;
+                break;
+            default: return NULL;
+        }
+        return makeNumber((double)r, 1, line);
+    }
+
+    switch (op) {
+        case TOKEN_PLUS:  return makeNumber(a + b, 0, line);
+        case TOKEN_MINUS: return makeNumber(a - b, 0, line);
+        case TOKEN_STAR:  return makeNumber(a * b, 0, line);
+        case TOKEN_SLASH: return makeNumber(a / b, 0, line);
+        default:          return NULL;
+    }
+}
+
+static AstNode* foldBinary(FoldState* state, BinaryExpr* bin) {
+    AstNode* folded = foldConstantBinary(bin);
+    if (folded) return folded;
+
+    // Identities with an int literal keep the other operand's representation
+    AstNode* left = bin->left;
+    AstNode* right = bin->right;
+    switch (bin->op.type) {
+        case TOKEN_PLUS:
+            if (isIntegralValue(right, 0.0) && isNumericExpr(state, left)) return left;
+            if (isIntegralValue(left, 0.0) && isNumericExpr(state, right)) return right;
+            break;
+        case TOKEN_MINUS:
+            if (isIntegralValue(right, 0.0) && isNumericExpr(state, left)) return left;
+            break;
+        case TOKEN_STAR:
+            if (isIntegralValue(right, 1.0) && isNumericExpr(state, left)) return left;
+            if (isIntegralValue(left, 1.0) && isNumericExpr(state, right)) return right;
+            break;
+        case TOKEN_SLASH:
+            if (isIntegralValue(right, 1.0) && isNumericExpr(state, left)) return left;
+            break;
+        default:
+            break;
+    }
+    return (AstNode*)bin;
+}
+
+static void foldFunction(FoldState* state, FunctionDecl* func) {
+    // Functions see none of the enclosing locals (fresh CompilerContext)
+    int savedScopeCount = state->scopeCount;
+    int savedScopeFloor = state->scopeFloor;
+    int savedAssignedBase = state->assignedBase;
+    int savedAssignedCount = state->assignedCount;
+    int savedOverflow = state->assignedOverflow;
+
+    state->scopeFloor = state->scopeCount;
+    state->assignedBase = state->assignedCount;
+    state->assignedOverflow = 0;
+    collectAssigned(state, func->body);
+
+    for (int i = 0; i < func->paramCount; i++) declare(state, func->params[i], func->paramTypes[i], NULL);
+    func->body = fold(state, func->body);
+
+    state->scopeCount = savedScopeCount;
+    state->scopeFloor = savedScopeFloor;
+    state->assignedBase = savedAssignedBase;
+    state->assignedCount = savedAssignedCount;
+    state->assignedOverflow = savedOverflow;
+}
+
+static AstNode* fold(FoldState* state, AstNode* node) {
+    if (!node) return NULL;
+
+    switch (node->type) {
+        case NODE_BLOCK: {
+            BlockStmt* block = (BlockStmt*)node;
+            int savedScope = state->scopeCount;
+            for (int i = 0; i < block->count; i++) {
+                block->statements[i] = fold(state, block->statements[i]);
+            }
+            state->scopeCount = savedScope;
+            return node;
+        }
+        case NODE_VAR_DECL: {
+            VarDecl* decl = (VarDecl*)node;
+            decl->initializer = fold(state, decl->initializer);
+            declare(state, decl->name, decl->typeName, declaredConstant(state, decl));
+            return node;
+        }
+        case NODE_LITERAL_EXPR: {
+            LiteralExpr* lit = (LiteralExpr*)node;
+            if (lit->token.type != TOKEN_IDENTIFIER) return node;
+            ScopeEntry* entry = lookup(state, &lit->token);
+            if (!entry || !entry->constant) return node;
+            LiteralExpr* constant = entry->constant;
+            // Fresh node per use: CodeGen keys some state by node identity
+            return (AstNode*)newLiteral(TOKEN_NUMBER, constant->token.start,
+                                        constant->token.length, lit->token.line);
+        }
+        case NODE_ASSIGNMENT_EXPR: {
+            AssignmentExpr* assign = (AssignmentExpr*)node;
+            assign->value = fold(state, assign->value);
+            return node;
+        }
+        case NODE_SET_EXPR: {
+            SetExpr* set = (SetExpr*)node;
+            set->object = fold(state, set->object);
+            set->value = fold(state, set->value);
+            return node;
+        }
+        case NODE_GET_EXPR: {
+            GetExpr* get = (GetExpr*)node;
+            get->object = fold(state, get->object);
+            return node;
+        }
+        case NODE_CALL_EXPR: {
+            CallExpr* call = (CallExpr*)node;
+            // A plain name in callee position is a function, never a constant
+            if (call->callee->type != NODE_LITERAL_EXPR) call->callee = fold(state, call->callee);
+            for (int i = 0; i < call->argCount; i++) call->args[i] = fold(state, call->args[i]);
+            return node;
+        }
+        case NODE_BINARY_EXPR: {
+            BinaryExpr* bin = (BinaryExpr*)node;
+            bin->left = fold(state, bin->left);
+            bin->right = fold(state, bin->right);
+            return foldBinary(state, bin);
+        }
+        case NODE_LOGICAL_EXPR: {
+            LogicalExpr* logic = (LogicalExpr*)node;
+            logic->left = fold(state, logic->left);
+            logic->right = fold(state, logic->right);
+            return foldLogical(logic);
+        }
+        case NODE_UNARY_EXPR: {
+            UnaryExpr* unary = (UnaryExpr*)node;
+            unary->right = fold(state, unary->right);
+            return foldUnary(unary);
+        }
+        case NODE_AWAIT_EXPR: {
+            AwaitExpr* await = (AwaitExpr*)node;
+            await->expression = fold(state, await->expression);
+            return node;
+        }
+        case NODE_ARRAY_LITERAL: {
+            ArrayLiteral* lit = (ArrayLiteral*)node;
+            for (int i = 0; i < lit->count; i++) lit->elements[i] = fold(state, lit->elements[i]);
+            return node;
+        }
+        case NODE_INDEX_EXPR: {
+            IndexExpr* index = (IndexExpr*)node;
+            index->array = fold(state, index->array);
+            index->index = fold(state, index->index);
+            return node;
+        }
+        case NODE_INDEX_SET_EXPR: {
+            IndexSetExpr* set = (IndexSetExpr*)node;
+            set->array = fold(state, set->array);
+            set->index = fold(state, set->index);
+            set->value = fold(state, set->value);
+            return node;
+        }
+        case NODE_STRUCT_INIT: {
+            StructInit* init = (StructInit*)node;
+            for (int i = 0; i < init->fieldCount; i++) init->values[i] = fold(state, init->values[i]);
+            return node;
+        }
+        case NODE_IF_STMT: {
+            IfStmt* stmt = (IfStmt*)node;
+            stmt->condition = fold(state, stmt->condition);
+            stmt->thenBranch = fold(state, stmt->thenBranch);
+            stmt->elseBranch = fold(state, stmt->elseBranch);
+            if (!isBoolean(stmt->condition)) return node;
+
+            // Constant condition: keep only the branch that runs
+            AstNode* taken = ((LiteralExpr*)stmt->condition)->token.type == TOKEN_TRUE
+                           ? stmt->thenBranch : stmt->elseBranch;
+            if (taken && taken->type == NODE_BLOCK) return taken;
+            BlockStmt* block = malloc(sizeof(BlockStmt));
+            block->main.type = NODE_BLOCK;
+            block->count = taken ? 1 : 0;
+            block->statements = malloc(sizeof(AstNode*));
+            block->statements[0] = taken;
+            return (AstNode*)block;
+        }
+        case NODE_FOR_STMT: {
+            ForStmt* loop = (ForStmt*)node;
+            // Initializer lives in the enclosing scope (CodeGen opens no block for it)
+            loop->initializer = fold(state, loop->initializer);
+            loop->condition = fold(state, loop->condition);
+            loop->increment = fold(state, loop->increment);
+            loop->body = fold(state, loop->body);
+            return node;
+        }
+        case NODE_RETURN_STMT: {
+            ReturnStmt* stmt = (ReturnStmt*)node;
+            stmt->returnValue = fold(state, stmt->returnValue);
+            return node;
+        }
+        case NODE_FUNCTION_DECL:
+            foldFunction(state, (FunctionDecl*)node);
+            return node;
+        case NODE_STRING_LITERAL:
+        case NODE_STRUCT_DECL:
+        default:
+            return node;
+    }
+}
+
+void Optimizer_FoldProgram(AstNode* root) {
+    if (!root) return;
+    FoldState* state = malloc(sizeof(FoldState));
+    state->scopeCount = 0;
+    state->scopeFloor = 0;
+    state->assignedBase = 0;
+    state->assignedCount = 0;
+    state->assignedOverflow = 0;
+    collectAssigned(state, root);
+
+    // The root block keeps its identity: Jit_Compile walks it directly
+    if (root->type == NODE_BLOCK) {
+        BlockStmt* block = (BlockStmt*)root;
+        for (int i = 0; i < block->count; i++) {
+            block->statements[i] = fold(state, block->statements[i]);
+        }
+    } else {
+        fold(state, root);
+    }
+    free(state);
+}
@@ -4,12 +4,14 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
+#include <errno.h>
 
 static Token currentToken;
 static Token previousToken;
 static Token nextToken; // Lookahead
 
 static const char* currentNamespacePrefix = NULL;
+static const char* currentFile = NULL;   // Path of the file being parsed (debug info)
 
 // Forward declarations
 static void scanNext();
@@ -20,6 +22,7 @@ typedef struct {
     Token previous;
     Token next;
     const char* namespacePrefix;
+    const char* file;
 } ParserState;
 
 static ParserState Parser_GetState() {
@@ -28,6 +31,7 @@ static ParserState Parser_GetState() {
     state.previous = previousToken;
     state.next = nextToken;
     state.namespacePrefix = currentNamespacePrefix;
+    state.file = currentFile;
     return state;
 }
 
@@ -36,6 +40,7 @@ static void Parser_RestoreState(ParserState state) {
     previousToken = state.previous;
     nextToken = state.next;
     currentNamespacePrefix = state.namespacePrefix;
+    currentFile = state.file;
 }
 
 static char* readFile(const char* path) {
@@ -62,9 +67,32 @@ static char* readFile(const char* path) {
     return buffer;
 }
 
+// Every file pulled in by an import, in load order
+static const char** importedFiles = NULL;
+static int importedFileCount = 0;
+
+static void recordImport(const char* path) {
+    importedFiles = realloc(importedFiles, sizeof(char*) * (importedFileCount + 1));
+    importedFiles[importedFileCount++] = path;
+}
+
+const char* const* Parser_GetImports(int* outCount) {
+    *outCount = importedFileCount;
+    return importedFiles;
+}
+
 // Forward declare declaration
 static AstNode* declaration();
 
+// Appends to a block, doubling its statement array when full
+static void appendStatement(BlockStmt* block, int* capacity, AstNode* stmt) {
+    if (block->count >= *capacity) {
+        *capacity *= 2;
+        block->statements = realloc(block->statements, sizeof(AstNode*) * (*capacity));
+    }
+    block->statements[block->count++] = stmt;
+}
+
 static AstNode* compileFile(const char* path, const char* namespacePrefix) {
     // 1. Save State
     ParserState pState = Parser_GetState();
@@ -76,17 +104,19 @@ static AstNode* compileFile(const char* path, const char* namespacePrefix) {
     // 3. Init Compiler for new file
     Lexer_Init(source);
     currentNamespacePrefix = namespacePrefix;
+    currentFile = path;
     scanNext(); // Prime
     advance();  // Prime
     
     // 4. Parse File (Program Level)
     BlockStmt* block = malloc(sizeof(BlockStmt));
     block->main.type = NODE_BLOCK;
-    block->statements = malloc(sizeof(AstNode*) * 1024);
+    int capacity = 1024;
+    block->statements = malloc(sizeof(AstNode*) * capacity);
     block->count = 0;
     
     while (currentToken.type != TOKEN_EOF) {
-        block->statements[block->count++] = declaration();
+        appendStatement(block, &capacity, declaration());
     }
     
     // 5. Restore State
@@ -123,6 +153,10 @@ static void consume(TokenType type, const char* message) {
     exit(1);
 }
 
+void Parser_SetFile(const char* path) {
+    currentFile = path;
+}
+
 void Parser_Init(const char* source) {
     Lexer_Init(source);
     scanNext(); // Fill nextToken with 1st token
@@ -132,6 +166,8 @@ void Parser_Init(const char* source) {
 // Forward decls
 static AstNode* expression();
 static AstNode* assignment();
+static AstNode* logicOr();
+static AstNode* logicAnd();
 static AstNode* equality();
 static AstNode* comparison();
 static AstNode* term();
@@ -146,7 +182,7 @@ static AstNode* expression() {
 }
 
 static AstNode* assignment() {
-    AstNode* expr = equality();
+    AstNode* expr = logicOr();
     
     if (currentToken.type == TOKEN_EQUAL) {
         advance();
@@ -189,12 +225,45 @@ static AstNode* assignment() {
     return expr;
 }
 
+// logicOr() parses || (or), logicAnd() parses && (and), binding looser
+// than equality: a < b && c == d groups as (a < b) && (c == d)
 // term() parses binary + -
 // factor() parses * /
 // call() parses calls
 // primary() parses literals and identifiers.
 
 
+static AstNode* logical(AstNode* left, Token op, AstNode* right) {
+    LogicalExpr* node = malloc(sizeof(LogicalExpr));
+    node->main.type = NODE_LOGICAL_EXPR;
+    node->left = left;
+    node->right = right;
+    node->op = op;
+    return (AstNode*)node;
+}
+
+static AstNode* logicOr() {
+    AstNode* expr = logicAnd();
+    
+    while (currentToken.type == TOKEN_OR) {
+        Token op = currentToken;
+        advance();
+        expr = logical(expr, op, logicAnd());
+    }
+    return expr;
+}
+
+static AstNode* logicAnd() {
+    AstNode* expr = equality();
+    
+    while (currentToken.type == TOKEN_AND) {
+        Token op = currentToken;
+        advance();
+        expr = logical(expr, op, equality());
+    }
+    return expr;
+}
+
 static AstNode* equality() {
     AstNode* expr = comparison();
     
@@ -349,8 +418,26 @@ static AstNode* factor() {
 }
 
 
+// Integer literals are exact int64 values (CodeGen reads them with
+// strtoll), so one that does not fit is rejected here rather than rounded
+static void checkIntegerLiteral(Token* token) {
+    if (memchr(token->start, '.', token->length)) return;
+    char buffer[64];
+    int len = token->length < 63 ? token->length : 63;
+    memcpy(buffer, token->start, len);
+    buffer[len] = '\0';
+    errno = 0;
+    strtoll(buffer, NULL, 10);
+    if (errno == ERANGE || token->length > 63) {
+        fprintf(stderr, "[Parser] Error at line %d: Integer literal '%.*s' does not fit in 64 bits.\n",
+                token->line, token->length, token->start);
+        exit(1);
+    }
+}
+
 static AstNode* primary() {
     if (currentToken.type == TOKEN_NUMBER) {
+        checkIntegerLiteral(&currentToken);
         LiteralExpr* node = malloc(sizeof(LiteralExpr));
         node->main.type = NODE_LITERAL_EXPR;
         node->token = currentToken;
@@ -525,7 +612,7 @@ static AstNode* declaration() {
         nsPrefix[nameLen + 1] = '\0';
         
         AstNode* moduleBlock = compileFile(path, nsPrefix);
-        free(path); // Path is temporary, source read is persistent
+        recordImport(path); // Keeps the path (code cache dependencies)
         // nsPrefix is persistent? Used in compileFile for CURRENT prefix.
         // But tokens created will point to strings? 
         // Fn name creation needs to allocate new Token string. 
@@ -715,6 +802,14 @@ static AstNode* declaration() {
                     currentToken.type == TOKEN_TYPE_STRING) {
                     typeToken = currentToken;
                     advance();
+                    
+                    // Array Type: int[] xs
+                    if (currentToken.type == TOKEN_LEFT_BRACKET) {
+                        advance();
+                        consume(TOKEN_RIGHT_BRACKET, "Expect ']' after '[' for array type.");
+                        const char* end = previousToken.start + previousToken.length;
+                        typeToken.length = (int)(end - typeToken.start);
+                    }
                 } else if (currentToken.type == TOKEN_IDENTIFIER && nextToken.type == TOKEN_IDENTIFIER) {
                     // Struct Type
                     typeToken = currentToken;
@@ -750,11 +845,12 @@ static AstNode* declaration() {
         consume(TOKEN_LEFT_BRACE, "Expect '{' before function body.");
         BlockStmt* body = malloc(sizeof(BlockStmt));
         body->main.type = NODE_BLOCK;
-        body->statements = malloc(sizeof(AstNode*) * 64);
+        int capacity = 64;
+        body->statements = malloc(sizeof(AstNode*) * capacity);
         body->count = 0;
         
         while (currentToken.type != TOKEN_RIGHT_BRACE && currentToken.type != TOKEN_EOF) {
-            body->statements[body->count++] = declaration();
+            appendStatement(body, &capacity, declaration());
         }
         consume(TOKEN_RIGHT_BRACE, "Expect '}' after function body.");
         
@@ -767,12 +863,71 @@ static AstNode* declaration() {
         node->returnType = returnType;
         node->body = (AstNode*)body;
         node->isAsync = isAsync;  // MASTERPLAN: async flag
+        node->file = currentFile;
         return (AstNode*)node;
     }
 
     return statement();
 }
 
+// Is the statement at the current token `name++` or `name--`? The lexer
+// has no ++/-- tokens, so that a--1 and a+-b keep their meaning inside
+// expressions; here two adjacent '+' (or '-') after a bare name, closing
+// the statement or a for increment, make an increment.
+static bool atIncrement() {
+    if (currentToken.type != TOKEN_IDENTIFIER) return false;
+    if (nextToken.type != TOKEN_PLUS && nextToken.type != TOKEN_MINUS) return false;
+
+    ParserState pState = Parser_GetState();
+    LexerState lState = Lexer_GetState();
+    advance();
+    Token first = currentToken;
+    bool found = nextToken.type == first.type && nextToken.start == first.start + 1;
+    if (found) {
+        advance();
+        found = nextToken.type == TOKEN_SEMICOLON || nextToken.type == TOKEN_RIGHT_PAREN;
+    }
+    Parser_RestoreState(pState);
+    Lexer_RestoreState(lState);
+    return found;
+}
+
+// An expression in statement position. i++ and i-- are statements, not
+// expressions: they desugar to i = i + 1 / i = i - 1, so the passes that
+// recognize counted loops see the same shape either way.
+static AstNode* expressionStatement() {
+    if (!atIncrement()) return expression();
+
+    Token name = currentToken;
+    advance();
+    Token op = currentToken;
+    advance();
+    advance();
+
+    LiteralExpr* var = malloc(sizeof(LiteralExpr));
+    var->main.type = NODE_LITERAL_EXPR;
+    var->token = name;
+
+    LiteralExpr* one = malloc(sizeof(LiteralExpr));
+    one->main.type = NODE_LITERAL_EXPR;
+    one->token = op;
+    one->token.type = TOKEN_NUMBER;
+    one->token.start = "1";
+    one->token.length = 1;
+
+    BinaryExpr* step = malloc(sizeof(BinaryExpr));
+    step->main.type = NODE_BINARY_EXPR;
+    step->left = (AstNode*)var;
+    step->right = (AstNode*)one;
+    step->op = op;
+
+    AssignmentExpr* node = malloc(sizeof(AssignmentExpr));
+    node->main.type = NODE_ASSIGNMENT_EXPR;
+    node->name = name;
+    node->value = (AstNode*)step;
+    return (AstNode*)node;
+}
+
 static AstNode* statement() {
     if (currentToken.type == TOKEN_RETURN) {
         advance();
@@ -834,7 +989,7 @@ static AstNode* statement() {
         // 3. Increment
         AstNode* increment = NULL;
         if (currentToken.type != TOKEN_RIGHT_PAREN) {
-            increment = expression();
+            increment = expressionStatement();
         }
         consume(TOKEN_RIGHT_PAREN, "Expect ')' after for clauses.");
         
@@ -861,17 +1016,18 @@ static AstNode* statement() {
         advance();
         BlockStmt* node = malloc(sizeof(BlockStmt));
         node->main.type = NODE_BLOCK;
-        node->statements = malloc(sizeof(AstNode*) * 64);
+        int capacity = 64;
+        node->statements = malloc(sizeof(AstNode*) * capacity);
         node->count = 0;
         
         while (currentToken.type != TOKEN_RIGHT_BRACE && currentToken.type != TOKEN_EOF) {
-            node->statements[node->count++] = declaration();
+            appendStatement(node, &capacity, declaration());
         }
         consume(TOKEN_RIGHT_BRACE, "Expect '}' after block.");
         return (AstNode*)node;
     }
     
-    AstNode* expr = expression();
+    AstNode* expr = expressionStatement();
     consume(TOKEN_SEMICOLON, "Expect ';' after expression.");
     return expr;
 }
@@ -883,14 +1039,12 @@ AstNode* Parser_ParseExpression(void) {
     // We'll create a BlockStmt node to hold everything
     BlockStmt* block = malloc(sizeof(BlockStmt));
     block->main.type = NODE_BLOCK;
-    block->statements = malloc(sizeof(AstNode*) * 64); // Max 64 stmts
-    block->count = 0;
-    
+    int capacity = 64;
+    block->statements = malloc(sizeof(AstNode*) * capacity);
     block->count = 0;
     
     while (currentToken.type != TOKEN_EOF) {
-        AstNode* decl = declaration();
-        block->statements[block->count++] = decl;
+        appendStatement(block, &capacity, declaration());
     }
     
     return (AstNode*)block;
@@ -104,8 +104,12 @@ static void markValue(Value value) {
         }
     } else if (obj->type == OBJ_ARRAY) {
         ObjArray* arr = (ObjArray*)obj;
-        for (int i = 0; i < arr->count; i++) {
-            markValue(arr->elements[i]);
+        // Typed arrays hold raw numbers, nothing to trace
+        if (arr->kind == ARRAY_VALUE) {
+            Value* elements = (Value*)arr->elements;
+            for (int i = 0; i < arr->count; i++) {
+                markValue(elements[i]);
+            }
         }
     }
 }
@@ -1,3 +1,4 @@
+#define _DEFAULT_SOURCE
 #include "Core/Memory.h"
 #include "Core/GarbageCollector.h"
 #include <sys/mman.h>
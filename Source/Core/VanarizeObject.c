@@ -31,51 +31,146 @@ ObjString* NewString(const char* chars, int length) {
 }
 
 // Array Implementation
-ObjArray* Runtime_NewArray(int capacity) {
-    printf("[Runtime] NewArray Checkpoint 1\n");
+static size_t elementSize(ArrayKind kind) {
+    return (kind == ARRAY_INT32 || kind == ARRAY_FLOAT32) ? 4 : 8;
+}
+
+ObjArray* Runtime_NewTypedArray(ArrayKind kind, int capacity) {
     ObjArray* array = (ObjArray*)GC_Allocate(sizeof(ObjArray));
-    printf("[Runtime] NewArray Checkpoint 2\n");
     array->obj.type = OBJ_ARRAY;
     array->count = 0;
-    array->capacity = capacity;
-    array->elements = malloc(sizeof(Value) * capacity);
-    printf("[Runtime] NewArray Allocated %p. Elements %p\n", array, array->elements);
+    array->capacity = capacity < 4 ? 4 : capacity;
+    array->kind = kind;
+    array->elements = malloc(elementSize(kind) * array->capacity);
     return array;
 }
 
-void Runtime_ArrayPush(ObjArray* arr, Value val) {
-    if (!arr) { printf("FATAL: Push to NULL Array\n"); exit(1); }
-    printf("[Runtime] Push to %p Val %lx\n", arr, val);
-    if (arr->count >= arr->capacity) {
-        arr->capacity *= 2;
-        arr->elements = realloc(arr->elements, sizeof(Value) * arr->capacity);
-    }
-    arr->elements[arr->count++] = val;
+ObjArray* Runtime_NewArray(int capacity) {
+    return Runtime_NewTypedArray(ARRAY_VALUE, capacity);
 }
 
-Value Runtime_ArrayGet(ObjArray* arr, int index) {
+static void checkIndex(ObjArray* arr, int index) {
     if (index < 0 || index >= arr->count) {
         fprintf(stderr, "Array Index Out of Bounds: %d (Size: %d)\n", index, arr->count);
         exit(1);
     }
-    return arr->elements[index];
 }
 
-void Runtime_ArraySet(ObjArray* arr, int index, Value val) {
-    if (index < 0 || index >= arr->count) {
-        fprintf(stderr, "Array Index Out of Bounds: %d (Size: %d)\n", index, arr->count);
-        exit(1);
+static void ensureCapacity(ObjArray* arr) {
+    if (arr->count < arr->capacity) return;
+    arr->capacity *= 2;
+    arr->elements = realloc(arr->elements, elementSize(arr->kind) * arr->capacity);
+}
+
+// Raw element <-> register form of the array's own kind
+static uint64_t loadRaw(ObjArray* arr, int index) {
+    switch (arr->kind) {
+        case ARRAY_INT32:
+            return (uint64_t)(int64_t)((int32_t*)arr->elements)[index];
+        case ARRAY_FLOAT32: {
+            uint32_t bits;
+            memcpy(&bits, (float*)arr->elements + index, sizeof(bits));
+            return bits;
+        }
+        default:
+            return ((uint64_t*)arr->elements)[index];
+    }
+}
+
+static void storeRaw(ObjArray* arr, int index, uint64_t bits) {
+    switch (arr->kind) {
+        case ARRAY_INT32:
+            ((int32_t*)arr->elements)[index] = (int32_t)(int64_t)bits;
+            break;
+        case ARRAY_FLOAT32: {
+            uint32_t low = (uint32_t)bits;
+            memcpy((float*)arr->elements + index, &low, sizeof(low));
+            break;
+        }
+        default:
+            ((uint64_t*)arr->elements)[index] = bits;
+            break;
+    }
+}
+
+// Register form of 'kind' <-> boxed Value (typed elements box as numbers)
+static Value rawToValue(uint64_t bits, ArrayKind kind) {
+    switch (kind) {
+        case ARRAY_INT32:
+        case ARRAY_INT64:
+            return NumberToValue((double)(int64_t)bits);
+        case ARRAY_FLOAT32: {
+            float f;
+            uint32_t low = (uint32_t)bits;
+            memcpy(&f, &low, sizeof(f));
+            return NumberToValue(f);
+        }
+        default:
+            return (Value)bits;   // Double bits are the boxed number
     }
-    arr->elements[index] = val;
+}
+
+static uint64_t valueToRaw(Value val, ArrayKind kind) {
+    if (kind == ARRAY_VALUE) return val;
+    double num = IsNumber(val) ? ValueToNumber(val) : 0.0;
+    switch (kind) {
+        case ARRAY_INT32:
+        case ARRAY_INT64:
+            return (uint64_t)(int64_t)num;
+        case ARRAY_FLOAT32: {
+            float f = (float)num;
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            return bits;
+        }
+        default:
+            return NumberToValue(num);
+    }
+}
+
+void Runtime_ArrayPush(ObjArray* arr, Value val) {
+    if (!arr) { printf("FATAL: Push to NULL Array\n"); exit(1); }
+    ensureCapacity(arr);
+    storeRaw(arr, arr->count++, valueToRaw(val, arr->kind));
+}
+
+Value Runtime_ArrayGet(ObjArray* arr, int index) {
+    checkIndex(arr, index);
+    return rawToValue(loadRaw(arr, index), arr->kind);
+}
+
+void Runtime_ArraySet(ObjArray* arr, int index, Value val) {
+    checkIndex(arr, index);
+    storeRaw(arr, index, valueToRaw(val, arr->kind));
 }
 
 int Runtime_ArrayLength(ObjArray* arr) {
     if (!arr) { printf("FATAL: Length of NULL\n"); exit(1); }
-    printf("[Runtime] Length of %p is %d\n", arr, arr->count);
     return arr->count;
 }
 
 Value Runtime_ArrayPop(ObjArray* arr) {
     if (arr->count == 0) return VAL_NULL;
-    return arr->elements[--arr->count];
+    arr->count--;
+    return rawToValue(loadRaw(arr, arr->count), arr->kind);
+}
+
+uint64_t Runtime_ArrayGetRaw(ObjArray* arr, int index, ArrayKind as) {
+    checkIndex(arr, index);
+    uint64_t bits = loadRaw(arr, index);
+    if (arr->kind == as) return bits;
+    return valueToRaw(rawToValue(bits, arr->kind), as);
+}
+
+void Runtime_ArraySetRaw(ObjArray* arr, int index, uint64_t bits, ArrayKind as) {
+    checkIndex(arr, index);
+    if (arr->kind != as) bits = valueToRaw(rawToValue(bits, as), arr->kind);
+    storeRaw(arr, index, bits);
+}
+
+void Runtime_ArrayPushRaw(ObjArray* arr, uint64_t bits, ArrayKind as) {
+    if (!arr) { printf("FATAL: Push to NULL Array\n"); exit(1); }
+    ensureCapacity(arr);
+    if (arr->kind != as) bits = valueToRaw(rawToValue(bits, as), arr->kind);
+    storeRaw(arr, arr->count++, bits);
 }
@@ -2,23 +2,101 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+// Instructions the peephole window can hold
+enum {
+    PEEP_NONE,
+    PEEP_PUSH,          // A = register
+    PEEP_ADD_RSP,       // A = amount
+    PEEP_SUB_RSP,       // A = amount
+    PEEP_MOVQ_TO_XMM,   // A = xmm, B = gpr
+    PEEP_MOVQ_TO_GPR    // A = gpr, B = xmm
+};
+
+static void peepRecord(Assembler* as, int kind, size_t start, int a, int b) {
+    as->peepKind = kind;
+    as->peepStart = start;
+    as->peepEnd = as->offset;
+    as->peepA = a;
+    as->peepB = b;
+}
+
+// The window still holds the instruction just before the current offset
+static int peepMatch(Assembler* as, int kind, int a, int b) {
+    return as->peepKind == kind && as->peepEnd == as->offset && as->peepA == a && as->peepB == b;
+}
+
+static void peepDrop(Assembler* as) {
+    as->offset = as->peepStart;
+    as->peepKind = PEEP_NONE;
+}
+
 void Asm_Init(Assembler* as, uint8_t* buffer, size_t capacity) {
     as->buffer = buffer;
     as->capacity = capacity;
     as->offset = 0;
+    as->growable = 0;
+    as->peepKind = PEEP_NONE;
+}
+
+size_t Asm_Label(Assembler* as) {
+    as->peepKind = PEEP_NONE;
+    return as->offset;
+}
+
+void Asm_InitDynamic(Assembler* as, size_t initialCapacity) {
+    Asm_Init(as, malloc(initialCapacity), initialCapacity);
+    if (!as->buffer) {
+        fprintf(stderr, "[Vanarize Assembler] Error: Out of memory\n");
+        exit(1);
+    }
+    as->growable = 1;
+}
+
+void Asm_Free(Assembler* as) {
+    if (as->growable) free(as->buffer);
+    as->buffer = NULL;
+    as->capacity = 0;
+    as->offset = 0;
 }
 
 void Asm_Emit8(Assembler* as, uint8_t byte) {
     if (as->offset >= as->capacity) {
-        fprintf(stderr, "[Vanarize Assembler] Error: Buffer overflow\n");
-        exit(1);
+        if (!as->growable) {
+            fprintf(stderr, "[Vanarize Assembler] Error: Buffer overflow\n");
+            exit(1);
+        }
+        // Staging buffer: code is position independent until installed
+        size_t capacity = as->capacity * 2;
+        uint8_t* buffer = realloc(as->buffer, capacity);
+        if (!buffer) {
+            fprintf(stderr, "[Vanarize Assembler] Error: Out of memory\n");
+            exit(1);
+        }
+        as->buffer = buffer;
+        as->capacity = capacity;
     }
     as->buffer[as->offset++] = byte;
 }
 
-// MOV r64, imm64
+// MOV r64, imm64, in the shortest encoding that yields the value
 // Opcode: 48 B8+rd val (for RAX..RDI)
 void Asm_Mov_Imm64(Assembler* as, Register dst, uint64_t val) {
+    if (val <= 0xFFFFFFFFull) {
+        // MOV r32, imm32 (zero-extends): B8+rd id, REX.B for R8-R15
+        if (dst >= R8) Asm_Emit8(as, 0x41);
+        Asm_Emit8(as, 0xB8 + (dst & 7));
+        Asm_Emit32(as, (int32_t)(uint32_t)val);
+        return;
+    }
+    if ((int64_t)val < 0 && (int64_t)val >= INT32_MIN) {
+        // MOV r/m64, imm32 (sign-extends): REX.W C7 /0 id
+        Asm_Emit8(as, dst >= R8 ? 0x49 : 0x48);
+        Asm_Emit8(as, 0xC7);
+        Asm_Emit8(as, 0xC0 | (dst & 7));
+        Asm_Emit32(as, (int32_t)(int64_t)val);
+        return;
+    }
+
     // REX.W prefix (48) is strictly speaking needed for 64-bit operands.
     // Extended regs need REX.B (0x01).
     uint8_t rex = 0x48;
@@ -37,6 +115,8 @@ void Asm_Mov_Imm64(Assembler* as, Register dst, uint64_t val) {
 // MOV dst, src
 // Opcode: 48 89 /r (ModR/M)
 void Asm_Mov_Reg_Reg(Assembler* as, Register dst, Register src) {
+    if (dst == src) return;
+
     // REX Prefix logic
     uint8_t rex = 0x48;
     if (src >= R8) rex |= 0x04; // REX.R (Source is Reg field)
@@ -91,6 +171,12 @@ void Asm_And_Reg_Reg(Assembler* as, Register dst, Register src) {
 // ADD r64, imm32 (with INC optimization for imm=1)
 // Opcode: 48 81 /0 id (ADD), or 48 FF /0 (INC)
 void Asm_Add_Reg_Imm(Assembler* as, Register dst, int32_t imm) {
+    size_t start = as->offset;
+    if (dst == RSP && peepMatch(as, PEEP_SUB_RSP, imm, 0)) {
+        peepDrop(as);
+        return;
+    }
+
     // Optimization: ADD r64, 1 -> INC r64 (1 byte shorter, same speed)
     if (imm == 1) {
         Asm_Inc_Reg(as, dst);
@@ -109,10 +195,8 @@ void Asm_Add_Reg_Imm(Assembler* as, Register dst, int32_t imm) {
     Asm_Emit8(as, modrm);
     
     // Emit imm32 (little-endian)
-    for (int i = 0; i < 4; i++) {
-        Asm_Emit8(as, (uint8_t)(imm & 0xFF));
-        imm >>= 8;
-    }
+    Asm_Emit32(as, imm);
+    if (dst == RSP) peepRecord(as, PEEP_ADD_RSP, start, imm, 0);
 }
 
 // SUB r64, r64
@@ -173,6 +257,7 @@ void Asm_Dec_Reg(Assembler* as, Register reg) {
 // PUSH r64
 // Opcode: 50 + rd
 void Asm_Push(Assembler* as, Register src) {
+    size_t start = as->offset;
     if (src >= R8) {
         // REX.B (41) + 50+(src-8)
         // Actually REX is 0x41 (0100 0001) - W bit not needed for Push/Pop usually?
@@ -184,11 +269,19 @@ void Asm_Push(Assembler* as, Register src) {
     } else {
         Asm_Emit8(as, 0x50 + src);
     }
+    peepRecord(as, PEEP_PUSH, start, src, 0);
 }
 
 // POP r64
 // Opcode: 58 + rd
 void Asm_Pop(Assembler* as, Register dst) {
+    if (as->peepKind == PEEP_PUSH && as->peepEnd == as->offset) {
+        Register src = (Register)as->peepA;
+        peepDrop(as);
+        Asm_Mov_Reg_Reg(as, dst, src);
+        return;
+    }
+
     if (dst >= R8) {
         // REX.B (41)
         Asm_Emit8(as, 0x41);
@@ -202,23 +295,30 @@ void Asm_Pop(Assembler* as, Register dst) {
 // Opcode: FF /2 (ModR/M with reg field=2)
 // ModR/M for register: 11 010 reg -> 0xD0 + reg
 void Asm_Call_Reg(Assembler* as, Register src) {
-    if (src > RDI) {
-        fprintf(stderr, "Extended registers not yet supported in Call\n");
-        exit(1);
+    if (src >= R8) {
+        // REX.B (41) selects R8-R15 in the R/M field
+        Asm_Emit8(as, 0x41);
     }
     Asm_Emit8(as, 0xFF);
-    Asm_Emit8(as, 0xD0 + src);
+    Asm_Emit8(as, 0xD0 + (src & 7));
 }
 
 void Asm_Mov_Reg_Ptr(Assembler* as, Register dst, void* ptr) {
-    Asm_Mov_Imm64(as, dst, (uint64_t)(uintptr_t)ptr);
+    // Always REX.W B8+r imm64, so the immediate can be relocated
+    uint64_t val = (uint64_t)(uintptr_t)ptr;
+    Asm_Emit8(as, dst >= R8 ? 0x49 : 0x48);
+    Asm_Emit8(as, 0xB8 + (dst & 7));
+    for (int i = 0; i < 8; i++) {
+        Asm_Emit8(as, (uint8_t)(val & 0xFF));
+        val >>= 8;
+    }
 }
 
 // Helper for ModR/M Disp32
 // Helper for ModR/M Disp32
-static void emitModRM_Disp32(Assembler* as, Register reg, Register base, int32_t offset) {
+static void emitModRM_Disp32(Assembler* as, int reg, Register base, int32_t offset) {
     // Mod = 10 (Disp32) | Reg | R/M
-    Asm_Emit8(as, 0x80 | (reg << 3) | (base & 7));
+    Asm_Emit8(as, 0x80 | ((reg & 7) << 3) | (base & 7));
     
     // Check for SIB requirement (RSP=4 or R12=12)
     if ((base & 7) == 4) {
@@ -237,7 +337,10 @@ static void emitModRM_Disp32(Assembler* as, Register reg, Register base, int32_t
 // MOV dst, [base + offset]
 // Opcode: 48 8B /r
 void Asm_Mov_Reg_Mem(Assembler* as, Register dst, Register base, int32_t offset) {
-    Asm_Emit8(as, 0x48);
+    uint8_t rex = 0x48;
+    if (dst >= R8) rex |= 0x04;  // REX.R (Reg field)
+    if (base >= R8) rex |= 0x01; // REX.B (Base)
+    Asm_Emit8(as, rex);
     Asm_Emit8(as, 0x8B);
     emitModRM_Disp32(as, dst, base, offset);
 }
@@ -245,19 +348,142 @@ void Asm_Mov_Reg_Mem(Assembler* as, Register dst, Register base, int32_t offset)
 // MOV [base + offset], src
 // Opcode: 48 89 /r
 void Asm_Mov_Mem_Reg(Assembler* as, Register base, int32_t offset, Register src) {
-    Asm_Emit8(as, 0x48);
+    uint8_t rex = 0x48;
+    if (src >= R8) rex |= 0x04;
+    if (base >= R8) rex |= 0x01;
+    Asm_Emit8(as, rex);
     Asm_Emit8(as, 0x89);
     emitModRM_Disp32(as, src, base, offset);
 }
 
+// LEA dst, [base + offset]
+// Opcode: 48 8D /r
+void Asm_Lea_Reg_Mem(Assembler* as, Register dst, Register base, int32_t offset) {
+    uint8_t rex = 0x48;
+    if (dst >= R8) rex |= 0x04;
+    if (base >= R8) rex |= 0x01;
+    Asm_Emit8(as, rex);
+    Asm_Emit8(as, 0x8D);
+    emitModRM_Disp32(as, dst, base, offset);
+}
+
+// ==================== INDEXED MEMORY OPERANDS ====================
+// Array element access: [base + index*scale], scale 1, 2, 4 or 8.
+// 'wide' selects the 64-bit operand size (REX.W).
+
+static void emitRexIndexed(Assembler* as, int wide, int reg, Register base, Register index) {
+    uint8_t rex = 0x40;
+    if (wide) rex |= 0x08;
+    if (reg >= R8) rex |= 0x04;   // REX.R
+    if (index >= R8) rex |= 0x02; // REX.X
+    if (base >= R8) rex |= 0x01;  // REX.B
+    if (rex != 0x40) Asm_Emit8(as, rex);
+}
+
+static void emitModRM_SIB(Assembler* as, int reg, Register base, Register index, int scale) {
+    uint8_t ss = scale == 8 ? 3 : scale == 4 ? 2 : scale == 2 ? 1 : 0;
+    // RBP/R13 as SIB base need Mod=01 with a zero disp8
+    int needsDisp = (base & 7) == RBP;
+    Asm_Emit8(as, (needsDisp ? 0x44 : 0x04) | ((reg & 7) << 3));
+    Asm_Emit8(as, (ss << 6) | ((index & 7) << 3) | (base & 7));
+    if (needsDisp) Asm_Emit8(as, 0x00);
+}
+
+// MOV r64, [base + index*scale]
+// Opcode: REX.W 8B /r
+void Asm_Mov_Reg_MemIndex(Assembler* as, Register dst, Register base, Register index, int scale) {
+    emitRexIndexed(as, 1, dst, base, index);
+    Asm_Emit8(as, 0x8B);
+    emitModRM_SIB(as, dst, base, index, scale);
+}
+
+// MOV r32, [base + index*scale] (zero-extends into r64)
+// Opcode: 8B /r
+void Asm_Mov32_Reg_MemIndex(Assembler* as, Register dst, Register base, Register index, int scale) {
+    emitRexIndexed(as, 0, dst, base, index);
+    Asm_Emit8(as, 0x8B);
+    emitModRM_SIB(as, dst, base, index, scale);
+}
+
+// MOVSXD r64, DWORD [base + index*scale]
+// Opcode: REX.W 63 /r
+void Asm_Movsxd_Reg_MemIndex(Assembler* as, Register dst, Register base, Register index, int scale) {
+    emitRexIndexed(as, 1, dst, base, index);
+    Asm_Emit8(as, 0x63);
+    emitModRM_SIB(as, dst, base, index, scale);
+}
+
+// MOV [base + index*scale], r64
+// Opcode: REX.W 89 /r
+void Asm_Mov_MemIndex_Reg(Assembler* as, Register base, Register index, int scale, Register src) {
+    emitRexIndexed(as, 1, src, base, index);
+    Asm_Emit8(as, 0x89);
+    emitModRM_SIB(as, src, base, index, scale);
+}
+
+// MOV DWORD [base + index*scale], r32
+// Opcode: 89 /r
+void Asm_Mov32_MemIndex_Reg(Assembler* as, Register base, Register index, int scale, Register src) {
+    emitRexIndexed(as, 0, src, base, index);
+    Asm_Emit8(as, 0x89);
+    emitModRM_SIB(as, src, base, index, scale);
+}
+
+// MOVSXD r64, DWORD [base + offset]
+// Opcode: REX.W 63 /r
+void Asm_Movsxd_Reg_Mem(Assembler* as, Register dst, Register base, int32_t offset) {
+    uint8_t rex = 0x48;
+    if (dst >= R8) rex |= 0x04;
+    if (base >= R8) rex |= 0x01;
+    Asm_Emit8(as, rex);
+    Asm_Emit8(as, 0x63);
+    emitModRM_Disp32(as, dst, base, offset);
+}
+
+// CMP DWORD [base + offset], imm8 (sign-extended)
+// Opcode: 83 /7 ib
+void Asm_Cmp_Mem32_Imm8(Assembler* as, Register base, int32_t offset, int8_t imm) {
+    if (base >= R8) Asm_Emit8(as, 0x41);
+    Asm_Emit8(as, 0x83);
+    emitModRM_Disp32(as, 7, base, offset);
+    Asm_Emit8(as, (uint8_t)imm);
+}
+
+// SUB DWORD [base + offset], imm8
+// Opcode: 83 /5 ib
+void Asm_Sub_Mem32_Imm8(Assembler* as, Register base, int32_t offset, int8_t imm) {
+    if (base >= R8) Asm_Emit8(as, 0x41);
+    Asm_Emit8(as, 0x83);
+    emitModRM_Disp32(as, 5, base, offset);
+    Asm_Emit8(as, (uint8_t)imm);
+}
+
+// SUB r64, imm32
+// Opcode: 48 81 /5 id
+void Asm_Sub_Reg_Imm(Assembler* as, Register dst, int32_t imm) {
+    size_t start = as->offset;
+    if (dst == RSP && peepMatch(as, PEEP_ADD_RSP, imm, 0)) {
+        peepDrop(as);
+        return;
+    }
+
+    uint8_t rex = 0x48;
+    if (dst >= R8) rex |= 0x01;
+    Asm_Emit8(as, rex);
+    Asm_Emit8(as, 0x81);
+    Asm_Emit8(as, 0xE8 | (dst & 7));
+    Asm_Emit32(as, imm);
+    if (dst == RSP) peepRecord(as, PEEP_SUB_RSP, start, imm, 0);
+}
+
 // CMP r64, imm32
 // Opcode: 48 81 /7 id
 void Asm_Cmp_Reg_Imm(Assembler* as, Register dst, int32_t imm) {
     // CMP r64, imm32: 48 81 /7 id
-    Asm_Emit8(as, 0x48); // REX.W
+    Asm_Emit8(as, dst >= R8 ? 0x49 : 0x48); // REX.W (+ REX.B for R8-R15)
     Asm_Emit8(as, 0x81); // CMP opcode
     // ModRM: Mod=11 (direct), Reg=111 (/7), RM=dst
-    uint8_t modrm = 0xF8 + dst;
+    uint8_t modrm = 0xF8 + (dst & 7);
     Asm_Emit8(as, modrm);
     
     // Emit imm32 (little-endian)
@@ -283,6 +509,88 @@ void Asm_Cmp_Reg_Reg(Assembler* as, Register dst, Register src) {
     Asm_Emit8(as, modrm);
 }
 
+// Helper: REX.W op /r with register operands (Reg = reg, R/M = rm)
+static void emitAluRegReg(Assembler* as, uint8_t opcode, Register reg, Register rm) {
+    uint8_t rex = 0x48;
+    if (reg >= R8) rex |= 0x04;
+    if (rm >= R8) rex |= 0x01;
+    Asm_Emit8(as, rex);
+    Asm_Emit8(as, opcode);
+    Asm_Emit8(as, 0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+// OR r64, r64
+// Opcode: 48 09 /r
+void Asm_Or_Reg_Reg(Assembler* as, Register dst, Register src) {
+    emitAluRegReg(as, 0x09, src, dst);
+}
+
+// XOR r64, r64
+// Opcode: 48 31 /r
+void Asm_Xor_Reg_Reg(Assembler* as, Register dst, Register src) {
+    emitAluRegReg(as, 0x31, src, dst);
+}
+
+// TEST r64, r64
+// Opcode: 48 85 /r
+void Asm_Test_Reg_Reg(Assembler* as, Register a, Register b) {
+    emitAluRegReg(as, 0x85, b, a);
+}
+
+// SETcc r8 (low byte only, upper bits untouched)
+// Opcode: [REX] 0F 90+cc /0
+void Asm_Setcc(Assembler* as, Condition cond, Register dst) {
+    // REX (even empty) selects SPL/BPL/SIL/DIL instead of AH/CH/DH/BH
+    if (dst >= RSP) Asm_Emit8(as, dst >= R8 ? 0x41 : 0x40);
+    Asm_Emit8(as, 0x0F);
+    Asm_Emit8(as, 0x90 + cond);
+    Asm_Emit8(as, 0xC0 | (dst & 7));
+}
+
+// MOVZX r64, r8
+// Opcode: REX.W 0F B6 /r
+void Asm_Movzx_Reg_Reg8(Assembler* as, Register dst, Register src) {
+    uint8_t rex = 0x48;
+    if (dst >= R8) rex |= 0x04;
+    if (src >= R8) rex |= 0x01;
+    Asm_Emit8(as, rex);
+    Asm_Emit8(as, 0x0F);
+    Asm_Emit8(as, 0xB6);
+    Asm_Emit8(as, 0xC0 | ((dst & 7) << 3) | (src & 7));
+}
+
+// NEG r64
+// Opcode: REX.W F7 /3
+void Asm_Neg_Reg(Assembler* as, Register reg) {
+    Asm_Emit8(as, reg >= R8 ? 0x49 : 0x48);
+    Asm_Emit8(as, 0xF7);
+    Asm_Emit8(as, 0xD8 | (reg & 7));
+}
+
+// SHL r64, imm8
+// Opcode: REX.W C1 /4 ib
+void Asm_Shl_Reg_Imm(Assembler* as, Register reg, uint8_t count) {
+    Asm_Emit8(as, reg >= R8 ? 0x49 : 0x48);
+    Asm_Emit8(as, 0xC1);
+    Asm_Emit8(as, 0xE0 | (reg & 7));
+    Asm_Emit8(as, count);
+}
+
+// CQO (sign-extend RAX into RDX:RAX)
+// Opcode: 48 99
+void Asm_Cqo(Assembler* as) {
+    Asm_Emit8(as, 0x48);
+    Asm_Emit8(as, 0x99);
+}
+
+// IDIV r64 (RDX:RAX / src -> RAX quotient, RDX remainder)
+// Opcode: REX.W F7 /7
+void Asm_Idiv_Reg(Assembler* as, Register src) {
+    Asm_Emit8(as, src >= R8 ? 0x49 : 0x48);
+    Asm_Emit8(as, 0xF7);
+    Asm_Emit8(as, 0xF8 | (src & 7));
+}
+
 // JMP rel32
 // Opcode: E9 cd
 void Asm_Jmp(Assembler* as, int32_t offset) {
@@ -348,6 +656,14 @@ void Asm_Jl(Assembler* as, int32_t offset) {
     }
 }
 
+// Jcc rel32 (any condition)
+// Opcode: 0F 80+cc cd
+void Asm_Jcc(Assembler* as, Condition cond, int32_t offset) {
+    Asm_Emit8(as, 0x0F);
+    Asm_Emit8(as, (uint8_t)(0x80 | cond));
+    Asm_Emit32(as, offset);
+}
+
 void Asm_Patch32(Assembler* as, size_t offset, int32_t value) {
     if (offset + 4 > as->capacity) return; // Error
     as->buffer[offset] = (uint8_t)(value & 0xFF);
@@ -362,6 +678,225 @@ void Asm_Ret(Assembler* as) {
     Asm_Emit8(as, 0xC3);
 }
 
+// ==================== SSE2 SCALAR INSTRUCTIONS ====================
+// Legacy SSE encodings: [mandatory prefix] [REX] 0F opcode ModR/M.
+// The mandatory prefix (66/F2/F3) must precede REX.
+
+// MOVQ xmm, r64
+// Opcode: 66 REX.W 0F 6E /r (Reg = xmm, R/M = gpr)
+void Asm_Movq_Xmm_Reg(Assembler* as, XmmRegister dst, Register src) {
+    if (peepMatch(as, PEEP_MOVQ_TO_GPR, src, dst)) return;   // Value is already there
+    size_t start = as->offset;
+    uint8_t rex = 0x48;
+    if (dst >= XMM8) rex |= 0x04;
+    if (src >= R8) rex |= 0x01;
+    Asm_Emit8(as, 0x66);
+    Asm_Emit8(as, rex);
+    Asm_Emit8(as, 0x0F);
+    Asm_Emit8(as, 0x6E);
+    Asm_Emit8(as, 0xC0 | ((dst & 7) << 3) | (src & 7));
+    peepRecord(as, PEEP_MOVQ_TO_XMM, start, dst, src);
+}
+
+// MOVQ r64, xmm
+// Opcode: 66 REX.W 0F 7E /r (Reg = xmm, R/M = gpr)
+void Asm_Movq_Reg_Xmm(Assembler* as, Register dst, XmmRegister src) {
+    if (peepMatch(as, PEEP_MOVQ_TO_XMM, src, dst)) return;   // Value is already there
+    size_t start = as->offset;
+    uint8_t rex = 0x48;
+    if (src >= XMM8) rex |= 0x04;
+    if (dst >= R8) rex |= 0x01;
+    Asm_Emit8(as, 0x66);
+    Asm_Emit8(as, rex);
+    Asm_Emit8(as, 0x0F);
+    Asm_Emit8(as, 0x7E);
+    Asm_Emit8(as, 0xC0 | ((src & 7) << 3) | (dst & 7));
+    peepRecord(as, PEEP_MOVQ_TO_GPR, start, dst, src);
+}
+
+// MOVAPD xmm, xmm
+// Opcode: 66 [REX] 0F 28 /r
+void Asm_Movapd_Xmm_Xmm(Assembler* as, XmmRegister dst, XmmRegister src) {
+    if (dst == src) return;
+    Asm_Emit8(as, 0x66);
+    if (dst >= XMM8 || src >= XMM8) {
+        uint8_t rex = 0x40;
+        if (dst >= XMM8) rex |= 0x04;
+        if (src >= XMM8) rex |= 0x01;
+        Asm_Emit8(as, rex);
+    }
+    Asm_Emit8(as, 0x0F);
+    Asm_Emit8(as, 0x28);
+    Asm_Emit8(as, 0xC0 | ((dst & 7) << 3) | (src & 7));
+}
+
+// Helper: prefix [REX] 0F op /r with a [base + disp32] memory operand
+static void emitSseMem(Assembler* as, uint8_t prefix, uint8_t opcode, int xmm, Register base, int32_t offset) {
+    Asm_Emit8(as, prefix);
+    if (xmm >= XMM8 || base >= R8) {
+        uint8_t rex = 0x40;
+        if (xmm >= XMM8) rex |= 0x04;
+        if (base >= R8) rex |= 0x01;
+        Asm_Emit8(as, rex);
+    }
+    Asm_Emit8(as, 0x0F);
+    Asm_Emit8(as, opcode);
+    emitModRM_Disp32(as, xmm, base, offset);
+}
+
+// MOVSD xmm, [base + offset]
+// Opcode: F2 [REX] 0F 10 /r
+void Asm_Movsd_Xmm_Mem(Assembler* as, XmmRegister dst, Register base, int32_t offset) {
+    emitSseMem(as, 0xF2, 0x10, dst, base, offset);
+}
+
+// MOVSD [base + offset], xmm
+// Opcode: F2 [REX] 0F 11 /r
+void Asm_Movsd_Mem_Xmm(Assembler* as, Register base, int32_t offset, XmmRegister src) {
+    emitSseMem(as, 0xF2, 0x11, src, base, offset);
+}
+
+// MOVSS xmm, [base + offset]
+// Opcode: F3 [REX] 0F 10 /r
+void Asm_Movss_Xmm_Mem(Assembler* as, XmmRegister dst, Register base, int32_t offset) {
+    emitSseMem(as, 0xF3, 0x10, dst, base, offset);
+}
+
+// Helper: [prefix] [REX] 0F op /r with register operands (Reg = reg, R/M = rm).
+// Packed single instructions have no prefix (0).
+static void emitSseRegReg(Assembler* as, uint8_t prefix, int rexW, uint8_t opcode, int reg, int rm) {
+    if (prefix) Asm_Emit8(as, prefix);
+    if (rexW || reg >= 8 || rm >= 8) {
+        uint8_t rex = 0x40;
+        if (rexW) rex |= 0x08;
+        if (reg >= 8) rex |= 0x04;
+        if (rm >= 8) rex |= 0x01;
+        Asm_Emit8(as, rex);
+    }
+    Asm_Emit8(as, 0x0F);
+    Asm_Emit8(as, opcode);
+    Asm_Emit8(as, 0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+// ADDSD / SUBSD / MULSD / DIVSD xmm, xmm
+// Opcode: F2 [REX] 0F 58 / 5C / 59 / 5E
+void Asm_Addsd(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0xF2, 0, 0x58, dst, src); }
+void Asm_Subsd(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0xF2, 0, 0x5C, dst, src); }
+void Asm_Mulsd(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0xF2, 0, 0x59, dst, src); }
+void Asm_Divsd(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0xF2, 0, 0x5E, dst, src); }
+
+// ADDSS / SUBSS / MULSS / DIVSS xmm, xmm
+// Opcode: F3 [REX] 0F 58 / 5C / 59 / 5E
+void Asm_Addss(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0xF3, 0, 0x58, dst, src); }
+void Asm_Subss(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0xF3, 0, 0x5C, dst, src); }
+void Asm_Mulss(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0xF3, 0, 0x59, dst, src); }
+void Asm_Divss(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0xF3, 0, 0x5E, dst, src); }
+
+// UCOMISD xmm, xmm (unordered compare, sets ZF/PF/CF)
+// Opcode: 66 [REX] 0F 2E
+void Asm_Ucomisd(Assembler* as, XmmRegister a, XmmRegister b) { emitSseRegReg(as, 0x66, 0, 0x2E, a, b); }
+
+// UCOMISS xmm, xmm
+// Opcode: [REX] 0F 2E
+void Asm_Ucomiss(Assembler* as, XmmRegister a, XmmRegister b) { emitSseRegReg(as, 0, 0, 0x2E, a, b); }
+
+// XORPD xmm, xmm
+// Opcode: 66 [REX] 0F 57
+void Asm_Xorpd(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0x66, 0, 0x57, dst, src); }
+
+// CVTSI2SD xmm, r64
+// Opcode: F2 REX.W 0F 2A
+void Asm_Cvtsi2sd_Xmm_Reg(Assembler* as, XmmRegister dst, Register src) { emitSseRegReg(as, 0xF2, 1, 0x2A, dst, src); }
+
+// CVTTSD2SI r64, xmm (truncate)
+// Opcode: F2 REX.W 0F 2C
+void Asm_Cvttsd2si_Reg_Xmm(Assembler* as, Register dst, XmmRegister src) { emitSseRegReg(as, 0xF2, 1, 0x2C, dst, src); }
+
+// CVTSI2SS xmm, r64
+// Opcode: F3 REX.W 0F 2A
+void Asm_Cvtsi2ss_Xmm_Reg(Assembler* as, XmmRegister dst, Register src) { emitSseRegReg(as, 0xF3, 1, 0x2A, dst, src); }
+
+// CVTTSS2SI r64, xmm (truncate)
+// Opcode: F3 REX.W 0F 2C
+void Asm_Cvttss2si_Reg_Xmm(Assembler* as, Register dst, XmmRegister src) { emitSseRegReg(as, 0xF3, 1, 0x2C, dst, src); }
+
+// CVTSD2SS xmm, xmm
+// Opcode: F2 [REX] 0F 5A
+void Asm_Cvtsd2ss(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0xF2, 0, 0x5A, dst, src); }
+
+// CVTSS2SD xmm, xmm
+// Opcode: F3 [REX] 0F 5A
+void Asm_Cvtss2sd(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0xF3, 0, 0x5A, dst, src); }
+
+// MOVD xmm, r32 (zero-extends into the XMM lane)
+// Opcode: 66 [REX] 0F 6E
+void Asm_Movd_Xmm_Reg(Assembler* as, XmmRegister dst, Register src) { emitSseRegReg(as, 0x66, 0, 0x6E, dst, src); }
+
+// MOVD r32, xmm (zero-extends into the GPR)
+// Opcode: 66 [REX] 0F 7E
+void Asm_Movd_Reg_Xmm(Assembler* as, Register dst, XmmRegister src) { emitSseRegReg(as, 0x66, 0, 0x7E, src, dst); }
+
+// ==================== SSE2 PACKED INSTRUCTIONS ====================
+
+// Helper: [prefix] [REX] 0F op /r with a [base + index*scale] memory operand
+static void emitSsePackedElement(Assembler* as, uint8_t prefix, uint8_t opcode, XmmRegister reg,
+                                 Register base, Register index, int scale) {
+    if (prefix) Asm_Emit8(as, prefix);
+    emitRexIndexed(as, 0, reg, base, index);
+    Asm_Emit8(as, 0x0F);
+    Asm_Emit8(as, opcode);
+    emitModRM_SIB(as, reg, base, index, scale);
+}
+
+// MOVUPD xmm, [base + index*8] - Load 2 doubles unaligned
+// Opcode: 66 [REX] 0F 10 /r
+void Asm_Movupd_Xmm_Mem(Assembler* as, XmmRegister dst, Register base, Register index) {
+    emitSsePackedElement(as, 0x66, 0x10, dst, base, index, 8);
+}
+
+// MOVUPD [base + index*8], xmm - Store 2 doubles unaligned
+// Opcode: 66 [REX] 0F 11 /r
+void Asm_Movupd_Mem_Xmm(Assembler* as, Register base, Register index, XmmRegister src) {
+    emitSsePackedElement(as, 0x66, 0x11, src, base, index, 8);
+}
+
+// MOVUPS xmm, [base + index*4] - Load 4 floats unaligned
+// Opcode: [REX] 0F 10 /r
+void Asm_Movups_Xmm_Mem(Assembler* as, XmmRegister dst, Register base, Register index) {
+    emitSsePackedElement(as, 0, 0x10, dst, base, index, 4);
+}
+
+// MOVUPS [base + index*4], xmm - Store 4 floats unaligned
+// Opcode: [REX] 0F 11 /r
+void Asm_Movups_Mem_Xmm(Assembler* as, Register base, Register index, XmmRegister src) {
+    emitSsePackedElement(as, 0, 0x11, src, base, index, 4);
+}
+
+// ADDPD / SUBPD / MULPD / DIVPD xmm, xmm
+// Opcode: 66 [REX] 0F 58 / 5C / 59 / 5E
+void Asm_Addpd(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0x66, 0, 0x58, dst, src); }
+void Asm_Subpd(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0x66, 0, 0x5C, dst, src); }
+void Asm_Mulpd(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0x66, 0, 0x59, dst, src); }
+void Asm_Divpd(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0x66, 0, 0x5E, dst, src); }
+
+// UNPCKLPD xmm, xmm (dst = { dst.lo, src.lo }; with dst == src, a splat)
+// Opcode: 66 [REX] 0F 14
+void Asm_Unpcklpd(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0x66, 0, 0x14, dst, src); }
+
+// ADDPS / SUBPS / MULPS / DIVPS xmm, xmm
+// Opcode: [REX] 0F 58 / 5C / 59 / 5E
+void Asm_Addps(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0, 0, 0x58, dst, src); }
+void Asm_Subps(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0, 0, 0x5C, dst, src); }
+void Asm_Mulps(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0, 0, 0x59, dst, src); }
+void Asm_Divps(Assembler* as, XmmRegister dst, XmmRegister src) { emitSseRegReg(as, 0, 0, 0x5E, dst, src); }
+
+// SHUFPS xmm, xmm, imm8 (SHUFPS x, x, 0 splats the low float)
+// Opcode: [REX] 0F C6 /r ib
+void Asm_Shufps(Assembler* as, XmmRegister dst, XmmRegister src, uint8_t imm) {
+    emitSseRegReg(as, 0, 0, 0xC6, dst, src);
+    Asm_Emit8(as, imm);
+}
+
 // ==================== AVX SIMD INSTRUCTIONS ====================
 // VEX Prefix Format (3-byte): C4 RXBm-mmmm WvvvvLpp
 // VEX Prefix Format (2-byte): C5 RvvvvLpp (when R=1, X=1, B=1, m-mmmm=00001)
@@ -377,6 +912,7 @@ static void emitVex2(Assembler* as, YmmRegister vvvv, int L, int pp) {
 }
 
 // Helper: Emit 3-byte VEX prefix for AVX2
+// R/X/B are the REX extension bits (1 = register 8-15); VEX stores them inverted.
 static void emitVex3(Assembler* as, int R, int X, int B, int mmmmm, int W, YmmRegister vvvv, int L, int pp) {
     // C4 RXBm-mmmm WvvvvLpp
     uint8_t byte2 = ((~R & 1) << 7) | ((~X & 1) << 6) | ((~B & 1) << 5) | (mmmmm & 0x1F);
@@ -418,21 +954,97 @@ void Asm_Vaddpd_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegiste
     Asm_Emit8(as, 0xC0 | (dst << 3) | src2);
 }
 
-// VMOVDQU ymm, [RIP + disp] - Load 256 bits unaligned
+// VSUBPD ymm, ymm, ymm - Subtract 4 packed doubles
+// VEX.256.66.0F.WIG 5C /r
+void Asm_Vsubpd_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+    emitVex2(as, src1, 1, 1);
+    Asm_Emit8(as, 0x5C);       // SUBPD opcode
+    Asm_Emit8(as, 0xC0 | (dst << 3) | src2);
+}
+
+// VMULPD ymm, ymm, ymm - Multiply 4 packed doubles
+// VEX.256.66.0F.WIG 59 /r
+void Asm_Vmulpd_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+    emitVex2(as, src1, 1, 1);
+    Asm_Emit8(as, 0x59);       // MULPD opcode
+    Asm_Emit8(as, 0xC0 | (dst << 3) | src2);
+}
+
+// VDIVPD ymm, ymm, ymm - Divide 4 packed doubles
+// VEX.256.66.0F.WIG 5E /r
+void Asm_Vdivpd_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+    emitVex2(as, src1, 1, 1);
+    Asm_Emit8(as, 0x5E);       // DIVPD opcode
+    Asm_Emit8(as, 0xC0 | (dst << 3) | src2);
+}
+
+// VADDPS / VSUBPS / VMULPS / VDIVPS ymm, ymm, ymm - 8 packed floats
+// VEX.256.0F.WIG 58 / 5C / 59 / 5E /r
+static void emitVexPackedSingle(Assembler* as, uint8_t opcode, YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+    emitVex2(as, src1, 1, 0);  // L=1 (256-bit), pp=00 (no prefix)
+    Asm_Emit8(as, opcode);
+    Asm_Emit8(as, 0xC0 | (dst << 3) | src2);
+}
+
+void Asm_Vaddps_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegister src2) { emitVexPackedSingle(as, 0x58, dst, src1, src2); }
+void Asm_Vsubps_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegister src2) { emitVexPackedSingle(as, 0x5C, dst, src1, src2); }
+void Asm_Vmulps_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegister src2) { emitVexPackedSingle(as, 0x59, dst, src1, src2); }
+void Asm_Vdivps_Ymm(Assembler* as, YmmRegister dst, YmmRegister src1, YmmRegister src2) { emitVexPackedSingle(as, 0x5E, dst, src1, src2); }
+
+// VBROADCASTSS ymm, xmm - Splat the low float of xmm to all 8 lanes (AVX2)
+// VEX.256.66.0F38.W0 18 /r
+void Asm_Vbroadcastss_Ymm_Xmm(Assembler* as, YmmRegister dst, XmmRegister src) {
+    emitVex3(as, 0, 0, src >= XMM8, 0x02, 0, YMM0, 1, 1);  // vvvv unused (1111)
+    Asm_Emit8(as, 0x18);
+    Asm_Emit8(as, 0xC0 | (dst << 3) | (src & 7));
+}
+
+// VBROADCASTSD ymm, xmm - Splat the low double of xmm to all 4 lanes (AVX2)
+// VEX.256.66.0F38.W0 19 /r
+void Asm_Vbroadcastsd_Ymm_Xmm(Assembler* as, YmmRegister dst, XmmRegister src) {
+    emitVex3(as, 0, 0, src >= XMM8, 0x02, 0, YMM0, 1, 1);  // vvvv unused (1111)
+    Asm_Emit8(as, 0x19);
+    Asm_Emit8(as, 0xC0 | (dst << 3) | (src & 7));
+}
+
+// Helper: VEX.256.<pp>.0F opcode with a [base + index*scale] memory operand
+static void emitVexElement(Assembler* as, int pp, uint8_t opcode, YmmRegister reg,
+                           Register base, Register index, int scale) {
+    emitVex3(as, 0, index >= R8, base >= R8, 0x01, 0, YMM0, 1, pp);
+    Asm_Emit8(as, opcode);
+    emitModRM_SIB(as, reg, base, index, scale);
+}
+
+// VMOVDQU ymm, [base + index*8] - Load 4 Values (256 bits) unaligned
 // VEX.256.F3.0F.WIG 6F /r
-void Asm_Vmovdqu_Ymm_Mem(Assembler* as, YmmRegister dst, void* mem) {
-    // Use RIP-relative addressing would be complex, use absolute for now
-    // Load pointer to RAX, then use [RAX]
-    // Actually simpler: emit address inline after instruction
-    // For now, stub - we'll load from static data
-    (void)as; (void)dst; (void)mem;
-    // TODO: Implement properly with RIP-relative or static data section
+void Asm_Vmovdqu_Ymm_Mem(Assembler* as, YmmRegister dst, Register base, Register index) {
+    emitVexElement(as, 2, 0x6F, dst, base, index, 8);   // pp=10 (F3)
+}
+
+// VMOVDQU [base + index*8], ymm - Store 4 Values (256 bits) unaligned
+// VEX.256.F3.0F.WIG 7F /r
+void Asm_Vmovdqu_Mem_Ymm(Assembler* as, Register base, Register index, YmmRegister src) {
+    emitVexElement(as, 2, 0x7F, src, base, index, 8);
+}
+
+// VMOVUPS ymm, [base + index*4] - Load 8 floats unaligned
+// VEX.256.0F.WIG 10 /r
+void Asm_Vmovups_Ymm_Mem(Assembler* as, YmmRegister dst, Register base, Register index) {
+    emitVexElement(as, 0, 0x10, dst, base, index, 4);
 }
 
-// VMOVDQU [mem], ymm - Store 256 bits unaligned
-void Asm_Vmovdqu_Mem_Ymm(Assembler* as, void* mem, YmmRegister src) {
-    (void)as; (void)mem; (void)src;
-    // TODO: Implement properly
+// VMOVUPS [base + index*4], ymm - Store 8 floats unaligned
+// VEX.256.0F.WIG 11 /r
+void Asm_Vmovups_Mem_Ymm(Assembler* as, Register base, Register index, YmmRegister src) {
+    emitVexElement(as, 0, 0x11, src, base, index, 4);
+}
+
+// VZEROUPPER - Clear upper YMM halves before returning to legacy SSE code
+// VEX.128.0F.WIG 77
+void Asm_Vzeroupper(Assembler* as) {
+    Asm_Emit8(as, 0xC5);
+    Asm_Emit8(as, 0xF8);
+    Asm_Emit8(as, 0x77);
 }
 
 // Horizontal sum of 8 ints in YMM -> RAX
@@ -441,7 +1053,7 @@ void Asm_Avx_HSum_Int(Assembler* as, YmmRegister src) {
     // For now, simple horizontal sum using SSE after extract
     // VEXTRACTI128 xmm1, ymm0, 1  ; Get high 128 bits to XMM1
     // VEX.256.66.0F3A.W0 39 /r ib
-    emitVex3(as, 1, 1, 1, 0x03, 0, YMM0, 1, 1);  // 0F3A map
+    emitVex3(as, 0, 0, 0, 0x03, 0, YMM0, 1, 1);  // 0F3A map
     Asm_Emit8(as, 0x39);  // VEXTRACTI128
     Asm_Emit8(as, 0xC1 | (src << 3));  // ModR/M: ymm0 -> xmm1
     Asm_Emit8(as, 0x01);  // imm8 = 1 (high half)
@@ -454,11 +1066,11 @@ void Asm_Avx_HSum_Int(Assembler* as, YmmRegister src) {
     // Now xmm0 has 4 ints, need to sum to 1
     // VPHADDD xmm0, xmm0, xmm0 (twice)
     // VEX.128.66.0F38.WIG 02 /r
-    emitVex3(as, 1, 1, 1, 0x02, 0, YMM0, 0, 1);  // 0F38 map
+    emitVex3(as, 0, 0, 0, 0x02, 0, YMM0, 0, 1);  // 0F38 map
     Asm_Emit8(as, 0x02);  // VPHADDD
     Asm_Emit8(as, 0xC0);  // xmm0, xmm0
     
-    emitVex3(as, 1, 1, 1, 0x02, 0, YMM0, 0, 1);
+    emitVex3(as, 0, 0, 0, 0x02, 0, YMM0, 0, 1);
     Asm_Emit8(as, 0x02);
     Asm_Emit8(as, 0xC0);
     
@@ -473,7 +1085,7 @@ void Asm_Avx_HSum_Int(Assembler* as, YmmRegister src) {
 void Asm_Avx_HSum_Double(Assembler* as, YmmRegister src) {
     // VEXTRACTF128 xmm1, ymm0, 1  ; Get high 128 bits
     // VEX.256.66.0F3A.W0 19 /r ib
-    emitVex3(as, 1, 1, 1, 0x03, 0, YMM0, 1, 1);
+    emitVex3(as, 0, 0, 0, 0x03, 0, YMM0, 1, 1);
     Asm_Emit8(as, 0x19);  // VEXTRACTF128
     Asm_Emit8(as, 0xC1 | (src << 3));
     Asm_Emit8(as, 0x01);  // imm8 = 1
@@ -1,6 +1,12 @@
 #include "Jit/CodeGen.h"
 #include "Jit/AssemblerX64.h"
 #include "Jit/ExecutableMemory.h"
+#include "Jit/RegisterMap.h"
+#include "Jit/LoopInvariant.h"
+#include "Jit/DiskCache.h"
+#include "Jit/ElfWriter.h"
+#include "Jit/DebugInfo.h"
+#include "Jit/CpuFeatures.h"
 #include "Core/VanarizeValue.h"
 #include "Core/Runtime.h"
 #include "Core/VanarizeObject.h"
@@ -13,41 +19,156 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <elf.h>
 #include <math.h>  // For floor() in integer detection
 
 // GLOBAL FUNCTION REGISTRY
+// Every function is declared before emission starts (declareGlobalFunctions),
+// so calls can bind to it statically; the address is filled in once the
+// function has been compiled and installed in the code cache.
+typedef enum {
+    TIER_NONE,              // Not compiled yet
+    TIER_BASELINE,          // Quick code with execution counters
+    TIER_OPTIMIZED          // Register allocation, inlining, LICM, vectorization
+} CompileTier;
+
 typedef struct {
     char name[128];
-    void* address;
+    void* address;          // NULL until compiled; re-pointed on tier-up
+    FunctionDecl* decl;     // Signature for direct calls
+    CompileTier tier;
+    int32_t callCounter;    // Baseline calls left before tier-up
+    void* baselineEntry;    // Patched to JMP to the optimized code on tier-up
+    struct TierLoop* loops; // Baseline loops, for on-stack replacement
+    int pending;            // Being emitted by a parallel batch (see compileInParallel)
+    FunctionDecl* precompiled; // Installed by the batch, for the top-level pass to bind
 } GlobalFunction;
 
 static GlobalFunction globalFunctions[256];
 static int globalFunctionCount = 0;
 static void* mainFunc = NULL;
 
-static void registerGlobalFunction(const char* name, int length, void* address) {
+// CALL rel32 site inside a function's staging buffer
+typedef struct {
+    size_t offset;          // Offset of the rel32 field
+    GlobalFunction* target;
+} CallSite;
+
+// Absolute pointer embedded in a function's code, so the persistent cache
+// can re-create it in another process (see Jit/DiskCache.h)
+typedef struct {
+    size_t offset;          // Offset of the imm64 field
+    CacheRelocKind kind;
+    const void* target;     // Helper address, ObjString* or GlobalFunction*
+} Relocation;
+
+// CALL/JMP rel32 sites in the code cache. Kept after they are resolved so
+// they can be re-linked when their callee is recompiled at a higher tier.
+typedef struct {
+    uint8_t* site;          // Address of the rel32 field
+    GlobalFunction* target;
+} LinkedCall;
+
+static LinkedCall* linkedCalls = NULL;
+static int linkedCallCount = 0;
+static int linkedCallCapacity = 0;
+
+static GlobalFunction* findGlobalEntry(const char* name, int length) {
+    for (int i = 0; i < globalFunctionCount; i++) {
+        int storedLen = strlen(globalFunctions[i].name);
+        if (storedLen == length && memcmp(globalFunctions[i].name, name, length) == 0) {
+            return &globalFunctions[i];
+        }
+    }
+    return NULL;
+}
+
+static GlobalFunction* declareGlobalFunction(const char* name, int length, FunctionDecl* decl) {
+    GlobalFunction* fn = findGlobalEntry(name, length);
+    if (fn) {
+        if (decl) fn->decl = decl;
+        return fn;
+    }
     if (globalFunctionCount >= 256) {
         fprintf(stderr, "JIT Error: Global function limit reached.\n");
         exit(1);
     }
+    fn = &globalFunctions[globalFunctionCount++];
+    memset(fn, 0, sizeof(*fn));
     int storeLen = length > 127 ? 127 : length;
-    memcpy(globalFunctions[globalFunctionCount].name, name, storeLen);
-    globalFunctions[globalFunctionCount].name[storeLen] = '\0';
-    globalFunctions[globalFunctionCount].address = address;
-    globalFunctionCount++;
+    memcpy(fn->name, name, storeLen);
+    fn->name[storeLen] = '\0';
+    fn->decl = decl;
+    return fn;
 }
 
-static void* findGlobalFunction(const char* name, int length) {
-    for (int i = 0; i < globalFunctionCount; i++) {
-        int storedLen = strlen(globalFunctions[i].name);
-        if (storedLen == length && memcmp(globalFunctions[i].name, name, length) == 0) {
-            return globalFunctions[i].address;
+static void registerGlobalFunction(const char* name, int length, void* address) {
+    GlobalFunction* fn = declareGlobalFunction(name, length, NULL);
+    __atomic_store_n(&fn->address, address, __ATOMIC_RELEASE);
+
+    // Fix up forward references (or re-link callers after a tier-up)
+    for (int i = 0; i < linkedCallCount; i++) {
+        if (linkedCalls[i].target == fn) Jit_PatchRel32(linkedCalls[i].site, address);
+    }
+}
+
+// Pre-pass: declare every function (including imported module blocks)
+static void declareGlobalFunctions(AstNode* root) {
+    if (!root || root->type != NODE_BLOCK) return;
+    BlockStmt* block = (BlockStmt*)root;
+    for (int i = 0; i < block->count; i++) {
+        AstNode* stmt = block->statements[i];
+        if (stmt->type == NODE_FUNCTION_DECL) {
+            FunctionDecl* func = (FunctionDecl*)stmt;
+            declareGlobalFunction(func->name.start, func->name.length, func);
+        } else if (stmt->type == NODE_BLOCK) {
+            declareGlobalFunctions(stmt);
         }
     }
-    return NULL;
 }
 
-#define MAX_JIT_SIZE 4096
+// Resolves a function's call sites once it sits at `code` in the cache.
+// Callees that are not compiled yet are patched when they register.
+static void linkCallSites(CallSite* sites, int count, uint8_t* code) {
+    for (int i = 0; i < count; i++) {
+        uint8_t* site = code + sites[i].offset;
+        if (sites[i].target->address) {
+            Jit_PatchRel32(site, sites[i].target->address);
+        }
+        if (linkedCallCount == linkedCallCapacity) {
+            linkedCallCapacity = linkedCallCapacity ? linkedCallCapacity * 2 : 64;
+            linkedCalls = realloc(linkedCalls, sizeof(LinkedCall) * linkedCallCapacity);
+        }
+        linkedCalls[linkedCallCount].site = site;
+        linkedCalls[linkedCallCount].target = sites[i].target;
+        linkedCallCount++;
+    }
+}
+
+// Function compiled in this run, kept while the persistent cache is on or
+// an object file is being produced (Jit_BeginObject)
+typedef struct {
+    GlobalFunction* fn;
+    const uint8_t* code;
+    size_t size;
+    int arity;
+    Relocation* relocs;
+    int relocCount;
+    CallSite* callSites;
+    int callSiteCount;
+} CompiledUnit;
+
+static CompiledUnit* compiledUnits = NULL;
+static int compiledUnitCount = 0;
+static int objectOutput = 0;
+
+static int keepCompiledUnits(void) {
+    return DiskCache_Enabled() || objectOutput;
+}
+
+#define JIT_STAGING_SIZE 4096   // Initial staging buffer, grows on demand
 
 // Internal value type tracking for JIT optimization (Java types)
 typedef enum {
@@ -68,19 +189,98 @@ typedef struct {
     Token name;
     Token typeName;      // User-facing type (always "number")
     int offset;          // RBP offset (negative)
-    int reg;             // -1 if stack, 0-4 for RBX, R12-R15
+    int reg;             // -1 if stack, else physical register (see regClass)
+    RegisterClass regClass;  // GPR home (RBX, R12-R15) or XMM home (XMM8-XMM15)
     ValueType internalType;  // INT64 vs DOUBLE (for specialization)
+    AstNode* invariant;      // Hoisted loop-invariant expression this unnamed local caches
 } Local;
 
+// Out-of-line slow path of an inline array access, taken when the storage
+// kind differs from the static one or the index is out of range. Emitted
+// after the function body (emitColdStubs).
+typedef struct {
+    size_t branches[2];     // rel32 fields of the JNE/JAE that lead here
+    int branchCount;
+    size_t resume;          // Fast path continuation
+    int stackSize;          // Frame depth at the access (call alignment)
+    uint32_t liveXmm;       // XMM homes to preserve across the helper call
+    ArrayKind kind;         // Static kind the fast path assumed
+    int isStore;            // RDX holds the value to store
+} ColdStub;
+
+// a[i] proven within [0, a.length()) by the enclosing counted loop
 typedef struct {
-    Local locals[64];
+    Local* array;
+    Local* index;
+} InBoundsAccess;
+
+#define MAX_IN_BOUNDS 8
+
+// Top-level code binds a local per function, as many as globalFunctions holds
+#define MAX_LOCALS 256
+
+// A for-loop of a baseline function. The baseline code counts its
+// backedges; once hot, the optimized code is entered at the top of the
+// loop with the baseline frame's locals copied in (on-stack replacement).
+typedef struct {
+    const char* name;       // Declaration's token, matched against the optimized compile
+    int offset;             // RBP offset in the baseline frame
+    ValueType type;
+} OsrSlot;
+
+typedef struct TierLoop {
+    ForStmt* loop;
+    int32_t counter;        // Backedges left before tier-up
+    int slotCount;          // Locals in scope after the initializer
+    OsrSlot slots[MAX_LOCALS]; // Every local can be in scope
+    size_t osrOffset;       // Entry offset in the optimized code (0: none)
+    void* osrEntry;         // Installed entry, called with the baseline RBP in RDI
+    struct TierLoop* next;
+} TierLoop;
+
+typedef struct {
+    Local locals[MAX_LOCALS];
     int localCount;
     int stackSize;
-    int usedRegisters;      // Count of allocated registers (0-5)
     ValueType lastExprType; // Track type of last emitted expression
     int lastResultReg;      // Track which register holds last result
+    RegisterMap* regMap;    // Linear scan result for the current function (NULL at top level)
+    uint32_t savedGprMask;  // Callee-saved GPRs pushed by the prologue
+    int xmmSaveBase;        // RBP offset of the XMM home save area
+    // Direct CALL/JMP rel32 sites in the staging buffer, linked after install
+    CallSite* callSites;
+    int callSiteCount;
+    int callSiteCapacity;
+    Relocation* relocs;     // Pointer immediates, for the persistent cache
+    int relocCount;
+    int relocCapacity;
+    int scopeFloor;         // Lowest local visible to lookups (raised inside inlined bodies)
+    int invariantCount;     // Hoisted loop invariants currently held in locals
+    ColdStub* coldStubs;    // Array access slow paths, emitted after the body
+    int coldStubCount;
+    int coldStubCapacity;
+    InBoundsAccess inBounds[MAX_IN_BOUNDS]; // Enclosing counted array loops
+    int inBoundsCount;
+    struct InlineFrame* inlineFrame; // Non-NULL while emitting an inlined callee
+    FunctionDecl* function; // Function being compiled (NULL at top level)
+    size_t tailEntry;       // Parameter binding after the prologue (self tail calls)
+    int tailEntryStackSize; // Frame depth at tailEntry
+    int baseline;           // Baseline tier: no register allocation, inlining, LICM or vectorization
+    GlobalFunction* tierFn; // Function whose counters / OSR records this compile uses (NULL if untiered)
+    uint32_t cpuFeatures;   // CpuFeature bits instruction selection may use
+    int trackLines;         // Build a source line table (see Jit/DebugInfo.h)
+    DebugLine* lines;
+    int lineCount;
+    int lineCapacity;
 } CompilerContext;
 
+static void reserveLocals(CompilerContext* ctx, int count) {
+    if (ctx->localCount + count > MAX_LOCALS) {
+        fprintf(stderr, "JIT Error: Too many locals in one scope (limit %d).\n", MAX_LOCALS);
+        exit(1);
+    }
+}
+
 // Struct Registry
 typedef struct {
     Token name;
@@ -136,14 +336,14 @@ static int getPackedFieldInfo(StructInfo* info, Token* field, int* outSize, int*
         int fSize = 8;
         int isPtr = 0;
         
-        if (fType.length == 3 && memcmp(fType.start, "int", 3) == 0) fSize = 4;
-        else if (fType.length == 5 && memcmp(fType.start, "float", 5) == 0) fSize = 4;
+        if (fType.length == 5 && memcmp(fType.start, "float", 5) == 0) fSize = 4;
         else if ((fType.length == 7 && memcmp(fType.start, "boolean", 7) == 0) || 
                  (fType.length == 4 && memcmp(fType.start, "byte", 4) == 0)) fSize = 1; 
         else if ((fType.length == 5 && memcmp(fType.start, "short", 5) == 0) || 
                  (fType.length == 4 && memcmp(fType.start, "char", 4) == 0)) fSize = 2;
         else if ((fType.length == 6 && memcmp(fType.start, "double", 6) == 0) || 
-                 (fType.length == 4 && memcmp(fType.start, "long", 4) == 0)) fSize = 8;
+                 (fType.length == 4 && memcmp(fType.start, "long", 4) == 0) ||
+                 (fType.length == 3 && memcmp(fType.start, "int", 3) == 0)) fSize = 8;
         else { fSize = 8; isPtr = 1; }
         
         while (dataSize % fSize != 0) dataSize++;
@@ -162,7 +362,7 @@ static int getPackedFieldInfo(StructInfo* info, Token* field, int* outSize, int*
 
 static int resolveLocal(CompilerContext* ctx, Token* name, Token* outType, int* outReg, ValueType* outInternalType) {
     // Scan backwards to support shadowing
-    for (int i = ctx->localCount - 1; i >= 0; i--) {
+    for (int i = ctx->localCount - 1; i >= ctx->scopeFloor; i--) {
         Token* localName = &ctx->locals[i].name;
         if (localName->length == name->length && 
             memcmp(localName->start, name->start, name->length) == 0) {
@@ -175,344 +375,2660 @@ static int resolveLocal(CompilerContext* ctx, Token* name, Token* outType, int*
     return -1; // Not found
 }
 
-static int allocRegister(CompilerContext* ctx) {
-    if (ctx->usedRegisters < 5) {
-        return ctx->usedRegisters++;
+static Local* findLocal(CompilerContext* ctx, Token* name) {
+    for (int i = ctx->localCount - 1; i >= ctx->scopeFloor; i--) {
+        Token* localName = &ctx->locals[i].name;
+        if (localName->length == name->length &&
+            memcmp(localName->start, name->start, name->length) == 0) {
+            return &ctx->locals[i];
+        }
     }
-    return -1;
+    return NULL;
 }
 
-// Helper to check if node results in a Number guaranteed
-// Helper to check if node is guaranteed to be an INTEGER (no fractional part)
-static int __attribute__((unused)) isGuaranteedInteger(AstNode* node, CompilerContext* ctx) {
-    if (node->type == NODE_LITERAL_EXPR) {
-        LiteralExpr* lit = (LiteralExpr*)node;
-        
-        // Check if identifier references INT64 variable
-        if (lit->token.type == TOKEN_IDENTIFIER) {
-            Token type = {0};
-            ValueType varType = TYPE_UNKNOWN;
-            if (resolveLocal(ctx, &lit->token, &type, NULL, &varType)) {
-                return varType == TYPE_INT || varType == TYPE_LONG;
-            }
-            return 0;
-        }
-        
-        // Check if numeric literal is whole number
-        if (lit->token.type == TOKEN_NUMBER) {
-            char buffer[64];
-            int len = lit->token.length < 63 ? lit->token.length : 63;
-            for (int i = 0; i < len; i++) buffer[i] = lit->token.start[i];
-            buffer[len] = '\0';
-            
-            double val = strtod(buffer, NULL);
-            // Check if value is whole and within int64 range
-            return (floor(val) == val && val >= (double)INT64_MIN && val <= (double)INT64_MAX);
+static ValueType valueTypeFromToken(Token* typeName) {
+    if (typeName->start == NULL) return TYPE_UNKNOWN;
+    if (typeName->length == 3 && memcmp(typeName->start, "int", 3) == 0) return TYPE_INT;
+    if (typeName->length == 4 && memcmp(typeName->start, "long", 4) == 0) return TYPE_LONG;
+    if (typeName->length == 6 && memcmp(typeName->start, "double", 6) == 0) return TYPE_DOUBLE;
+    if (typeName->length == 5 && memcmp(typeName->start, "float", 5) == 0) return TYPE_FLOAT;
+    if (typeName->length == 7 && memcmp(typeName->start, "boolean", 7) == 0) return TYPE_BOOLEAN;
+    if (typeName->length == 4 && memcmp(typeName->start, "byte", 4) == 0) return TYPE_BYTE;
+    if (typeName->length == 5 && memcmp(typeName->start, "short", 5) == 0) return TYPE_SHORT;
+    if (typeName->length == 4 && memcmp(typeName->start, "char", 4) == 0) return TYPE_CHAR;
+    return TYPE_UNKNOWN;
+}
+
+// Element storage for a declared "T[]" type: int[], long[], float[] and
+// double[] are packed, anything else holds boxed Values. int is 64-bit in
+// registers, so int[] elements are too.
+static ArrayKind arrayKindFromToken(Token* typeName) {
+    if (typeName->start == NULL || typeName->length < 3) return ARRAY_VALUE;
+    if (typeName->start[typeName->length - 2] != '[' || typeName->start[typeName->length - 1] != ']') return ARRAY_VALUE;
+    Token elem = { .start = typeName->start, .length = typeName->length - 2 };
+    switch (valueTypeFromToken(&elem)) {
+        case TYPE_INT:
+        case TYPE_LONG:   return ARRAY_INT64;
+        case TYPE_FLOAT:  return ARRAY_FLOAT32;
+        case TYPE_DOUBLE: return ARRAY_FLOAT64;
+        default:          return ARRAY_VALUE;
+    }
+}
+
+// Representation of an element loaded unboxed from a typed array
+static ValueType arrayElementType(ArrayKind kind) {
+    switch (kind) {
+        case ARRAY_INT32:   return TYPE_INT;
+        case ARRAY_INT64:   return TYPE_LONG;
+        case ARRAY_FLOAT32: return TYPE_FLOAT;
+        case ARRAY_FLOAT64: return TYPE_DOUBLE;
+        default:            return TYPE_UNKNOWN;
+    }
+}
+
+static int elementScale(ArrayKind kind) {
+    return (kind == ARRAY_INT32 || kind == ARRAY_FLOAT32) ? 4 : 8;
+}
+
+// Representation of a struct field once loaded into RAX (pointers stay boxed)
+static ValueType structFieldType(StructInfo* info, Token* field) {
+    for (int i = 0; i < info->fieldCount; i++) {
+        Token* fName = &info->fieldNames[i];
+        if (fName->length == field->length && memcmp(fName->start, field->start, field->length) == 0) {
+            return valueTypeFromToken(&info->fieldTypes[i]);
         }
     }
-    
-    // Binary expressions: both operands must be int64
-    if (node->type == NODE_BINARY_EXPR) {
-        BinaryExpr* bin = (BinaryExpr*)node;
-        return isGuaranteedInteger(bin->left, ctx) && isGuaranteedInteger(bin->right, ctx);
+    return TYPE_UNKNOWN;
+}
+
+static void emitRegisterMove(Assembler* as, Local* local, Register srcReg) {
+    // Move srcReg (usually RAX) into the local's home
+    if (local->regClass == REG_CLASS_XMM) {
+        Asm_Movq_Xmm_Reg(as, (XmmRegister)local->reg, srcReg);
+    } else if (local->reg != -1) {
+        Asm_Mov_Reg_Reg(as, (Register)local->reg, srcReg);
+    } else {
+        Asm_Mov_Mem_Reg(as, RBP, -local->offset, srcReg);
     }
-    
-    return 0;
 }
 
-static void emitRegisterMove(Assembler* as, int regIndex, int srcReg) {
-    // Move srcReg (usually RAX) to Dest Reg (RBX, R12-R15)
-    // Reg Map: 0:RBX, 1:R12, 2:R13, 3:R14, 4:R15
-    switch (regIndex) {
-        case 0: Asm_Mov_Reg_Reg(as, RBX, srcReg); break;
-        case 1: Asm_Mov_Reg_Reg(as, R12, srcReg); break;
-        case 2: Asm_Mov_Reg_Reg(as, R13, srcReg); break;
-        case 3: Asm_Mov_Reg_Reg(as, R14, srcReg); break;
-        case 4: Asm_Mov_Reg_Reg(as, R15, srcReg); break;
+static void emitRegisterLoad(Assembler* as, Register dstReg, Local* local) {
+    // Move from the local's home to Dst Reg (usually RAX)
+    if (local->regClass == REG_CLASS_XMM) {
+        Asm_Movq_Reg_Xmm(as, dstReg, (XmmRegister)local->reg);
+    } else if (local->reg != -1) {
+        Asm_Mov_Reg_Reg(as, dstReg, (Register)local->reg);
+    } else {
+        Asm_Mov_Reg_Mem(as, dstReg, RBP, -local->offset);
     }
 }
 
+// XMM homes are caller-saved in the SysV ABI. Collect the ones owned by
+// locals currently in scope so calls can preserve them.
+static uint32_t liveXmmHomes(CompilerContext* ctx) {
+    uint32_t mask = 0;
+    for (int i = 0; i < ctx->localCount; i++) {
+        if (ctx->locals[i].regClass == REG_CLASS_XMM) mask |= 1u << ctx->locals[i].reg;
+    }
+    return mask;
+}
 
+static int xmmSaveSlot(CompilerContext* ctx, int xmm) {
+    // One 8-byte slot per allocated XMM home, in register order
+    uint32_t below = ctx->regMap->usedXmmMask & ((1u << xmm) - 1);
+    return ctx->xmmSaveBase + 8 * (__builtin_popcount(below) + 1);
+}
 
-static void emitRegisterLoad(Assembler* as, int dstReg, int regIndex) {
-    // Move from Src Reg (RBX...) to Dst Reg (usually RAX)
-    switch (regIndex) {
-        case 0: Asm_Mov_Reg_Reg(as, dstReg, RBX); break;
-        case 1: Asm_Mov_Reg_Reg(as, dstReg, R12); break;
-        case 2: Asm_Mov_Reg_Reg(as, dstReg, R13); break;
-        case 3: Asm_Mov_Reg_Reg(as, dstReg, R14); break;
-        case 4: Asm_Mov_Reg_Reg(as, dstReg, R15); break;
+static void emitXmmHomeTransfer(Assembler* as, CompilerContext* ctx, uint32_t mask, int save) {
+    for (int xmm = XMM8; xmm <= XMM15; xmm++) {
+        if (!(mask & (1u << xmm))) continue;
+        int slot = xmmSaveSlot(ctx, xmm);
+        if (save) Asm_Movsd_Mem_Xmm(as, RBP, -slot, (XmmRegister)xmm);
+        else Asm_Movsd_Xmm_Mem(as, (XmmRegister)xmm, RBP, -slot);
     }
 }
 
-static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
+// CALL/JMP rel32 (opcode) to fn, linked after the caller is installed
+// (linkCallSites) and relinked when fn tiers up, possibly while the caller
+// runs. NOPs keep the rel32 inside one aligned 8-byte word, which code
+// addresses preserve (functions start 16-byte aligned), so
+// Jit_PatchRel32 rewrites it with a single atomic store.
+static void emitCallSiteRel32(Assembler* as, CompilerContext* ctx, uint8_t opcode, GlobalFunction* fn) {
+    while (((as->offset + 1) & 7) > 4) Asm_Emit8(as, 0x90);
+    Asm_Emit8(as, opcode);
+    if (ctx->callSiteCount == ctx->callSiteCapacity) {
+        ctx->callSiteCapacity = ctx->callSiteCapacity ? ctx->callSiteCapacity * 2 : 16;
+        ctx->callSites = realloc(ctx->callSites, sizeof(CallSite) * ctx->callSiteCapacity);
+    }
+    ctx->callSites[ctx->callSiteCount].offset = as->offset;
+    ctx->callSites[ctx->callSiteCount].target = fn;
+    ctx->callSiteCount++;
+    Asm_Emit32(as, 0);
+}
+
+// CALL through a register with the ABI obligations handled in one place:
+// live XMM homes are preserved and RSP is 16-byte aligned at the CALL.
+// RBP is 16-byte aligned after the prologue, so alignment follows stackSize.
+// A non-NULL direct target emits CALL rel32 instead (see emitCallDirect).
+static void emitCallPreserving(Assembler* as, CompilerContext* ctx, Register target, GlobalFunction* direct, uint32_t liveXmm) {
+    emitXmmHomeTransfer(as, ctx, liveXmm, 1);
+
+    int pad = (ctx->stackSize % 16) != 0;
+    if (pad) Asm_Sub_Reg_Imm(as, RSP, 8);
+    if (direct) {
+        emitCallSiteRel32(as, ctx, 0xE8, direct);   // CALL rel32
+    } else {
+        Asm_Call_Reg(as, target);
+    }
+    if (pad) Asm_Add_Reg_Imm(as, RSP, 8);
+
+    emitXmmHomeTransfer(as, ctx, liveXmm, 0);
+}
+
+static void emitCall(Assembler* as, CompilerContext* ctx, Register target, GlobalFunction* direct) {
+    emitCallPreserving(as, ctx, target, direct, liveXmmHomes(ctx));
+}
+
+static void emitCallRegister(Assembler* as, CompilerContext* ctx, Register target) {
+    emitCall(as, ctx, target, NULL);
+}
+
+// MOV reg, imm64 of a pointer the persistent cache has to relocate:
+// a runtime helper (CACHE_RELOC_IMAGE), a string constant or a function
+static void emitPointer(Assembler* as, CompilerContext* ctx, Register dst, uint64_t value, CacheRelocKind kind, const void* target) {
+    Asm_Mov_Reg_Ptr(as, dst, (void*)(uintptr_t)value);
+    if (ctx->relocCount == ctx->relocCapacity) {
+        ctx->relocCapacity = ctx->relocCapacity ? ctx->relocCapacity * 2 : 16;
+        ctx->relocs = realloc(ctx->relocs, sizeof(Relocation) * ctx->relocCapacity);
+    }
+    ctx->relocs[ctx->relocCount].offset = as->offset - 8;
+    ctx->relocs[ctx->relocCount].kind = kind;
+    ctx->relocs[ctx->relocCount].target = target;
+    ctx->relocCount++;
+}
+
+static void emitCallAbsolute(Assembler* as, CompilerContext* ctx, void* target) {
+    emitPointer(as, ctx, RAX, (uint64_t)(uintptr_t)target, CACHE_RELOC_IMAGE, target);
+    emitCallRegister(as, ctx, RAX);
+}
+
+static const Register calleeSavedGprs[] = { RBX, R12, R13, R14, R15 };
+
+static int savedGprCount(CompilerContext* ctx) {
+    return __builtin_popcount(ctx->savedGprMask);
+}
+
+// Prologue: PUSH RBP / MOV RBP, RSP, then the callee-saved registers the
+// allocator handed out (the frame then sits 8 * savedGprCount below RBP)
+static void emitFramePrologue(Assembler* as, CompilerContext* ctx) {
+    Asm_Push(as, RBP);
+    Asm_Mov_Reg_Reg(as, RBP, RSP);
+    for (int i = 0; i < 5; i++) {
+        if (ctx->savedGprMask & (1u << calleeSavedGprs[i])) Asm_Push(as, calleeSavedGprs[i]);
+    }
+}
+
+// Epilogue: restore only the callee-saved registers the allocator handed out
+static void emitFrameTeardown(Assembler* as, CompilerContext* ctx) {
+    Asm_Lea_Reg_Mem(as, RSP, RBP, -8 * savedGprCount(ctx));
+    for (int i = 4; i >= 0; i--) {
+        if (ctx->savedGprMask & (1u << calleeSavedGprs[i])) Asm_Pop(as, calleeSavedGprs[i]);
+    }
+    Asm_Pop(as, RBP);
+}
+
+static void emitEpilogue(Assembler* as, CompilerContext* ctx) {
+    emitFrameTeardown(as, ctx);
+    Asm_Ret(as);
+}
+
+// ==================== TYPE-DIRECTED EMISSION ====================
+// Every expression leaves RAX in the representation named by lastExprType:
+// raw int64 (INT/LONG/BYTE/SHORT/CHAR), raw 0/1 (BOOLEAN), double bits
+// (DOUBLE), single-precision bits (FLOAT) or a boxed Value (UNKNOWN).
+// Binary operators pick the operation type from the operands' static
+// types before emitting anything, so each side is converted at most once.
+
+static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx);
+static void emitStatement(Assembler* as, CompilerContext* ctx, AstNode* node);
+
+static int isIntegralType(ValueType t) {
+    return t == TYPE_INT || t == TYPE_LONG || t == TYPE_BYTE || t == TYPE_SHORT || t == TYPE_CHAR;
+}
+
+static int isNumberLiteral(AstNode* node) {
+    return node->type == NODE_LITERAL_EXPR && ((LiteralExpr*)node)->token.type == TOKEN_NUMBER;
+}
+
+static int isIdentifier(AstNode* node) {
+    return node->type == NODE_LITERAL_EXPR && ((LiteralExpr*)node)->token.type == TOKEN_IDENTIFIER;
+}
+
+static double literalNumber(LiteralExpr* lit) {
+    char buffer[64];
+    int len = lit->token.length < 63 ? lit->token.length : 63;
+    memcpy(buffer, lit->token.start, len);
+    buffer[len] = '\0';
+    return strtod(buffer, NULL);
+}
+
+static int literalIsIntegral(LiteralExpr* lit) {
+    for (int i = 0; i < lit->token.length; i++) {
+        char c = lit->token.start[i];
+        if (c == '.' || c == 'e' || c == 'E') return 0;
+    }
+    return 1;
+}
+
+// Exact value of an integral literal (the parser rejects ones that do not
+// fit); going through literalNumber() would round above 2^53
+static int64_t literalInt(LiteralExpr* lit) {
+    char buffer[64];
+    int len = lit->token.length < 63 ? lit->token.length : 63;
+    memcpy(buffer, lit->token.start, len);
+    buffer[len] = '\0';
+    return strtoll(buffer, NULL, 10);
+}
+
+// k for an integral literal 2^k (1 <= k <= 62), 0 otherwise
+static int powerOfTwoLiteral(AstNode* node) {
+    if (!isNumberLiteral(node) || !literalIsIntegral((LiteralExpr*)node)) return 0;
+    int64_t value = literalInt((LiteralExpr*)node);
+    for (int k = 1; k <= 62; k++) {
+        if (value == (int64_t)1 << k) return k;
+    }
+    return 0;
+}
+
+static int isComparisonOp(TokenType op) {
+    return op == TOKEN_LESS || op == TOKEN_GREATER || op == TOKEN_LESS_EQUAL ||
+           op == TOKEN_GREATER_EQUAL || op == TOKEN_EQUAL_EQUAL || op == TOKEN_BANG_EQUAL;
+}
+
+// Operation type for + - * /. Unknown operands are boxed numbers (double
+// bits) except for '+', which may be string concatenation. float stays
+// single precision unless a double takes part (see operandType() for
+// literals).
+static ValueType arithmeticType(TokenType op, ValueType a, ValueType b) {
+    if (op == TOKEN_PLUS && (a == TYPE_UNKNOWN || b == TYPE_UNKNOWN)) return TYPE_UNKNOWN;
+    if (a == TYPE_DOUBLE || a == TYPE_UNKNOWN || b == TYPE_DOUBLE || b == TYPE_UNKNOWN) return TYPE_DOUBLE;
+    if (a == TYPE_FLOAT || b == TYPE_FLOAT) return TYPE_FLOAT;
+    if (a == TYPE_LONG || b == TYPE_LONG) return TYPE_LONG;
+    return TYPE_INT;
+}
+
+static ValueType inferType(CompilerContext* ctx, AstNode* node);
+
+// Type of one operand of a binary operator. There is no float literal
+// suffix, so a number literal next to a float is a float constant and
+// float-only code keeps single precision.
+static ValueType operandType(CompilerContext* ctx, AstNode* node, AstNode* other) {
+    if (isNumberLiteral(node) && inferType(ctx, other) == TYPE_FLOAT) return TYPE_FLOAT;
+    return inferType(ctx, node);
+}
+
+// Operand type for comparisons. Equality on boxed values goes through
+// Runtime_Equal, everything else compares numerically.
+static ValueType compareType(TokenType op, ValueType a, ValueType b) {
+    if (op == TOKEN_EQUAL_EQUAL || op == TOKEN_BANG_EQUAL) {
+        if (a == TYPE_BOOLEAN && b == TYPE_BOOLEAN) return TYPE_BOOLEAN;
+        if (a == TYPE_UNKNOWN || b == TYPE_UNKNOWN || a == TYPE_BOOLEAN || b == TYPE_BOOLEAN) return TYPE_UNKNOWN;
+    }
+    return arithmeticType(TOKEN_MINUS, a, b);
+}
+
+// Static element storage of an array expression, from the declared type of
+// a local. The runtime helpers convert if the object turns out different.
+static ArrayKind arrayKindOf(CompilerContext* ctx, AstNode* array) {
+    if (array->type != NODE_LITERAL_EXPR || ((LiteralExpr*)array)->token.type != TOKEN_IDENTIFIER) return ARRAY_VALUE;
+    Local* local = findLocal(ctx, &((LiteralExpr*)array)->token);
+    return local ? arrayKindFromToken(&local->typeName) : ARRAY_VALUE;
+}
+
+// Predicts the lastExprType emitNode() will report, without emitting
+static ValueType inferType(CompilerContext* ctx, AstNode* node) {
     switch (node->type) {
-        case NODE_BLOCK: {
-            BlockStmt* block = (BlockStmt*)node;
-            
-            // Scope Management
-            int savedStackSize = ctx->stackSize;
-            int savedLocalCount = ctx->localCount;
-            
-            for (int i = 0; i < block->count; i++) {
-                emitNode(as, block->statements[i], ctx);
+        case NODE_LITERAL_EXPR: {
+            LiteralExpr* lit = (LiteralExpr*)node;
+            if (lit->token.type == TOKEN_NUMBER) return literalIsIntegral(lit) ? TYPE_INT : TYPE_DOUBLE;
+            if (lit->token.type == TOKEN_TRUE || lit->token.type == TOKEN_FALSE) return TYPE_BOOLEAN;
+            if (lit->token.type == TOKEN_IDENTIFIER) {
+                Local* local = findLocal(ctx, &lit->token);
+                return local ? local->internalType : TYPE_UNKNOWN;
             }
-            
-            // Pop Stack (if locals were declared)
-            int diff = ctx->stackSize - savedStackSize;
-            if (diff > 0) {
-                 // ADD RSP, diff
-                 Asm_Add_Reg_Imm(as, RSP, diff);
-                 ctx->stackSize = savedStackSize;
+            return TYPE_UNKNOWN;
+        }
+        case NODE_BINARY_EXPR: {
+            BinaryExpr* bin = (BinaryExpr*)node;
+            if (isComparisonOp(bin->op.type)) return TYPE_BOOLEAN;
+            return arithmeticType(bin->op.type, operandType(ctx, bin->left, bin->right),
+                                  operandType(ctx, bin->right, bin->left));
+        }
+        case NODE_LOGICAL_EXPR:
+            return TYPE_BOOLEAN;
+        case NODE_UNARY_EXPR: {
+            UnaryExpr* unary = (UnaryExpr*)node;
+            if (unary->op.type == TOKEN_BANG) return TYPE_BOOLEAN;
+            ValueType t = inferType(ctx, unary->right);
+            return (isIntegralType(t) || t == TYPE_FLOAT) ? t : TYPE_DOUBLE;
+        }
+        case NODE_ASSIGNMENT_EXPR: {
+            Local* local = findLocal(ctx, &((AssignmentExpr*)node)->name);
+            return local ? local->internalType : TYPE_UNKNOWN;
+        }
+        case NODE_GET_EXPR: {
+            GetExpr* get = (GetExpr*)node;
+            if (get->object->type != NODE_LITERAL_EXPR) return TYPE_UNKNOWN;
+            Local* local = findLocal(ctx, &((LiteralExpr*)get->object)->token);
+            StructInfo* info = local ? resolveStruct(&local->typeName) : NULL;
+            return info ? structFieldType(info, &get->name) : TYPE_UNKNOWN;
+        }
+        case NODE_INDEX_EXPR:
+            return arrayElementType(arrayKindOf(ctx, ((IndexExpr*)node)->array));
+        case NODE_INDEX_SET_EXPR:
+            return arrayElementType(arrayKindOf(ctx, ((IndexSetExpr*)node)->array));
+        case NODE_CALL_EXPR: {
+            CallExpr* call = (CallExpr*)node;
+            if (call->callee->type == NODE_GET_EXPR) {
+                GetExpr* get = (GetExpr*)call->callee;
+                if (get->name.length == 6 && memcmp(get->name.start, "length", 6) == 0) return TYPE_INT;
             }
-            
-            // Restore Scope
-            ctx->localCount = savedLocalCount;
-            
-            break;
+            return TYPE_UNKNOWN;
         }
+        default:
+            return TYPE_UNKNOWN;
+    }
+}
 
-        case NODE_ARRAY_LITERAL: {
-            ArrayLiteral* lit = (ArrayLiteral*)node;
-            
-            // Call Runtime_NewArray(capacity)
-            Asm_Mov_Imm64(as, RDI, lit->count < 4 ? 4 : lit->count);
-            void* ptr = (void*)Runtime_NewArray;
-            Asm_Mov_Reg_Ptr(as, RAX, ptr);
-            
-            // Align and Call
-            Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xEC); Asm_Emit8(as, 0x08);
-            Asm_Call_Reg(as, RAX);
-            Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xC4); Asm_Emit8(as, 0x08);
-            
-            // Array in RAX. Push to protect.
-            Asm_Push(as, RAX);
-            ctx->stackSize += 8;
-            
-            for (int i = 0; i < lit->count; i++) {
-                emitNode(as, lit->elements[i], ctx);
-                // RAX = Value.
-                // RSI = Register holding Value (Arg 2)
-                Asm_Mov_Reg_Reg(as, RSI, RAX); 
-                
-                // RDI = Array Ptr (Arg 1) (Peek Stack)
-                Asm_Mov_Reg_Mem(as, RDI, RSP, 0);
-                
-                // Call Runtime_ArrayPush(arr, val)
-                void* pushPtr = (void*)Runtime_ArrayPush;
-                Asm_Mov_Reg_Ptr(as, RAX, pushPtr);
-                
-                // Align (Stack is misaligned by 1 push) -> Need SUB 8
-                Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xEC); Asm_Emit8(as, 0x08);
-                Asm_Call_Reg(as, RAX);
-                Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xC4); Asm_Emit8(as, 0x08);
-            }
-            
-            // Pop Array -> RAX
-            Asm_Pop(as, RAX);
-            ctx->stackSize -= 8;
-            ctx->lastExprType = TYPE_UNKNOWN; 
-            break;
+// Converts RAX from one representation to another (XMM0/RCX are scratch)
+static void emitConvert(Assembler* as, ValueType from, ValueType to) {
+    int fromInt = isIntegralType(from) || from == TYPE_BOOLEAN;
+    if (from == to) return;
+
+    if (to == TYPE_UNKNOWN) {
+        // Box
+        if (from == TYPE_BOOLEAN) {
+            Asm_Mov_Imm64(as, RCX, VAL_FALSE);   // 0/1 -> VAL_FALSE/VAL_TRUE
+            Asm_Add_Reg_Reg(as, RAX, RCX);
+        } else if (fromInt) {
+            Asm_Cvtsi2sd_Xmm_Reg(as, XMM0, RAX);
+            Asm_Movq_Reg_Xmm(as, RAX, XMM0);
+        } else if (from == TYPE_FLOAT) {
+            Asm_Movd_Xmm_Reg(as, XMM0, RAX);
+            Asm_Cvtss2sd(as, XMM0, XMM0);
+            Asm_Movq_Reg_Xmm(as, RAX, XMM0);
         }
+        return;
+    }
 
-        case NODE_INDEX_EXPR: {
-            IndexExpr* expr = (IndexExpr*)node;
-            // 1. Evaluate Array -> Stack
-            emitNode(as, expr->array, ctx);
-            Asm_Push(as, RAX);
-            ctx->stackSize += 8;
-            
-            // 2. Evaluate Index -> RAX (Boxed Value)
-            emitNode(as, expr->index, ctx);
-            
-            // Unbox Double -> Int (RSI)
-            // MOVQ XMM0, RAX
-            Asm_Emit8(as, 0x66); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x6E); Asm_Emit8(as, 0xC0); 
-            // CVTTSD2SI RSI, XMM0 (Truncate to Int64)
-            // F2 48 0F 2C F0 (RSI is 0xF0? 11 110 000. Dest=RSI(110)=6. Src=XMM0(000). REX.W=1. )
-            // Opcode: F2 REX.W 0F 2C /r.
-            // RSI (6) -> 110. XMM0 -> 000.  ModRM: 11 110 000 = 0xF0.
-            Asm_Emit8(as, 0xF2); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x2C); Asm_Emit8(as, 0xF0);
-            
-            // 3. Pop Array -> RDI
-            Asm_Pop(as, RDI);
-            ctx->stackSize -= 8;
-            
-            // 4. Call Runtime_ArrayGet
-            void* getPtr = (void*)Runtime_ArrayGet;
-            Asm_Mov_Reg_Ptr(as, RAX, getPtr);
-            
-            // Align
-            Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xEC); Asm_Emit8(as, 0x08);
-            Asm_Call_Reg(as, RAX);
-            Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xC4); Asm_Emit8(as, 0x08);
-            
-            ctx->lastExprType = TYPE_UNKNOWN;
-            break;
+    if (to == TYPE_BOOLEAN) {
+        if (from == TYPE_UNKNOWN) {
+            Asm_Mov_Imm64(as, RCX, VAL_TRUE);
+            Asm_Cmp_Reg_Reg(as, RAX, RCX);
+            Asm_Setcc(as, COND_E, RAX);
+        } else {
+            Asm_Test_Reg_Reg(as, RAX, RAX);
+            Asm_Setcc(as, COND_NE, RAX);
         }
-        
-        case NODE_INDEX_SET_EXPR: {
-            IndexSetExpr* expr = (IndexSetExpr*)node;
-            
-            // 1. Evaluate Array -> Stack
-            emitNode(as, expr->array, ctx);
-            Asm_Push(as, RAX);
-            ctx->stackSize += 8;
-            
-            // 2. Evaluate Index -> Stack
-            emitNode(as, expr->index, ctx);
-            Asm_Push(as, RAX);
-            ctx->stackSize += 8;
-            
-            // 3. Evaluate Value -> RAX
-            emitNode(as, expr->value, ctx);
-            Asm_Mov_Reg_Reg(as, RDX, RAX); // Arg 3: Value
-            
-            // 4. Pop Index -> RSI
-            Asm_Pop(as, RSI); // This is Boxed Value
-            
-            // Unbox RSI (Boxed) -> RSI (Int)
-            // MOVQ XMM0, RSI
-            Asm_Emit8(as, 0x66); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x6E); Asm_Emit8(as, 0xC6); 
-            // CVTTSD2SI RSI, XMM0
-            Asm_Emit8(as, 0xF2); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x2C); Asm_Emit8(as, 0xF0);
-            
-            // 5. Pop Array -> RDI
-            Asm_Pop(as, RDI);
-            ctx->stackSize -= 8;
-            
-            // 6. Call Runtime_ArraySet
-            void* setPtr = (void*)Runtime_ArraySet;
-            Asm_Mov_Reg_Ptr(as, RAX, setPtr);
-            
-            // Align
-            Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xEC); Asm_Emit8(as, 0x08);
-            Asm_Call_Reg(as, RAX);
-            Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xC4); Asm_Emit8(as, 0x08);
-            
-            // Void return? Or return assigned value (RDX)?
-            // Convention: Assignment returns value.
-            Asm_Mov_Reg_Reg(as, RAX, RDX);
-            ctx->lastExprType = TYPE_UNKNOWN;
-            break;
+        Asm_Movzx_Reg_Reg8(as, RAX, RAX);
+        return;
+    }
+
+    if (isIntegralType(to)) {
+        if (fromInt) return; // All integral types are kept as raw int64
+        if (from == TYPE_FLOAT) {
+            Asm_Movd_Xmm_Reg(as, XMM0, RAX);
+            Asm_Cvttss2si_Reg_Xmm(as, RAX, XMM0);
+        } else {
+            // DOUBLE, or a boxed number (same bits)
+            Asm_Movq_Xmm_Reg(as, XMM0, RAX);
+            Asm_Cvttsd2si_Reg_Xmm(as, RAX, XMM0);
         }
+        return;
+    }
 
-        case NODE_VAR_DECL: {
-            VarDecl* decl = (VarDecl*)node;
-            
-            // ==================== PHASE 0: UNIFIED VALUE STORAGE ====================
-            // All numbers stored as NaN-boxed doubles for consistency
+    if (to == TYPE_DOUBLE) {
+        if (fromInt) {
+            Asm_Cvtsi2sd_Xmm_Reg(as, XMM0, RAX);
+            Asm_Movq_Reg_Xmm(as, RAX, XMM0);
+        } else if (from == TYPE_FLOAT) {
+            Asm_Movd_Xmm_Reg(as, XMM0, RAX);
+            Asm_Cvtss2sd(as, XMM0, XMM0);
+            Asm_Movq_Reg_Xmm(as, RAX, XMM0);
+        }
+        // UNKNOWN: boxed numbers are already double bits
+        return;
+    }
+
+    if (to == TYPE_FLOAT) {
+        if (fromInt) {
+            Asm_Cvtsi2ss_Xmm_Reg(as, XMM0, RAX);
+        } else {
+            Asm_Movq_Xmm_Reg(as, XMM0, RAX);
+            Asm_Cvtsd2ss(as, XMM0, XMM0);
+        }
+        Asm_Movd_Reg_Xmm(as, RAX, XMM0);
+    }
+}
+
+// Materializes a numeric constant directly in the wanted representation
+static void emitNumberConstant(Assembler* as, Register dst, double value, ValueType want) {
+    if (isIntegralType(want)) {
+        // Truncates like the runtime conversion; outside int64 (or NaN) the
+        // cast would be undefined
+        if (!(value >= -9223372036854775808.0 && value < 9223372036854775808.0)) {
+            fprintf(stderr, "JIT Error: Constant %g does not fit in a 64-bit integer\n", value);
+            exit(1);
+        }
+        Asm_Mov_Imm64(as, dst, (uint64_t)(int64_t)value);
+    } else if (want == TYPE_BOOLEAN) {
+        Asm_Mov_Imm64(as, dst, value != 0.0);
+    } else if (want == TYPE_FLOAT) {
+        float f = (float)value;
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        Asm_Mov_Imm64(as, dst, bits);
+    } else {
+        Asm_Mov_Imm64(as, dst, NumberToValue(value)); // DOUBLE bits == boxed number
+    }
+}
+
+// Number literal in the wanted representation; integral literals stay
+// exact when the destination is integral
+static void emitLiteralConstant(Assembler* as, Register dst, LiteralExpr* lit, ValueType want) {
+    if (literalIsIntegral(lit) && isIntegralType(want)) {
+        Asm_Mov_Imm64(as, dst, (uint64_t)literalInt(lit));
+    } else {
+        emitNumberConstant(as, dst, literalNumber(lit), want);
+    }
+}
+
+// Emits node and leaves RAX in the wanted representation
+static void emitAs(Assembler* as, CompilerContext* ctx, AstNode* node, ValueType want) {
+    if (isNumberLiteral(node)) {
+        emitLiteralConstant(as, RAX, (LiteralExpr*)node, want);
+        ctx->lastExprType = want;
+        return;
+    }
+    emitNode(as, node, ctx);
+    emitConvert(as, ctx->lastExprType, want);
+    ctx->lastExprType = want;
+}
+
+// Leaf operands (number literals and locals) are loaded straight into
+// their destination register without going through RAX and the stack.
+
+// Loads a leaf operand into an XMM register as a double or a float (type;
+// may clobber temp)
+static void loadXmmLeaf(Assembler* as, CompilerContext* ctx, AstNode* node, XmmRegister dst, Register temp, ValueType type) {
+    if (isNumberLiteral(node)) {
+        double value = literalNumber((LiteralExpr*)node);
+        if (value == 0.0 && !signbit(value)) {
+            Asm_Xorpd(as, dst, dst);
+        } else {
+            emitNumberConstant(as, temp, value, type);
+            if (type == TYPE_FLOAT) Asm_Movd_Xmm_Reg(as, dst, temp);
+            else Asm_Movq_Xmm_Reg(as, dst, temp);
+        }
+        return;
+    }
+
+    Local* local = findLocal(ctx, &((LiteralExpr*)node)->token);
+    if (isIntegralType(local->internalType) || local->internalType == TYPE_BOOLEAN) {
+        Register src = temp;
+        if (local->regClass == REG_CLASS_GPR) src = (Register)local->reg;
+        else Asm_Mov_Reg_Mem(as, temp, RBP, -local->offset);
+        if (type == TYPE_FLOAT) Asm_Cvtsi2ss_Xmm_Reg(as, dst, src);
+        else Asm_Cvtsi2sd_Xmm_Reg(as, dst, src);
+    } else if (type == TYPE_FLOAT) {
+        // A float tree has no double leaves
+        if (local->regClass == REG_CLASS_XMM) Asm_Movapd_Xmm_Xmm(as, dst, (XmmRegister)local->reg);
+        else Asm_Movss_Xmm_Mem(as, dst, RBP, -local->offset);
+    } else if (local->internalType == TYPE_FLOAT) {
+        if (local->regClass == REG_CLASS_XMM) {
+            Asm_Cvtss2sd(as, dst, (XmmRegister)local->reg);
+        } else {
+            Asm_Mov_Reg_Mem(as, temp, RBP, -local->offset);
+            Asm_Movd_Xmm_Reg(as, dst, temp);
+            Asm_Cvtss2sd(as, dst, dst);
+        }
+    } else if (local->regClass == REG_CLASS_XMM) {
+        Asm_Movapd_Xmm_Xmm(as, dst, (XmmRegister)local->reg);
+    } else {
+        // DOUBLE or boxed number on the stack
+        Asm_Movsd_Xmm_Mem(as, dst, RBP, -local->offset);
+    }
+}
+
+// Loads a leaf operand into a GPR as int64 (never touches other registers)
+static void loadIntLeaf(Assembler* as, CompilerContext* ctx, AstNode* node, Register dst) {
+    if (isNumberLiteral(node)) {
+        emitLiteralConstant(as, dst, (LiteralExpr*)node, TYPE_LONG);
+        return;
+    }
+    Local* local = findLocal(ctx, &((LiteralExpr*)node)->token);
+    emitRegisterLoad(as, dst, local);
+}
+
+// Register-stack evaluation. Pure arithmetic trees (number literals, numeric locals, + - * and, on
+// doubles, /) are evaluated on a stack of scratch registers rather than
+// through RAX and PUSH/POP. Each node is labelled with the registers it
+// needs (Sethi-Ullman): a leaf needs one, an operator the larger of its
+// children's needs, or one more when they are equal. The needier child is
+// evaluated first, so a tree never holds more values than its label.
+// Trees deeper than the pool go through the operand helpers below, which
+// spill to the stack only at the levels that do not fit.
+//
+// GPR slot 0 is RAX, so a whole tree lands where emitNode leaves values;
+// callers already holding values in low slots start higher. Int '/' is
+// left out since IDIV is tied to RAX:RDX. Double and float trees use
+// XMM0-XMM7 and only R11 as a GPR (constants, stack locals).
+
+static const Register gprStack[] = { RAX, RCX, RDX, RSI, RDI, R8, R9, R10, R11 };
+#define GPR_STACK_SLOTS 9
+#define XMM_STACK_SLOTS 8
+#define XMM_STACK_TEMP  R11
+
+static int labelNeed(int left, int right) {
+    if (left == right) return left + 1;
+    return left > right ? left : right;
+}
+
+static int fitsGprStack(int need, int slot) {
+    return need > 0 && slot + need <= GPR_STACK_SLOTS;
+}
+
+static int fitsXmmStack(int need, int slot) {
+    return need > 0 && slot + need <= XMM_STACK_SLOTS;
+}
+
+// x + c / x - c (c fits imm32) and x * 2^k / 2^k * x take the constant as
+// an immediate. Returns x and sets imm (the shift count for '*'), or NULL.
+static AstNode* intImmediateForm(BinaryExpr* bin, int32_t* imm) {
+    TokenType op = bin->op.type;
+    if ((op == TOKEN_PLUS || op == TOKEN_MINUS) && isNumberLiteral(bin->right) &&
+        literalIsIntegral((LiteralExpr*)bin->right)) {
+        double value = literalNumber((LiteralExpr*)bin->right);
+        if (value >= -2147483647.0 && value <= 2147483647.0) {
+            *imm = (int32_t)value;
+            return bin->left;
+        }
+    }
+    if (op == TOKEN_STAR) {
+        if ((*imm = powerOfTwoLiteral(bin->right)) > 0) return bin->left;
+        if ((*imm = powerOfTwoLiteral(bin->left)) > 0) return bin->right;
+    }
+    return NULL;
+}
+
+// Registers needed to evaluate node as int64, 0 if it is not pure integer
+// arithmetic
+static int intTreeNeed(CompilerContext* ctx, AstNode* node) {
+    if (isNumberLiteral(node)) return literalIsIntegral((LiteralExpr*)node);
+    if (isIdentifier(node)) {
+        Local* local = findLocal(ctx, &((LiteralExpr*)node)->token);
+        return local && (isIntegralType(local->internalType) || local->internalType == TYPE_BOOLEAN);
+    }
+    if (node->type == NODE_UNARY_EXPR) {
+        UnaryExpr* unary = (UnaryExpr*)node;
+        if (unary->op.type != TOKEN_MINUS || !isIntegralType(inferType(ctx, unary->right))) return 0;
+        return intTreeNeed(ctx, unary->right);
+    }
+    if (node->type != NODE_BINARY_EXPR) return 0;
+
+    BinaryExpr* bin = (BinaryExpr*)node;
+    TokenType op = bin->op.type;
+    if (op != TOKEN_PLUS && op != TOKEN_MINUS && op != TOKEN_STAR) return 0;
+    int32_t imm;
+    AstNode* operand = intImmediateForm(bin, &imm);
+    if (operand) return intTreeNeed(ctx, operand);
+    int left = intTreeNeed(ctx, bin->left);
+    int right = left ? intTreeNeed(ctx, bin->right) : 0;
+    return right ? labelNeed(left, right) : 0;
+}
+
+// Registers needed to evaluate node as a double (or a float), 0 if it is
+// not pure arithmetic of that type. Inner operators must have the type
+// themselves: an int subtree computed in doubles would not truncate, and a
+// float subtree computed in doubles would not round.
+static int xmmTreeNeed(CompilerContext* ctx, AstNode* node, ValueType type) {
+    if (isNumberLiteral(node)) return 1;
+    if (isIdentifier(node)) {
+        Local* local = findLocal(ctx, &((LiteralExpr*)node)->token);
+        if (!local) return 0;
+        ValueType t = local->internalType;
+        return isIntegralType(t) || t == TYPE_BOOLEAN || t == TYPE_FLOAT || (t == TYPE_DOUBLE && type == TYPE_DOUBLE);
+    }
+    if (node->type != NODE_BINARY_EXPR || inferType(ctx, node) != type) return 0;
+
+    BinaryExpr* bin = (BinaryExpr*)node;
+    int left = xmmTreeNeed(ctx, bin->left, type);
+    int right = left ? xmmTreeNeed(ctx, bin->right, type) : 0;
+    return right ? labelNeed(left, right) : 0;
+}
+
+// Evaluates an intTreeNeed() tree into gprStack[slot], touching only the
+// slots from there up
+static void emitIntTree(Assembler* as, CompilerContext* ctx, AstNode* node, int slot) {
+    Register dst = gprStack[slot];
+    if (node->type == NODE_UNARY_EXPR) {
+        emitIntTree(as, ctx, ((UnaryExpr*)node)->right, slot);
+        Asm_Neg_Reg(as, dst);
+        return;
+    }
+    if (node->type != NODE_BINARY_EXPR) {
+        loadIntLeaf(as, ctx, node, dst);
+        return;
+    }
+
+    BinaryExpr* bin = (BinaryExpr*)node;
+    TokenType op = bin->op.type;
+    int32_t imm;
+    AstNode* operand = intImmediateForm(bin, &imm);
+    if (operand) {
+        emitIntTree(as, ctx, operand, slot);
+        if (op == TOKEN_PLUS) Asm_Add_Reg_Imm(as, dst, imm);
+        else if (op == TOKEN_MINUS) Asm_Sub_Reg_Imm(as, dst, imm);
+        else Asm_Shl_Reg_Imm(as, dst, (uint8_t)imm);
+        return;
+    }
+
+    Register src = gprStack[slot + 1];
+    if (intTreeNeed(ctx, bin->left) >= intTreeNeed(ctx, bin->right)) {
+        emitIntTree(as, ctx, bin->left, slot);
+        emitIntTree(as, ctx, bin->right, slot + 1);
+    } else {
+        // Needier right side first (trees are side-effect free, so the
+        // order is not observable); '-' is then computed in the upper slot
+        emitIntTree(as, ctx, bin->right, slot);
+        emitIntTree(as, ctx, bin->left, slot + 1);
+        if (op == TOKEN_MINUS) {
+            Asm_Sub_Reg_Reg_64(as, src, dst);
+            Asm_Mov_Reg_Reg(as, dst, src);
+            return;
+        }
+    }
+    if (op == TOKEN_PLUS) Asm_Add_Reg_Reg(as, dst, src);
+    else if (op == TOKEN_MINUS) Asm_Sub_Reg_Reg_64(as, dst, src);
+    else Asm_Imul_Reg_Reg_64(as, dst, src);
+}
+
+static void emitXmmOp(Assembler* as, TokenType op, XmmRegister dst, XmmRegister src, ValueType type) {
+    if (type == TYPE_FLOAT) {
+        if (op == TOKEN_PLUS) Asm_Addss(as, dst, src);
+        else if (op == TOKEN_MINUS) Asm_Subss(as, dst, src);
+        else if (op == TOKEN_STAR) Asm_Mulss(as, dst, src);
+        else Asm_Divss(as, dst, src);
+        return;
+    }
+    if (op == TOKEN_PLUS) Asm_Addsd(as, dst, src);
+    else if (op == TOKEN_MINUS) Asm_Subsd(as, dst, src);
+    else if (op == TOKEN_STAR) Asm_Mulsd(as, dst, src);
+    else Asm_Divsd(as, dst, src);
+}
+
+// Moves a double (MOVQ) or float (MOVD) between a GPR and an XMM register
+static void moveToXmm(Assembler* as, XmmRegister dst, Register src, ValueType type) {
+    if (type == TYPE_FLOAT) Asm_Movd_Xmm_Reg(as, dst, src);
+    else Asm_Movq_Xmm_Reg(as, dst, src);
+}
+
+static void moveFromXmm(Assembler* as, Register dst, XmmRegister src, ValueType type) {
+    if (type == TYPE_FLOAT) Asm_Movd_Reg_Xmm(as, dst, src);
+    else Asm_Movq_Reg_Xmm(as, dst, src);
+}
+
+// Evaluates an xmmTreeNeed() tree into XMM<slot>, touching only the XMM
+// slots from there up and XMM_STACK_TEMP
+static void emitXmmTree(Assembler* as, CompilerContext* ctx, AstNode* node, int slot, ValueType type) {
+    XmmRegister dst = (XmmRegister)(XMM0 + slot);
+    if (node->type != NODE_BINARY_EXPR) {
+        loadXmmLeaf(as, ctx, node, dst, XMM_STACK_TEMP, type);
+        return;
+    }
+
+    BinaryExpr* bin = (BinaryExpr*)node;
+    TokenType op = bin->op.type;
+    XmmRegister src = (XmmRegister)(XMM0 + slot + 1);
+    if (xmmTreeNeed(ctx, bin->left, type) >= xmmTreeNeed(ctx, bin->right, type)) {
+        emitXmmTree(as, ctx, bin->left, slot, type);
+        emitXmmTree(as, ctx, bin->right, slot + 1, type);
+    } else {
+        emitXmmTree(as, ctx, bin->right, slot, type);
+        emitXmmTree(as, ctx, bin->left, slot + 1, type);
+        if (op == TOKEN_MINUS || op == TOKEN_SLASH) {
+            emitXmmOp(as, op, src, dst, type);
+            Asm_Movapd_Xmm_Xmm(as, dst, src);
+            return;
+        }
+    }
+    emitXmmOp(as, op, dst, src, type);
+}
+
+// Leaves left in XMM0 and right in XMM1 as doubles (or floats). A pure side
+// goes on the XMM stack; only two impure sides meet on the machine stack.
+// Could evaluating node write a local or other visible state (assignment,
+// i++/i--, stores, calls)? Such a right operand must run after the left.
+static int hasSideEffects(AstNode* node) {
+    switch (node->type) {
+        case NODE_LITERAL_EXPR:
+        case NODE_STRING_LITERAL:
+            return 0;
+        case NODE_BINARY_EXPR:
+            return hasSideEffects(((BinaryExpr*)node)->left) || hasSideEffects(((BinaryExpr*)node)->right);
+        case NODE_LOGICAL_EXPR:
+            return hasSideEffects(((LogicalExpr*)node)->left) || hasSideEffects(((LogicalExpr*)node)->right);
+        case NODE_UNARY_EXPR:
+            return hasSideEffects(((UnaryExpr*)node)->right);
+        case NODE_GET_EXPR:
+            return hasSideEffects(((GetExpr*)node)->object);
+        case NODE_INDEX_EXPR:
+            return hasSideEffects(((IndexExpr*)node)->array) || hasSideEffects(((IndexExpr*)node)->index);
+        case NODE_ARRAY_LITERAL: {
+            ArrayLiteral* lit = (ArrayLiteral*)node;
+            for (int i = 0; i < lit->count; i++) {
+                if (hasSideEffects(lit->elements[i])) return 1;
+            }
+            return 0;
+        }
+        default:
+            return 1;   // Assignments, stores, calls, awaits
+    }
+}
+
+// Operand order for the helpers below: the right side goes first only
+// when both sides are pure trees, or the left is a pure tree and the right
+// has no side effects that the left could observe. Otherwise the left is
+// evaluated first and kept on the stack.
+
+static void emitXmmOperands(Assembler* as, CompilerContext* ctx, BinaryExpr* bin, ValueType type) {
+    int leftNeed = xmmTreeNeed(ctx, bin->left, type);
+    int rightNeed = xmmTreeNeed(ctx, bin->right, type);
+    int rightFirst = fitsXmmStack(leftNeed, 2) && (rightNeed > 0 || !hasSideEffects(bin->right));
+
+    if (fitsXmmStack(rightNeed, 1) && (leftNeed == 0 || leftNeed >= rightNeed)) {
+        if (leftNeed) {
+            emitXmmTree(as, ctx, bin->left, 0, type);
+        } else {
+            emitAs(as, ctx, bin->left, type);
+            moveToXmm(as, XMM0, RAX, type);
+        }
+        emitXmmTree(as, ctx, bin->right, 1, type);
+    } else if (rightFirst) {
+        if (fitsXmmStack(rightNeed, 1)) {
+            emitXmmTree(as, ctx, bin->right, 1, type);
+        } else {
+            emitAs(as, ctx, bin->right, type);
+            moveToXmm(as, XMM1, RAX, type);
+        }
+        if (leftNeed == 1) {
+            emitXmmTree(as, ctx, bin->left, 0, type);
+        } else {
+            emitXmmTree(as, ctx, bin->left, 2, type);
+            Asm_Movapd_Xmm_Xmm(as, XMM0, XMM2);
+        }
+    } else {
+        emitAs(as, ctx, bin->left, type);
+        Asm_Push(as, RAX);
+        ctx->stackSize += 8;
+        emitAs(as, ctx, bin->right, type);
+        moveToXmm(as, XMM1, RAX, type);
+        Asm_Pop(as, RCX);
+        ctx->stackSize -= 8;
+        moveToXmm(as, XMM0, RCX, type);
+    }
+}
+
+// Leaves left in RAX and right in RCX as int64, on the same terms
+static void emitIntOperands(Assembler* as, CompilerContext* ctx, BinaryExpr* bin, ValueType type) {
+    int leftNeed = intTreeNeed(ctx, bin->left);
+    int rightNeed = intTreeNeed(ctx, bin->right);
+    int rightFirst = fitsGprStack(leftNeed, 2) && (rightNeed > 0 || !hasSideEffects(bin->right));
+
+    if (fitsGprStack(rightNeed, 1) && (leftNeed == 0 || leftNeed >= rightNeed)) {
+        emitAs(as, ctx, bin->left, type);
+        emitIntTree(as, ctx, bin->right, 1);
+    } else if (rightFirst) {
+        if (fitsGprStack(rightNeed, 1)) {
+            emitIntTree(as, ctx, bin->right, 1);
+        } else {
+            emitAs(as, ctx, bin->right, type);
+            Asm_Mov_Reg_Reg(as, RCX, RAX);
+        }
+        if (leftNeed == 1) {
+            emitIntTree(as, ctx, bin->left, 0);
+        } else {
+            emitIntTree(as, ctx, bin->left, 2);
+            Asm_Mov_Reg_Reg(as, RAX, RDX);
+        }
+    } else {
+        emitAs(as, ctx, bin->left, type);
+        Asm_Push(as, RAX);
+        ctx->stackSize += 8;
+        emitAs(as, ctx, bin->right, type);
+        Asm_Mov_Reg_Reg(as, RCX, RAX);
+        Asm_Pop(as, RAX);
+        ctx->stackSize -= 8;
+    }
+}
+
+// Leaves left in RCX and right in RAX as boxed Values
+static void emitBoxedOperands(Assembler* as, CompilerContext* ctx, BinaryExpr* bin) {
+    emitAs(as, ctx, bin->left, TYPE_UNKNOWN);
+    Asm_Push(as, RAX);
+    ctx->stackSize += 8;
+    emitAs(as, ctx, bin->right, TYPE_UNKNOWN);
+    Asm_Pop(as, RCX);
+    ctx->stackSize -= 8;
+}
+
+// An int or boolean local whose home is a GPR (raw int64 / 0-1), or NULL
+static Local* gprLocal(CompilerContext* ctx, AstNode* node) {
+    if (!isIdentifier(node)) return NULL;
+    Local* local = findLocal(ctx, &((LiteralExpr*)node)->token);
+    if (!local || local->regClass != REG_CLASS_GPR || local->reg == -1) return NULL;
+    return isIntegralType(local->internalType) || local->internalType == TYPE_BOOLEAN ? local : NULL;
+}
+
+// x = x + c / x = x - c in statement position on an int local in a GPR:
+// ADD/SUB (INC for 1) on the home register, without the round trip
+// through RAX. Returns 0 when the assignment does not have that shape.
+static int emitInPlaceUpdate(Assembler* as, CompilerContext* ctx, AssignmentExpr* assign) {
+    if (assign->value->type != NODE_BINARY_EXPR) return 0;
+    BinaryExpr* bin = (BinaryExpr*)assign->value;
+    if (bin->op.type != TOKEN_PLUS && bin->op.type != TOKEN_MINUS) return 0;
+    int32_t imm;
+    AstNode* operand = intImmediateForm(bin, &imm);
+    Local* target = gprLocal(ctx, operand ? operand : bin->left);
+    if (!operand || !target || target->internalType == TYPE_BOOLEAN ||
+        findLocal(ctx, &assign->name) != target) return 0;
+
+    if (bin->op.type == TOKEN_PLUS) Asm_Add_Reg_Imm(as, (Register)target->reg, imm);
+    else Asm_Sub_Reg_Imm(as, (Register)target->reg, imm);
+    ctx->lastExprType = target->internalType;
+    return 1;
+}
+
+// Compares the operands of an int or boolean comparison and returns the
+// condition that holds when it is true. An int literal on the right is
+// compared as an immediate, and locals in registers are compared in place
+// (loop counters: CMP reg, imm32 / CMP reg, reg).
+static Condition emitIntCompare(Assembler* as, CompilerContext* ctx, BinaryExpr* bin, ValueType type) {
+    Local* left = gprLocal(ctx, bin->left);
+    Local* right = gprLocal(ctx, bin->right);
+    double value = isNumberLiteral(bin->right) ? literalNumber((LiteralExpr*)bin->right) : 0.0;
+    if (isNumberLiteral(bin->right) && literalIsIntegral((LiteralExpr*)bin->right) &&
+        value >= -2147483648.0 && value <= 2147483647.0) {
+        Register reg = RAX;
+        if (left) reg = (Register)left->reg;
+        else emitAs(as, ctx, bin->left, type);
+        Asm_Cmp_Reg_Imm(as, reg, (int32_t)value);
+    } else if (left && right) {
+        Asm_Cmp_Reg_Reg(as, (Register)left->reg, (Register)right->reg);
+    } else {
+        emitIntOperands(as, ctx, bin, type);
+        Asm_Cmp_Reg_Reg(as, RAX, RCX);
+    }
+    switch (bin->op.type) {
+        case TOKEN_LESS:          return COND_L;
+        case TOKEN_LESS_EQUAL:    return COND_LE;
+        case TOKEN_GREATER:       return COND_G;
+        case TOKEN_GREATER_EQUAL: return COND_GE;
+        case TOKEN_EQUAL_EQUAL:   return COND_E;
+        default:                  return COND_NE;
+    }
+}
+
+// Same for doubles and floats. UCOMISD/UCOMISS set CF/ZF like an unsigned
+// compare and PF on NaN. a < b is tested as b > a so unordered operands
+// yield false; for == and != the caller must also look at PF.
+static Condition emitXmmCompare(Assembler* as, CompilerContext* ctx, BinaryExpr* bin, ValueType type) {
+    emitXmmOperands(as, ctx, bin, type);
+    void (*ucomis)(Assembler*, XmmRegister, XmmRegister) = type == TYPE_FLOAT ? Asm_Ucomiss : Asm_Ucomisd;
+    switch (bin->op.type) {
+        case TOKEN_LESS:          ucomis(as, XMM1, XMM0); return COND_A;
+        case TOKEN_LESS_EQUAL:    ucomis(as, XMM1, XMM0); return COND_AE;
+        case TOKEN_GREATER:       ucomis(as, XMM0, XMM1); return COND_A;
+        case TOKEN_GREATER_EQUAL: ucomis(as, XMM0, XMM1); return COND_AE;
+        case TOKEN_EQUAL_EQUAL:   ucomis(as, XMM0, XMM1); return COND_E;
+        default:                  ucomis(as, XMM0, XMM1); return COND_NE;
+    }
+}
+
+static void emitBinaryExpr(Assembler* as, CompilerContext* ctx, BinaryExpr* bin) {
+    TokenType op = bin->op.type;
+    ValueType lt = operandType(ctx, bin->left, bin->right);
+    ValueType rt = operandType(ctx, bin->right, bin->left);
+
+    if (!isComparisonOp(op)) {
+        ValueType type = arithmeticType(op, lt, rt);
+
+        if (type == TYPE_UNKNOWN) {
+            // '+' on boxed values: inline number add, Runtime_Add otherwise
+            emitBoxedOperands(as, ctx, bin);
+            Asm_Mov_Imm64(as, RDX, QNAN);
+            Asm_Mov_Reg_Reg(as, R8, RCX);
+            Asm_And_Reg_Reg(as, R8, RDX);
+            Asm_Cmp_Reg_Reg(as, R8, RDX);
+            size_t leftSlow = as->offset + 2;
+            Asm_Je(as, 0);
+            Asm_Mov_Reg_Reg(as, R8, RAX);
+            Asm_And_Reg_Reg(as, R8, RDX);
+            Asm_Cmp_Reg_Reg(as, R8, RDX);
+            size_t rightSlow = as->offset + 2;
+            Asm_Je(as, 0);
+
+            Asm_Movq_Xmm_Reg(as, XMM0, RCX);
+            Asm_Movq_Xmm_Reg(as, XMM1, RAX);
+            Asm_Addsd(as, XMM0, XMM1);
+            Asm_Movq_Reg_Xmm(as, RAX, XMM0);
+            size_t donePatch = as->offset + 1;
+            Asm_Jmp(as, 0);
+
+            size_t slow = Asm_Label(as);
+            Asm_Patch32(as, leftSlow, (int32_t)(slow - (leftSlow + 4)));
+            Asm_Patch32(as, rightSlow, (int32_t)(slow - (rightSlow + 4)));
+            Asm_Mov_Reg_Reg(as, RDI, RCX);
+            Asm_Mov_Reg_Reg(as, RSI, RAX);
+            emitCallAbsolute(as, ctx, (void*)Runtime_Add);
+            Asm_Patch32(as, donePatch, (int32_t)(Asm_Label(as) - (donePatch + 4)));
+
+            ctx->lastExprType = TYPE_UNKNOWN;
+        } else if (type == TYPE_DOUBLE || type == TYPE_FLOAT) {
+            if (fitsXmmStack(xmmTreeNeed(ctx, (AstNode*)bin, type), 0)) {
+                emitXmmTree(as, ctx, (AstNode*)bin, 0, type);
+            } else {
+                emitXmmOperands(as, ctx, bin, type);
+                emitXmmOp(as, op, XMM0, XMM1, type);
+            }
+            moveFromXmm(as, RAX, XMM0, type);
+            ctx->lastExprType = type;
+        } else {
+            if (fitsGprStack(intTreeNeed(ctx, (AstNode*)bin), 0)) {
+                emitIntTree(as, ctx, (AstNode*)bin, 0);
+                ctx->lastExprType = type;
+                return;
+            }
+
+            // Constant operand of an impure tree: ADD/SUB RAX, imm32 or SHL RAX, k
+            int32_t imm;
+            AstNode* other = intImmediateForm(bin, &imm);
+            if (other) {
+                emitAs(as, ctx, other, type);
+                if (op == TOKEN_PLUS) Asm_Add_Reg_Imm(as, RAX, imm);
+                else if (op == TOKEN_MINUS) Asm_Sub_Reg_Imm(as, RAX, imm);
+                else Asm_Shl_Reg_Imm(as, RAX, (uint8_t)imm);
+                ctx->lastExprType = type;
+                return;
+            }
+
+            emitIntOperands(as, ctx, bin, type);
+            if (op == TOKEN_PLUS) Asm_Add_Reg_Reg(as, RAX, RCX);
+            else if (op == TOKEN_MINUS) Asm_Sub_Reg_Reg_64(as, RAX, RCX);
+            else if (op == TOKEN_STAR) Asm_Imul_Reg_Reg_64(as, RAX, RCX);
+            else {
+                Asm_Cqo(as);
+                Asm_Idiv_Reg(as, RCX);
+            }
+            ctx->lastExprType = type;
+        }
+        return;
+    }
+
+    ValueType type = compareType(op, lt, rt);
+
+    if (type == TYPE_UNKNOWN) {
+        emitBoxedOperands(as, ctx, bin);
+        Asm_Mov_Reg_Reg(as, RDI, RCX);
+        Asm_Mov_Reg_Reg(as, RSI, RAX);
+        emitCallAbsolute(as, ctx, (void*)Runtime_Equal);
+        Asm_Mov_Imm64(as, RCX, VAL_TRUE);
+        Asm_Cmp_Reg_Reg(as, RAX, RCX);
+        Asm_Setcc(as, op == TOKEN_EQUAL_EQUAL ? COND_E : COND_NE, RAX);
+        Asm_Movzx_Reg_Reg8(as, RAX, RAX);
+    } else if (type == TYPE_DOUBLE || type == TYPE_FLOAT) {
+        Asm_Setcc(as, emitXmmCompare(as, ctx, bin, type), RAX);
+        if (op == TOKEN_EQUAL_EQUAL) {
+            Asm_Setcc(as, COND_NP, RCX);
+            Asm_And_Reg_Reg(as, RAX, RCX);
+        } else if (op == TOKEN_BANG_EQUAL) {
+            Asm_Setcc(as, COND_P, RCX);
+            Asm_Or_Reg_Reg(as, RAX, RCX);
+        }
+        Asm_Movzx_Reg_Reg8(as, RAX, RAX);
+    } else {
+        Asm_Setcc(as, emitIntCompare(as, ctx, bin, type), RAX);
+        Asm_Movzx_Reg_Reg8(as, RAX, RAX);
+    }
+    ctx->lastExprType = TYPE_BOOLEAN;
+}
+
+static void patchForward(Assembler* as, size_t patch) {
+    Asm_Patch32(as, patch, (int32_t)(Asm_Label(as) - (patch + 4)));
+}
+
+// ==================== CONDITIONS ====================
+// if and for conditions that are int or double comparisons branch on the
+// flags of CMP/UCOMISD directly; SETcc only materializes a boolean where
+// the value itself is used. && and || become jump chains into the same
+// targets, so their right side is skipped once the left decides and no
+// intermediate boolean is built. Other conditions are evaluated as raw 0/1
+// and tested.
+
+typedef struct {
+    size_t* patches;     // rel32 fields of the Jcc taken to the target
+    int count;
+    int capacity;
+} ConditionJumps;
+
+// x86 condition codes come in pairs that differ in the low bit
+static Condition invertCondition(Condition cond) {
+    return (Condition)(cond ^ 1);
+}
+
+static void emitConditionJump(Assembler* as, ConditionJumps* jumps, Condition cond) {
+    if (jumps->count == jumps->capacity) {
+        jumps->capacity = jumps->capacity ? jumps->capacity * 2 : 4;
+        jumps->patches = realloc(jumps->patches, sizeof(size_t) * jumps->capacity);
+    }
+    jumps->patches[jumps->count++] = as->offset + 2;
+    Asm_Jcc(as, cond, 0);
+}
+
+static void patchConditionJumps(Assembler* as, ConditionJumps* jumps) {
+    for (int i = 0; i < jumps->count; i++) patchForward(as, jumps->patches[i]);
+    free(jumps->patches);
+    jumps->patches = NULL;
+    jumps->count = jumps->capacity = 0;
+}
+
+static int isHoistedInvariant(CompilerContext* ctx, AstNode* node) {
+    if (ctx->invariantCount == 0) return 0;
+    for (int i = ctx->localCount - 1; i >= 0; i--) {
+        if (ctx->locals[i].invariant == node) return 1;
+    }
+    return 0;
+}
+
+// Evaluates cond and jumps to jumps when its truth equals sense; falls
+// through otherwise
+static void emitConditionBranch(Assembler* as, CompilerContext* ctx, AstNode* cond, int sense, ConditionJumps* jumps) {
+    if (isHoistedInvariant(ctx, cond)) {
+        // Already computed in the loop preheader: test the cached value
+    } else if (cond->type == NODE_LOGICAL_EXPR) {
+        LogicalExpr* logic = (LogicalExpr*)cond;
+        // The left side decides && when false and || when true
+        int decides = logic->op.type == TOKEN_OR;
+        if (decides == sense) {
+            emitConditionBranch(as, ctx, logic->left, sense, jumps);
+            emitConditionBranch(as, ctx, logic->right, sense, jumps);
+        } else {
+            ConditionJumps skip = { 0 };
+            emitConditionBranch(as, ctx, logic->left, decides, &skip);
+            emitConditionBranch(as, ctx, logic->right, sense, jumps);
+            patchConditionJumps(as, &skip);
+        }
+        return;
+    } else if (cond->type == NODE_UNARY_EXPR && ((UnaryExpr*)cond)->op.type == TOKEN_BANG) {
+        emitConditionBranch(as, ctx, ((UnaryExpr*)cond)->right, !sense, jumps);
+        return;
+    } else if (cond->type == NODE_BINARY_EXPR && isComparisonOp(((BinaryExpr*)cond)->op.type)) {
+        BinaryExpr* bin = (BinaryExpr*)cond;
+        TokenType op = bin->op.type;
+        ValueType type = compareType(op, operandType(ctx, bin->left, bin->right),
+                                     operandType(ctx, bin->right, bin->left));
+        if (type == TYPE_DOUBLE || type == TYPE_FLOAT) {
+            Condition holds = emitXmmCompare(as, ctx, bin, type);
+            if (op == TOKEN_EQUAL_EQUAL || op == TOKEN_BANG_EQUAL) {
+                // Unordered (PF) makes == false and != true
+                int equalSense = op == TOKEN_EQUAL_EQUAL ? sense : !sense;
+                if (equalSense) {
+                    size_t unordered = as->offset + 2;
+                    Asm_Jcc(as, COND_P, 0);
+                    emitConditionJump(as, jumps, COND_E);
+                    patchForward(as, unordered);
+                } else {
+                    emitConditionJump(as, jumps, COND_NE);
+                    emitConditionJump(as, jumps, COND_P);
+                }
+            } else {
+                // A/AE already fail on unordered; their inverses BE/B take it
+                emitConditionJump(as, jumps, sense ? holds : invertCondition(holds));
+            }
+            return;
+        }
+        if (type != TYPE_UNKNOWN) {
+            Condition holds = emitIntCompare(as, ctx, bin, type);
+            emitConditionJump(as, jumps, sense ? holds : invertCondition(holds));
+            return;
+        }
+    }
+    emitAs(as, ctx, cond, TYPE_BOOLEAN);
+    Asm_Test_Reg_Reg(as, RAX, RAX);
+    emitConditionJump(as, jumps, sense ? COND_NE : COND_E);
+}
+
+// Evaluates cond and jumps away when it is false (patch with
+// patchConditionJumps); falls through when it is true
+static void emitJumpIfFalse(Assembler* as, CompilerContext* ctx, AstNode* cond, ConditionJumps* jumps) {
+    memset(jumps, 0, sizeof(*jumps));
+    emitConditionBranch(as, ctx, cond, 0, jumps);
+}
+
+// ==================== DIRECT CALLS ====================
+// Calls to functions known at compile time bind with CALL rel32 and pass
+// each argument in the callee's declared representation, in the registers
+// its prologue reads (GPRs in order, double/float in XMM0-7).
+
+static GlobalFunction* resolveDirectCallee(CompilerContext* ctx, AstNode* callee) {
+    GlobalFunction* fn = NULL;
+    if (callee->type == NODE_LITERAL_EXPR) {
+        LiteralExpr* lit = (LiteralExpr*)callee;
+        if (lit->token.type != TOKEN_IDENTIFIER || findLocal(ctx, &lit->token)) return NULL;
+        fn = findGlobalEntry(lit->token.start, lit->token.length);
+    } else if (callee->type == NODE_GET_EXPR) {
+        // Namespace.Function -> "Namespace_Function"
+        GetExpr* get = (GetExpr*)callee;
+        if (get->object->type != NODE_LITERAL_EXPR) return NULL;
+        Token* ns = &((LiteralExpr*)get->object)->token;
+        if (ns->type != TOKEN_IDENTIFIER || findLocal(ctx, ns)) return NULL;
+        char name[128];
+        int length = ns->length + 1 + get->name.length;
+        if (length >= (int)sizeof(name)) return NULL;
+        memcpy(name, ns->start, ns->length);
+        name[ns->length] = '_';
+        memcpy(name + ns->length + 1, get->name.start, get->name.length);
+        fn = findGlobalEntry(name, length);
+    }
+    return (fn && fn->decl) ? fn : NULL;
+}
+
+// Leaves the arguments in the registers fn's prologue reads
+static void emitDirectArgs(Assembler* as, CompilerContext* ctx, GlobalFunction* fn, CallExpr* call) {
+    static const Register gprArgs[] = { RDI, RSI, RDX, RCX, R8, R9 };
+    FunctionDecl* decl = fn->decl;
+    if (call->argCount != decl->paramCount) {
+        fprintf(stderr, "JIT Error: '%s' expects %d arguments but got %d\n", fn->name, decl->paramCount, call->argCount);
+        exit(1);
+    }
+
+    ValueType types[16];
+    int slots[16];
+    int gprCount = 0, xmmCount = 0;
+    if (call->argCount > 16) {
+        fprintf(stderr, "JIT Error: Too many arguments in call to '%s'\n", fn->name);
+        exit(1);
+    }
+    for (int i = 0; i < call->argCount; i++) {
+        types[i] = valueTypeFromToken(&decl->paramTypes[i]);
+        int isFloat = types[i] == TYPE_DOUBLE || types[i] == TYPE_FLOAT;
+        slots[i] = isFloat ? xmmCount++ : gprCount++;
+    }
+    if (gprCount > 6 || xmmCount > 8) {
+        fprintf(stderr, "JIT Error: Stack-passed arguments not supported in call to '%s'\n", fn->name);
+        exit(1);
+    }
+
+    // Evaluate left to right. All but the last argument are parked on the
+    // stack; the last one goes straight to its register.
+    for (int i = 0; i < call->argCount; i++) {
+        emitAs(as, ctx, call->args[i], types[i]);
+        if (i < call->argCount - 1) {
+            Asm_Push(as, RAX);
+            ctx->stackSize += 8;
+        }
+    }
+    for (int i = call->argCount - 1; i >= 0; i--) {
+        int isFloat = types[i] == TYPE_DOUBLE || types[i] == TYPE_FLOAT;
+        if (i < call->argCount - 1) {
+            Asm_Pop(as, isFloat ? RAX : gprArgs[slots[i]]);
+            ctx->stackSize -= 8;
+            if (isFloat) Asm_Movq_Xmm_Reg(as, (XmmRegister)slots[i], RAX);
+        } else if (isFloat) {
+            Asm_Movq_Xmm_Reg(as, (XmmRegister)slots[i], RAX);
+        } else {
+            Asm_Mov_Reg_Reg(as, gprArgs[slots[i]], RAX);
+        }
+    }
+}
+
+static void emitCallDirect(Assembler* as, CompilerContext* ctx, GlobalFunction* fn, CallExpr* call) {
+    emitDirectArgs(as, ctx, fn, call);
+    emitCall(as, ctx, RAX, fn);
+    ctx->lastExprType = TYPE_UNKNOWN; // Functions return a boxed Value
+}
+
+// ==================== INLINING ====================
+// Small leaf functions (no loops, no calls, a handful of AST nodes) are
+// emitted straight into the caller instead of going through CALL and the
+// full prologue/epilogue. Parameters become caller locals: an argument
+// that is already a caller local of the same representation is aliased
+// to its home when the body never writes the parameter, everything else
+// is evaluated once into a fresh stack slot. Returns jump to a common exit
+// with the value in RAX in the callee's declared representation.
+
+#define INLINE_MAX_NODES 32
+
+typedef struct InlineFrame {
+    ValueType returnType;
+    int entryStackSize;     // stackSize once the parameters are bound
+    size_t exits[16];       // JMP rel32 displacement offsets to the exit
+    int exitCount;
+} InlineFrame;
+
+typedef struct {
+    FunctionDecl* decl;
+    int nodes;
+    int locals;
+    int returns;
+    int rejected;
+    uint32_t assignedParams;    // Bit i set if parameter i may be written
+} InlineScan;
+
+static void markAssignedParam(InlineScan* scan, Token* name) {
+    for (int i = 0; i < scan->decl->paramCount; i++) {
+        Token* param = &scan->decl->params[i];
+        if (param->length == name->length && memcmp(param->start, name->start, name->length) == 0) {
+            scan->assignedParams |= 1u << i;
+        }
+    }
+}
+
+static void scanInlineBody(InlineScan* scan, AstNode* node) {
+    if (!node || scan->rejected) return;
+    if (++scan->nodes > INLINE_MAX_NODES) {
+        scan->rejected = 1;
+        return;
+    }
+
+    switch (node->type) {
+        case NODE_BLOCK: {
+            BlockStmt* block = (BlockStmt*)node;
+            for (int i = 0; i < block->count; i++) scanInlineBody(scan, block->statements[i]);
+            break;
+        }
+        case NODE_VAR_DECL: {
+            VarDecl* decl = (VarDecl*)node;
+            scanInlineBody(scan, decl->initializer);
+            markAssignedParam(scan, &decl->name);   // Shadowing: be conservative
+            scan->locals++;
+            break;
+        }
+        case NODE_ASSIGNMENT_EXPR: {
+            AssignmentExpr* assign = (AssignmentExpr*)node;
+            scanInlineBody(scan, assign->value);
+            markAssignedParam(scan, &assign->name);
+            break;
+        }
+        case NODE_SET_EXPR:
+            scanInlineBody(scan, ((SetExpr*)node)->object);
+            scanInlineBody(scan, ((SetExpr*)node)->value);
+            break;
+        case NODE_GET_EXPR:
+            scanInlineBody(scan, ((GetExpr*)node)->object);
+            break;
+        case NODE_BINARY_EXPR:
+            scanInlineBody(scan, ((BinaryExpr*)node)->left);
+            scanInlineBody(scan, ((BinaryExpr*)node)->right);
+            break;
+        case NODE_LOGICAL_EXPR:
+            scanInlineBody(scan, ((LogicalExpr*)node)->left);
+            scanInlineBody(scan, ((LogicalExpr*)node)->right);
+            break;
+        case NODE_UNARY_EXPR:
+            scanInlineBody(scan, ((UnaryExpr*)node)->right);
+            break;
+        case NODE_INDEX_EXPR:
+            scanInlineBody(scan, ((IndexExpr*)node)->array);
+            scanInlineBody(scan, ((IndexExpr*)node)->index);
+            break;
+        case NODE_INDEX_SET_EXPR: {
+            IndexSetExpr* set = (IndexSetExpr*)node;
+            scanInlineBody(scan, set->array);
+            scanInlineBody(scan, set->index);
+            scanInlineBody(scan, set->value);
+            break;
+        }
+        case NODE_IF_STMT: {
+            IfStmt* stmt = (IfStmt*)node;
+            scanInlineBody(scan, stmt->condition);
+            scanInlineBody(scan, stmt->thenBranch);
+            scanInlineBody(scan, stmt->elseBranch);
+            break;
+        }
+        case NODE_RETURN_STMT:
+            scanInlineBody(scan, ((ReturnStmt*)node)->returnValue);
+            scan->returns++;
+            break;
+        case NODE_CALL_EXPR: {
+            // x.length() is emitted inline; anything else is a real call
+            CallExpr* call = (CallExpr*)node;
+            GetExpr* get = (GetExpr*)call->callee;
+            if (call->argCount != 0 || call->callee->type != NODE_GET_EXPR ||
+                get->name.length != 6 || memcmp(get->name.start, "length", 6) != 0) {
+                scan->rejected = 1;
+                return;
+            }
+            scanInlineBody(scan, get->object);
+            break;
+        }
+        case NODE_LITERAL_EXPR:
+        case NODE_STRING_LITERAL:
+            break;
+        default:
+            // Loops, awaits, allocations, nested declarations
+            scan->rejected = 1;
+            break;
+    }
+}
+
+static int isInlineCandidate(CompilerContext* ctx, FunctionDecl* decl, InlineScan* scan) {
+    memset(scan, 0, sizeof(*scan));
+    scan->decl = decl;
+    if (ctx->baseline || decl->isAsync || decl->paramCount > 16) return 0;
+    scanInlineBody(scan, decl->body);
+    if (scan->rejected || scan->returns > 16) return 0;
+    return ctx->localCount + decl->paramCount + scan->locals <= 64;
+}
+
+static void emitInlineCall(Assembler* as, CompilerContext* ctx, GlobalFunction* fn, CallExpr* call, InlineScan* scan) {
+    FunctionDecl* decl = fn->decl;
+    if (call->argCount != decl->paramCount) {
+        fprintf(stderr, "JIT Error: '%s' expects %d arguments but got %d\n", fn->name, decl->paramCount, call->argCount);
+        exit(1);
+    }
+
+    int savedLocalCount = ctx->localCount;
+    int savedScopeFloor = ctx->scopeFloor;
+    int savedStackSize = ctx->stackSize;
+    InlineFrame* savedFrame = ctx->inlineFrame;
+
+    // Bind parameters. Arguments are evaluated in the caller's scope, so
+    // the new bindings only become visible once all of them are done.
+    Local params[16];
+    for (int i = 0; i < call->argCount; i++) {
+        Local* param = &params[i];
+        param->name = decl->params[i];
+        param->typeName = decl->paramTypes[i];
+        param->internalType = valueTypeFromToken(&decl->paramTypes[i]);
+        param->offset = 0;
+        param->reg = -1;
+        param->regClass = REG_CLASS_NONE;
+        param->invariant = NULL;
+
+        Local* source = isIdentifier(call->args[i]) ? findLocal(ctx, &((LiteralExpr*)call->args[i])->token) : NULL;
+        if (source && source->internalType == param->internalType && !(scan->assignedParams & (1u << i))) {
+            param->offset = source->offset;
+            param->reg = source->reg;
+            param->regClass = source->regClass;
+            continue;
+        }
+
+        emitAs(as, ctx, call->args[i], param->internalType);
+        Asm_Push(as, RAX);
+        ctx->stackSize += 8;
+        param->offset = ctx->stackSize;
+    }
+    reserveLocals(ctx, call->argCount);
+    for (int i = 0; i < call->argCount; i++) ctx->locals[ctx->localCount++] = params[i];
+    ctx->scopeFloor = savedLocalCount;
+
+    InlineFrame frame;
+    frame.returnType = valueTypeFromToken(&decl->returnType);
+    frame.entryStackSize = ctx->stackSize;
+    frame.exitCount = 0;
+    ctx->inlineFrame = &frame;
+
+    // Body statements run directly in the caller's scope; the parameter
+    // scope opened above is closed below.
+    AstNode** stmts = &decl->body;
+    int count = decl->body ? 1 : 0;
+    if (decl->body && decl->body->type == NODE_BLOCK) {
+        stmts = ((BlockStmt*)decl->body)->statements;
+        count = ((BlockStmt*)decl->body)->count;
+    }
+    for (int i = 0; i < count; i++) emitNode(as, stmts[i], ctx);
+
+    if (count > 0 && stmts[count - 1]->type == NODE_RETURN_STMT) {
+        // The trailing return's JMP would target the very next instruction
+        as->offset -= 5;
+        frame.exitCount--;
+    } else {
+        if (frame.returnType != TYPE_UNKNOWN) {
+            emitNumberConstant(as, RAX, 0.0, frame.returnType);
+        } else {
+            Asm_Mov_Imm64(as, RAX, VAL_NULL);
+        }
+        if (ctx->stackSize > frame.entryStackSize) {
+            Asm_Add_Reg_Imm(as, RSP, ctx->stackSize - frame.entryStackSize);
+        }
+    }
+    ctx->stackSize = frame.entryStackSize;
+    for (int i = 0; i < frame.exitCount; i++) patchForward(as, frame.exits[i]);
+
+    // Drop the parameter slots (RAX holds the result)
+    if (ctx->stackSize > savedStackSize) {
+        Asm_Add_Reg_Imm(as, RSP, ctx->stackSize - savedStackSize);
+    }
+    ctx->stackSize = savedStackSize;
+    ctx->localCount = savedLocalCount;
+    ctx->scopeFloor = savedScopeFloor;
+    ctx->inlineFrame = savedFrame;
+    ctx->lastExprType = frame.returnType;
+}
+
+// ==================== TAIL CALLS ====================
+// "return f(args)" to a compiled function reuses the current frame. Self
+// calls rebind the parameters and jump back past the prologue, so self
+// recursion runs in constant stack and skips the callee-saved register
+// save/restore. Calls to other functions tear the frame down like the
+// epilogue and JMP to the callee, which then returns straight to our
+// caller; arguments travel in registers only, so the two frames need not
+// match. Both return a boxed Value. Inlined bodies and top-level code keep
+// ordinary calls.
+
+static int emitTailCall(Assembler* as, CompilerContext* ctx, AstNode* value) {
+    if (!ctx->function || ctx->inlineFrame || !value || value->type != NODE_CALL_EXPR) return 0;
+    CallExpr* call = (CallExpr*)value;
+    GlobalFunction* fn = resolveDirectCallee(ctx, call->callee);
+    InlineScan scan;
+    if (!fn || isInlineCandidate(ctx, fn->decl, &scan)) return 0;
+
+    emitDirectArgs(as, ctx, fn, call);
+    if (fn->decl == ctx->function) {
+        Asm_Lea_Reg_Mem(as, RSP, RBP, -ctx->tailEntryStackSize);
+        Asm_Jmp(as, (int32_t)(ctx->tailEntry - (as->offset + 5)));
+    } else {
+        emitFrameTeardown(as, ctx);
+        emitCallSiteRel32(as, ctx, 0xE9, fn);   // JMP rel32
+    }
+    return 1;
+}
+
+// ==================== LOOP VECTORIZER ====================
+// Counted loops whose body is a list of element-wise stores
+//
+//     for (int i = s; i < n; i = i + 1) { c[i] = a[i] * b[i] + k; ... }
+//
+// run a vector of elements per iteration: 4 doubles or 8 floats in a YMM
+// register with AVX2, 2 or 4 in an XMM register with SSE2 on CPUs without
+// it. All arrays of a loop are double[] (packed doubles, or NaN-boxed
+// numbers, which are plain doubles) or all float[], where the arithmetic
+// must be float-typed so the lanes round like the scalar loop does.
+// Layout of the emitted code:
+//
+//   guard     i >= 0, the expected storage and n <= count of every array,
+//             else straight to scalar
+//   prologue  scalar iterations until the first store is vector aligned
+//   vector    YMM (XMM) body while i + lanes <= n
+//   epilogue  the ordinary scalar loop picks up the remainder
+//
+// Any subtree without an element load is loop invariant: it is evaluated
+// once with the scalar rules (so int division stays int division) and
+// broadcast into a YMM register before the loop.
+
+#define VEC_MAX_ARRAYS 5
+#define VEC_MAX_INVARIANTS 6
+#define VEC_BYTES_AVX2 32
+#define VEC_BYTES_SSE2 16
+
+typedef struct {
+    int avx;                // AVX2 YMM or SSE2 XMM registers
+    ArrayKind kind;         // ARRAY_FLOAT64 or ARRAY_FLOAT32, set by the first store
+    int lanes;              // Elements per vector
+    Local* induction;
+    AstNode* limit;
+    AstNode* stores[16];
+    int storeCount;
+    Local* arrays[VEC_MAX_ARRAYS];
+    int arrayCount;
+    AstNode* invariants[VEC_MAX_INVARIANTS];
+    int invariantCount;
+    int depth;              // YMM expression stack depth needed
+} VectorLoop;
+
+// Vectorized loop state lives in scratch registers that scalar code
+// emitted inside the vector body never touches (there is none).
+static const Register vecBaseRegs[VEC_MAX_ARRAYS] = { RSI, RDI, R8, R9, RDX };
+#define VEC_INDEX R11
+#define VEC_LIMIT R10
+
+static int isLocalRef(AstNode* node, Local* local, CompilerContext* ctx) {
+    return isIdentifier(node) && findLocal(ctx, &((LiteralExpr*)node)->token) == local;
+}
+
+// double[] (packed doubles, or boxed numbers: the same bits) or float[].
+// The loop guard rejects arrays whose runtime storage is anything else.
+static int isVectorArray(Local* local) {
+    ArrayKind kind = arrayKindFromToken(&local->typeName);
+    return kind == ARRAY_FLOAT64 || kind == ARRAY_FLOAT32;
+}
+
+static int vecArraySlot(VectorLoop* loop, Local* array) {
+    for (int i = 0; i < loop->arrayCount; i++) {
+        if (loop->arrays[i] == array) return i;
+    }
+    if (loop->arrayCount == VEC_MAX_ARRAYS) return -1;
+    loop->arrays[loop->arrayCount] = array;
+    return loop->arrayCount++;
+}
+
+// a[i] with 'a' an array local of the loop's kind and 'i' the induction variable
+static Local* vecElementArray(CompilerContext* ctx, VectorLoop* loop, AstNode* node) {
+    if (node->type != NODE_INDEX_EXPR) return NULL;
+    IndexExpr* index = (IndexExpr*)node;
+    if (!isIdentifier(index->array) || !isLocalRef(index->index, loop->induction, ctx)) return NULL;
+    Local* array = findLocal(ctx, &((LiteralExpr*)index->array)->token);
+    return (array && arrayKindFromToken(&array->typeName) == loop->kind) ? array : NULL;
+}
+
+// Pure scalar expression over literals and locals other than the induction variable
+static int isInvariantExpr(CompilerContext* ctx, VectorLoop* loop, AstNode* node) {
+    if (isNumberLiteral(node)) return 1;
+    if (isIdentifier(node)) {
+        Local* local = findLocal(ctx, &((LiteralExpr*)node)->token);
+        if (!local || local == loop->induction) return 0;
+        return isIntegralType(local->internalType) || local->internalType == TYPE_DOUBLE ||
+               local->internalType == TYPE_FLOAT;
+    }
+    if (node->type == NODE_BINARY_EXPR) {
+        BinaryExpr* bin = (BinaryExpr*)node;
+        TokenType op = bin->op.type;
+        if (op != TOKEN_PLUS && op != TOKEN_MINUS && op != TOKEN_STAR && op != TOKEN_SLASH) return 0;
+        return isInvariantExpr(ctx, loop, bin->left) && isInvariantExpr(ctx, loop, bin->right);
+    }
+    return 0;
+}
+
+// Returns YMM registers needed to evaluate node, -1 if not vectorizable
+static int vecCheckExpr(CompilerContext* ctx, VectorLoop* loop, AstNode* node) {
+    Local* array = vecElementArray(ctx, loop, node);
+    if (array) return vecArraySlot(loop, array) < 0 ? -1 : 1;
+
+    if (isInvariantExpr(ctx, loop, node)) {
+        if (loop->invariantCount == VEC_MAX_INVARIANTS) return -1;
+        loop->invariants[loop->invariantCount++] = node;
+        return 0;   // Lives in a hoisted register
+    }
+
+    if (node->type != NODE_BINARY_EXPR) return -1;
+    BinaryExpr* bin = (BinaryExpr*)node;
+    TokenType op = bin->op.type;
+    if (op != TOKEN_PLUS && op != TOKEN_MINUS && op != TOKEN_STAR && op != TOKEN_SLASH) return -1;
+    // float[] lanes cannot compute a double-typed operation
+    if (inferType(ctx, node) != arrayElementType(loop->kind)) return -1;
+
+    int left = vecCheckExpr(ctx, loop, bin->left);
+    int right = vecCheckExpr(ctx, loop, bin->right);
+    if (left < 0 || right < 0) return -1;
+    // Left result stays live while the right side is evaluated
+    int need = left > right + 1 ? left : right + 1;
+    return need < 1 ? 1 : need;
+}
+
+static int analyzeVectorLoop(CompilerContext* ctx, ForStmt* forStmt, VectorLoop* loop) {
+    memset(loop, 0, sizeof(*loop));
+    loop->avx = (ctx->cpuFeatures & CPU_AVX2) != 0;
+
+    // Condition: i < limit
+    if (!forStmt->condition || forStmt->condition->type != NODE_BINARY_EXPR) return 0;
+    BinaryExpr* cond = (BinaryExpr*)forStmt->condition;
+    if (cond->op.type != TOKEN_LESS || !isIdentifier(cond->left)) return 0;
+    loop->induction = findLocal(ctx, &((LiteralExpr*)cond->left)->token);
+    if (!loop->induction || !isIntegralType(loop->induction->internalType)) return 0;
+
+    // Limit: int literal, integral local, or array.length()
+    loop->limit = cond->right;
+    if (isNumberLiteral(loop->limit)) {
+        if (!literalIsIntegral((LiteralExpr*)loop->limit)) return 0;
+    } else if (isIdentifier(loop->limit)) {
+        Local* limit = findLocal(ctx, &((LiteralExpr*)loop->limit)->token);
+        if (!limit || limit == loop->induction || !isIntegralType(limit->internalType)) return 0;
+    } else if (loop->limit->type == NODE_CALL_EXPR) {
+        CallExpr* call = (CallExpr*)loop->limit;
+        if (call->argCount != 0 || call->callee->type != NODE_GET_EXPR) return 0;
+        GetExpr* get = (GetExpr*)call->callee;
+        if (get->name.length != 6 || memcmp(get->name.start, "length", 6) != 0) return 0;
+        if (!isIdentifier(get->object) || isLocalRef(get->object, loop->induction, ctx)) return 0;
+        Local* array = findLocal(ctx, &((LiteralExpr*)get->object)->token);
+        if (!array || !isVectorArray(array)) return 0;
+    } else {
+        return 0;
+    }
+
+    // Increment: i = i + 1
+    if (!forStmt->increment || forStmt->increment->type != NODE_ASSIGNMENT_EXPR) return 0;
+    AssignmentExpr* inc = (AssignmentExpr*)forStmt->increment;
+    if (findLocal(ctx, &inc->name) != loop->induction || inc->value->type != NODE_BINARY_EXPR) return 0;
+    BinaryExpr* step = (BinaryExpr*)inc->value;
+    if (step->op.type != TOKEN_PLUS) return 0;
+    AstNode* one = isLocalRef(step->left, loop->induction, ctx) ? step->right :
+                   isLocalRef(step->right, loop->induction, ctx) ? step->left : NULL;
+    if (!one || !isNumberLiteral(one) || literalNumber((LiteralExpr*)one) != 1.0) return 0;
+
+    // Body: only a[i] = <element-wise expression> statements
+    AstNode** stmts = &forStmt->body;
+    int count = 1;
+    if (forStmt->body && forStmt->body->type == NODE_BLOCK) {
+        stmts = ((BlockStmt*)forStmt->body)->statements;
+        count = ((BlockStmt*)forStmt->body)->count;
+    }
+    if (count < 1 || count > 16) return 0;
+
+    for (int i = 0; i < count; i++) {
+        AstNode* stmt = stmts[i];
+        if (!stmt || stmt->type != NODE_INDEX_SET_EXPR) return 0;
+        IndexSetExpr* set = (IndexSetExpr*)stmt;
+        if (!isIdentifier(set->array) || !isLocalRef(set->index, loop->induction, ctx)) return 0;
+        Local* array = findLocal(ctx, &((LiteralExpr*)set->array)->token);
+        if (!array || !isVectorArray(array)) return 0;
+        if (i == 0) {
+            loop->kind = arrayKindFromToken(&array->typeName);
+            loop->lanes = (loop->avx ? VEC_BYTES_AVX2 : VEC_BYTES_SSE2) / elementScale(loop->kind);
+        }
+        if (arrayKindFromToken(&array->typeName) != loop->kind || vecArraySlot(loop, array) < 0) return 0;
+
+        int need = vecCheckExpr(ctx, loop, set->value);
+        if (need < 0) return 0;
+        if (need == 0) need = 1;   // Stored straight from the broadcast register
+        if (need > loop->depth) loop->depth = need;
+        loop->stores[loop->storeCount++] = stmt;
+    }
+
+    // YMM0.. (XMM0..) expression stack, hoisted invariants from register 7 down
+    return loop->depth + loop->invariantCount <= 8;
+}
+
+static int vecInvariantReg(VectorLoop* loop, AstNode* node) {
+    for (int i = 0; i < loop->invariantCount; i++) {
+        if (loop->invariants[i] == node) return YMM7 - i;
+    }
+    return -1;
+}
+
+// Evaluates a vectorizable expression into register [depth] (YMM with
+// AVX2, XMM with SSE2). Invariants are used in place, so the returned
+// register may differ from [depth].
+static int emitVectorExpr(Assembler* as, CompilerContext* ctx, VectorLoop* loop, AstNode* node, int depth) {
+    int hoisted = vecInvariantReg(loop, node);
+    if (hoisted >= 0) return hoisted;
+
+    int single = loop->kind == ARRAY_FLOAT32;
+    int dst = depth;
+    Local* array = vecElementArray(ctx, loop, node);
+    if (array) {
+        Register base = vecBaseRegs[vecArraySlot(loop, array)];
+        if (loop->avx && single) Asm_Vmovups_Ymm_Mem(as, (YmmRegister)dst, base, VEC_INDEX);
+        else if (loop->avx) Asm_Vmovdqu_Ymm_Mem(as, (YmmRegister)dst, base, VEC_INDEX);
+        else if (single) Asm_Movups_Xmm_Mem(as, (XmmRegister)dst, base, VEC_INDEX);
+        else Asm_Movupd_Xmm_Mem(as, (XmmRegister)dst, base, VEC_INDEX);
+        return dst;
+    }
+
+    BinaryExpr* bin = (BinaryExpr*)node;
+    int left = emitVectorExpr(as, ctx, loop, bin->left, depth);
+    int right = emitVectorExpr(as, ctx, loop, bin->right, depth + 1);
+    if (loop->avx) {
+        YmmRegister d = (YmmRegister)dst, l = (YmmRegister)left, r = (YmmRegister)right;
+        switch (bin->op.type) {
+            case TOKEN_PLUS:  single ? Asm_Vaddps_Ymm(as, d, l, r) : Asm_Vaddpd_Ymm(as, d, l, r); break;
+            case TOKEN_MINUS: single ? Asm_Vsubps_Ymm(as, d, l, r) : Asm_Vsubpd_Ymm(as, d, l, r); break;
+            case TOKEN_STAR:  single ? Asm_Vmulps_Ymm(as, d, l, r) : Asm_Vmulpd_Ymm(as, d, l, r); break;
+            default:          single ? Asm_Vdivps_Ymm(as, d, l, r) : Asm_Vdivpd_Ymm(as, d, l, r); break;
+        }
+        return dst;
+    }
+
+    // Two-operand SSE2: right is never dst (it sits above it, or is an invariant)
+    XmmRegister d = (XmmRegister)dst, r = (XmmRegister)right;
+    Asm_Movapd_Xmm_Xmm(as, d, (XmmRegister)left);
+    switch (bin->op.type) {
+        case TOKEN_PLUS:  single ? Asm_Addps(as, d, r) : Asm_Addpd(as, d, r); break;
+        case TOKEN_MINUS: single ? Asm_Subps(as, d, r) : Asm_Subpd(as, d, r); break;
+        case TOKEN_STAR:  single ? Asm_Mulps(as, d, r) : Asm_Mulpd(as, d, r); break;
+        default:          single ? Asm_Divps(as, d, r) : Asm_Divpd(as, d, r); break;
+    }
+    return dst;
+}
+
+// RAX = masked ObjArray* of a boxed array local
+static void emitArrayPointer(Assembler* as, Local* array) {
+    emitRegisterLoad(as, RAX, array);
+    Asm_Mov_Imm64(as, RCX, 0x0000FFFFFFFFFFFF);
+    Asm_And_Reg_Reg(as, RAX, RCX);
+}
+
+static size_t emitJlForward(Assembler* as) {
+    size_t patch = as->offset + 2;
+    Asm_Jl(as, 0);
+    return patch;
+}
+
+static size_t emitJaeForward(Assembler* as) {
+    size_t patch = as->offset + 2;
+    Asm_Jae(as, 0);
+    return patch;
+}
+
+// Emits guard, alignment prologue and vector body. Falls through to the
+// scalar loop with the induction variable at the first unprocessed index.
+static void emitVectorLoop(Assembler* as, CompilerContext* ctx, ForStmt* forStmt, VectorLoop* loop) {
+    size_t exits[2 * VEC_MAX_ARRAYS + 4];
+    int exitCount = 0;
+    int avx = loop->avx;
+    int single = loop->kind == ARRAY_FLOAT32;
+    ValueType elementType = arrayElementType(loop->kind);
+
+    // 1. Guard: every element the vector body touches must exist
+    emitAs(as, ctx, loop->limit, TYPE_INT);
+    Asm_Mov_Reg_Reg(as, VEC_LIMIT, RAX);
+    emitRegisterLoad(as, RAX, loop->induction);
+    Asm_Cmp_Reg_Imm(as, RAX, 0);
+    exits[exitCount++] = emitJlForward(as);
+    for (int i = 0; i < loop->arrayCount; i++) {
+        emitArrayPointer(as, loop->arrays[i]);
+        if (single) {
+            Asm_Cmp_Mem32_Imm8(as, RAX, (int32_t)offsetof(ObjArray, kind), ARRAY_FLOAT32);
+            exits[exitCount++] = as->offset + 2;
+            Asm_Jne(as, 0);
+        } else {
+            // Elements must be double bits (ARRAY_VALUE or ARRAY_FLOAT64)
+            Asm_Cmp_Mem32_Imm8(as, RAX, (int32_t)offsetof(ObjArray, kind), ARRAY_INT32);
+            exits[exitCount++] = emitJaeForward(as);
+        }
+        Asm_Movsxd_Reg_Mem(as, RAX, RAX, (int32_t)offsetof(ObjArray, count));
+        Asm_Cmp_Reg_Reg(as, RAX, VEC_LIMIT);
+        exits[exitCount++] = emitJlForward(as);
+    }
+
+    // 2. Prologue: scalar iterations until the first store target is aligned
+    IndexSetExpr* first = (IndexSetExpr*)loop->stores[0];
+    Local* firstArray = findLocal(ctx, &((LiteralExpr*)first->array)->token);
+    size_t peelStart = Asm_Label(as);
+    ConditionJumps peelDone;
+    emitJumpIfFalse(as, ctx, forStmt->condition, &peelDone);
+    emitArrayPointer(as, firstArray);
+    Asm_Mov_Reg_Mem(as, RAX, RAX, (int32_t)offsetof(ObjArray, elements));
+    emitRegisterLoad(as, RCX, loop->induction);
+    // LEA RAX, [RAX + RCX*4 or RCX*8]
+    Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x8D); Asm_Emit8(as, 0x04); Asm_Emit8(as, single ? 0x88 : 0xC8);
+    Asm_Emit8(as, 0xA8); Asm_Emit8(as, (uint8_t)(avx ? VEC_BYTES_AVX2 - 1 : VEC_BYTES_SSE2 - 1)); // TEST AL, vector size - 1
+    size_t aligned = as->offset + 2;
+    Asm_Je(as, 0);
+    emitNode(as, forStmt->body, ctx);
+    emitStatement(as, ctx, forStmt->increment);
+    Asm_Jmp(as, (int32_t)(peelStart - (as->offset + 5)));
+    patchForward(as, aligned);
+
+    // 3. Setup. Scalar code may use any scratch register (R10/R11 and
+    // XMM0-XMM7 included), so the limit and the invariants are parked on
+    // the stack until all of it has run.
+    emitAs(as, ctx, loop->limit, TYPE_INT);
+    Asm_Push(as, RAX);
+    ctx->stackSize += 8;
+    for (int i = 0; i < loop->invariantCount; i++) {
+        emitAs(as, ctx, loop->invariants[i], elementType);
+        Asm_Push(as, RAX);
+        ctx->stackSize += 8;
+    }
+    for (int i = loop->invariantCount - 1; i >= 0; i--) {
+        Asm_Pop(as, RAX);
+        ctx->stackSize -= 8;
+        XmmRegister splat = (XmmRegister)(XMM7 - i);
+        if (avx) {
+            moveToXmm(as, XMM0, RAX, elementType);
+            if (single) Asm_Vbroadcastss_Ymm_Xmm(as, (YmmRegister)splat, XMM0);
+            else Asm_Vbroadcastsd_Ymm_Xmm(as, (YmmRegister)splat, XMM0);
+        } else {
+            moveToXmm(as, splat, RAX, elementType);
+            if (single) Asm_Shufps(as, splat, splat, 0);
+            else Asm_Unpcklpd(as, splat, splat);
+        }
+    }
+    Asm_Pop(as, VEC_LIMIT);
+    ctx->stackSize -= 8;
+
+    // At least one full vector?
+    emitRegisterLoad(as, VEC_INDEX, loop->induction);
+    Asm_Lea_Reg_Mem(as, RAX, VEC_INDEX, loop->lanes);
+    Asm_Cmp_Reg_Reg(as, VEC_LIMIT, RAX);
+    exits[exitCount++] = emitJlForward(as);
+
+    // Element base pointers (arrays cannot grow inside the loop)
+    for (int i = 0; i < loop->arrayCount; i++) {
+        emitArrayPointer(as, loop->arrays[i]);
+        Asm_Mov_Reg_Mem(as, vecBaseRegs[i], RAX, (int32_t)offsetof(ObjArray, elements));
+    }
+
+    // 4. Vector body: while (i + lanes <= limit)
+    size_t vecStart = Asm_Label(as);
+    Asm_Lea_Reg_Mem(as, RAX, VEC_INDEX, loop->lanes);
+    Asm_Cmp_Reg_Reg(as, VEC_LIMIT, RAX);
+    size_t vecDone = emitJlForward(as);
+    for (int i = 0; i < loop->storeCount; i++) {
+        IndexSetExpr* set = (IndexSetExpr*)loop->stores[i];
+        Local* array = findLocal(ctx, &((LiteralExpr*)set->array)->token);
+        Register base = vecBaseRegs[vecArraySlot(loop, array)];
+        int value = emitVectorExpr(as, ctx, loop, set->value, 0);
+        if (avx && single) Asm_Vmovups_Mem_Ymm(as, base, VEC_INDEX, (YmmRegister)value);
+        else if (avx) Asm_Vmovdqu_Mem_Ymm(as, base, VEC_INDEX, (YmmRegister)value);
+        else if (single) Asm_Movups_Mem_Xmm(as, base, VEC_INDEX, (XmmRegister)value);
+        else Asm_Movupd_Mem_Xmm(as, base, VEC_INDEX, (XmmRegister)value);
+    }
+    Asm_Add_Reg_Imm(as, VEC_INDEX, loop->lanes);
+    Asm_Jmp(as, (int32_t)(vecStart - (as->offset + 5)));
+    patchForward(as, vecDone);
+
+    // 5. Hand the index back to the scalar epilogue
+    emitRegisterMove(as, loop->induction, VEC_INDEX);
+    if (avx) Asm_Vzeroupper(as);
+
+    patchConditionJumps(as, &peelDone);
+    for (int i = 0; i < exitCount; i++) patchForward(as, exits[i]);
+}
+
+// ==================== ARRAYS ====================
+// Array literals take the element storage of the local they initialise or
+// are assigned to; elsewhere they hold boxed Values. Typed elements are
+// pushed in their register form so nothing is boxed on the way.
+
+static void emitArrayLiteral(Assembler* as, CompilerContext* ctx, ArrayLiteral* lit, ArrayKind kind) {
+    ValueType elemType = arrayElementType(kind);
+
+    // Call Runtime_NewTypedArray(kind, capacity)
+    Asm_Mov_Imm64(as, RDI, kind);
+    Asm_Mov_Imm64(as, RSI, lit->count < 4 ? 4 : lit->count);
+    emitCallAbsolute(as, ctx, (void*)Runtime_NewTypedArray);
+
+    // Array in RAX. Push to protect.
+    Asm_Push(as, RAX);
+    ctx->stackSize += 8;
+
+    for (int i = 0; i < lit->count; i++) {
+        emitAs(as, ctx, lit->elements[i], elemType);
+        Asm_Mov_Reg_Reg(as, RSI, RAX);          // Arg 2: element
+        Asm_Mov_Reg_Mem(as, RDI, RSP, 0);       // Arg 1: array (peek stack)
+        if (kind == ARRAY_VALUE) {
+            emitCallAbsolute(as, ctx, (void*)Runtime_ArrayPush);
+        } else {
+            Asm_Mov_Imm64(as, RDX, kind);       // Arg 3: register form
+            emitCallAbsolute(as, ctx, (void*)Runtime_ArrayPushRaw);
+        }
+    }
+
+    // Pop Array -> RAX, boxed so the GC's stack scan recognizes it
+    Asm_Pop(as, RAX);
+    ctx->stackSize -= 8;
+    Asm_Mov_Imm64(as, RCX, QNAN);
+    Asm_Or_Reg_Reg(as, RAX, RCX);
+    ctx->lastExprType = TYPE_UNKNOWN;
+}
+
+// Element access is inline: the unboxed ObjArray* in RDI and the raw index
+// in RSI are checked against the static storage kind and the count, then
+// the element is loaded or stored directly. Either check failing branches
+// to a cold stub that calls the runtime helper (which converts between
+// kinds or reports the bad index) and jumps back. Inside a counted loop
+// over the same array the bounds check is dropped (Licm_FindCountedArrayLoop).
+
+static int isInBounds(CompilerContext* ctx, AstNode* array, AstNode* index) {
+    if (!isIdentifier(array) || !isIdentifier(index)) return 0;
+    Local* arrayLocal = findLocal(ctx, &((LiteralExpr*)array)->token);
+    Local* indexLocal = findLocal(ctx, &((LiteralExpr*)index)->token);
+    for (int i = 0; i < ctx->inBoundsCount; i++) {
+        if (ctx->inBounds[i].array == arrayLocal && ctx->inBounds[i].index == indexLocal) return 1;
+    }
+    return 0;
+}
+
+// A pure index is built straight in RSI (register-stack slot 3); a pure
+// store value then goes above it (RDX for a leaf, else from RDI) or on the
+// XMM stack, keeping the index out of memory.
+#define INDEX_SLOT 3
+#define VALUE_SLOT 4
+
+static int isPureStoreValue(CompilerContext* ctx, AstNode* value, ValueType valueType) {
+    if (isIntegralType(valueType)) return fitsGprStack(intTreeNeed(ctx, value), VALUE_SLOT);
+    if (valueType == TYPE_DOUBLE || valueType == TYPE_FLOAT) return fitsXmmStack(xmmTreeNeed(ctx, value, valueType), 0);
+    return 0;
+}
+
+// RDI = unboxed ObjArray* and RSI = raw index. A plain local array is
+// loaded after the index instead of being saved on the stack around it.
+static void emitArrayAndIndex(Assembler* as, CompilerContext* ctx, AstNode* array, AstNode* index, AstNode* value, ValueType valueType) {
+    Local* arrayLocal = isIdentifier(array) ? findLocal(ctx, &((LiteralExpr*)array)->token) : NULL;
+    if (!arrayLocal) {
+        emitNode(as, array, ctx);
+        Asm_Push(as, RAX);
+        ctx->stackSize += 8;
+    }
+
+    // Stores: RDX = value, RAX keeps it as the expression result
+    if (fitsGprStack(intTreeNeed(ctx, index), INDEX_SLOT) && (!value || isPureStoreValue(ctx, value, valueType))) {
+        emitIntTree(as, ctx, index, INDEX_SLOT);
+        if (value && isIntegralType(valueType)) {
+            int need = intTreeNeed(ctx, value);
+            emitIntTree(as, ctx, value, need == 1 ? 2 : VALUE_SLOT);
+            if (need != 1) Asm_Mov_Reg_Reg(as, RDX, gprStack[VALUE_SLOT]);
+            Asm_Mov_Reg_Reg(as, RAX, RDX);
+        } else if (value) {
+            emitXmmTree(as, ctx, value, 0, valueType);
+            moveFromXmm(as, RAX, XMM0, valueType);
+            Asm_Mov_Reg_Reg(as, RDX, RAX);
+        }
+    } else {
+        emitAs(as, ctx, index, TYPE_INT);
+        if (value) {
+            Asm_Push(as, RAX);
+            ctx->stackSize += 8;
+            emitAs(as, ctx, value, valueType);
+            Asm_Mov_Reg_Reg(as, RDX, RAX);
+            Asm_Pop(as, RSI);
+            ctx->stackSize -= 8;
+        } else {
+            Asm_Mov_Reg_Reg(as, RSI, RAX);
+        }
+    }
+
+    if (arrayLocal) {
+        emitRegisterLoad(as, RDI, arrayLocal);
+    } else {
+        Asm_Pop(as, RDI);
+        ctx->stackSize -= 8;
+    }
+    Asm_Mov_Imm64(as, RCX, 0x0000FFFFFFFFFFFF);
+    Asm_And_Reg_Reg(as, RDI, RCX);
+}
+
+// Kind and bounds checks; leaves RCX = element buffer. Returns the stub.
+static int emitElementGuards(Assembler* as, CompilerContext* ctx, ArrayKind kind, int inBounds, int isStore) {
+    if (ctx->coldStubCount == ctx->coldStubCapacity) {
+        ctx->coldStubCapacity = ctx->coldStubCapacity ? ctx->coldStubCapacity * 2 : 16;
+        ctx->coldStubs = realloc(ctx->coldStubs, sizeof(ColdStub) * ctx->coldStubCapacity);
+    }
+    int index = ctx->coldStubCount++;
+    ColdStub* stub = &ctx->coldStubs[index];
+    memset(stub, 0, sizeof(*stub));
+    stub->stackSize = ctx->stackSize;
+    stub->liveXmm = liveXmmHomes(ctx);
+    stub->kind = kind;
+    stub->isStore = isStore;
+
+    Asm_Cmp_Mem32_Imm8(as, RDI, (int32_t)offsetof(ObjArray, kind), kind);
+    stub->branches[stub->branchCount++] = as->offset + 2;
+    Asm_Jne(as, 0);
+    if (!inBounds) {
+        // Unsigned compare also sends negative indices to the stub
+        Asm_Movsxd_Reg_Mem(as, RCX, RDI, (int32_t)offsetof(ObjArray, count));
+        Asm_Cmp_Reg_Reg(as, RSI, RCX);
+        stub->branches[stub->branchCount++] = as->offset + 2;
+        Asm_Jae(as, 0);
+    }
+    Asm_Mov_Reg_Mem(as, RCX, RDI, (int32_t)offsetof(ObjArray, elements));
+    return index;
+}
+
+static void emitColdStubs(Assembler* as, CompilerContext* ctx) {
+    int savedStackSize = ctx->stackSize;
+    for (int i = 0; i < ctx->coldStubCount; i++) {
+        ColdStub* stub = &ctx->coldStubs[i];
+        for (int b = 0; b < stub->branchCount; b++) patchForward(as, stub->branches[b]);
+        ctx->stackSize = stub->stackSize;
+
+        void* helper;
+        if (stub->isStore) {
+            // Runtime_ArraySet(arr, index, value) / ArraySetRaw(.., kind)
+            Asm_Push(as, RDX);
+            ctx->stackSize += 8;
+            helper = stub->kind == ARRAY_VALUE ? (void*)Runtime_ArraySet : (void*)Runtime_ArraySetRaw;
+            Asm_Mov_Imm64(as, RCX, stub->kind);
+        } else {
+            // Runtime_ArrayGet(arr, index) / ArrayGetRaw(.., kind)
+            helper = stub->kind == ARRAY_VALUE ? (void*)Runtime_ArrayGet : (void*)Runtime_ArrayGetRaw;
+            Asm_Mov_Imm64(as, RDX, stub->kind);
+        }
+        emitPointer(as, ctx, RAX, (uint64_t)(uintptr_t)helper, CACHE_RELOC_IMAGE, helper);
+        emitCallPreserving(as, ctx, RAX, NULL, stub->liveXmm);
+        if (stub->isStore) Asm_Pop(as, RAX);   // Assignment returns the value
+        Asm_Jmp(as, (int32_t)(stub->resume - (as->offset + 5)));
+    }
+    ctx->stackSize = savedStackSize;
+    free(ctx->coldStubs);
+    ctx->coldStubs = NULL;
+    ctx->coldStubCount = ctx->coldStubCapacity = 0;
+}
+
+// ==================== LOOP-INVARIANT CODE MOTION ====================
+// Invariants found by Licm_FindInvariants are evaluated once in the loop
+// preheader into unnamed locals. The register allocator gave the numeric
+// ones a home spanning the loop; the rest get a stack slot, which also
+// keeps boxed objects visible to the GC. emitNode then loads the home
+// wherever the expression appears inside the loop.
+
+static void hoistInvariant(Assembler* as, CompilerContext* ctx, AstNode* expr) {
+    emitNode(as, expr, ctx);
+    ValueType type = ctx->lastExprType;
+
+    Local* home = &ctx->locals[ctx->localCount];
+    memset(home, 0, sizeof(*home));
+    home->internalType = type;
+    home->reg = -1;
+    home->regClass = REG_CLASS_NONE;
+
+    RegisterClass regClass;
+    int reg = RegMap_Lookup(ctx->regMap, expr, &regClass);
+    int fits = regClass == REG_CLASS_GPR ? (isIntegralType(type) || type == TYPE_BOOLEAN)
+             : regClass == REG_CLASS_XMM ? (type == TYPE_DOUBLE || type == TYPE_FLOAT) : 0;
+    if (reg != -1 && fits) {
+        home->reg = reg;
+        home->regClass = regClass;
+        emitRegisterMove(as, home, RAX);
+    } else {
+        Asm_Push(as, RAX);
+        ctx->stackSize += 8;
+        home->offset = ctx->stackSize;
+    }
+
+    // Bound only now, so the evaluation above emitted the real expression
+    home->invariant = expr;
+    ctx->localCount++;
+    ctx->invariantCount++;
+}
+
+// ==================== TIERED COMPILATION ====================
+// Functions start in a baseline tier that compiles quickly: no register
+// allocation, inlining, LICM or vectorization, every local on the stack.
+// Its entry and loop backedges decrement execution counters. When one runs
+// out, the function is recompiled with the full pipeline and re-pointed:
+// the registry entry and every linked call site move to the new code, and
+// the baseline entry is patched to jump there for stale function values.
+// The frame that tripped the counter moves over as well, at entry by
+// re-issuing its call as a tail jump, in a loop through that loop's OSR
+// entry. Top-level code, async functions and functions declaring nested
+// functions are compiled optimized from the start.
+
+#define TIER_CALL_THRESHOLD 100     // Calls before a baseline function is re-JITed
+#define TIER_LOOP_THRESHOLD 1000    // Backedges before a baseline loop is re-JITed
+
+static int tieringEnabled = 1;
+
+void Jit_SetTiering(int enabled) {
+    tieringEnabled = enabled;
+}
+
+// ==================== LINE TABLES ====================
+
+// First source line a node covers, or 0 when it carries no token
+static int nodeLine(AstNode* node) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_LITERAL_EXPR: return ((LiteralExpr*)node)->token.line;
+        case NODE_STRING_LITERAL: return ((StringExpr*)node)->token.line;
+        case NODE_UNARY_EXPR: return ((UnaryExpr*)node)->op.line;
+        case NODE_VAR_DECL: return ((VarDecl*)node)->name.line;
+        case NODE_ASSIGNMENT_EXPR: return ((AssignmentExpr*)node)->name.line;
+        case NODE_STRUCT_INIT: return ((StructInit*)node)->structName.line;
+        case NODE_BINARY_EXPR: {
+            BinaryExpr* binary = (BinaryExpr*)node;
+            int line = nodeLine(binary->left);
+            return line ? line : binary->op.line;
+        }
+        case NODE_LOGICAL_EXPR: {
+            LogicalExpr* logic = (LogicalExpr*)node;
+            int line = nodeLine(logic->left);
+            return line ? line : logic->op.line;
+        }
+        case NODE_SET_EXPR: {
+            SetExpr* set = (SetExpr*)node;
+            int line = nodeLine(set->object);
+            return line ? line : set->name.line;
+        }
+        case NODE_GET_EXPR: {
+            GetExpr* get = (GetExpr*)node;
+            int line = nodeLine(get->object);
+            return line ? line : get->name.line;
+        }
+        case NODE_CALL_EXPR: return nodeLine(((CallExpr*)node)->callee);
+        case NODE_RETURN_STMT: return nodeLine(((ReturnStmt*)node)->returnValue);
+        case NODE_IF_STMT: return nodeLine(((IfStmt*)node)->condition);
+        case NODE_AWAIT_EXPR: return nodeLine(((AwaitExpr*)node)->expression);
+        case NODE_INDEX_EXPR: return nodeLine(((IndexExpr*)node)->array);
+        case NODE_INDEX_SET_EXPR: return nodeLine(((IndexSetExpr*)node)->array);
+        case NODE_ARRAY_LITERAL: {
+            ArrayLiteral* array = (ArrayLiteral*)node;
+            return array->count > 0 ? nodeLine(array->elements[0]) : 0;
+        }
+        case NODE_FOR_STMT: {
+            ForStmt* loop = (ForStmt*)node;
+            int line = nodeLine(loop->initializer);
+            return line ? line : nodeLine(loop->condition);
+        }
+        default:
+            return 0;   // Blocks and declarations: their contents record lines
+    }
+}
+
+static void recordLine(Assembler* as, CompilerContext* ctx, AstNode* node) {
+    int line = nodeLine(node);
+    if (line <= 0) return;
+    uint32_t offset = (uint32_t)as->offset;
+    // Peephole rewrites can move the offset back over recorded entries
+    while (ctx->lineCount > 0 && ctx->lines[ctx->lineCount - 1].offset >= offset) ctx->lineCount--;
+    if (ctx->lineCount > 0 && ctx->lines[ctx->lineCount - 1].line == (uint32_t)line) return;
+    if (ctx->lineCount == ctx->lineCapacity) {
+        ctx->lineCapacity = ctx->lineCapacity ? ctx->lineCapacity * 2 : 32;
+        ctx->lines = realloc(ctx->lines, sizeof(DebugLine) * ctx->lineCapacity);
+    }
+    ctx->lines[ctx->lineCount++] = (DebugLine){ offset, (uint32_t)line };
+}
+
+static void* compileFunction(FunctionDecl* func, CompileTier tier);
+
+static int declaresFunction(AstNode* node) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_FUNCTION_DECL:
+            return 1;
+        case NODE_BLOCK: {
+            BlockStmt* block = (BlockStmt*)node;
+            for (int i = 0; i < block->count; i++) {
+                if (declaresFunction(block->statements[i])) return 1;
+            }
+            return 0;
+        }
+        case NODE_IF_STMT:
+            return declaresFunction(((IfStmt*)node)->thenBranch) ||
+                   declaresFunction(((IfStmt*)node)->elseBranch);
+        case NODE_FOR_STMT:
+            return declaresFunction(((ForStmt*)node)->body);
+        default:
+            return 0;
+    }
+}
+
+static CompileTier initialTier(FunctionDecl* func) {
+    // Cached and ahead-of-time code must not call back into the compiler,
+    // which has no AST on a warm start and does not exist in a linked program
+    if (!tieringEnabled || keepCompiledUnits() || func->isAsync || func->paramCount > 6) return TIER_OPTIMIZED;
+    return declaresFunction(func->body) ? TIER_OPTIMIZED : TIER_BASELINE;
+}
+
+// Rewrites the baseline entry as JMP rel32 to target. The first 8 bytes
+// go out in one aligned store, so a caller sees either the old prologue
+// or the complete jump.
+static void redirectBaselineEntry(uint8_t* entry, void* target) {
+    uint64_t word;
+    memcpy(&word, entry, sizeof(word));
+    uint8_t* bytes = (uint8_t*)&word;
+    int32_t rel = (int32_t)((intptr_t)target - (intptr_t)(entry + 5));
+    bytes[0] = 0xE9;
+    memcpy(bytes + 1, &rel, sizeof(rel));
+    __atomic_store_n((uint64_t*)Jit_WritableAddress(entry), word, __ATOMIC_RELEASE);
+}
+
+// Runtime entry points, called from baseline code with the frame intact
+static void* tierUpFunction(GlobalFunction* fn) {
+    fn->callCounter = TIER_CALL_THRESHOLD;
+    if (fn->tier == TIER_BASELINE) compileFunction(fn->decl, TIER_OPTIMIZED);
+    return fn->address;
+}
+
+static void* tierUpLoop(GlobalFunction* fn, TierLoop* loop) {
+    loop->counter = TIER_LOOP_THRESHOLD;
+    if (fn->tier == TIER_BASELINE) compileFunction(fn->decl, TIER_OPTIMIZED);
+    return loop->osrEntry;
+}
+
+// Baseline entry, after the parameters are bound: count the call and, once
+// hot, jump to the optimized code with the arguments reloaded
+static void emitEntryCounter(Assembler* as, CompilerContext* ctx) {
+    Asm_Mov_Reg_Ptr(as, RAX, &ctx->tierFn->callCounter);
+    Asm_Sub_Mem32_Imm8(as, RAX, 0, 1);
+    size_t warm = as->offset + 2;
+    Asm_Jne(as, 0);
+
+    Asm_Mov_Reg_Ptr(as, RDI, ctx->tierFn);
+    emitCallAbsolute(as, ctx, (void*)tierUpFunction);
+
+    FunctionDecl* func = ctx->function;
+    Register gprRegs[] = { RDI, RSI, RDX, RCX, R8, R9 };
+    int gprCount = 0;
+    int xmmCount = 0;
+    for (int i = 0; i < func->paramCount; i++) {
+        Local* param = &ctx->locals[i];
+        if (param->internalType == TYPE_DOUBLE || param->internalType == TYPE_FLOAT) {
+            Asm_Movsd_Xmm_Mem(as, (XmmRegister)xmmCount++, RBP, -param->offset);
+        } else {
+            Asm_Mov_Reg_Mem(as, gprRegs[gprCount++], RBP, -param->offset);
+        }
+    }
+    emitFrameTeardown(as, ctx);
+    Asm_Emit8(as, 0xFF); Asm_Emit8(as, 0xE0); // JMP RAX
+
+    patchForward(as, warm);
+}
+
+// Baseline loop, after the initializer: remember where each local lives
+static TierLoop* recordTierLoop(CompilerContext* ctx, ForStmt* forStmt) {
+    TierLoop* loop = malloc(sizeof(TierLoop));
+    memset(loop, 0, sizeof(*loop));
+    loop->loop = forStmt;
+    loop->counter = TIER_LOOP_THRESHOLD;
+    for (int i = 0; i < ctx->localCount; i++) {
+        loop->slots[i].name = ctx->locals[i].name.start;
+        loop->slots[i].offset = ctx->locals[i].offset;
+        loop->slots[i].type = ctx->locals[i].internalType;
+    }
+    loop->slotCount = ctx->localCount;
+    loop->next = ctx->tierFn->loops;
+    ctx->tierFn->loops = loop;
+    return loop;
+}
+
+// Baseline backedge: count it and, once hot, finish the call in the
+// optimized code (entered at this loop) and return its result
+static void emitBackedgeCounter(Assembler* as, CompilerContext* ctx, TierLoop* loop, size_t loopStart) {
+    Asm_Mov_Reg_Ptr(as, RAX, &loop->counter);
+    Asm_Sub_Mem32_Imm8(as, RAX, 0, 1);
+    Asm_Jne(as, (int32_t)(loopStart - (as->offset + 6)));
+
+    Asm_Mov_Reg_Ptr(as, RDI, ctx->tierFn);
+    Asm_Mov_Reg_Ptr(as, RSI, loop);
+    emitCallAbsolute(as, ctx, (void*)tierUpLoop);
+    Asm_Test_Reg_Reg(as, RAX, RAX);
+    Asm_Je(as, (int32_t)(loopStart - (as->offset + 6)));
+
+    Asm_Mov_Reg_Reg(as, RDI, RBP);
+    emitCallRegister(as, ctx, RAX);
+    emitEpilogue(as, ctx);
+}
+
+// Optimized code, at the same point of a loop the baseline recorded: an
+// alternative entry that builds this frame from the baseline one (RDI)
+// and falls into the loop. Hoisted values of enclosing loops are
+// recomputed from the copied locals, exactly as their preheaders did.
+static void emitOsrEntry(Assembler* as, CompilerContext* ctx, ForStmt* forStmt) {
+    TierLoop* loop = ctx->tierFn->loops;
+    while (loop && loop->loop != forStmt) loop = loop->next;
+    if (!loop) return;
+
+    // Both frames must hold the same named locals in the same representation
+    int slot = 0;
+    for (int i = 0; i < ctx->localCount; i++) {
+        Local* local = &ctx->locals[i];
+        if (local->invariant) continue;
+        if (slot == loop->slotCount || local->name.start != loop->slots[slot].name ||
+            local->internalType != loop->slots[slot].type) return;
+        slot++;
+    }
+    if (slot != loop->slotCount) return;
+
+    size_t skip = as->offset + 1;
+    Asm_Jmp(as, 0);
+    loop->osrOffset = Asm_Label(as);
+
+    // Whole frame in one step, plus a slot for the baseline RBP
+    emitFramePrologue(as, ctx);
+    int savedStackSize = ctx->stackSize;
+    int savedLocalCount = ctx->localCount;
+    int baselineSlot = ctx->stackSize + 8;
+    Asm_Sub_Reg_Imm(as, RSP, baselineSlot - 8 * savedGprCount(ctx));
+    Asm_Mov_Mem_Reg(as, RBP, -baselineSlot, RDI);
+    ctx->stackSize = baselineSlot;
+
+    slot = 0;
+    for (int i = 0; i < savedLocalCount; i++) {
+        Local* local = &ctx->locals[i];
+        if (local->invariant) {
+            ctx->localCount = i;
+            emitAs(as, ctx, local->invariant, local->internalType);
+            ctx->localCount = savedLocalCount;
+        } else {
+            Asm_Mov_Reg_Mem(as, RCX, RBP, -baselineSlot);
+            Asm_Mov_Reg_Mem(as, RAX, RCX, -loop->slots[slot++].offset);
+        }
+        emitRegisterMove(as, local, RAX);
+    }
+
+    Asm_Add_Reg_Imm(as, RSP, 8);
+    ctx->stackSize = savedStackSize;
+    patchForward(as, skip);
+}
+
+// A function emitted into its staging buffer, not installed yet
+typedef struct {
+    FunctionDecl* func;
+    GlobalFunction* fn;
+    CompileTier tier;
+    Assembler as;
+    CallSite* callSites;
+    int callSiteCount;
+    Relocation* relocs;
+    int relocCount;
+    DebugLine* lines;
+    int lineCount;
+} EmittedFunction;
+
+// Emits a function body at the given tier. Only reads shared compiler
+// state, so independent functions can be emitted on several threads.
+static void emitFunction(FunctionDecl* func, GlobalFunction* fn, CompileTier tier, EmittedFunction* out) {
+    int baseline = tier == TIER_BASELINE;
+    Assembler funcAs;
+    Asm_InitDynamic(&funcAs, JIT_STAGING_SIZE);
+    
+    // Register allocation runs before emission so the prologue knows
+    // which callee-saved registers and XMM homes are needed.
+    RegisterMap* regMap = NULL;
+    if (!baseline) {
+        regMap = malloc(sizeof(RegisterMap));
+        RegMap_Allocate(regMap, func);
+    }
+    
+    // Setup Context for Function
+    CompilerContext funcCtx = {0};
+    funcCtx.regMap = regMap;
+    funcCtx.savedGprMask = regMap ? regMap->usedGprMask : 0;
+    funcCtx.baseline = baseline;
+    funcCtx.cpuFeatures = Cpu_Features();
+    funcCtx.trackLines = Debug_WantsLines();
+    if (baseline || fn->tier == TIER_BASELINE) funcCtx.tierFn = fn;
+    
+    // Function Prologue
+    // ABI: Save only the callee-saved registers that hold locals
+    emitFramePrologue(&funcAs, &funcCtx);
+    funcCtx.stackSize = 8 * savedGprCount(&funcCtx);
+    
+    // XMM homes are caller-saved: reserve a slot for each one so
+    // calls can spill and reload them (see emitCallRegister)
+    int xmmHomes = regMap ? __builtin_popcount(regMap->usedXmmMask) : 0;
+    funcCtx.xmmSaveBase = funcCtx.stackSize;
+    if (xmmHomes > 0) {
+        Asm_Sub_Reg_Imm(&funcAs, RSP, 8 * xmmHomes);
+        funcCtx.stackSize += 8 * xmmHomes;
+    }
+    
+    // Self tail calls re-enter here with fresh arguments
+    funcCtx.function = func;
+    funcCtx.tailEntry = Asm_Label(&funcAs);
+    funcCtx.tailEntryStackSize = funcCtx.stackSize;
+
+    // Raw ABI: Check param types to determine source register (GPR or XMM)
+    Register gprRegs[] = { RDI, RSI, RDX, RCX, R8, R9 };
+    int gprCount = 0;
+    int xmmCount = 0;
+    
+    for (int i = 0; i < func->paramCount; i++) {
+        Token type = func->paramTypes[i];
+        int isFloat = 0;
+        
+        if (type.length == 5 && memcmp(type.start, "float", 5) == 0) isFloat = 1;
+        else if (type.length == 6 && memcmp(type.start, "double", 6) == 0) isFloat = 1;
+        
+        reserveLocals(&funcCtx, 1);
+        Local* local = &funcCtx.locals[funcCtx.localCount++];
+        local->name = func->params[i];
+        local->typeName = func->paramTypes[i]; 
+        local->internalType = valueTypeFromToken(&func->paramTypes[i]);
+        local->offset = 0;
+        local->invariant = NULL;
+        local->reg = RegMap_Lookup(regMap, &func->params[i], &local->regClass);
+        int inRegister = isFloat ? xmmCount < 8 : gprCount < 6;
+        
+        if (local->reg != -1 && inRegister) {
+            // Param lives in a register home for the whole body
+            if (local->regClass == REG_CLASS_XMM) {
+                Asm_Movapd_Xmm_Xmm(&funcAs, (XmmRegister)local->reg, (XmmRegister)xmmCount++);
+            } else {
+                Asm_Mov_Reg_Reg(&funcAs, (Register)local->reg, gprRegs[gprCount++]);
+            }
+            continue;
+        }
+        local->reg = -1;
+        local->regClass = REG_CLASS_NONE;
+
+        if (isFloat) {
+            if (xmmCount < 8) {
+                // MOVSD [RBP - slot], XMMk (keeps 8-byte slots uniform)
+                Asm_Sub_Reg_Imm(&funcAs, RSP, 8);
+                Asm_Movsd_Mem_Xmm(&funcAs, RBP, -(funcCtx.stackSize + 8), (XmmRegister)xmmCount++);
+            } else {
+                // Stack overflow
+                Asm_Push(&funcAs, RAX); // Placeholder
+            }
+        } else {
+            // Int/Ptr
+            if (gprCount < 6) {
+                Asm_Push(&funcAs, gprRegs[gprCount++]);
+            } else {
+                Asm_Push(&funcAs, RAX); // Stack overflow
+            }
+        }
+        
+        funcCtx.stackSize += 8;
+        local->offset = funcCtx.stackSize;
+    }
+
+    if (baseline) emitEntryCounter(&funcAs, &funcCtx);
+    
+    // Compile Body
+    emitNode(&funcAs, func->body, &funcCtx);
+
+    
+    // Default Return (if user didn't)
+    Asm_Mov_Imm64(&funcAs, RAX, VAL_NULL); // Default return nil
+    emitEpilogue(&funcAs, &funcCtx);
+    emitColdStubs(&funcAs, &funcCtx);
+    free(regMap);
+
+    *out = (EmittedFunction){
+        func, fn, tier, funcAs,
+        funcCtx.callSites, funcCtx.callSiteCount,
+        funcCtx.relocs, funcCtx.relocCount,
+        funcCtx.lines, funcCtx.lineCount
+    };
+}
+
+// Installs an emitted function into the shared code cache and registers it.
+// Its relocations stay with the caller unless compiled units are kept.
+static void* installFunction(EmittedFunction* body) {
+    FunctionDecl* func = body->func;
+    GlobalFunction* fn = body->fn;
+    int baseline = body->tier == TIER_BASELINE;
+
+    size_t funcSize = body->as.offset;
+    uint8_t* funcMem = Jit_InstallCode(body->as.buffer, funcSize, func->name.start, func->name.length);
+    Asm_Free(&body->as);
+    Debug_RegisterCode(funcMem, funcSize, func->name.start, func->name.length, func->file,
+                       body->lines, body->lineCount);
+    free(body->lines);
+
+    if (fn->tier == TIER_BASELINE && !baseline) {
+        for (TierLoop* loop = fn->loops; loop; loop = loop->next) {
+            if (loop->osrOffset) loop->osrEntry = funcMem + loop->osrOffset;
+        }
+        redirectBaselineEntry(fn->baselineEntry, funcMem);
+    }
+    if (baseline) {
+        fn->callCounter = TIER_CALL_THRESHOLD;
+        fn->baselineEntry = funcMem;
+    }
+    fn->tier = body->tier;
+    
+    // Register first so recursive call sites resolve immediately
+    registerGlobalFunction(func->name.start, func->name.length, funcMem);
+    linkCallSites(body->callSites, body->callSiteCount, funcMem);
+    if (keepCompiledUnits()) {
+        compiledUnits = realloc(compiledUnits, sizeof(CompiledUnit) * (compiledUnitCount + 1));
+        compiledUnits[compiledUnitCount++] = (CompiledUnit){
+            fn, funcMem, funcSize, func->paramCount,
+            body->relocs, body->relocCount, body->callSites, body->callSiteCount
+        };
+    } else {
+        free(body->callSites);
+    }
+
+    // Check for Main
+    if (func->name.length == 4 && memcmp(func->name.start, "Main", 4) == 0) {
+         mainFunc = funcMem; // Update global
+    }
+    return funcMem;
+}
+
+// Compiles a function declaration into the code cache and registers it.
+// TIER_NONE picks the starting tier; TIER_OPTIMIZED on a baseline
+// function is the tier-up.
+static void* compileFunction(FunctionDecl* func, CompileTier tier) {
+    GlobalFunction* fn = declareGlobalFunction(func->name.start, func->name.length, func);
+    if (tier == TIER_NONE) tier = initialTier(func);
+
+    EmittedFunction body;
+    emitFunction(func, fn, tier, &body);
+    void* funcMem = installFunction(&body);
+    if (!keepCompiledUnits()) free(body.relocs);
+    return funcMem;
+}
+
+// A node whose value is discarded (block statements, for increments)
+static void emitStatement(Assembler* as, CompilerContext* ctx, AstNode* node) {
+    if (node->type == NODE_ASSIGNMENT_EXPR) {
+        if (ctx->trackLines && !ctx->inlineFrame) recordLine(as, ctx, node);
+        if (emitInPlaceUpdate(as, ctx, (AssignmentExpr*)node)) return;
+    }
+    emitNode(as, node, ctx);
+}
+
+static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
+    // Inlined bodies are attributed to the line of their call
+    if (ctx->trackLines && !ctx->inlineFrame) recordLine(as, ctx, node);
+
+    // Hoisted out of an enclosing loop: already computed in the preheader
+    if (ctx->invariantCount > 0) {
+        for (int i = ctx->localCount - 1; i >= 0; i--) {
+            if (ctx->locals[i].invariant == node) {
+                emitRegisterLoad(as, RAX, &ctx->locals[i]);
+                ctx->lastExprType = ctx->locals[i].internalType;
+                return;
+            }
+        }
+    }
+
+    switch (node->type) {
+        case NODE_BLOCK: {
+            BlockStmt* block = (BlockStmt*)node;
+            
+            // Scope Management
+            int savedStackSize = ctx->stackSize;
+            int savedLocalCount = ctx->localCount;
+            
+            for (int i = 0; i < block->count; i++) {
+                emitStatement(as, ctx, block->statements[i]);
+            }
+            
+            // Pop Stack (if locals were declared)
+            int diff = ctx->stackSize - savedStackSize;
+            if (diff > 0) {
+                 // ADD RSP, diff
+                 Asm_Add_Reg_Imm(as, RSP, diff);
+                 ctx->stackSize = savedStackSize;
+            }
+            
+            // Restore Scope
+            ctx->localCount = savedLocalCount;
+            
+            break;
+        }
+
+        case NODE_ARRAY_LITERAL:
+            emitArrayLiteral(as, ctx, (ArrayLiteral*)node, ARRAY_VALUE);
+            break;
+
+        case NODE_INDEX_EXPR: {
+            IndexExpr* expr = (IndexExpr*)node;
+            ArrayKind kind = arrayKindOf(ctx, expr->array);
+            emitArrayAndIndex(as, ctx, expr->array, expr->index, NULL, TYPE_UNKNOWN);
+            
+            int stub = emitElementGuards(as, ctx, kind, isInBounds(ctx, expr->array, expr->index), 0);
+            switch (kind) {
+                case ARRAY_INT32:   Asm_Movsxd_Reg_MemIndex(as, RAX, RCX, RSI, 4); break;
+                case ARRAY_FLOAT32: Asm_Mov32_Reg_MemIndex(as, RAX, RCX, RSI, 4); break;
+                default:            Asm_Mov_Reg_MemIndex(as, RAX, RCX, RSI, 8); break;
+            }
+            ctx->coldStubs[stub].resume = Asm_Label(as);
+            
+            ctx->lastExprType = arrayElementType(kind);
+            break;
+        }
+        
+        case NODE_INDEX_SET_EXPR: {
+            IndexSetExpr* expr = (IndexSetExpr*)node;
+            ArrayKind kind = arrayKindOf(ctx, expr->array);
+            ValueType elemType = arrayElementType(kind);
+            emitArrayAndIndex(as, ctx, expr->array, expr->index, expr->value, elemType);
+            
+            int stub = emitElementGuards(as, ctx, kind, isInBounds(ctx, expr->array, expr->index), 1);
+            if (elementScale(kind) == 4) {
+                Asm_Mov32_MemIndex_Reg(as, RCX, RSI, 4, RDX);
+            } else {
+                Asm_Mov_MemIndex_Reg(as, RCX, RSI, 8, RDX);
+            }
+            ctx->coldStubs[stub].resume = Asm_Label(as);
+            
+            // Convention: Assignment returns value (still in RAX)
+            ctx->lastExprType = elemType;
+            break;
+        }
+
+        case NODE_VAR_DECL: {
+            VarDecl* decl = (VarDecl*)node;
             
-            // Add to Locals first (so we can detect type)
-            Local* local = &ctx->locals[ctx->localCount++];
+            // Build the local now, but only bring it into scope after the
+            // initializer so "int x = x + 1" sees the outer binding.
+            reserveLocals(ctx, 1);
+            Local declared;
+            Local* local = &declared;
             local->name = decl->name;
             local->typeName = decl->typeName;
+            local->offset = 0;
             local->reg = -1; // Default to stack
-            local->internalType = TYPE_DOUBLE; // All numbers are doubles
+            local->regClass = REG_CLASS_NONE;
+            local->invariant = NULL;
+            
+            // Primitive declarations fix the representation; everything else
+            // keeps whatever the initializer produced.
+            ValueType targetType = valueTypeFromToken(&decl->typeName);
             
-            // Compile Init Value -> RAX
+            // Compile Init Value -> RAX (converted once to the declared type)
             if (decl->initializer) {
-                if (decl->initializer->type == NODE_LITERAL_EXPR) {
-                    LiteralExpr* lit = (LiteralExpr*)decl->initializer;
-                    if (lit->token.type == TOKEN_NUMBER) {
-                        // Parse number and store as NaN-boxed double
-                        char buffer[64];
-                        int len = lit->token.length < 63 ? lit->token.length : 63;
-                        for (int i = 0; i < len; i++) buffer[i] = lit->token.start[i];
-                        buffer[len] = '\0';
-                        
-                        double value = strtod(buffer, NULL);
-                        Value val = NumberToValue(value);
-                        Asm_Mov_Imm64(as, RAX, val);
-                        ctx->lastExprType = TYPE_DOUBLE;
-                    } else {
-                        // Non-number literal (string, bool, etc.)
-                        emitNode(as, decl->initializer, ctx);
-                        local->internalType = TYPE_UNKNOWN;
-                    }
+                if (targetType != TYPE_UNKNOWN) {
+                    emitAs(as, ctx, decl->initializer, targetType);
+                } else if (decl->initializer->type == NODE_ARRAY_LITERAL) {
+                    emitArrayLiteral(as, ctx, (ArrayLiteral*)decl->initializer, arrayKindFromToken(&decl->typeName));
                 } else {
-                    // Complex expression - emit normally
                     emitNode(as, decl->initializer, ctx);
-                    
-                    local->internalType = ctx->lastExprType;
                 }
+                local->internalType = ctx->lastExprType;
+            } else if (targetType != TYPE_UNKNOWN) {
+                emitNumberConstant(as, RAX, 0.0, targetType);
+                local->internalType = targetType;
             } else {
                 Asm_Mov_Imm64(as, RAX, VAL_NULL);
                 local->internalType = TYPE_UNKNOWN;
-                ctx->lastExprType = TYPE_UNKNOWN; // Reset for NoInit
-            }
-            
-            // MOVED: Target Type & Unboxing Logic (Runs for Literals too)
-            ValueType targetType = TYPE_UNKNOWN;
-            if (decl->typeName.length == 3 && memcmp(decl->typeName.start, "int", 3) == 0) targetType = TYPE_INT;
-            else if (decl->typeName.length == 6 && memcmp(decl->typeName.start, "double", 6) == 0) targetType = TYPE_DOUBLE;
-            else if (decl->typeName.length == 4 && memcmp(decl->typeName.start, "long", 4) == 0) targetType = TYPE_LONG;
-            else if (decl->typeName.length == 4 && memcmp(decl->typeName.start, "byte", 4) == 0) targetType = TYPE_BYTE;
-            else if (decl->typeName.length == 5 && memcmp(decl->typeName.start, "short", 5) == 0) targetType = TYPE_SHORT;
-            else if (decl->typeName.length == 4 && memcmp(decl->typeName.start, "char", 4) == 0) targetType = TYPE_CHAR;
-            else if (decl->typeName.length == 5 && memcmp(decl->typeName.start, "float", 5) == 0) targetType = TYPE_FLOAT;
-
-            if (targetType != TYPE_UNKNOWN) {
-                local->internalType = targetType;
-                
-                if (targetType == TYPE_DOUBLE && (ctx->lastExprType == TYPE_INT || ctx->lastExprType == TYPE_LONG)) {
-                     // Int -> Double (Box)
-                     Asm_Emit8(as, 0x66); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x6E); Asm_Emit8(as, 0xC0); 
-                     Asm_Emit8(as, 0xF2); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x2A); Asm_Emit8(as, 0xC0); 
-                     Asm_Emit8(as, 0x66); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x7E); Asm_Emit8(as, 0xC0); 
-                } 
-                else if (targetType == TYPE_FLOAT && ctx->lastExprType == TYPE_DOUBLE) {
-                    // Double -> Float (Downcast)
-                     Asm_Emit8(as, 0x66); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x6E); Asm_Emit8(as, 0xC0); 
-                     Asm_Emit8(as, 0xF2); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x5A); Asm_Emit8(as, 0xC0); 
-                     Asm_Emit8(as, 0x66); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x7E); Asm_Emit8(as, 0xC0); 
-                }
-                else if ((targetType == TYPE_INT || targetType == TYPE_LONG || 
-                          targetType == TYPE_BYTE || targetType == TYPE_SHORT || targetType == TYPE_CHAR) && 
-                          ctx->lastExprType == TYPE_DOUBLE) {
-                     // Double -> Int (Unbox)
-                     Asm_Emit8(as, 0x66); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x6E); Asm_Emit8(as, 0xC0); 
-                     Asm_Emit8(as, 0xF2); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x2C); Asm_Emit8(as, 0xC0); 
-                }
             }
+            ctx->lastExprType = local->internalType;
 
-            // Optimization: If primitive type (int/long/bool/double), try allocate register
-            int useReg = 0;
-            if (decl->typeName.length == 3 && memcmp(decl->typeName.start, "int", 3) == 0) {
-                local->internalType = TYPE_INT;
-                useReg = 1;
-            } else if (decl->typeName.length == 4 && memcmp(decl->typeName.start, "long", 4) == 0) {
-                local->internalType = TYPE_LONG;
-                useReg = 1;
-            } else if (decl->typeName.length == 7 && memcmp(decl->typeName.start, "boolean", 7) == 0) {
-                local->internalType = TYPE_BOOLEAN;
-                useReg = 1;
-            } else if (decl->typeName.length == 6 && memcmp(decl->typeName.start, "double", 6) == 0) {
-                local->internalType = TYPE_DOUBLE;
-                useReg = 1;
-            } else if (decl->typeName.length == 5 && memcmp(decl->typeName.start, "float", 5) == 0) {
-                local->internalType = TYPE_FLOAT;
-                useReg = 1;
-            } else if (decl->typeName.length == 4 && memcmp(decl->typeName.start, "byte", 4) == 0) {
-                local->internalType = TYPE_BYTE;
-                useReg = 1;
-            } else if (decl->typeName.length == 5 && memcmp(decl->typeName.start, "short", 5) == 0) {
-                local->internalType = TYPE_SHORT;
-                useReg = 1;
-            } else if (decl->typeName.length == 4 && memcmp(decl->typeName.start, "char", 4) == 0) {
-                local->internalType = TYPE_CHAR;
-                useReg = 1;
-            }
+            // Primitive locals may have been given a register home
+            int useReg = RegMap_ClassForType(&decl->typeName) != REG_CLASS_NONE;
 
             if (useReg) {
-                 int reg = allocRegister(ctx);
+                 RegisterClass regClass;
+                 int reg = RegMap_Lookup(ctx->regMap, decl, &regClass);
                  if (reg != -1) {
                      local->reg = reg;
-                     // Move RAX to Reg
-                     emitRegisterMove(as, reg, RAX);
+                     local->regClass = regClass;
+                     // Move RAX to its home (offset stays 0, not on stack)
+                     emitRegisterMove(as, local, RAX);
                      ctx->lastResultReg = reg;
-                     // Set offset to 0 as it's not on stack
-                     local->offset = 0; 
+                     ctx->locals[ctx->localCount++] = declared;
                      break; 
                  }
             }
@@ -521,6 +3037,7 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
             Asm_Push(as, RAX);
             ctx->stackSize += 8;
             local->offset = ctx->stackSize;
+            ctx->locals[ctx->localCount++] = declared;
             
             break;
         }
@@ -548,14 +3065,14 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
                 int fSize = 8;
                 int isPtr = 0;
                 
-                if (fType.length == 3 && memcmp(fType.start, "int", 3) == 0) fSize = 4;
-                else if (fType.length == 5 && memcmp(fType.start, "float", 5) == 0) fSize = 4;
+                if (fType.length == 5 && memcmp(fType.start, "float", 5) == 0) fSize = 4;
                 else if ((fType.length == 7 && memcmp(fType.start, "boolean", 7) == 0) || 
                          (fType.length == 4 && memcmp(fType.start, "byte", 4) == 0)) fSize = 1; 
                 else if ((fType.length == 5 && memcmp(fType.start, "short", 5) == 0) || 
                          (fType.length == 4 && memcmp(fType.start, "char", 4) == 0)) fSize = 2;
                 else if ((fType.length == 6 && memcmp(fType.start, "double", 6) == 0) || 
-                         (fType.length == 4 && memcmp(fType.start, "long", 4) == 0)) fSize = 8;
+                         (fType.length == 4 && memcmp(fType.start, "long", 4) == 0) ||
+                         (fType.length == 3 && memcmp(fType.start, "int", 3) == 0)) fSize = 8;
                 else { fSize = 8; isPtr = 1; }
                 
                 while (dataSize % fSize != 0) dataSize++;
@@ -576,17 +3093,11 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
             int totalSize = headerSize + dataSize;
             
             Asm_Mov_Imm64(as, RDI, totalSize);
-            void* mallocPtr = (void*)MemAlloc;
-            Asm_Mov_Reg_Ptr(as, RAX, mallocPtr);
-            
-            // Align Stack for MemAlloc (SUB RSP, 8)
-            Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xEC); Asm_Emit8(as, 0x08);
-            Asm_Call_Reg(as, RAX);
-            // Restore Stack (ADD RSP, 8)
-            Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xC4); Asm_Emit8(as, 0x08);
+            emitCallAbsolute(as, ctx, (void*)MemAlloc);
             
-            // Initialize Header
-            Asm_Push(as, RAX); // Stack Aligned (RSP % 16 == 0)
+            // Initialize Header (object stays on the stack so the GC can see it)
+            Asm_Push(as, RAX);
+            ctx->stackSize += 8;
             Asm_Mov_Reg_Reg(as, RCX, RAX);
             
             Asm_Mov_Imm64(as, RDX, OBJ_STRUCT);
@@ -598,14 +3109,9 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
             Asm_Mov_Imm64(as, RDX, bitmap);
             Asm_Mov_Mem_Reg(as, RCX, 24, RDX);
             
-            // Register GC (Stack ALREADY aligned due to Push RAX above)
+            // Register GC
             Asm_Mov_Reg_Reg(as, RDI, RAX);
-            void* gcRegPtr = (void*)GC_RegisterObject;
-            Asm_Mov_Reg_Ptr(as, RAX, gcRegPtr);
-            Asm_Call_Reg(as, RAX);
-            
-            Asm_Pop(as, RAX);
-            Asm_Push(as, RAX);
+            emitCallAbsolute(as, ctx, (void*)GC_RegisterObject);
             
             // Fill Fields
             for (int i=0; i<info->fieldCount; i++) {
@@ -621,8 +3127,11 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
                      }
                  }
                  
+                 ValueType fieldType = valueTypeFromToken(&fType);
                  if (valExpr) {
-                     emitNode(as, valExpr, ctx);
+                     emitAs(as, ctx, valExpr, fieldType);
+                 } else if (fieldType != TYPE_UNKNOWN) {
+                     emitNumberConstant(as, RAX, 0.0, fieldType);
                  } else {
                      Asm_Mov_Imm64(as, RAX, VAL_NULL);
                  } 
@@ -634,9 +3143,7 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
                  
                  // offset & fType already defined above
                  
-                 if (fType.length == 3 && memcmp(fType.start, "int", 3) == 0) {
-                     Asm_Emit8(as, 0x89); Asm_Emit8(as, 0x87); Asm_Emit32(as, offset);
-                 } else if (fType.length == 5 && memcmp(fType.start, "float", 5) == 0) {
+                 if (fType.length == 5 && memcmp(fType.start, "float", 5) == 0) {
                      Asm_Emit8(as, 0x89); Asm_Emit8(as, 0x87); Asm_Emit32(as, offset);
                  } else if ((fType.length == 7 && memcmp(fType.start, "boolean", 7) == 0) || 
                             (fType.length == 4 && memcmp(fType.start, "byte", 4) == 0)) {
@@ -653,6 +3160,7 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
             }
             
             Asm_Pop(as, RAX);
+            ctx->stackSize -= 8;
             
             // Apply Tag: QNAN (0x7FFC...)
             Asm_Mov_Imm64(as, RCX, 0x7FFC000000000000); 
@@ -680,9 +3188,10 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
                              funcName[nsLen] = '_';
                              memcpy(funcName + nsLen + 1, get->name.start, methodLen);
                              funcName[nsLen + 1 + methodLen] = '\0';
-                             void* funcPtr = findGlobalFunction(funcName, nsLen + 1 + methodLen);
-                             if (funcPtr) {
-                                 Asm_Mov_Imm64(as, RAX, (long long)funcPtr);
+                             GlobalFunction* target = findGlobalEntry(funcName, nsLen + 1 + methodLen);
+                             // A batch member gets its address once the batch is installed
+                             if (target && (target->address || target->pending)) {
+                                 emitPointer(as, ctx, RAX, (uint64_t)(uintptr_t)target->address, CACHE_RELOC_CODE, target);
                                  ctx->lastExprType = TYPE_UNKNOWN; 
                                  break;
                              }
@@ -697,20 +3206,19 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
                                 Asm_Mov_Imm64(as, RCX, 0x0000FFFFFFFFFFFF);
                                 Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x21); Asm_Emit8(as, 0xC8); 
                                 
+                                ValueType fieldType = structFieldType(info, &get->name);
                                 if (fSize == 1) {
                                     Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0xB6); Asm_Emit8(as, 0x80); Asm_Emit32(as, fOffset);
-                                    ctx->lastExprType = TYPE_INT;
                                 } else if (fSize == 2) {
                                     Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0xB7); Asm_Emit8(as, 0x80); Asm_Emit32(as, fOffset);
-                                    ctx->lastExprType = TYPE_INT;
                                 } else if (fSize == 4) {
-                                    Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x63); Asm_Emit8(as, 0x80); Asm_Emit32(as, fOffset);
-                                    ctx->lastExprType = TYPE_INT;
+                                    // MOV EAX, [RAX + disp32] (raw float bits, zero-extended)
+                                    Asm_Emit8(as, 0x8B); Asm_Emit8(as, 0x80); Asm_Emit32(as, fOffset);
                                 } else {
                                     Asm_Mov_Reg_Mem(as, RAX, RAX, fOffset);
-                                    if(isPtr) ctx->lastExprType = TYPE_UNKNOWN;
-                                    else ctx->lastExprType = TYPE_DOUBLE;
                                 }
+                                // Pointer fields are stored boxed (UNKNOWN), scalars raw
+                                ctx->lastExprType = isPtr ? TYPE_UNKNOWN : fieldType;
                                 break;
                             }
                          }
@@ -722,95 +3230,41 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
         }
         case NODE_ASSIGNMENT_EXPR: {
             AssignmentExpr* assign = (AssignmentExpr*)node;
-            emitNode(as, assign->value, ctx);
-            // Value in RAX, remember its type
-            ValueType assignedType = ctx->lastExprType;
-            
-            Token type;
-            int reg = -1;
-            int offset = resolveLocal(ctx, &assign->name, &type, &reg, NULL);
-            if (offset > 0 || reg != -1) {
-                // Update local's type
-                for (int i = ctx->localCount - 1; i >= 0; i--) {
-                    if (ctx->locals[i].name.length == assign->name.length &&
-                        memcmp(ctx->locals[i].name.start, assign->name.start, assign->name.length) == 0) {
-                        
-                        ValueType varType = ctx->locals[i].internalType;
-                        
-                        // IMPLICIT CASTING
-                        if (varType == TYPE_DOUBLE && (assignedType == TYPE_INT || assignedType == TYPE_LONG)) {
-                             // Cast Int(RAX) -> Double
-                             Asm_Emit8(as, 0x66); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x6E); Asm_Emit8(as, 0xC0); // MOVQ XMM0, RAX
-                             Asm_Emit8(as, 0xF2); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x2A); Asm_Emit8(as, 0xC0); // CVTSI2SD XMM0, RAX
-                             Asm_Emit8(as, 0x66); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x7E); Asm_Emit8(as, 0xC0); // MOVQ RAX, XMM0
-                        } else if (varType == TYPE_INT && assignedType == TYPE_DOUBLE) {
-                             // Cast Double(RAX) -> Int
-                             Asm_Emit8(as, 0x66); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x6E); Asm_Emit8(as, 0xC0); // MOVQ XMM0, RAX
-                             Asm_Emit8(as, 0xF2); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x2C); Asm_Emit8(as, 0xC0); // CVTTSD2SI RAX, XMM0
-                        } else {
-                             // Update type if we didn't cast and it was Unknown?
-                             // No, if varType is known, we stick to it. If unknown, we update.
-                             if (varType == TYPE_UNKNOWN) ctx->locals[i].internalType = assignedType;
-                        }
-                        break;
-                    }
-                }
-                
-                if (reg != -1) {
-                     // Store RAX to Reg
-                     emitRegisterMove(as, reg, RAX);
-                } else {
-                     // Store RAX to [RBP - offset]
-                     // offset is positive from ctx start.
-                     // Local at [RBP - offset]
-                     Asm_Mov_Mem_Reg(as, RBP, -offset, RAX);
-                }
-            } else {
+            Local* target = findLocal(ctx, &assign->name);
+            if (!target) {
                 fprintf(stderr, "JIT Error: Assignment to unknown variable '%.*s'\n", assign->name.length, assign->name.start);
                 exit(1);
             }
+            
+            // IMPLICIT CASTING: the local's representation never changes,
+            // so the value is converted (at most once) to match it.
+            if (assign->value->type == NODE_ARRAY_LITERAL && target->internalType == TYPE_UNKNOWN) {
+                emitArrayLiteral(as, ctx, (ArrayLiteral*)assign->value, arrayKindFromToken(&target->typeName));
+            } else {
+                emitAs(as, ctx, assign->value, target->internalType);
+            }
+            
+            // Store RAX to the local's home (register or [RBP - offset])
+            emitRegisterMove(as, target, RAX);
             break;
         }
 
         case NODE_LITERAL_EXPR: {
             LiteralExpr* lit = (LiteralExpr*)node;
             if (lit->token.type == TOKEN_NUMBER) {
-                // Parse number as double
-                char buffer[64];
-                int len = lit->token.length < 63 ? lit->token.length : 63;
-                for(int i=0; i<len; i++) buffer[i] = lit->token.start[i];
-                buffer[len] = '\0';
-                
-                double num = strtod(buffer, NULL);
-                Value val = NumberToValue(num);
-                
-                // If context expects INT/LONG, or value is small integer, emit raw?
-                // For now, emit Double (NaN-Boxed) by default UNLESS we are in an INT path?
-                // But NODE_VAR_DECL converts it?
-                // Wait, if I emit Boxed here, and assign to INT local in Register, I need to UNBOX.
-                // Or I emit Raw here if I know it's INT.
-                
-                // Let's emit Raw Integer if it looks like one? 
-                // Checks for integer:
-                // Always emit as Double (Value) for compatibility with NaN Boxing
-                // The runtime expects Numbers to be IEEE 754 doubles.
-                // Raw integers (e.g. 0x00000010) are interpreted as denormal doubles.
-                Asm_Mov_Imm64(as, RAX, val);
-                ctx->lastExprType = TYPE_DOUBLE;
+                // Integral literals are raw int64, everything else double bits.
+                // Sinks that need another representation go through emitAs(),
+                // which materializes the constant directly in that form.
+                ValueType type = literalIsIntegral(lit) ? TYPE_INT : TYPE_DOUBLE;
+                emitLiteralConstant(as, RAX, lit, type);
+                ctx->lastExprType = type;
             } else if (lit->token.type == TOKEN_IDENTIFIER) {
                 // Resolve Variable
-                Token type;
-                int reg = -1; // Added for resolveLocal
-                ValueType varInternalType = TYPE_UNKNOWN;
-                int offset = resolveLocal(ctx, &lit->token, &type, &reg, &varInternalType); // Updated call
-                if (offset > 0 || reg != -1) { // Updated condition
-                    if (reg != -1) {
-                        emitRegisterLoad(as, RAX, reg); // New
-                    } else {
-                        // Load from [RBP - offset] -> RAX
-                        Asm_Mov_Reg_Mem(as, RAX, RBP, -offset);
-                    }
-                    ctx->lastExprType = varInternalType; // CORRECTLY SET TYPE
+                Local* local = findLocal(ctx, &lit->token);
+                if (local) {
+                    // Register home (GPR or XMM) or [RBP - offset] -> RAX
+                    emitRegisterLoad(as, RAX, local);
+                    ctx->lastExprType = local->internalType;
                 } else {
                      fprintf(stderr, "JIT Error: Undefined variable '%.*s'\n", lit->token.length, lit->token.start);
                      exit(1);
@@ -842,7 +3296,7 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
             memcpy(objStr->chars, strExpr->token.start + 1, len);
             objStr->chars[len] = '\0';
             Value v = ObjToValue(objStr);
-            Asm_Mov_Imm64(as, RAX, v);
+            emitPointer(as, ctx, RAX, v, CACHE_RELOC_STRING, objStr);
             ctx->lastExprType = TYPE_UNKNOWN; // Boxed String
             break;
         }
@@ -865,25 +3319,19 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
                       
                       Asm_Push(as, RAX); ctx->stackSize += 8;
                       
-                      emitNode(as, call->args[0], ctx); // Val -> RAX
-                      
-                      // Auto-Box if Int (Promoted Register Variable)
-                      if (ctx->lastExprType == TYPE_INT) {
-                          // CVTSI2SD XMM0, RAX
-                          Asm_Emit8(as, 0xF2); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x2A); Asm_Emit8(as, 0xC0);
-                          // MOVQ RAX, XMM0
-                          Asm_Emit8(as, 0x66); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x7E); Asm_Emit8(as, 0xC0);
-                          ctx->lastExprType = TYPE_DOUBLE;
-                      }
+                      // Boxed Val, or the typed element's form -> RAX
+                      ArrayKind kind = arrayKindOf(ctx, get->object);
+                      emitAs(as, ctx, call->args[0], arrayElementType(kind));
                       
                       Asm_Mov_Reg_Reg(as, RSI, RAX); 
                       Asm_Pop(as, RDI); ctx->stackSize -= 8; // Arr -> RDI
                       
-                      void* ptr = (void*)Runtime_ArrayPush;
-                      Asm_Mov_Reg_Ptr(as, RAX, ptr);
-                      Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xEC); Asm_Emit8(as, 0x08);
-                      Asm_Call_Reg(as, RAX);
-                      Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xC4); Asm_Emit8(as, 0x08);
+                      if (kind == ARRAY_VALUE) {
+                          emitCallAbsolute(as, ctx, (void*)Runtime_ArrayPush);
+                      } else {
+                          Asm_Mov_Imm64(as, RDX, kind);
+                          emitCallAbsolute(as, ctx, (void*)Runtime_ArrayPushRaw);
+                      }
                       
                       // Void return
                       Asm_Mov_Imm64(as, RAX, VAL_NULL);
@@ -898,50 +3346,55 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
                       
                       Asm_Mov_Reg_Reg(as, RDI, RAX);
                       
-                      void* ptr = (void*)Runtime_ArrayPop;
-                      Asm_Mov_Reg_Ptr(as, RAX, ptr);
-                      Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xEC); Asm_Emit8(as, 0x08);
-                      Asm_Call_Reg(as, RAX);
-                      Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xC4); Asm_Emit8(as, 0x08);
+                      emitCallAbsolute(as, ctx, (void*)Runtime_ArrayPop);
+                      ctx->lastExprType = TYPE_UNKNOWN;
                       break;
                  }
                  else if (get->name.length == 6 && memcmp(get->name.start, "length", 6) == 0) {
                       emitNode(as, get->object, ctx); // Array Value (Boxed)
                       
-                      Asm_Call_Reg(as, RAX);
-                      Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xC4); Asm_Emit8(as, 0x08);
-                      
-                      // Result is (int) in RAX. 
-                      // Convert Int32 (EAX) to Double (XMM0).
-                      // CVTSI2SD XMM0, EAX (No REX.W)
-                      // F2 0F 2A C0
                       // Unbox Array
                       Asm_Mov_Imm64(as, RCX, 0xFFFFFFFFFFFF);
                       Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x21); Asm_Emit8(as, 0xC8);
                       
                       Asm_Mov_Reg_Reg(as, RDI, RAX); // Array object in RDI
                       
-                      void* ptr = (void*)Runtime_ArrayLength; // Correct runtime function
-                      Asm_Mov_Reg_Ptr(as, RAX, ptr);
-                      Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xEC); Asm_Emit8(as, 0x08); // SUB RSP, 8
-                      Asm_Call_Reg(as, RAX);
-                      Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xC4); Asm_Emit8(as, 0x08); // ADD RSP, 8
+                      emitCallAbsolute(as, ctx, (void*)Runtime_ArrayLength);
                       
-                      // Result is (int) in RAX. 
-                      // Convert Int32 (EAX) to Double (XMM0).
-                      // CVTSI2SD XMM0, EAX (No REX.W)
-                      // F2 0F 2A C0
-                      Asm_Emit8(as, 0xF2); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x2A); Asm_Emit8(as, 0xC0); 
-                      // MOVQ RAX, XMM0
-                      Asm_Emit8(as, 0x66); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x7E); Asm_Emit8(as, 0xC0); 
-                      
-                      ctx->lastExprType = TYPE_DOUBLE; // Boxed Integer is technically a Double in logic
+                      // Result is (int) in EAX: sign-extend to a raw int64
+                      // MOVSXD RAX, EAX
+                      Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x63); Asm_Emit8(as, 0xC0);
+                      ctx->lastExprType = TYPE_INT;
                       break;
                  }
             }
 
             // 1. Resolve Function
-            // Default Call Logic
+            // print(value) -> Native_Print
+            if (call->callee->type == NODE_LITERAL_EXPR &&
+                ((LiteralExpr*)call->callee)->token.type == TOKEN_PRINT) {
+                 if (call->argCount > 0) emitAs(as, ctx, call->args[0], TYPE_UNKNOWN);
+                 else Asm_Mov_Imm64(as, RAX, VAL_NULL);
+                 Asm_Mov_Reg_Reg(as, RDI, RAX);
+                 emitCallAbsolute(as, ctx, (void*)Native_Print);
+                 Asm_Mov_Imm64(as, RAX, VAL_NULL);
+                 ctx->lastExprType = TYPE_UNKNOWN;
+                 break;
+            }
+            
+            // Statically known function: direct CALL rel32
+            GlobalFunction* direct = resolveDirectCallee(ctx, call->callee);
+            if (direct) {
+                 InlineScan scan;
+                 if (isInlineCandidate(ctx, direct->decl, &scan)) {
+                     emitInlineCall(as, ctx, direct, call, &scan);
+                 } else {
+                     emitCallDirect(as, ctx, direct, call);
+                 }
+                 break;
+            }
+            
+            // Default Call Logic (callee is a runtime value)
             if (call->callee->type == NODE_LITERAL_EXPR) {
                  // ... (Rest of logic truncated/restored conceptually? No, I must match what was overwritten)
                  // The damage pasted 'Resolve Function' logic.
@@ -954,7 +3407,7 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
                  
                  // Args ...
                  for (int i = call->argCount - 1; i >= 0; i--) {
-                    emitNode(as, call->args[i], ctx);
+                    emitAs(as, ctx, call->args[i], TYPE_UNKNOWN);
                     Asm_Push(as, RAX);
                     ctx->stackSize += 8;
                  }
@@ -977,9 +3430,7 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
                  ctx->stackSize -= 8;
                  
                  // Call
-                 Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xEC); Asm_Emit8(as, 0x08);
-                 Asm_Call_Reg(as, R10);
-                 Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xC4); Asm_Emit8(as, 0x08);
+                 emitCallRegister(as, ctx, R10);
                  
                  ctx->lastExprType = TYPE_UNKNOWN;
             }
@@ -996,15 +3447,10 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
         case NODE_SET_EXPR: {
             SetExpr* set = (SetExpr*)node;
             
-            emitNode(as, set->object, ctx);
-            Asm_Push(as, RAX);
-            
-            emitNode(as, set->value, ctx);
-            ValueType valType = ctx->lastExprType;
-            
             int offset = -1;
             int fSize = 8; 
             int isPtr = 0;
+            ValueType fieldType = TYPE_UNKNOWN;
             
             if (set->object->type == NODE_LITERAL_EXPR) {
                 LiteralExpr* lit = (LiteralExpr*)set->object;
@@ -1014,6 +3460,7 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
                     StructInfo* info = resolveStruct(&typeToken);
                     if (info) {
                         offset = getPackedFieldInfo(info, &set->name, &fSize, &isPtr);
+                        fieldType = isPtr ? TYPE_UNKNOWN : structFieldType(info, &set->name);
                     }
                 }
             }
@@ -1023,7 +3470,15 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
                  exit(1);
             }
             
+            emitNode(as, set->object, ctx);
+            Asm_Push(as, RAX);
+            ctx->stackSize += 8;
+            
+            // Convert to the field's storage representation
+            emitAs(as, ctx, set->value, fieldType);
+            
             Asm_Pop(as, RCX);
+            ctx->stackSize -= 8;
             
             Asm_Mov_Imm64(as, RDX, 0x0000FFFFFFFFFFFF);
             Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x21); Asm_Emit8(as, 0xD1); 
@@ -1038,89 +3493,57 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
                 Asm_Mov_Mem_Reg(as, RCX, offset, RAX);
             }
             
-            ctx->lastExprType = valType;
+            ctx->lastExprType = fieldType;
             break;
         }
 
         case NODE_BINARY_EXPR: {
-            BinaryExpr* bin = (BinaryExpr*)node;
-
-            if (bin->op.type == TOKEN_PLUS || bin->op.type == TOKEN_MINUS || 
-                bin->op.type == TOKEN_STAR || bin->op.type == TOKEN_SLASH) {
-                
-                // 1. Emit Left
-                emitNode(as, bin->left, ctx);
-                Asm_Push(as, RAX); // Save Left
-                
-                // 2. Emit Right
-                emitNode(as, bin->right, ctx);
-                // Right in RAX
-                
-                Asm_Pop(as, RCX); // Left in RCX
-                
-                // For this validation fix, assuming simple Integer Arithmetic for now to pass compilation and basic tests.
-                // In a real implementation, we would check types (INT vs DOUBLE) and dispatch.
-                // Since this is "Fix Syntax", we restore the basic Integer path which is safe for compilation.
-                
-                if (bin->op.type == TOKEN_PLUS) {
-                    Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x01); Asm_Emit8(as, 0xC8); // ADD RAX, RCX
-                } else if (bin->op.type == TOKEN_MINUS) {
-                    Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x29); Asm_Emit8(as, 0xC1); // SUB RCX, RAX
-                    Asm_Mov_Reg_Reg(as, RAX, RCX);
-                } else if (bin->op.type == TOKEN_STAR) {
-                    Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0xAF); Asm_Emit8(as, 0xC1); // IMUL RAX, RCX
-                } else if (bin->op.type == TOKEN_SLASH) {
-                    Asm_Push(as, RAX); // Save Right
-                    Asm_Mov_Reg_Reg(as, RAX, RCX); // RAX = Left
-                    Asm_Pop(as, RCX); // RCX = Right
-                    Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x99); // CQO
-                    Asm_Emit8(as, 0x48); Asm_Emit8(as, 0xF7); Asm_Emit8(as, 0xF9); // IDIV RCX
-                }
-                ctx->lastExprType = TYPE_INT;
-            } else if (bin->op.type == TOKEN_LESS || bin->op.type == TOKEN_GREATER || 
-                       bin->op.type == TOKEN_LESS_EQUAL || bin->op.type == TOKEN_GREATER_EQUAL ||
-                       bin->op.type == TOKEN_EQUAL_EQUAL || bin->op.type == TOKEN_BANG_EQUAL) {
-                       
-                 emitNode(as, bin->left, ctx);
-                 Asm_Push(as, RAX);
-                 emitNode(as, bin->right, ctx);
-                 Asm_Pop(as, RCX); // Left in RCX, Right in RAX
-                 
-                 // CMP RCX, RAX
-                 Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x39); Asm_Emit8(as, 0xC1);
-                 
-                 Asm_Mov_Imm64(as, RAX, 0);
-                 if (bin->op.type == TOKEN_EQUAL_EQUAL) { Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x94); Asm_Emit8(as, 0xC0); }
-                 else if (bin->op.type == TOKEN_BANG_EQUAL) { Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x95); Asm_Emit8(as, 0xC0); }
-                 else if (bin->op.type == TOKEN_LESS) { Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x9C); Asm_Emit8(as, 0xC0); }
-                 else if (bin->op.type == TOKEN_GREATER) { Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x9F); Asm_Emit8(as, 0xC0); }
-                 else if (bin->op.type == TOKEN_LESS_EQUAL) { Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x9E); Asm_Emit8(as, 0xC0); }
-                 else if (bin->op.type == TOKEN_GREATER_EQUAL) { Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x9D); Asm_Emit8(as, 0xC0); }
-                 
-                 ctx->lastExprType = TYPE_BOOLEAN;
-            }
+            emitBinaryExpr(as, ctx, (BinaryExpr*)node);
             break;
         }
 
         case NODE_UNARY_EXPR: {
             UnaryExpr* unary = (UnaryExpr*)node;
-            emitNode(as, unary->right, ctx);
-            // RAX has operand
             
             if (unary->op.type == TOKEN_MINUS) {
-                // Negate Number
-                Asm_Emit8(as, 0x66); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x6E); Asm_Emit8(as, 0xC0); // MOVQ XMM0, RAX
-                Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x57); Asm_Emit8(as, 0xC9); // XORPS XMM1, XMM1 (0.0)
-                Asm_Emit8(as, 0xF2); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x5C); Asm_Emit8(as, 0xC8); // SUBSD XMM1, XMM0
-                Asm_Emit8(as, 0x66); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x7E); Asm_Emit8(as, 0xC8); // MOVQ RAX, XMM1
+                emitNode(as, unary->right, ctx);
+                if (isIntegralType(ctx->lastExprType)) {
+                    Asm_Neg_Reg(as, RAX);
+                } else if (ctx->lastExprType == TYPE_FLOAT) {
+                    // Flip the single-precision sign bit
+                    Asm_Mov_Imm64(as, RCX, 0x80000000);
+                    Asm_Xor_Reg_Reg(as, RAX, RCX);
+                } else {
+                    // Negate Number (flip the double sign bit)
+                    emitConvert(as, ctx->lastExprType, TYPE_DOUBLE);
+                    Asm_Mov_Imm64(as, RCX, SIGN_BIT);
+                    Asm_Xor_Reg_Reg(as, RAX, RCX);
+                    ctx->lastExprType = TYPE_DOUBLE;
+                }
             } 
             else if (unary->op.type == TOKEN_BANG) {
-                // Not (!)
-                // Result in RAX is VAL_TRUE or VAL_FALSE. No branches.
+                // Not (!) on raw 0/1, no branches
+                emitAs(as, ctx, unary->right, TYPE_BOOLEAN);
+                Asm_Mov_Imm64(as, RCX, 1);
+                Asm_Xor_Reg_Reg(as, RAX, RCX);
             }
             break;
         }
 
+        case NODE_LOGICAL_EXPR: {
+            // Used as a value: the jump chain selects a raw 0/1
+            ConditionJumps falseJumps;
+            emitJumpIfFalse(as, ctx, node, &falseJumps);
+            Asm_Mov_Imm64(as, RAX, 1);
+            size_t endPatch = as->offset + 1;
+            Asm_Jmp(as, 0);
+            patchConditionJumps(as, &falseJumps);
+            Asm_Xor_Reg_Reg(as, RAX, RAX);
+            patchForward(as, endPatch);
+            ctx->lastExprType = TYPE_BOOLEAN;
+            break;
+        }
+
         case NODE_AWAIT_EXPR: {
             // MASTERPLAN: async/await support
             // MVP: Execute expression synchronously (full async requires event loop integration)
@@ -1133,23 +3556,9 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
 
         case NODE_IF_STMT: {
             IfStmt* stmt = (IfStmt*)node;
-            // 1. Compile Condition
-            // 2. Check Result
-            if (ctx->lastExprType == TYPE_BOOLEAN) {
-                 // Raw 0/1 (0=False, 1=True)
-                 Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x85); Asm_Emit8(as, 0xC0); // TEST RAX, RAX
-                 // JE elseBranch (Jump if Zero/False)
-            } else {
-                 // Boxed Value
-                 // Load VAL_FALSE to RCX.
-                 Asm_Mov_Imm64(as, RCX, VAL_FALSE);
-                 // CMP RAX, RCX
-                 Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x39); Asm_Emit8(as, 0xC8); // CMP RAX, RCX
-                 // JE elseBranch (Jump if Equal to False)
-            }
-            
-            size_t elseJumpPatch = as->offset + 2; // Offset of the displacement bytes (after 0F 84)
-            Asm_Je(as, 0); 
+            // 1. Condition: jumps to the else branch when false
+            ConditionJumps elseJumps;
+            emitJumpIfFalse(as, ctx, stmt->condition, &elseJumps);
             
             // Compile Then
             emitNode(as, stmt->thenBranch, ctx);
@@ -1158,10 +3567,8 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
             size_t endJumpPatch = as->offset + 1; // Offset of displacement (after E9)
             Asm_Jmp(as, 0);
             
-            // Patch JE to here (start of Else)
-            size_t elseStart = as->offset;
-            int32_t jumpDist = (int32_t)(elseStart - (elseJumpPatch + 4));
-            Asm_Patch32(as, elseJumpPatch, jumpDist);
+            // Patch the condition jumps to here (start of Else)
+            patchConditionJumps(as, &elseJumps);
             
             // Compile Else
             if (stmt->elseBranch) {
@@ -1169,7 +3576,7 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
             }
             
             // Patch JMP to here (End)
-            size_t endStart = as->offset;
+            size_t endStart = Asm_Label(as);
             int32_t endDist = (int32_t)(endStart - (endJumpPatch + 4));
             Asm_Patch32(as, endJumpPatch, endDist);
             
@@ -1177,180 +3584,102 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
         }
 
         case NODE_FOR_STMT: {
-            // Direct For Loop with SIMD/Unroll optimization
             ForStmt* forStmt = (ForStmt*)node;
             
-            // Try to detect simple accumulator loop pattern:
-            // for (int i = 0; i < N; i = i + 1) { acc = acc + 1; }
-            int canVectorize = 0;
-            int64_t loopLimit = 0;
-            
-            // Check condition: i < LITERAL
-            if (forStmt->condition && forStmt->condition->type == NODE_BINARY_EXPR) {
-                BinaryExpr* condBin = (BinaryExpr*)forStmt->condition;
-                if (condBin->op.type == TOKEN_LESS && condBin->right->type == NODE_LITERAL_EXPR) {
-                    LiteralExpr* limitLit = (LiteralExpr*)condBin->right;
-                    if (limitLit->token.type == TOKEN_NUMBER) {
-                        char buf[64];
-                        int len = limitLit->token.length < 63 ? limitLit->token.length : 63;
-                        for (int j = 0; j < len; j++) buf[j] = limitLit->token.start[j];
-                        buf[len] = '\0';
-                        loopLimit = (int64_t)strtod(buf, NULL);
-                        
-                        // Check if body is block with single assignment: { acc = acc + 1; }
-                        if (forStmt->body && forStmt->body->type == NODE_BLOCK) {
-                            BlockStmt* block = (BlockStmt*)forStmt->body;
-                            if (block->count == 1 && block->statements[0]->type == NODE_ASSIGNMENT_EXPR) {
-                                AssignmentExpr* assign = (AssignmentExpr*)block->statements[0];
-                                if (assign->value->type == NODE_BINARY_EXPR) {
-                                    BinaryExpr* addExpr = (BinaryExpr*)assign->value;
-                                    if (addExpr->op.type == TOKEN_PLUS && 
-                                        addExpr->right->type == NODE_LITERAL_EXPR) {
-                                        // Pattern matched!
-                                        canVectorize = (loopLimit >= 8);
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
+            // 1. Emit initializer if present
+            if (forStmt->initializer) {
+                emitNode(as, forStmt->initializer, ctx);
             }
             
-            if (canVectorize && loopLimit >= 1000000) {
-                // ========== AVX VECTORIZED INTEGER LOOP ==========
-                // Uses VPADDD to add 8 integers per iteration
-                
-                // Emit initializer (int i = 0, int accumulator = 0)
-                if (forStmt->initializer) {
-                    emitNode(as, forStmt->initializer, ctx);
-                }
-                
-                // Get accumulator variable info from body
-                BlockStmt* bodyBlock = (BlockStmt*)forStmt->body;
-                AssignmentExpr* assign = (AssignmentExpr*)bodyBlock->statements[0];
-                
-                // Load accumulator into RBX (initial value)
-                Token accType;
-                int accReg = -1;
-                int accOffset = resolveLocal(ctx, &assign->name, &accType, &accReg, NULL);
-                
-                if (accOffset > 0) {
-                    Asm_Mov_Reg_Mem(as, RBX, RBP, -accOffset);
-                } else if (accReg != -1) {
-                    Asm_Mov_Reg_Reg(as, RBX, (Register)accReg);
-                }
-                
-                // Load iteration count into RCX (will decrement by 128 each loop)
-                Asm_Mov_Imm64(as, RCX, loopLimit);
-                
-                // ========== 128x UNROLLED LOOP (OPTIMAL) ==========
-                // Best performance: 832M ops/sec
-                
-                size_t loopStart = as->offset;
-                
-                // ADD RBX, 128 (accumulator += 128)
-                Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x81); Asm_Emit8(as, 0xC3); // ADD RBX, imm32
-                Asm_Emit8(as, 0x80); Asm_Emit8(as, 0x00); Asm_Emit8(as, 0x00); Asm_Emit8(as, 0x00); // 128
-                
-                // SUB RCX, 128
-                Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x81); Asm_Emit8(as, 0xE9); // SUB RCX, imm32
-                Asm_Emit8(as, 0x80); Asm_Emit8(as, 0x00); Asm_Emit8(as, 0x00); Asm_Emit8(as, 0x00); // 128
-                
-                // JNZ loop (short jump)
-                int32_t jumpDist = (int32_t)(loopStart - (as->offset + 2));
-                if (jumpDist >= -128) {
-                    Asm_Emit8(as, 0x75);  // JNZ rel8
-                    Asm_Emit8(as, (uint8_t)jumpDist);
-                } else {
-                    Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x85);  // JNZ rel32
-                    int32_t backJump = (int32_t)(loopStart - (as->offset + 4));
-                    Asm_Emit8(as, (backJump) & 0xFF);
-                    Asm_Emit8(as, (backJump >> 8) & 0xFF);
-                    Asm_Emit8(as, (backJump >> 16) & 0xFF);
-                    Asm_Emit8(as, (backJump >> 24) & 0xFF);
-                }
-                
-                // Store final accumulator value back
-                if (accOffset > 0) {
-                    Asm_Mov_Mem_Reg(as, RBP, -accOffset, RBX);
-                } else if (accReg != -1) {
-                    Asm_Mov_Reg_Reg(as, (Register)accReg, RBX);
-                }
-                
-            } else {
-                // ========== ORIGINAL SCALAR LOOP ==========
-                // 1. Emit initializer if present
-                if (forStmt->initializer) {
-                    emitNode(as, forStmt->initializer, ctx);
+            // Tiered functions: the baseline counts this loop's backedges,
+            // the optimized code can be entered here from the baseline frame
+            TierLoop* tierLoop = NULL;
+            if (ctx->tierFn && ctx->baseline) {
+                tierLoop = recordTierLoop(ctx, forStmt);
+            } else if (ctx->tierFn) {
+                emitOsrEntry(as, ctx, forStmt);
+            }
+            
+            // Counted loop over an array: its a[i] accesses skip the bounds check
+            int savedInBoundsCount = ctx->inBoundsCount;
+            Token countedIndex, countedArray;
+            if (ctx->inBoundsCount < MAX_IN_BOUNDS &&
+                Licm_FindCountedArrayLoop(forStmt, &countedIndex, &countedArray)) {
+                Local* index = findLocal(ctx, &countedIndex);
+                Local* array = findLocal(ctx, &countedArray);
+                if (index && array && isIntegralType(index->internalType)) {
+                    ctx->inBounds[ctx->inBoundsCount].array = array;
+                    ctx->inBounds[ctx->inBoundsCount].index = index;
+                    ctx->inBoundsCount++;
                 }
-                
-                // 2. Loop start
-                size_t loopStart = as->offset;
-                
-                // 3. Condition check
-                size_t loopEndPatch = 0;
-                int fused = 0;
-                
+            }
+            
+            // Element-wise array loops get a SIMD body first; the scalar
+            // loop below then doubles as the remainder epilogue.
+            VectorLoop vectorLoop;
+            if (!ctx->baseline && analyzeVectorLoop(ctx, forStmt, &vectorLoop)) {
+                emitVectorLoop(as, ctx, forStmt, &vectorLoop);
+            }
+            
+            // Loop-invariant code motion. The preheader only runs once the
+            // condition has passed, so a loop that never iterates never
+            // evaluates the hoisted expressions.
+            AstNode* invariants[LICM_MAX_INVARIANTS];
+            int invariantCount = ctx->baseline ? 0 : Licm_FindInvariants(forStmt, invariants, LICM_MAX_INVARIANTS);
+            if (ctx->localCount + invariantCount > MAX_LOCALS) invariantCount = 0;
+            int savedLocalCount = ctx->localCount;
+            int savedInvariantCount = ctx->invariantCount;
+            int savedStackSize = ctx->stackSize;
+            ConditionJumps guardJumps = { 0 };
+            if (invariantCount > 0) {
                 if (forStmt->condition) {
-                    // OPTIMIZATION: Fused Compare-Branch for TOKEN_LESS
-                    if (forStmt->condition->type == NODE_BINARY_EXPR) {
-                        BinaryExpr* bin = (BinaryExpr*)forStmt->condition;
-                        if (bin->op.type == TOKEN_LESS) {
-                            emitNode(as, bin->left, ctx);
-                            int rightSimple = (bin->right->type == NODE_LITERAL_EXPR);
-                            if (rightSimple) {
-                                Asm_Mov_Reg_Reg(as, R10, RAX);
-                                emitNode(as, bin->right, ctx);
-                            } else {
-                                Asm_Push(as, RAX);
-                                emitNode(as, bin->right, ctx);
-                                Asm_Pop(as, R10);
-                            }
-                            // XMM1 = Right, XMM0 = Left
-                            Asm_Emit8(as, 0x66); Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x6E); Asm_Emit8(as, 0xC8);
-                            Asm_Emit8(as, 0x66); Asm_Emit8(as, 0x49); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x6E); Asm_Emit8(as, 0xC2);
-                            
-                            // UCOMISD XMM0, XMM1
-                            Asm_Emit8(as, 0x66); Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x2E); Asm_Emit8(as, 0xC1);
-                            
-                            // JAE (jump if >= to end)
-                            Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x83);
-                            loopEndPatch = as->offset;
-                            Asm_Emit8(as, 0x00); Asm_Emit8(as, 0x00); Asm_Emit8(as, 0x00); Asm_Emit8(as, 0x00);
-                            
-                            fused = 1;
-                        }
-                    }
-                    
-                    if (!fused) {
-                        emitNode(as, forStmt->condition, ctx);
-                        Asm_Mov_Imm64(as, RCX, VAL_FALSE);
-                        Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x39); Asm_Emit8(as, 0xC8); // CMP RAX, RCX
-                        Asm_Emit8(as, 0x0F); Asm_Emit8(as, 0x84); // JE rel32
-                        loopEndPatch = as->offset;
-                        Asm_Emit8(as, 0x00); Asm_Emit8(as, 0x00); Asm_Emit8(as, 0x00); Asm_Emit8(as, 0x00);
-                    }
+                    emitJumpIfFalse(as, ctx, forStmt->condition, &guardJumps);
                 }
-                
-                // 4. Loop body
-                emitNode(as, forStmt->body, ctx);
-                
-                // 5. Increment
-                if (forStmt->increment) {
-                    emitNode(as, forStmt->increment, ctx);
+                for (int i = 0; i < invariantCount; i++) {
+                    hoistInvariant(as, ctx, invariants[i]);
                 }
-                
-                // 6. Jump back to loop start
+            }
+            
+            // 2. Loop start (scalar)
+            size_t loopStart = Asm_Label(as);
+            
+            // 3. Condition check, branching on the compare flags
+            ConditionJumps loopEndJumps = { 0 };
+            
+            if (forStmt->condition) {
+                emitJumpIfFalse(as, ctx, forStmt->condition, &loopEndJumps);
+            }
+            
+            // 4. Loop body
+            emitNode(as, forStmt->body, ctx);
+            
+            // 5. Increment
+            if (forStmt->increment) {
+                emitStatement(as, ctx, forStmt->increment);
+            }
+            
+            // 6. Jump back to loop start
+            if (tierLoop) {
+                emitBackedgeCounter(as, ctx, tierLoop, loopStart);
+            } else {
                 int32_t backOffset = loopStart - (as->offset + 5);
                 Asm_Jmp(as, backOffset);
-                
-                // 7. Patch the loop end jump
-                if (loopEndPatch != 0) {
-                    size_t loopEnd = as->offset;
-                    int32_t forwardOffset = loopEnd - (loopEndPatch + 4);
-                    Asm_Patch32(as, loopEndPatch, forwardOffset);
+            }
+            
+            // 7. Patch the loop end jumps
+            patchConditionJumps(as, &loopEndJumps);
+            
+            // 8. Drop the hoisted values
+            if (invariantCount > 0) {
+                if (ctx->stackSize > savedStackSize) {
+                    Asm_Add_Reg_Imm(as, RSP, ctx->stackSize - savedStackSize);
                 }
+                patchConditionJumps(as, &guardJumps);
+                ctx->stackSize = savedStackSize;
+                ctx->localCount = savedLocalCount;
+                ctx->invariantCount = savedInvariantCount;
             }
+            ctx->inBoundsCount = savedInBoundsCount;
             
             break;
         }
@@ -1394,116 +3723,15 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
             // `Jit_Compile` calls `emitNode`.
             // We can manually do what `Jit_Compile` does here.
             
-            void* funcMem = Jit_AllocExec(MAX_JIT_SIZE);
-            Assembler funcAs;
-            Asm_Init(&funcAs, (uint8_t*)funcMem, MAX_JIT_SIZE);
-            
-            // Function Prologue
-            Asm_Push(&funcAs, RBP);
-            Asm_Mov_Reg_Reg(&funcAs, RBP, RSP);
-            
-            // Setup Context for Function
-            CompilerContext funcCtx;
-            funcCtx.localCount = 0;
-            funcCtx.localCount = 0;
-            
-            // ABI: Save Callee-Saved Registers (RBX, R12-R15)
-            Asm_Push(&funcAs, RBX);
-            Asm_Push(&funcAs, R12);
-            Asm_Push(&funcAs, R13);
-            Asm_Push(&funcAs, R14);
-            Asm_Push(&funcAs, R15);
-            funcCtx.stackSize = 40; // 5 regs * 8 bytes
-            
-            // Simple: Spill to stack.
-            // Simple: Spill to stack.
-            // Raw ABI: Check param types to determine source register (GPR or XMM)
-            Register gprRegs[] = { RDI, RSI, RDX, RCX, R8, R9 };
-            int gprCount = 0;
-            int xmmCount = 0;
-            
-            for (int i = 0; i < func->paramCount; i++) {
-                Token type = func->paramTypes[i];
-                int isFloat = 0;
-                
-                if (type.length == 5 && memcmp(type.start, "float", 5) == 0) isFloat = 1;
-                else if (type.length == 6 && memcmp(type.start, "double", 6) == 0) isFloat = 1;
-
-                if (isFloat) {
-                    if (xmmCount < 6) {
-                        // Push XMM[k]. 
-                        // SUB RSP, 8
-                        // MOVSD [RSP], XMMk
-                        // We use MOVSD (double) for storage to keep 8-byte alignment uniformly.
-                        Asm_Emit8(&funcAs, 0x48); Asm_Emit8(&funcAs, 0x83); Asm_Emit8(&funcAs, 0xEC); Asm_Emit8(&funcAs, 0x08);
-                        
-                        // MOVSD [RSP], XMM
-                        // F2 0F 11 04 24 (if XMM0)
-                        // ModRM: 00 xxx 100(SIB) ... 24
-                        // Simpler: MOVQ [RSP], XMMk (66 48 0F 7E /r)
-                        // Dest is Mem.
-                        uint8_t modrm = 0x04 + (xmmCount << 3); 
-                        // SIB for RSP is 0x24 (Scale=1, Index=None, Base=RSP)
-                        
-                        // Let's use Asm_Mov_Mem_Reg? No that's GPR.
-                        // Manual XMM store:
-                        // MOVQ [RSP], XMMk
-                        Asm_Emit8(&funcAs, 0x66); Asm_Emit8(&funcAs, 0x48); Asm_Emit8(&funcAs, 0x0F); Asm_Emit8(&funcAs, 0x7E); 
-                        // ModRM: 00(Mode) Reg(XMM) RM(RSP=100 -> SIB)
-                        // Reg=xmmCount. RM=4.
-                        Asm_Emit8(&funcAs, modrm);
-                        // SIB: 00 100 100 = 0x24
-                        Asm_Emit8(&funcAs, 0x24);
-                        
-                        xmmCount++;
-                    } else {
-                        // Stack overflow
-                        Asm_Push(&funcAs, RAX); // Placeholder
-                    }
-                } else {
-                    // Int/Ptr
-                    if (gprCount < 6) {
-                        Asm_Push(&funcAs, gprRegs[gprCount++]);
-                    } else {
-                        Asm_Push(&funcAs, RAX); // Stack overflow
-                    }
-                }
-                
-                funcCtx.stackSize += 8;
-                Local* local = &funcCtx.locals[funcCtx.localCount++];
-                local->name = func->params[i];
-                local->typeName = func->paramTypes[i]; 
-                local->offset = funcCtx.stackSize;
-            }
-            
-            // Align Stack to 16 bytes for body execution (CALLs)
-            if (funcCtx.stackSize % 16 != 0) {
-                 Asm_Emit8(&funcAs, 0x48); Asm_Emit8(&funcAs, 0x83); Asm_Emit8(&funcAs, 0xEC); Asm_Emit8(&funcAs, 0x08); // SUB RSP, 8
-                 funcCtx.stackSize += 8;
-                 // Note: This padding is not registered as a local variable, just dead space.
+            GlobalFunction* compiled = findGlobalEntry(func->name.start, func->name.length);
+            void* funcMem;
+            if (compiled && compiled->precompiled == func) {
+                funcMem = compiled->address;
+                compiled->precompiled = NULL;
+            } else {
+                funcMem = compileFunction(func, TIER_NONE);
             }
             
-            // Compile Body
-            emitNode(&funcAs, func->body, &funcCtx);
-
-            
-            // Default Return (if user didn't)
-            Asm_Mov_Imm64(&funcAs, RAX, VAL_NULL); // Default return nil
-            
-            // Epilogue: Restore Regs
-            Asm_Mov_Reg_Reg(&funcAs, RSP, RBP); // Reset stack
-            // SUB RSP, 40 (0x28)
-            Asm_Emit8(&funcAs, 0x48); Asm_Emit8(&funcAs, 0x83); Asm_Emit8(&funcAs, 0xEC); Asm_Emit8(&funcAs, 0x28);
-            
-            Asm_Pop(&funcAs, R15);
-            Asm_Pop(&funcAs, R14);
-            Asm_Pop(&funcAs, R13);
-            Asm_Pop(&funcAs, R12);
-            Asm_Pop(&funcAs, RBX);
-            
-            Asm_Pop(&funcAs, RBP);
-            Asm_Ret(&funcAs);
-            
             // Now we have the function compiled at `funcMem`.
             // CONSTANT POOL/GC TODO: objFunc should be GC tracked.
             ObjFunction* objFunc = malloc(sizeof(ObjFunction));
@@ -1517,48 +3745,52 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
             // Implicit "var name = func..."
             // Push objFunc (pointer) to stack
             Value funcVal = ObjToValue(objFunc);
-            Asm_Mov_Imm64(as, RAX, funcVal);
+            emitPointer(as, ctx, RAX, funcVal, CACHE_RELOC_FUNCTION,
+                        findGlobalEntry(func->name.start, func->name.length));
             Asm_Push(as, RAX);
             ctx->stackSize += 8;
+            reserveLocals(ctx, 1);
             Local* local = &ctx->locals[ctx->localCount++];
             local->name = func->name;
+            local->typeName = (Token){0};
             local->offset = ctx->stackSize;
+            local->reg = -1;
+            local->regClass = REG_CLASS_NONE;
+            local->internalType = TYPE_UNKNOWN;
+            local->invariant = NULL;
             
-            // Protect Executable Memory
-            Jit_ProtectExec(funcMem, MAX_JIT_SIZE);
-
-            // 5. Register Global Function
-            registerGlobalFunction(func->name.start, func->name.length, funcMem);
-
-            // 6. Check for Main
-            if (func->name.length == 4 && memcmp(func->name.start, "Main", 4) == 0) {
-                 mainFunc = funcMem; // Update global
-            }
-
             break;
         }
         
         case NODE_RETURN_STMT: {
             ReturnStmt* stmt = (ReturnStmt*)node;
+            if (ctx->inlineFrame) {
+                // Inlined callee: leave the value in its declared
+                // representation and jump to the common exit
+                InlineFrame* frame = ctx->inlineFrame;
+                if (stmt->returnValue) {
+                    emitAs(as, ctx, stmt->returnValue, frame->returnType);
+                } else if (frame->returnType != TYPE_UNKNOWN) {
+                    emitNumberConstant(as, RAX, 0.0, frame->returnType);
+                } else {
+                    Asm_Mov_Imm64(as, RAX, VAL_NULL);
+                }
+                if (ctx->stackSize > frame->entryStackSize) {
+                    Asm_Add_Reg_Imm(as, RSP, ctx->stackSize - frame->entryStackSize);
+                }
+                frame->exits[frame->exitCount++] = as->offset + 1;
+                Asm_Jmp(as, 0);
+                break;
+            }
+            if (emitTailCall(as, ctx, stmt->returnValue)) break;
             if (stmt->returnValue) {
-                emitNode(as, stmt->returnValue, ctx);
+                // Callers always receive a boxed Value
+                emitAs(as, ctx, stmt->returnValue, TYPE_UNKNOWN);
             } else {
                 Asm_Mov_Imm64(as, RAX, VAL_NULL);
             }
             // Epilogue and Ret
-            // Epilogue and Ret
-            Asm_Mov_Reg_Reg(as, RSP, RBP); // Reset stack
-            // SUB RSP, 40 (0x28)
-            Asm_Emit8(as, 0x48); Asm_Emit8(as, 0x83); Asm_Emit8(as, 0xEC); Asm_Emit8(as, 0x28);
-            
-            Asm_Pop(as, R15);
-            Asm_Pop(as, R14);
-            Asm_Pop(as, R13);
-            Asm_Pop(as, R12);
-            Asm_Pop(as, RBX);
-            
-            Asm_Pop(as, RBP);
-            Asm_Ret(as);
+            emitEpilogue(as, ctx);
             break;
         }
 
@@ -1566,25 +3798,139 @@ static void emitNode(Assembler* as, AstNode* node, CompilerContext* ctx) {
     }
 }
 
+// ==================== PARALLEL COMPILATION ====================
+// With more than one compile thread, Jit_Compile emits the bodies of the
+// declared functions on a worker pool before the top-level pass. Emission
+// only reads the function and struct registries, which are complete after
+// the declaration pre-pass. The bodies are then installed and linked on
+// the calling thread in declaration order, so the code cache layout does
+// not depend on which worker finished first. Functions that declare
+// nested functions, or share their name with another declaration, are
+// left to the top-level pass.
+
+static int compileThreads = 1;
+
+void Jit_SetCompileThreads(int count) {
+    compileThreads = count < 1 ? 1 : count;
+}
+
+typedef struct {
+    EmittedFunction* bodies;
+    int count;
+    int next;               // Next body to claim
+} CompileBatch;
+
+static void collectBatch(AstNode* root, CompileBatch* batch, int* capacity) {
+    if (!root || root->type != NODE_BLOCK) return;
+    BlockStmt* block = (BlockStmt*)root;
+    for (int i = 0; i < block->count; i++) {
+        AstNode* stmt = block->statements[i];
+        if (stmt->type == NODE_BLOCK) {
+            collectBatch(stmt, batch, capacity);
+            continue;
+        }
+        if (stmt->type != NODE_FUNCTION_DECL) continue;
+        FunctionDecl* func = (FunctionDecl*)stmt;
+        if (declaresFunction(func->body)) continue;
+
+        if (batch->count == *capacity) {
+            *capacity = *capacity ? *capacity * 2 : 64;
+            batch->bodies = realloc(batch->bodies, sizeof(EmittedFunction) * *capacity);
+        }
+        EmittedFunction* body = &batch->bodies[batch->count++];
+        body->func = func;
+        body->fn = findGlobalEntry(func->name.start, func->name.length);
+        body->tier = initialTier(func);
+        body->fn->pending++;
+    }
+}
+
+static void* compileWorker(void* arg) {
+    CompileBatch* batch = (CompileBatch*)arg;
+    for (;;) {
+        int i = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED);
+        if (i >= batch->count) return NULL;
+        EmittedFunction* body = &batch->bodies[i];
+        emitFunction(body->func, body->fn, body->tier, body);
+    }
+}
+
+static void compileInParallel(AstNode* root) {
+    CompileBatch batch = {0};
+    int capacity = 0;
+    collectBatch(root, &batch, &capacity);
+
+    // Drop names declared twice; the top-level pass decides which body wins
+    int kept = 0;
+    for (int i = 0; i < batch.count; i++) {
+        if (batch.bodies[i].fn->pending == 1) batch.bodies[kept++] = batch.bodies[i];
+    }
+    for (int i = 0; i < globalFunctionCount; i++) {
+        if (globalFunctions[i].pending > 1) globalFunctions[i].pending = 0;
+    }
+    batch.count = kept;
+
+    // The calling thread is one of the workers
+    int workerCount = compileThreads < batch.count ? compileThreads : batch.count;
+    pthread_t* workers = malloc(sizeof(pthread_t) * (workerCount + 1));
+    int started = 0;
+    for (int i = 1; i < workerCount; i++) {
+        if (pthread_create(&workers[started], NULL, compileWorker, &batch) != 0) break;
+        started++;
+    }
+    compileWorker(&batch);
+    for (int i = 0; i < started; i++) pthread_join(workers[i], NULL);
+    free(workers);
+
+    uint8_t** entries = malloc(sizeof(uint8_t*) * (batch.count + 1));
+    for (int i = 0; i < batch.count; i++) {
+        batch.bodies[i].fn->pending = 0;
+        batch.bodies[i].fn->precompiled = batch.bodies[i].func;
+        entries[i] = installFunction(&batch.bodies[i]);
+    }
+
+    // Code pointers to other batch members were emitted before they had one
+    for (int i = 0; i < batch.count; i++) {
+        EmittedFunction* body = &batch.bodies[i];
+        for (int r = 0; r < body->relocCount; r++) {
+            if (body->relocs[r].kind != CACHE_RELOC_CODE) continue;
+            void* address = ((const GlobalFunction*)body->relocs[r].target)->address;
+            memcpy(Jit_WritableAddress(entries[i] + body->relocs[r].offset), &address, sizeof(address));
+        }
+        if (!keepCompiledUnits()) free(body->relocs);
+    }
+    free(entries);
+    free(batch.bodies);
+}
+
 JitFunction Jit_Compile(AstNode* root) {
    if (!root) return NULL;
     
     registerGlobalStructs(root);
+    declareGlobalFunctions(root);
+    if (compileThreads > 1) compileInParallel(root);
     
     // Compile Top-Level Block
-    void* mem = Jit_AllocExec(MAX_JIT_SIZE);
     Assembler as;
-    Asm_Init(&as, (uint8_t*)mem, MAX_JIT_SIZE);
+    Asm_InitDynamic(&as, JIT_STAGING_SIZE);
     
     CompilerContext ctx = {0};
     ctx.localCount = 0;
     ctx.stackSize = 0;
+    ctx.cpuFeatures = Cpu_Features();
     
     // Emission
     emitNode(&as, root, &ctx);
+    emitColdStubs(&as, &ctx);
     
-    // Verify Executable
-    Jit_ProtectExec(mem, MAX_JIT_SIZE);
+    // Install and verify executable
+    size_t size = as.offset;
+    void* mem = Jit_InstallCode(as.buffer, size, "<toplevel>", 10);
+    Asm_Free(&as);
+    Debug_RegisterCode(mem, size, "<toplevel>", 10, NULL, NULL, 0);
+    linkCallSites(ctx.callSites, ctx.callSiteCount, mem);
+    free(ctx.callSites);
+    free(ctx.relocs);
     
     if (mainFunc == NULL) {
         fprintf(stderr, "JIT Error: No 'Main' function found.\n");
@@ -1592,3 +3938,325 @@ JitFunction Jit_Compile(AstNode* root) {
     }
     return (JitFunction)mainFunc;
 }
+
+// ==================== PERSISTENT CACHE ====================
+// Jit_StoreCached writes the functions compiled by Jit_Compile (top-level
+// code is never run and is left out); Jit_LoadCached installs them again
+// and rebuilds what their pointers referred to.
+
+static int unitIndex(const GlobalFunction* fn) {
+    for (int i = 0; i < compiledUnitCount; i++) {
+        if (compiledUnits[i].fn == fn) return i;
+    }
+    return -1;
+}
+
+void Jit_StoreCached(const char* source, const char* const* imports, int importCount) {
+    if (!DiskCache_Enabled() || compiledUnitCount == 0) return;
+
+    CacheImage image = {0};
+    image.unitCount = compiledUnitCount;
+    image.units = calloc(compiledUnitCount, sizeof(CacheUnit));
+    int stringCapacity = 16;
+    image.strings = malloc(sizeof(char*) * stringCapacity);
+    image.stringLengths = malloc(sizeof(uint32_t) * stringCapacity);
+    uintptr_t anchor = DiskCache_ImageAnchor();
+    int complete = 1;
+
+    for (int u = 0; u < compiledUnitCount && complete; u++) {
+        CompiledUnit* unit = &compiledUnits[u];
+        CacheReloc* relocs = malloc(sizeof(CacheReloc) * (unit->relocCount + unit->callSiteCount + 1));
+        int count = 0;
+        for (int i = 0; i < unit->relocCount; i++) {
+            Relocation* reloc = &unit->relocs[i];
+            CacheReloc* out = &relocs[count++];
+            out->offset = (uint32_t)reloc->offset;
+            out->kind = reloc->kind;
+            if (reloc->kind == CACHE_RELOC_IMAGE) {
+                out->value = (int64_t)((uintptr_t)reloc->target - anchor);
+            } else if (reloc->kind == CACHE_RELOC_STRING) {
+                if (image.stringCount == stringCapacity) {
+                    stringCapacity *= 2;
+                    image.strings = realloc(image.strings, sizeof(char*) * stringCapacity);
+                    image.stringLengths = realloc(image.stringLengths, sizeof(uint32_t) * stringCapacity);
+                }
+                const ObjString* str = reloc->target;
+                image.strings[image.stringCount] = str->chars;
+                image.stringLengths[image.stringCount] = str->length;
+                out->value = image.stringCount++;
+            } else {
+                out->value = unitIndex(reloc->target);
+                if (out->value < 0) complete = 0;
+            }
+        }
+        for (int i = 0; i < unit->callSiteCount; i++) {
+            CacheReloc* out = &relocs[count++];
+            out->offset = (uint32_t)unit->callSites[i].offset;
+            out->kind = CACHE_RELOC_CALL;
+            out->value = unitIndex(unit->callSites[i].target);
+            if (out->value < 0) complete = 0;
+        }
+
+        CacheUnit* cached = &image.units[u];
+        cached->name = unit->fn->name;
+        cached->nameLength = strlen(unit->fn->name);
+        cached->arity = unit->arity;
+        cached->code = unit->code;
+        cached->size = (uint32_t)unit->size;
+        cached->relocs = relocs;
+        cached->relocCount = count;
+    }
+
+    // A call into something that was never compiled cannot be linked on load
+    if (complete) DiskCache_Store(source, imports, importCount, &image);
+
+    for (int u = 0; u < compiledUnitCount; u++) free((void*)image.units[u].relocs);
+    free(image.units);
+    free(image.strings);
+    free(image.stringLengths);
+}
+
+JitFunction Jit_LoadCached(const char* source) {
+    CacheImage image;
+    if (!DiskCache_Load(source, &image)) return NULL;
+
+    uint8_t** entries = malloc(sizeof(uint8_t*) * image.unitCount);
+    for (int u = 0; u < image.unitCount; u++) {
+        CacheUnit* unit = &image.units[u];
+        entries[u] = Jit_InstallCode(unit->code, unit->size, unit->name, unit->nameLength);
+        Debug_RegisterCode(entries[u], unit->size, unit->name, unit->nameLength, NULL, NULL, 0);
+        registerGlobalFunction(unit->name, unit->nameLength, entries[u]);
+        if (unit->nameLength == 4 && memcmp(unit->name, "Main", 4) == 0) mainFunc = entries[u];
+    }
+
+    // String constants live as long as the program, like compiled ones
+    ObjString** strings = malloc(sizeof(ObjString*) * (image.stringCount + 1));
+    for (int i = 0; i < image.stringCount; i++) {
+        uint32_t len = image.stringLengths[i];
+        strings[i] = malloc(sizeof(ObjString) + len + 1);
+        strings[i]->obj.type = OBJ_STRING;
+        strings[i]->length = len;
+        memcpy(strings[i]->chars, image.strings[i], len);
+        strings[i]->chars[len] = '\0';
+    }
+
+    uintptr_t anchor = DiskCache_ImageAnchor();
+    for (int u = 0; u < image.unitCount; u++) {
+        CacheUnit* unit = &image.units[u];
+        for (int i = 0; i < unit->relocCount; i++) {
+            const CacheReloc* reloc = &unit->relocs[i];
+            uint8_t* field = entries[u] + reloc->offset;
+            uint64_t value = 0;
+            switch ((CacheRelocKind)reloc->kind) {
+                case CACHE_RELOC_CALL:
+                    Jit_PatchRel32(field, entries[reloc->value]);
+                    continue;
+                case CACHE_RELOC_IMAGE:
+                    value = anchor + (uintptr_t)reloc->value;
+                    break;
+                case CACHE_RELOC_CODE:
+                    value = (uintptr_t)entries[reloc->value];
+                    break;
+                case CACHE_RELOC_STRING:
+                    value = ObjToValue(strings[reloc->value]);
+                    break;
+                case CACHE_RELOC_FUNCTION: {
+                    ObjFunction* objFunc = malloc(sizeof(ObjFunction));
+                    objFunc->obj.type = OBJ_FUNCTION;
+                    objFunc->entrypoint = entries[reloc->value];
+                    objFunc->arity = image.units[reloc->value].arity;
+                    objFunc->name = NULL;
+                    value = ObjToValue(objFunc);
+                    break;
+                }
+            }
+            memcpy(Jit_WritableAddress(field), &value, sizeof(value));
+        }
+    }
+
+    free(strings);
+    free(entries);
+    DiskCache_Release(&image);
+    return (JitFunction)mainFunc;
+}
+
+// ==================== OBJECT OUTPUT ====================
+// Jit_WriteObject lays the functions compiled by Jit_Compile out in one
+// .text section. Pointer immediates become RIP-relative (the MOV imm64 is
+// rewritten in place as a 7-byte LEA/MOV plus a 3-byte NOP), so the object
+// links into position-independent executables without text relocations:
+// runtime helpers are PLT32 references to libvanarize.a, string constants
+// and function objects are boxed values in .data.
+
+typedef struct {
+    const void* address;
+    const char* name;
+} RuntimeSymbol;
+
+#define RUNTIME_SYMBOL(fn) { (const void*)fn, #fn }
+
+// Every helper emitCallAbsolute and the cold stubs can reference
+static const RuntimeSymbol runtimeSymbols[] = {
+    RUNTIME_SYMBOL(Runtime_Add),
+    RUNTIME_SYMBOL(Runtime_Equal),
+    RUNTIME_SYMBOL(Runtime_NewTypedArray),
+    RUNTIME_SYMBOL(Runtime_ArrayPush),
+    RUNTIME_SYMBOL(Runtime_ArrayPushRaw),
+    RUNTIME_SYMBOL(Runtime_ArrayPop),
+    RUNTIME_SYMBOL(Runtime_ArrayLength),
+    RUNTIME_SYMBOL(Runtime_ArrayGet),
+    RUNTIME_SYMBOL(Runtime_ArrayGetRaw),
+    RUNTIME_SYMBOL(Runtime_ArraySet),
+    RUNTIME_SYMBOL(Runtime_ArraySetRaw),
+    RUNTIME_SYMBOL(MemAlloc),
+    RUNTIME_SYMBOL(GC_RegisterObject),
+    RUNTIME_SYMBOL(Native_Print),
+};
+
+static const char* runtimeSymbolName(const void* address) {
+    for (size_t i = 0; i < sizeof(runtimeSymbols) / sizeof(runtimeSymbols[0]); i++) {
+        if (runtimeSymbols[i].address == address) return runtimeSymbols[i].name;
+    }
+    return NULL;
+}
+
+void Jit_BeginObject(void) {
+    objectOutput = 1;
+}
+
+// Rewrites the REX.W B8+r imm64 whose immediate is at field as
+// opcode reg, [RIP + disp32] and returns the offset of the disp32
+static size_t rewriteRipRelative(uint8_t* text, size_t field, uint8_t opcode) {
+    size_t insn = field - 2;
+    int reg = (text[insn + 1] - 0xB8) | ((text[insn] & 1) << 3);
+    text[insn] = reg >= R8 ? 0x4C : 0x48;               // REX.W, REX.R for R8-R15
+    text[insn + 1] = opcode;
+    text[insn + 2] = 0x05 | ((reg & 7) << 3);           // ModR/M: RIP + disp32
+    memset(text + insn + 3, 0, 4);
+    text[insn + 7] = 0x0F;                              // NOP DWORD [RAX]
+    text[insn + 8] = 0x1F;
+    text[insn + 9] = 0x00;
+    return insn + 3;
+}
+
+static void patchDisp32(uint8_t* text, size_t field, size_t target) {
+    int32_t disp = (int32_t)((int64_t)target - (int64_t)(field + 4));
+    memcpy(text + field, &disp, sizeof(disp));
+}
+
+// Places object bytes in .data followed by its boxed Value; returns the
+// offset of the object, and of the Value in boxOffset
+static size_t appendBoxedObject(ElfObject* elf, const void* object, size_t size, size_t* boxOffset) {
+    size_t offset = Elf_Append(elf, ELF_SECTION_DATA, object, size, 16);
+    *boxOffset = Elf_Append(elf, ELF_SECTION_DATA, NULL, sizeof(Value), 8);
+    Elf_AddReloc(elf, ELF_SECTION_DATA, *boxOffset, R_X86_64_64, ELF_SYMBOL_DATA, (int64_t)(offset | QNAN));
+    return offset;
+}
+
+int Jit_WriteObject(const char* path) {
+    if (compiledUnitCount == 0) {
+        fprintf(stderr, "JIT Error: Nothing was compiled for the object file.\n");
+        return 0;
+    }
+
+    ElfObject elf;
+    Elf_Init(&elf);
+    size_t* starts = malloc(sizeof(size_t) * compiledUnitCount);
+    for (int u = 0; u < compiledUnitCount; u++) {
+        starts[u] = Elf_Append(&elf, ELF_SECTION_TEXT, compiledUnits[u].code, compiledUnits[u].size, JIT_CODE_ALIGNMENT);
+    }
+
+    int ok = 1;
+    for (int u = 0; u < compiledUnitCount && ok; u++) {
+        CompiledUnit* unit = &compiledUnits[u];
+        uint8_t* text = elf.contents[ELF_SECTION_TEXT].data;
+        int unresolved = 0;
+
+        size_t nameLength = strlen(unit->fn->name) + 6;
+        char* symbol = malloc(nameLength);
+        snprintf(symbol, nameLength, "Vana_%s", unit->fn->name);
+        Elf_DefineSymbol(&elf, symbol, ELF_SECTION_TEXT, starts[u], unit->size);
+        free(symbol);
+
+        for (int i = 0; i < unit->relocCount && ok && !unresolved; i++) {
+            Relocation* reloc = &unit->relocs[i];
+            size_t field = starts[u] + reloc->offset;
+            switch (reloc->kind) {
+                case CACHE_RELOC_IMAGE: {
+                    const char* name = runtimeSymbolName(reloc->target);
+                    if (!name) {
+                        fprintf(stderr, "JIT Error: Function '%s' calls a helper that cannot be linked ahead of time.\n",
+                                unit->fn->name);
+                        ok = 0;
+                        break;
+                    }
+                    size_t disp = rewriteRipRelative(text, field, 0x8D);   // LEA
+                    Elf_AddReloc(&elf, ELF_SECTION_TEXT, disp, R_X86_64_PLT32, Elf_ImportSymbol(&elf, name), -4);
+                    break;
+                }
+                case CACHE_RELOC_CODE: {
+                    int target = unitIndex(reloc->target);
+                    if (target < 0) {
+                        unresolved = 1;
+                        break;
+                    }
+                    size_t disp = rewriteRipRelative(text, field, 0x8D);   // LEA
+                    patchDisp32(text, disp, starts[target]);
+                    break;
+                }
+                case CACHE_RELOC_STRING: {
+                    const ObjString* str = reloc->target;
+                    size_t size = sizeof(ObjString) + str->length + 1;
+                    ObjString* copy = calloc(1, size);
+                    copy->obj.type = OBJ_STRING;
+                    copy->length = str->length;
+                    memcpy(copy->chars, str->chars, str->length + 1);
+                    size_t box;
+                    appendBoxedObject(&elf, copy, size, &box);
+                    free(copy);
+                    size_t disp = rewriteRipRelative(text, field, 0x8B);   // MOV load
+                    Elf_AddReloc(&elf, ELF_SECTION_TEXT, disp, R_X86_64_PC32, ELF_SYMBOL_DATA, (int64_t)box - 4);
+                    break;
+                }
+                case CACHE_RELOC_FUNCTION: {
+                    int target = unitIndex(reloc->target);
+                    if (target < 0) {
+                        unresolved = 1;
+                        break;
+                    }
+                    ObjFunction objFunc = {0};
+                    objFunc.obj.type = OBJ_FUNCTION;
+                    objFunc.arity = compiledUnits[target].arity;
+                    size_t box;
+                    size_t offset = appendBoxedObject(&elf, &objFunc, sizeof(objFunc), &box);
+                    Elf_AddReloc(&elf, ELF_SECTION_DATA, offset + offsetof(ObjFunction, entrypoint),
+                                 R_X86_64_64, ELF_SYMBOL_TEXT, (int64_t)starts[target]);
+                    size_t disp = rewriteRipRelative(text, field, 0x8B);   // MOV load
+                    Elf_AddReloc(&elf, ELF_SECTION_TEXT, disp, R_X86_64_PC32, ELF_SYMBOL_DATA, (int64_t)box - 4);
+                    break;
+                }
+                case CACHE_RELOC_CALL:
+                    break;
+            }
+        }
+
+        // Direct calls between functions are resolved within .text
+        for (int i = 0; i < unit->callSiteCount && !unresolved; i++) {
+            int target = unitIndex(unit->callSites[i].target);
+            if (target < 0) unresolved = 1;
+            else patchDisp32(text, starts[u] + unit->callSites[i].offset, starts[target]);
+        }
+        if (unresolved) {
+            fprintf(stderr, "JIT Error: Function '%s' refers to code that was not compiled.\n", unit->fn->name);
+            ok = 0;
+        }
+    }
+
+    if (ok && !Elf_Write(&elf, path)) {
+        fprintf(stderr, "JIT Error: Could not write object file \"%s\".\n", path);
+        ok = 0;
+    }
+    free(starts);
+    Elf_Free(&elf);
+    return ok;
+}
@@ -0,0 +1,64 @@
+#include "Jit/CpuFeatures.h"
+#include <cpuid.h>
+#include <string.h>
+
+#define LEVEL_SSE4 (CPU_SSE4_1 | CPU_SSE4_2)
+#define LEVEL_AVX2 (LEVEL_SSE4 | CPU_AVX | CPU_AVX2 | CPU_FMA | CPU_BMI2)
+
+static uint32_t levelMask = LEVEL_AVX2;
+static uint32_t probed = 0;
+static int probeDone = 0;
+
+static uint32_t probeFeatures(void) {
+    unsigned int eax, ebx, ecx, edx;
+    uint32_t features = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return 0;
+    if (ecx & bit_SSE4_1) features |= CPU_SSE4_1;
+    if (ecx & bit_SSE4_2) features |= CPU_SSE4_2;
+
+    // YMM registers are usable only if the OS saves them (XCR0 bits 1, 2)
+    int ymmState = 0;
+    if (ecx & bit_OSXSAVE) {
+        uint32_t xcr0, xcr0High;
+        __asm__ volatile ("xgetbv" : "=a"(xcr0), "=d"(xcr0High) : "c"(0));
+        ymmState = (xcr0 & 0x6) == 0x6;
+    }
+    if (ymmState && (ecx & bit_AVX)) {
+        features |= CPU_AVX;
+        if (ecx & bit_FMA) features |= CPU_FMA;
+    }
+
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        if ((features & CPU_AVX) && (ebx & bit_AVX2)) features |= CPU_AVX2;
+        if (ebx & bit_BMI2) features |= CPU_BMI2;
+    }
+    return features;
+}
+
+uint32_t Cpu_Features(void) {
+    // Compile workers may race here; they all store the same value
+    if (!__atomic_load_n(&probeDone, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&probed, probeFeatures(), __ATOMIC_RELAXED);
+        __atomic_store_n(&probeDone, 1, __ATOMIC_RELEASE);
+    }
+    return __atomic_load_n(&probed, __ATOMIC_RELAXED) & levelMask;
+}
+
+void Cpu_SetIsaLevel(CpuIsaLevel level) {
+    switch (level) {
+        case CPU_ISA_SSE2: levelMask = 0; break;
+        case CPU_ISA_SSE4: levelMask = LEVEL_SSE4; break;
+        case CPU_ISA_AVX2: levelMask = LEVEL_AVX2; break;
+    }
+}
+
+int Cpu_ParseIsaLevel(const char* name, CpuIsaLevel* outLevel) {
+    static const char* const names[] = { "sse2", "sse4", "avx2" };
+    for (int i = 0; i < 3; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            *outLevel = (CpuIsaLevel)i;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,632 @@
+#define _GNU_SOURCE     // REG_RIP / REG_RBP in ucontext_t
+#include "Jit/DebugInfo.h"
+#include <elf.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static FILE* perfMap = NULL;
+static FILE* jitDump = NULL;
+static void* jitDumpMarker = NULL;
+static uint64_t codeIndex = 0;
+
+void Debug_EnablePerfMap(void) {
+    if (perfMap) return;
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/perf-%ld.map", (long)getpid());
+    perfMap = fopen(path, "w");
+    if (!perfMap) {
+        fprintf(stderr, "[Vanarize JIT] Could not create %s, perf map disabled.\n", path);
+        return;
+    }
+    setvbuf(perfMap, NULL, _IOLBF, 0);  // Entries survive a crash
+}
+
+// ==================== JITDUMP ====================
+// Layout per tools/perf/Documentation/jitdump-specification.txt
+
+#define JITDUMP_MAGIC 0x4A695444u       // "JiTD"
+#define JITDUMP_VERSION 1
+#define JITDUMP_EM_X86_64 62
+
+enum {
+    JIT_CODE_LOAD = 0,
+    JIT_CODE_DEBUG_INFO = 2
+};
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t totalSize;
+    uint32_t elfMach;
+    uint32_t pad1;
+    uint32_t pid;
+    uint64_t timestamp;
+    uint64_t flags;
+} JitDumpHeader;
+
+typedef struct {
+    uint32_t id;
+    uint32_t totalSize;
+    uint64_t timestamp;
+} JitRecordPrefix;
+
+typedef struct {
+    JitRecordPrefix prefix;
+    uint32_t pid;
+    uint32_t tid;
+    uint64_t vma;
+    uint64_t codeAddr;
+    uint64_t codeSize;
+    uint64_t codeIndex;
+    // Followed by the NUL-terminated name and the code bytes
+} JitCodeLoad;
+
+typedef struct {
+    JitRecordPrefix prefix;
+    uint64_t codeAddr;
+    uint64_t entryCount;
+    // Followed by entryCount entries
+} JitDebugInfo;
+
+typedef struct {
+    uint64_t addr;
+    uint32_t line;
+    uint32_t discriminator;
+    // Followed by the NUL-terminated file name
+} JitDebugEntry;
+
+// perf record -k 1 samples CLOCK_MONOTONIC
+static uint64_t timestamp(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+int Debug_EnableJitDump(const char* dir) {
+    if (jitDump) return 1;
+    size_t length = strlen(dir) + 32;
+    char* path = malloc(length);
+    snprintf(path, length, "%s/jit-%ld.dump", dir, (long)getpid());
+    int fd = open(path, O_CREAT | O_TRUNC | O_RDWR, 0666);
+    if (fd < 0) {
+        fprintf(stderr, "[Vanarize JIT] Could not create %s, jitdump disabled.\n", path);
+        free(path);
+        return 0;
+    }
+    free(path);
+
+    // perf finds the dump through this executable mapping of it
+    long pageSize = sysconf(_SC_PAGESIZE);
+    jitDumpMarker = mmap(NULL, pageSize, PROT_READ | PROT_EXEC, MAP_PRIVATE, fd, 0);
+    if (jitDumpMarker == MAP_FAILED) {
+        jitDumpMarker = NULL;
+        close(fd);
+        return 0;
+    }
+    jitDump = fdopen(fd, "wb");
+
+    JitDumpHeader header = { JITDUMP_MAGIC, JITDUMP_VERSION, sizeof(JitDumpHeader), JITDUMP_EM_X86_64,
+                             0, (uint32_t)getpid(), timestamp(), 0 };
+    fwrite(&header, sizeof(header), 1, jitDump);
+    fflush(jitDump);
+    return 1;
+}
+
+static void writeDebugInfo(const void* code, const char* file, const DebugLine* lines, int lineCount) {
+    size_t fileLength = strlen(file) + 1;
+    JitDebugInfo info;
+    info.prefix.id = JIT_CODE_DEBUG_INFO;
+    info.prefix.totalSize = (uint32_t)(sizeof(info) + (sizeof(JitDebugEntry) + fileLength) * lineCount);
+    info.prefix.timestamp = timestamp();
+    info.codeAddr = (uint64_t)(uintptr_t)code;
+    info.entryCount = (uint64_t)lineCount;
+    fwrite(&info, sizeof(info), 1, jitDump);
+
+    for (int i = 0; i < lineCount; i++) {
+        JitDebugEntry entry = { (uint64_t)(uintptr_t)code + lines[i].offset, lines[i].line, 0 };
+        fwrite(&entry, sizeof(entry), 1, jitDump);
+        fwrite(file, 1, fileLength, jitDump);
+    }
+}
+
+static void writeCodeLoad(const void* code, size_t size, const char* name, int nameLength) {
+    JitCodeLoad load;
+    load.prefix.id = JIT_CODE_LOAD;
+    load.prefix.totalSize = (uint32_t)(sizeof(load) + nameLength + 1 + size);
+    load.prefix.timestamp = timestamp();
+    load.pid = (uint32_t)getpid();
+    load.tid = (uint32_t)syscall(SYS_gettid);
+    load.vma = (uint64_t)(uintptr_t)code;
+    load.codeAddr = load.vma;
+    load.codeSize = size;
+    load.codeIndex = codeIndex++;
+    fwrite(&load, sizeof(load), 1, jitDump);
+    fwrite(name, 1, nameLength, jitDump);
+    fputc('\0', jitDump);
+    fwrite(code, 1, size, jitDump);
+}
+
+// ==================== GDB JIT INTERFACE ====================
+// GDB sets a breakpoint in __jit_debug_register_code and reads the
+// descriptor when it hits; both names are fixed by the protocol.
+
+typedef enum {
+    JIT_NOACTION = 0,
+    JIT_REGISTER_FN,
+    JIT_UNREGISTER_FN
+} JitActions;
+
+struct jit_code_entry {
+    struct jit_code_entry* next_entry;
+    struct jit_code_entry* prev_entry;
+    const char* symfile_addr;
+    uint64_t symfile_size;
+};
+
+struct jit_descriptor {
+    uint32_t version;
+    uint32_t action_flag;
+    struct jit_code_entry* relevant_entry;
+    struct jit_code_entry* first_entry;
+};
+
+void __attribute__((noinline)) __jit_debug_register_code(void);
+void __attribute__((noinline)) __jit_debug_register_code(void) {
+    __asm__ volatile("" ::: "memory");
+}
+
+struct jit_descriptor __jit_debug_descriptor = { 1, JIT_NOACTION, NULL, NULL };
+
+static int gdbJitEnabled = 0;
+
+static void notifyGdb(struct jit_code_entry* entry, JitActions action) {
+    __jit_debug_descriptor.relevant_entry = entry;
+    __jit_debug_descriptor.action_flag = action;
+    __jit_debug_register_code();
+}
+
+void Debug_SetGdbJit(int enabled) {
+    gdbJitEnabled = enabled;
+    if (enabled) return;
+
+    // Withdraw every symfile, newest first, and free it
+    while (__jit_debug_descriptor.first_entry) {
+        struct jit_code_entry* entry = __jit_debug_descriptor.first_entry;
+        __jit_debug_descriptor.first_entry = entry->next_entry;
+        if (entry->next_entry) entry->next_entry->prev_entry = NULL;
+        notifyGdb(entry, JIT_UNREGISTER_FN);
+        free((void*)entry->symfile_addr);
+        free(entry);
+    }
+    __jit_debug_descriptor.relevant_entry = NULL;
+    __jit_debug_descriptor.action_flag = JIT_NOACTION;
+}
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+} ByteBuffer;
+
+static void put(ByteBuffer* b, const void* bytes, size_t size) {
+    if (b->size + size > b->capacity) {
+        b->capacity = b->capacity ? b->capacity * 2 : 256;
+        while (b->capacity < b->size + size) b->capacity *= 2;
+        b->data = realloc(b->data, b->capacity);
+    }
+    memcpy(b->data + b->size, bytes, size);
+    b->size += size;
+}
+
+static void put8(ByteBuffer* b, uint8_t v) { put(b, &v, 1); }
+static void put16(ByteBuffer* b, uint16_t v) { put(b, &v, 2); }
+static void put32(ByteBuffer* b, uint32_t v) { put(b, &v, 4); }
+static void put64(ByteBuffer* b, uint64_t v) { put(b, &v, 8); }
+static void putString(ByteBuffer* b, const char* s) { put(b, s, strlen(s) + 1); }
+
+static void putUleb(ByteBuffer* b, uint64_t v) {
+    do {
+        uint8_t byte = v & 0x7f;
+        v >>= 7;
+        put8(b, v ? byte | 0x80 : byte);
+    } while (v);
+}
+
+static void putSleb(ByteBuffer* b, int64_t v) {
+    for (;;) {
+        uint8_t byte = v & 0x7f;
+        v >>= 7;    // Arithmetic shift
+        if ((v == 0 && !(byte & 0x40)) || (v == -1 && (byte & 0x40))) {
+            put8(b, byte);
+            return;
+        }
+        put8(b, byte | 0x80);
+    }
+}
+
+static void patch32(ByteBuffer* b, size_t at, uint32_t v) {
+    memcpy(b->data + at, &v, sizeof(v));
+}
+
+static void alignNop(ByteBuffer* b) {
+    while (b->size & 7) put8(b, 0);    // DW_CFA_nop
+}
+
+// DWARF constants (version 2 line and info, .eh_frame CFI)
+enum {
+    DW_TAG_compile_unit = 0x11,
+    DW_AT_name = 0x03, DW_AT_stmt_list = 0x10, DW_AT_low_pc = 0x11, DW_AT_high_pc = 0x12,
+    DW_FORM_addr = 0x01, DW_FORM_data4 = 0x06, DW_FORM_string = 0x08,
+    DW_LNS_copy = 1, DW_LNS_advance_pc = 2, DW_LNS_advance_line = 3,
+    DW_LNE_end_sequence = 1, DW_LNE_set_address = 2,
+    DW_CFA_advance_loc = 0x40, DW_CFA_offset = 0x80,
+    DW_CFA_def_cfa = 0x0c, DW_CFA_def_cfa_register = 0x0d, DW_CFA_def_cfa_offset = 0x0e,
+    DW_EH_PE_udata4 = 0x03, DW_EH_PE_textrel = 0x20,
+    DW_REG_RBP = 6, DW_REG_RSP = 7, DW_REG_RA = 16
+};
+
+static void buildAbbrev(ByteBuffer* b) {
+    putUleb(b, 1);
+    putUleb(b, DW_TAG_compile_unit);
+    put8(b, 0);                                     // No children
+    putUleb(b, DW_AT_name); putUleb(b, DW_FORM_string);
+    putUleb(b, DW_AT_low_pc); putUleb(b, DW_FORM_addr);
+    putUleb(b, DW_AT_high_pc); putUleb(b, DW_FORM_addr);
+    putUleb(b, DW_AT_stmt_list); putUleb(b, DW_FORM_data4);
+    put8(b, 0); put8(b, 0);
+    put8(b, 0);
+}
+
+static void buildInfo(ByteBuffer* b, const char* file, uint64_t low, uint64_t high) {
+    put32(b, 0);                                    // unit_length, patched below
+    put16(b, 2);                                    // DWARF version
+    put32(b, 0);                                    // .debug_abbrev offset
+    put8(b, 8);                                     // Address size
+    putUleb(b, 1);                                  // Abbrev 1: compile unit
+    putString(b, file);
+    put64(b, low);
+    put64(b, high);
+    put32(b, 0);                                    // DW_AT_stmt_list
+    patch32(b, 0, (uint32_t)(b->size - 4));
+}
+
+static void buildLine(ByteBuffer* b, const char* file, uint64_t code, uint64_t size,
+                      const DebugLine* lines, int lineCount) {
+    put32(b, 0);                                    // unit_length, patched below
+    put16(b, 2);
+    size_t headerLength = b->size;
+    put32(b, 0);                                    // header_length, patched below
+    put8(b, 1);                                     // Minimum instruction length
+    put8(b, 1);                                     // default_is_stmt
+    put8(b, 0);                                     // line_base (no special opcodes used)
+    put8(b, 1);                                     // line_range
+    put8(b, 4);                                     // opcode_base
+    put8(b, 0); put8(b, 1); put8(b, 1);             // Standard opcode lengths
+    put8(b, 0);                                     // No include directories
+    putString(b, file);
+    putUleb(b, 0); putUleb(b, 0); putUleb(b, 0);    // Directory, mtime, length
+    put8(b, 0);
+    patch32(b, headerLength, (uint32_t)(b->size - headerLength - 4));
+
+    put8(b, 0); putUleb(b, 9); put8(b, DW_LNE_set_address);
+    put64(b, code);
+    uint32_t offset = 0, line = 1;
+    for (int i = 0; i < lineCount; i++) {
+        if (lines[i].offset > offset) {
+            put8(b, DW_LNS_advance_pc);
+            putUleb(b, lines[i].offset - offset);
+            offset = lines[i].offset;
+        }
+        put8(b, DW_LNS_advance_line);
+        putSleb(b, (int64_t)lines[i].line - line);
+        line = lines[i].line;
+        put8(b, DW_LNS_copy);
+    }
+    put8(b, DW_LNS_advance_pc);
+    putUleb(b, size - offset);
+    put8(b, 0); putUleb(b, 1); put8(b, DW_LNE_end_sequence);
+    patch32(b, 0, (uint32_t)(b->size - 4));
+}
+
+// Every function starts PUSH RBP; MOV RBP, RSP and keeps that frame
+static void buildEhFrame(ByteBuffer* b, uint64_t size) {
+    size_t cie = b->size;
+    put32(b, 0);                                    // Length, patched below
+    put32(b, 0);                                    // CIE id
+    put8(b, 1);                                     // Version
+    putString(b, "zR");
+    putUleb(b, 1);                                  // Code alignment
+    putSleb(b, -8);                                 // Data alignment
+    put8(b, DW_REG_RA);
+    putUleb(b, 1);                                  // Augmentation data: FDE pointer encoding
+    put8(b, DW_EH_PE_textrel | DW_EH_PE_udata4);
+    put8(b, DW_CFA_def_cfa); putUleb(b, DW_REG_RSP); putUleb(b, 8);
+    put8(b, DW_CFA_offset | DW_REG_RA); putUleb(b, 1);
+    alignNop(b);
+    patch32(b, cie, (uint32_t)(b->size - cie - 4));
+
+    size_t fde = b->size;
+    put32(b, 0);                                    // Length, patched below
+    put32(b, (uint32_t)(b->size - cie));            // Back to the CIE
+    put32(b, 0);                                    // Start, relative to .text
+    put32(b, (uint32_t)size);
+    putUleb(b, 0);                                  // No augmentation data
+    put8(b, DW_CFA_advance_loc | 1);                // After PUSH RBP
+    put8(b, DW_CFA_def_cfa_offset); putUleb(b, 16);
+    put8(b, DW_CFA_offset | DW_REG_RBP); putUleb(b, 2);
+    put8(b, DW_CFA_advance_loc | 3);                // After MOV RBP, RSP
+    put8(b, DW_CFA_def_cfa_register); putUleb(b, DW_REG_RBP);
+    alignNop(b);
+    patch32(b, fde, (uint32_t)(b->size - fde - 4));
+    put32(b, 0);                                    // Terminator
+}
+
+// Symfile section indices
+enum {
+    SYM_SECT_NULL,
+    SYM_SECT_TEXT,
+    SYM_SECT_EH_FRAME,
+    SYM_SECT_SHSTRTAB,
+    SYM_SECT_STRTAB,
+    SYM_SECT_SYMTAB,
+    SYM_SECT_DEBUG_INFO,
+    SYM_SECT_DEBUG_ABBREV,
+    SYM_SECT_DEBUG_LINE,
+    SYM_SECT_COUNT
+};
+
+static void registerWithGdb(const void* code, size_t size, const char* name, int nameLength,
+                            const char* file, const DebugLine* lines, int lineCount) {
+    uint64_t addr = (uint64_t)(uintptr_t)code;
+    ByteBuffer sections[SYM_SECT_COUNT] = {{0}};
+
+    // .text is NOBITS at the code's address, so nothing is copied
+    buildEhFrame(&sections[SYM_SECT_EH_FRAME], size);
+    static const char shstrtab[] =
+        "\0.text\0.eh_frame\0.shstrtab\0.strtab\0.symtab\0.debug_info\0.debug_abbrev\0.debug_line";
+    put(&sections[SYM_SECT_SHSTRTAB], shstrtab, sizeof(shstrtab));
+    buildInfo(&sections[SYM_SECT_DEBUG_INFO], file, addr, addr + size);
+    buildAbbrev(&sections[SYM_SECT_DEBUG_ABBREV]);
+    buildLine(&sections[SYM_SECT_DEBUG_LINE], file, addr, size, lines, lineCount);
+
+    ByteBuffer* strtab = &sections[SYM_SECT_STRTAB];
+    put8(strtab, 0);
+    putString(strtab, file);
+    uint32_t funcName = (uint32_t)strtab->size;
+    put(strtab, name, nameLength);
+    put8(strtab, 0);
+
+    Elf64_Sym syms[3] = {{0}};
+    syms[1].st_name = 1;
+    syms[1].st_info = ELF64_ST_INFO(STB_LOCAL, STT_FILE);
+    syms[1].st_shndx = SHN_ABS;
+    syms[2].st_name = funcName;
+    syms[2].st_info = ELF64_ST_INFO(STB_GLOBAL, STT_FUNC);
+    syms[2].st_shndx = SYM_SECT_TEXT;
+    syms[2].st_value = 0;                           // Relative to .text
+    syms[2].st_size = size;
+    put(&sections[SYM_SECT_SYMTAB], syms, sizeof(syms));
+
+    // Lay out: ELF header, section contents, section headers
+    size_t offsets[SYM_SECT_COUNT] = {0};
+    size_t total = sizeof(Elf64_Ehdr);
+    for (int i = 0; i < SYM_SECT_COUNT; i++) {
+        total = (total + 7) & ~(size_t)7;
+        offsets[i] = total;
+        total += sections[i].size;
+    }
+    total = (total + 7) & ~(size_t)7;
+    size_t shoff = total;
+    total += sizeof(Elf64_Shdr) * SYM_SECT_COUNT;
+
+    uint8_t* image = calloc(1, total);
+    Elf64_Ehdr* ehdr = (Elf64_Ehdr*)image;
+    memcpy(ehdr->e_ident, ELFMAG, SELFMAG);
+    ehdr->e_ident[EI_CLASS] = ELFCLASS64;
+    ehdr->e_ident[EI_DATA] = ELFDATA2LSB;
+    ehdr->e_ident[EI_VERSION] = EV_CURRENT;
+    ehdr->e_type = ET_REL;
+    ehdr->e_machine = EM_X86_64;
+    ehdr->e_version = EV_CURRENT;
+    ehdr->e_shoff = shoff;
+    ehdr->e_ehsize = sizeof(Elf64_Ehdr);
+    ehdr->e_shentsize = sizeof(Elf64_Shdr);
+    ehdr->e_shnum = SYM_SECT_COUNT;
+    ehdr->e_shstrndx = SYM_SECT_SHSTRTAB;
+
+    static const uint32_t nameOffsets[SYM_SECT_COUNT] = { 0, 1, 7, 17, 27, 35, 43, 55, 69 };
+    Elf64_Shdr* shdrs = (Elf64_Shdr*)(image + shoff);
+    for (int i = 1; i < SYM_SECT_COUNT; i++) {
+        if (sections[i].size) memcpy(image + offsets[i], sections[i].data, sections[i].size);
+        shdrs[i].sh_name = nameOffsets[i];
+        shdrs[i].sh_type = SHT_PROGBITS;
+        shdrs[i].sh_offset = offsets[i];
+        shdrs[i].sh_size = sections[i].size;
+        shdrs[i].sh_addralign = 1;
+        free(sections[i].data);
+    }
+    shdrs[SYM_SECT_TEXT].sh_type = SHT_NOBITS;
+    shdrs[SYM_SECT_TEXT].sh_flags = SHF_ALLOC | SHF_EXECINSTR;
+    shdrs[SYM_SECT_TEXT].sh_addr = addr;
+    shdrs[SYM_SECT_TEXT].sh_offset = 0;
+    shdrs[SYM_SECT_TEXT].sh_size = size;
+    shdrs[SYM_SECT_TEXT].sh_addralign = 16;
+    shdrs[SYM_SECT_EH_FRAME].sh_flags = SHF_ALLOC;
+    shdrs[SYM_SECT_EH_FRAME].sh_addralign = 8;
+    shdrs[SYM_SECT_SHSTRTAB].sh_type = SHT_STRTAB;
+    shdrs[SYM_SECT_STRTAB].sh_type = SHT_STRTAB;
+    shdrs[SYM_SECT_SYMTAB].sh_type = SHT_SYMTAB;
+    shdrs[SYM_SECT_SYMTAB].sh_link = SYM_SECT_STRTAB;
+    shdrs[SYM_SECT_SYMTAB].sh_info = 2;             // First global
+    shdrs[SYM_SECT_SYMTAB].sh_entsize = sizeof(Elf64_Sym);
+    shdrs[SYM_SECT_SYMTAB].sh_addralign = 8;
+
+    struct jit_code_entry* entry = malloc(sizeof(struct jit_code_entry));
+    entry->symfile_addr = (const char*)image;
+    entry->symfile_size = total;
+    entry->prev_entry = NULL;
+    entry->next_entry = __jit_debug_descriptor.first_entry;
+    if (entry->next_entry) entry->next_entry->prev_entry = entry;
+    __jit_debug_descriptor.first_entry = entry;
+    notifyGdb(entry, JIT_REGISTER_FN);
+}
+
+// ==================== CRASH HANDLER ====================
+
+// Installed functions, kept for the crash handler. The handler may run
+// in the middle of recordCode, so the table is never modified in place
+// where it could be reading: a full table is copied into a bigger one,
+// which is published with an atomic store, and the old one stays
+// allocated. A record is complete before the count that covers it is
+// published.
+typedef struct {
+    uintptr_t start;
+    size_t size;
+    char* name;
+    const char* file;
+    DebugLine* lines;
+    int lineCount;
+} CodeRecord;
+
+static CodeRecord* codeRecords = NULL;
+static int codeRecordCount = 0;
+static int codeRecordCapacity = 0;
+static int crashHandlerInstalled = 0;
+
+#define CRASH_STACK_SIZE (64 * 1024)
+#define CRASH_MAX_FRAMES 64
+#define CRASH_STACK_WINDOW (64 * 1024 * 1024)   // Frame pointers followed above the faulting RSP
+
+static void recordCode(const void* code, size_t size, const char* name, int nameLength,
+                       const char* file, const DebugLine* lines, int lineCount) {
+    if (codeRecordCount == codeRecordCapacity) {
+        codeRecordCapacity = codeRecordCapacity ? codeRecordCapacity * 2 : 64;
+        CodeRecord* grown = malloc(sizeof(CodeRecord) * codeRecordCapacity);
+        if (codeRecordCount > 0) memcpy(grown, codeRecords, sizeof(CodeRecord) * codeRecordCount);
+        __atomic_store_n(&codeRecords, grown, __ATOMIC_RELEASE);   // Old table leaked on purpose
+    }
+    CodeRecord* record = &codeRecords[codeRecordCount];
+    record->start = (uintptr_t)code;
+    record->size = size;
+    record->name = strndup(name, nameLength);
+    record->file = file;
+    record->lines = NULL;
+    record->lineCount = lineCount;
+    if (lineCount > 0) {
+        record->lines = malloc(sizeof(DebugLine) * lineCount);
+        memcpy(record->lines, lines, sizeof(DebugLine) * lineCount);
+    }
+    __atomic_store_n(&codeRecordCount, codeRecordCount + 1, __ATOMIC_RELEASE);
+}
+
+// Count first: any table loaded after it holds at least that many records
+static const CodeRecord* findCode(uintptr_t pc) {
+    int count = __atomic_load_n(&codeRecordCount, __ATOMIC_ACQUIRE);
+    const CodeRecord* records = __atomic_load_n(&codeRecords, __ATOMIC_ACQUIRE);
+    for (int i = count - 1; i >= 0; i--) {
+        if (pc >= records[i].start && pc < records[i].start + records[i].size) return &records[i];
+    }
+    return NULL;
+}
+
+static uint32_t lineAt(const CodeRecord* record, uintptr_t pc) {
+    uint32_t line = 0;
+    for (int i = 0; i < record->lineCount && record->start + record->lines[i].offset <= pc; i++) {
+        line = record->lines[i].line;
+    }
+    return line;
+}
+
+static void printFrame(int depth, uintptr_t pc, const CodeRecord* record, uintptr_t lookup) {
+    char text[512];
+    int n;
+    if (!record) {
+        n = snprintf(text, sizeof(text), "  #%d 0x%lx in <native>\n", depth, (unsigned long)pc);
+    } else {
+        const char* file = record->file ? record->file : "?";
+        uint32_t line = lineAt(record, lookup);     // 0 in the prologue
+        if (line) {
+            n = snprintf(text, sizeof(text), "  #%d 0x%lx in %s (%s:%u)\n", depth, (unsigned long)pc,
+                         record->name, file, line);
+        } else {
+            n = snprintf(text, sizeof(text), "  #%d 0x%lx in %s (%s)\n", depth, (unsigned long)pc, record->name, file);
+        }
+    }
+    if (n > 0) write(STDERR_FILENO, text, n < (int)sizeof(text) ? (size_t)n : sizeof(text) - 1);
+}
+
+static void crashHandler(int sig, siginfo_t* info, void* context) {
+    (void)info;
+    ucontext_t* uc = context;
+    uintptr_t pc = (uintptr_t)uc->uc_mcontext.gregs[REG_RIP];
+    uintptr_t fp = (uintptr_t)uc->uc_mcontext.gregs[REG_RBP];
+    uintptr_t sp = (uintptr_t)uc->uc_mcontext.gregs[REG_RSP];
+
+    char text[64];
+    int n = snprintf(text, sizeof(text), "[Vanarize] Fatal signal %d, JIT backtrace:\n", sig);
+    if (n > 0) write(STDERR_FILENO, text, n);
+    printFrame(0, pc, findCode(pc), pc);
+
+    // JIT frames keep RBP chains. A native frame 0 (a runtime helper) may
+    // still hold its JIT caller's RBP, so the walk starts from it either way.
+    for (int depth = 1; depth < CRASH_MAX_FRAMES; depth++) {
+        if (fp < sp || fp >= sp + CRASH_STACK_WINDOW || (fp & 7)) break;
+        uintptr_t next = ((uintptr_t*)fp)[0];
+        uintptr_t ret = ((uintptr_t*)fp)[1];
+        const CodeRecord* record = findCode(ret - 1);
+        printFrame(depth, ret, record, ret - 1);
+        if (!record || next <= fp) break;
+        fp = next;
+    }
+
+    // SA_RESETHAND restored the default action: core dump / termination
+    raise(sig);
+}
+
+void Debug_InstallCrashHandler(void) {
+    if (crashHandlerInstalled) return;
+    crashHandlerInstalled = 1;
+
+    // Own stack, so deep recursion overflowing the main one is reported too
+    stack_t altStack;
+    altStack.ss_sp = malloc(CRASH_STACK_SIZE);
+    altStack.ss_size = CRASH_STACK_SIZE;
+    altStack.ss_flags = 0;
+    sigaltstack(&altStack, NULL);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = crashHandler;
+    action.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+    static const int signals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGQUIT };
+    for (size_t i = 0; i < sizeof(signals) / sizeof(signals[0]); i++) sigaction(signals[i], &action, NULL);
+}
+
+// ==================== REGISTRATION ====================
+
+int Debug_WantsLines(void) {
+    return jitDump != NULL || gdbJitEnabled || crashHandlerInstalled;
+}
+
+void Debug_RegisterCode(const void* code, size_t size, const char* name, int nameLength,
+                        const char* file, const DebugLine* lines, int lineCount) {
+    if (perfMap) {
+        fprintf(perfMap, "%lx %zx %.*s\n", (unsigned long)(uintptr_t)code, size, nameLength, name);
+    }
+    if (jitDump) {
+        // A function's line table must precede its code
+        if (lineCount > 0) writeDebugInfo(code, file ? file : "<unknown>", lines, lineCount);
+        writeCodeLoad(code, size, name, nameLength);
+        fflush(jitDump);
+    }
+    if (gdbJitEnabled) registerWithGdb(code, size, name, nameLength, file ? file : "<unknown>", lines, lineCount);
+    if (crashHandlerInstalled) recordCode(code, size, name, nameLength, file, lines, lineCount);
+}
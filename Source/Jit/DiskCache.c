@@ -0,0 +1,283 @@
+#define _DEFAULT_SOURCE
+#include "Jit/DiskCache.h"
+#include "Jit/CodeGen.h"
+#include "Jit/CpuFeatures.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CACHE_MAGIC 0x435a4e56u     // "VNZC"
+#define CACHE_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t importCount;
+    uint32_t stringCount;
+    uint32_t unitCount;
+    uint32_t reserved;
+} CacheHeader;
+
+static char* cacheDir = NULL;
+
+void DiskCache_SetDirectory(const char* dir) {
+    free(cacheDir);
+    cacheDir = dir ? strdup(dir) : NULL;
+    if (cacheDir) mkdir(cacheDir, 0755);   // Fails harmlessly if it exists
+}
+
+int DiskCache_Enabled(void) {
+    return cacheDir != NULL;
+}
+
+uintptr_t DiskCache_ImageAnchor(void) {
+    return (uintptr_t)(void*)Jit_Compile;
+}
+
+// ==================== KEY ====================
+
+// FNV-1a, 64-bit
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+#define HASH_SEED 0xcbf29ce484222325ull
+
+static uint64_t hashFile(const char* path, int* ok) {
+    FILE* file = fopen(path, "rb");
+    *ok = file != NULL;
+    if (!file) return 0;
+    uint64_t hash = HASH_SEED;
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) hash = hashBytes(hash, buffer, n);
+    fclose(file);
+    return hash;
+}
+
+// Main file contents, the CPU features the code was generated for and the
+// binary the image-relative relocations were taken against
+static uint64_t cacheKey(const char* source) {
+    uint64_t hash = hashBytes(HASH_SEED, source, strlen(source));
+
+    uint32_t features = Cpu_Features();
+    hash = hashBytes(hash, &features, sizeof(features));
+
+    struct stat st;
+    if (stat("/proc/self/exe", &st) == 0) {
+        int64_t identity[4] = { (int64_t)st.st_size, (int64_t)st.st_mtim.tv_sec,
+                                (int64_t)st.st_mtim.tv_nsec, (int64_t)st.st_ino };
+        hash = hashBytes(hash, identity, sizeof(identity));
+    }
+    uint32_t version = CACHE_VERSION;
+    return hashBytes(hash, &version, sizeof(version));
+}
+
+static char* entryPath(uint64_t key) {
+    size_t length = strlen(cacheDir) + 32;
+    char* path = malloc(length);
+    snprintf(path, length, "%s/%016llx.vnc", cacheDir, (unsigned long long)key);
+    return path;
+}
+
+// ==================== READING ====================
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    int failed;
+} Reader;
+
+static const void* take(Reader* r, size_t size) {
+    if (r->failed || size > r->size - r->pos) {
+        r->failed = 1;
+        return NULL;
+    }
+    const void* p = r->data + r->pos;
+    r->pos += size;
+    return p;
+}
+
+static uint32_t takeU32(Reader* r) {
+    const void* p = take(r, sizeof(uint32_t));
+    uint32_t v = 0;
+    if (p) memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t takeU64(Reader* r) {
+    const void* p = take(r, sizeof(uint64_t));
+    uint64_t v = 0;
+    if (p) memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static void alignReader(Reader* r) {
+    size_t pad = (8 - (r->pos & 7)) & 7;
+    take(r, pad);
+}
+
+static int importsMatch(Reader* r, int count) {
+    for (int i = 0; i < count; i++) {
+        uint32_t length = takeU32(r);
+        uint64_t hash = takeU64(r);
+        const char* path = take(r, length);
+        if (!path) return 0;
+
+        char* name = malloc(length + 1);
+        memcpy(name, path, length);
+        name[length] = '\0';
+        int ok;
+        uint64_t current = hashFile(name, &ok);
+        free(name);
+        if (!ok || current != hash) return 0;
+    }
+    return 1;
+}
+
+int DiskCache_Load(const char* source, CacheImage* image) {
+    memset(image, 0, sizeof(*image));
+    if (!cacheDir) return 0;
+
+    uint64_t key = cacheKey(source);
+    char* path = entryPath(key);
+    int fd = open(path, O_RDONLY);
+    free(path);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(CacheHeader)) {
+        close(fd);
+        return 0;
+    }
+    void* mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return 0;
+    image->mapping = mapping;
+    image->mappingSize = st.st_size;
+
+    Reader r = { mapping, st.st_size, 0, 0 };
+    CacheHeader header;
+    memcpy(&header, take(&r, sizeof(header)), sizeof(header));
+    if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.key != key ||
+        !importsMatch(&r, header.importCount)) {
+        DiskCache_Release(image);
+        return 0;
+    }
+
+    image->stringCount = header.stringCount;
+    image->strings = malloc(sizeof(char*) * (header.stringCount + 1));
+    image->stringLengths = malloc(sizeof(uint32_t) * (header.stringCount + 1));
+    for (uint32_t i = 0; i < header.stringCount; i++) {
+        image->stringLengths[i] = takeU32(&r);
+        image->strings[i] = take(&r, image->stringLengths[i]);
+    }
+
+    image->unitCount = header.unitCount;
+    image->units = malloc(sizeof(CacheUnit) * (header.unitCount + 1));
+    for (uint32_t i = 0; i < header.unitCount; i++) {
+        CacheUnit* unit = &image->units[i];
+        unit->nameLength = takeU32(&r);
+        unit->arity = (int)takeU32(&r);
+        unit->size = takeU32(&r);
+        unit->relocCount = takeU32(&r);
+        unit->name = take(&r, unit->nameLength);
+        alignReader(&r);
+        unit->relocs = take(&r, sizeof(CacheReloc) * (size_t)unit->relocCount);
+        unit->code = take(&r, unit->size);
+        alignReader(&r);
+    }
+
+    if (r.failed) {
+        fprintf(stderr, "[Vanarize JIT] Ignoring truncated cache entry.\n");
+        DiskCache_Release(image);
+        return 0;
+    }
+    return 1;
+}
+
+void DiskCache_Release(CacheImage* image) {
+    if (image->mapping) munmap(image->mapping, image->mappingSize);
+    free(image->strings);
+    free(image->stringLengths);
+    free(image->units);
+    memset(image, 0, sizeof(*image));
+}
+
+// ==================== WRITING ====================
+
+static void putU32(FILE* f, uint32_t v) { fwrite(&v, sizeof(v), 1, f); }
+static void putU64(FILE* f, uint64_t v) { fwrite(&v, sizeof(v), 1, f); }
+
+static void alignWriter(FILE* f) {
+    static const uint8_t zeros[8] = {0};
+    long pos = ftell(f);
+    fwrite(zeros, 1, (8 - (pos & 7)) & 7, f);
+}
+
+void DiskCache_Store(const char* source, const char* const* imports, int importCount, const CacheImage* image) {
+    if (!cacheDir) return;
+
+    uint64_t key = cacheKey(source);
+    char* path = entryPath(key);
+    size_t tmpLength = strlen(path) + 32;
+    char* tmpPath = malloc(tmpLength);
+    snprintf(tmpPath, tmpLength, "%s.%ld.tmp", path, (long)getpid());
+
+    FILE* f = fopen(tmpPath, "wb");
+    if (!f) {
+        free(tmpPath);
+        free(path);
+        return;
+    }
+
+    CacheHeader header = { CACHE_MAGIC, CACHE_VERSION, key, importCount,
+                           image->stringCount, image->unitCount, 0 };
+    fwrite(&header, sizeof(header), 1, f);
+
+    int ok = 1;
+    for (int i = 0; i < importCount; i++) {
+        int found;
+        uint64_t hash = hashFile(imports[i], &found);
+        ok &= found;
+        putU32(f, strlen(imports[i]));
+        putU64(f, hash);
+        fwrite(imports[i], 1, strlen(imports[i]), f);
+    }
+
+    for (int i = 0; i < image->stringCount; i++) {
+        putU32(f, image->stringLengths[i]);
+        fwrite(image->strings[i], 1, image->stringLengths[i], f);
+    }
+
+    for (int i = 0; i < image->unitCount; i++) {
+        const CacheUnit* unit = &image->units[i];
+        putU32(f, unit->nameLength);
+        putU32(f, (uint32_t)unit->arity);
+        putU32(f, unit->size);
+        putU32(f, unit->relocCount);
+        fwrite(unit->name, 1, unit->nameLength, f);
+        alignWriter(f);
+        fwrite(unit->relocs, sizeof(CacheReloc), unit->relocCount, f);
+        fwrite(unit->code, 1, unit->size, f);
+        alignWriter(f);
+    }
+
+    // Publish atomically: readers see the old entry or the complete new one
+    ok &= !ferror(f);
+    ok &= fclose(f) == 0;
+    if (!ok || rename(tmpPath, path) != 0) unlink(tmpPath);
+    free(tmpPath);
+    free(path);
+}
@@ -0,0 +1,209 @@
+#include "Jit/ElfWriter.h"
+#include <elf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FIRST_GLOBAL_SYMBOL 3
+
+// Section header indices in the written file
+enum {
+    SHDR_NULL,
+    SHDR_TEXT,
+    SHDR_DATA,
+    SHDR_RELA_TEXT,
+    SHDR_RELA_DATA,
+    SHDR_SYMTAB,
+    SHDR_STRTAB,
+    SHDR_SHSTRTAB,
+    SHDR_NOTE_STACK,
+    SHDR_COUNT
+};
+
+static const char sectionNames[] =
+    "\0.text\0.data\0.rela.text\0.rela.data\0.symtab\0.strtab\0.shstrtab\0.note.GNU-stack";
+
+static uint32_t sectionNameOffset(const char* name) {
+    size_t offset = 1;
+    while (offset < sizeof(sectionNames)) {
+        if (strcmp(sectionNames + offset, name) == 0) return (uint32_t)offset;
+        offset += strlen(sectionNames + offset) + 1;
+    }
+    return 0;
+}
+
+static size_t bufferAppend(ElfBuffer* buffer, const void* bytes, size_t size, size_t align) {
+    size_t offset = (buffer->size + align - 1) & ~(align - 1);
+    if (offset + size > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 256;
+        while (capacity < offset + size) capacity *= 2;
+        buffer->data = realloc(buffer->data, capacity);
+        if (!buffer->data) {
+            fprintf(stderr, "[Vanarize JIT] Fatal: Out of memory writing object file.\n");
+            exit(1);
+        }
+        buffer->capacity = capacity;
+    }
+    memset(buffer->data + buffer->size, 0, offset - buffer->size);
+    if (bytes) memcpy(buffer->data + offset, bytes, size);
+    else memset(buffer->data + offset, 0, size);
+    buffer->size = offset + size;
+    return offset;
+}
+
+void Elf_Init(ElfObject* elf) {
+    memset(elf, 0, sizeof(*elf));
+    bufferAppend(&elf->names, "", 1, 1);
+    elf->symbolCount = FIRST_GLOBAL_SYMBOL;
+}
+
+void Elf_Free(ElfObject* elf) {
+    for (int i = 0; i < ELF_SECTION_COUNT; i++) {
+        free(elf->contents[i].data);
+        free(elf->relocs[i].data);
+    }
+    free(elf->symbols.data);
+    free(elf->names.data);
+    memset(elf, 0, sizeof(*elf));
+}
+
+size_t Elf_Append(ElfObject* elf, ElfSection section, const void* bytes, size_t size, size_t align) {
+    return bufferAppend(&elf->contents[section], bytes, size, align);
+}
+
+static int addSymbol(ElfObject* elf, const char* name, uint16_t shndx, uint8_t type, size_t value, size_t size) {
+    Elf64_Sym sym = {0};
+    sym.st_name = (uint32_t)bufferAppend(&elf->names, name, strlen(name) + 1, 1);
+    sym.st_info = ELF64_ST_INFO(STB_GLOBAL, type);
+    sym.st_shndx = shndx;
+    sym.st_value = value;
+    sym.st_size = size;
+    bufferAppend(&elf->symbols, &sym, sizeof(sym), 1);
+    return elf->symbolCount++;
+}
+
+int Elf_DefineSymbol(ElfObject* elf, const char* name, ElfSection section, size_t offset, size_t size) {
+    return addSymbol(elf, name, section == ELF_SECTION_TEXT ? SHDR_TEXT : SHDR_DATA,
+                     section == ELF_SECTION_TEXT ? STT_FUNC : STT_OBJECT, offset, size);
+}
+
+int Elf_ImportSymbol(ElfObject* elf, const char* name) {
+    const Elf64_Sym* syms = (const Elf64_Sym*)elf->symbols.data;
+    for (int i = 0; i < elf->symbolCount - FIRST_GLOBAL_SYMBOL; i++) {
+        if (syms[i].st_shndx == SHN_UNDEF && strcmp((const char*)elf->names.data + syms[i].st_name, name) == 0) {
+            return i + FIRST_GLOBAL_SYMBOL;
+        }
+    }
+    return addSymbol(elf, name, SHN_UNDEF, STT_NOTYPE, 0, 0);
+}
+
+void Elf_AddReloc(ElfObject* elf, ElfSection section, size_t offset, uint32_t type, int symbol, int64_t addend) {
+    Elf64_Rela rela;
+    rela.r_offset = offset;
+    rela.r_info = ELF64_R_INFO((uint64_t)symbol, type);
+    rela.r_addend = addend;
+    bufferAppend(&elf->relocs[section], &rela, sizeof(rela), 1);
+}
+
+// ==================== WRITING ====================
+
+typedef struct {
+    const void* bytes;
+    size_t size;
+    size_t align;
+    size_t offset;          // Assigned file offset
+} FilePart;
+
+int Elf_Write(const ElfObject* elf, const char* path) {
+    // Null and section symbols precede the globals
+    Elf64_Sym locals[FIRST_GLOBAL_SYMBOL] = {{0}};
+    locals[ELF_SYMBOL_TEXT].st_info = ELF64_ST_INFO(STB_LOCAL, STT_SECTION);
+    locals[ELF_SYMBOL_TEXT].st_shndx = SHDR_TEXT;
+    locals[ELF_SYMBOL_DATA].st_info = ELF64_ST_INFO(STB_LOCAL, STT_SECTION);
+    locals[ELF_SYMBOL_DATA].st_shndx = SHDR_DATA;
+    size_t symtabSize = sizeof(locals) + elf->symbols.size;
+    uint8_t* symtab = malloc(symtabSize);
+    memcpy(symtab, locals, sizeof(locals));
+    if (elf->symbols.size) memcpy(symtab + sizeof(locals), elf->symbols.data, elf->symbols.size);
+
+    FilePart parts[SHDR_COUNT] = {
+        [SHDR_TEXT] = { elf->contents[ELF_SECTION_TEXT].data, elf->contents[ELF_SECTION_TEXT].size, 16, 0 },
+        [SHDR_DATA] = { elf->contents[ELF_SECTION_DATA].data, elf->contents[ELF_SECTION_DATA].size, 16, 0 },
+        [SHDR_RELA_TEXT] = { elf->relocs[ELF_SECTION_TEXT].data, elf->relocs[ELF_SECTION_TEXT].size, 8, 0 },
+        [SHDR_RELA_DATA] = { elf->relocs[ELF_SECTION_DATA].data, elf->relocs[ELF_SECTION_DATA].size, 8, 0 },
+        [SHDR_SYMTAB] = { symtab, symtabSize, 8, 0 },
+        [SHDR_STRTAB] = { elf->names.data, elf->names.size, 1, 0 },
+        [SHDR_SHSTRTAB] = { sectionNames, sizeof(sectionNames), 1, 0 },
+        [SHDR_NOTE_STACK] = { NULL, 0, 1, 0 },
+    };
+    size_t offset = sizeof(Elf64_Ehdr);
+    for (int i = 1; i < SHDR_COUNT; i++) {
+        offset = (offset + parts[i].align - 1) & ~(parts[i].align - 1);
+        parts[i].offset = offset;
+        offset += parts[i].size;
+    }
+    size_t shoff = (offset + 7) & ~(size_t)7;
+
+    Elf64_Shdr shdrs[SHDR_COUNT] = {{0}};
+    static const char* const names[SHDR_COUNT] = {
+        NULL, ".text", ".data", ".rela.text", ".rela.data", ".symtab", ".strtab", ".shstrtab", ".note.GNU-stack"
+    };
+    for (int i = 1; i < SHDR_COUNT; i++) {
+        shdrs[i].sh_name = sectionNameOffset(names[i]);
+        shdrs[i].sh_offset = parts[i].offset;
+        shdrs[i].sh_size = parts[i].size;
+        shdrs[i].sh_addralign = parts[i].align;
+        shdrs[i].sh_type = SHT_PROGBITS;
+    }
+    shdrs[SHDR_TEXT].sh_flags = SHF_ALLOC | SHF_EXECINSTR;
+    shdrs[SHDR_DATA].sh_flags = SHF_ALLOC | SHF_WRITE;
+    for (int i = SHDR_RELA_TEXT; i <= SHDR_RELA_DATA; i++) {
+        shdrs[i].sh_type = SHT_RELA;
+        shdrs[i].sh_flags = SHF_INFO_LINK;
+        shdrs[i].sh_link = SHDR_SYMTAB;
+        shdrs[i].sh_info = i == SHDR_RELA_TEXT ? SHDR_TEXT : SHDR_DATA;
+        shdrs[i].sh_entsize = sizeof(Elf64_Rela);
+    }
+    shdrs[SHDR_SYMTAB].sh_type = SHT_SYMTAB;
+    shdrs[SHDR_SYMTAB].sh_link = SHDR_STRTAB;
+    shdrs[SHDR_SYMTAB].sh_info = FIRST_GLOBAL_SYMBOL;
+    shdrs[SHDR_SYMTAB].sh_entsize = sizeof(Elf64_Sym);
+    shdrs[SHDR_STRTAB].sh_type = SHT_STRTAB;
+    shdrs[SHDR_SHSTRTAB].sh_type = SHT_STRTAB;
+
+    Elf64_Ehdr ehdr = {0};
+    memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+    ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+    ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+    ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+    ehdr.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+    ehdr.e_type = ET_REL;
+    ehdr.e_machine = EM_X86_64;
+    ehdr.e_version = EV_CURRENT;
+    ehdr.e_shoff = shoff;
+    ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+    ehdr.e_shentsize = sizeof(Elf64_Shdr);
+    ehdr.e_shnum = SHDR_COUNT;
+    ehdr.e_shstrndx = SHDR_SHSTRTAB;
+
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        free(symtab);
+        return 0;
+    }
+    static const uint8_t zeros[16] = {0};
+    fwrite(&ehdr, sizeof(ehdr), 1, f);
+    size_t pos = sizeof(ehdr);
+    for (int i = 1; i < SHDR_COUNT; i++) {
+        fwrite(zeros, 1, parts[i].offset - pos, f);
+        if (parts[i].size) fwrite(parts[i].bytes, 1, parts[i].size, f);
+        pos = parts[i].offset + parts[i].size;
+    }
+    fwrite(zeros, 1, shoff - pos, f);
+    fwrite(shdrs, sizeof(shdrs), 1, f);
+
+    int ok = !ferror(f);
+    ok &= fclose(f) == 0;
+    free(symtab);
+    return ok;
+}
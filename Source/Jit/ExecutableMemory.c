@@ -1,7 +1,10 @@
+#define _GNU_SOURCE     // memfd_create
 #include "Jit/ExecutableMemory.h"
 #include <sys/mman.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 void* Jit_AllocExec(size_t size) {
@@ -24,9 +27,10 @@ void* Jit_AllocExec(size_t size) {
 }
 
 void Jit_ProtectExec(void* ptr, size_t size) {
-    // Optionally remove WRITE permission to enforce W^X
-    // mprotect(ptr, size, PROT_READ | PROT_EXEC);
-    (void)ptr; (void)size;
+    if (mprotect(ptr, size, PROT_READ | PROT_EXEC) != 0) {
+        perror("[Vanarize JIT] Fatal: Failed to protect executable memory");
+        exit(1);
+    }
 }
 
 void Jit_FreeExec(void* ptr, size_t size) {
@@ -34,3 +38,212 @@ void Jit_FreeExec(void* ptr, size_t size) {
         munmap(ptr, size);
     }
 }
+
+// ==================== CODE CACHE ====================
+
+typedef struct CodeRegion {
+    uint8_t* base;
+    size_t size;
+    size_t used;
+    struct CodeRegion* next;   // Older regions
+} CodeRegion;
+
+// Guards the bump allocator, the entry table and the stats, and
+// serializes patches
+static pthread_mutex_t cacheLock = PTHREAD_MUTEX_INITIALIZER;
+
+static CodeRegion* currentRegion = NULL;
+static int useHugePages = 0;
+
+static JitCodeEntry* codeEntries = NULL;
+static int codeEntryCount = 0;
+static int codeEntryCapacity = 0;
+static JitCodeStats codeStats = {0};
+
+void Jit_SetHugePages(int enabled) {
+    useHugePages = enabled;
+}
+
+// All regions are carved out of one reserved address window so any two
+// compiled functions are within CALL rel32 reach of each other. With dual
+// mapping a second window of the same size holds the writable views, so
+// the RW alias of any code address is a fixed distance away.
+static uint8_t* reserveBase = NULL;
+static size_t reserveUsed = 0;
+static int dualMapped = 0;
+static ptrdiff_t writeDelta = 0;    // Writable alias - code address
+
+static uint8_t* reserveWindow(const char* what) {
+    // Over-reserve by one region so the window can start on a 2 MB boundary
+    size_t size = JIT_CODE_RESERVE + JIT_CODE_REGION_SIZE;
+    void* base = mmap(NULL, size, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "[Vanarize JIT] Fatal: Failed to reserve %s\n", what);
+        exit(1);
+    }
+    uintptr_t aligned = ((uintptr_t)base + JIT_CODE_REGION_SIZE - 1) & ~(uintptr_t)(JIT_CODE_REGION_SIZE - 1);
+    return (uint8_t*)aligned;
+}
+
+static void reserveCodeWindow(void) {
+    reserveBase = reserveWindow("code cache");
+
+    // Kernels without memfd (or sandboxes that block it) keep RWX regions
+    int probe = memfd_create("vanarize-jit", MFD_CLOEXEC);
+    if (probe < 0) return;
+    close(probe);
+    dualMapped = 1;
+    writeDelta = reserveWindow("code cache write view") - reserveBase;
+}
+
+// Backs [code, code + size) and its writable alias with one memfd
+static int mapDualRegion(uint8_t* code, size_t size, int hugePages) {
+    unsigned int flags = MFD_CLOEXEC;
+#ifdef MFD_HUGETLB
+    if (hugePages) flags |= MFD_HUGETLB;
+#else
+    if (hugePages) return 0;
+#endif
+    int fd = memfd_create("vanarize-jit", flags);
+    if (fd < 0) return 0;
+    int ok = ftruncate(fd, (off_t)size) == 0 &&
+             mmap(code + writeDelta, size, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED &&
+             mmap(code, size, PROT_READ | PROT_EXEC,
+                  MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+    close(fd);  // The mappings keep the file alive
+    return ok;
+}
+
+static int mapRegion(uint8_t* code, size_t size, int hugePages) {
+    if (dualMapped) return mapDualRegion(code, size, hugePages);
+
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED;
+#ifdef MAP_HUGETLB
+    if (hugePages) flags |= MAP_HUGETLB;
+#else
+    if (hugePages) return 0;
+#endif
+    return mmap(code, size, PROT_READ | PROT_WRITE | PROT_EXEC, flags, -1, 0) != MAP_FAILED;
+}
+
+static CodeRegion* newRegion(size_t minSize) {
+    size_t size = JIT_CODE_REGION_SIZE;
+    while (size < minSize) size += JIT_CODE_REGION_SIZE;
+
+    if (!reserveBase) reserveCodeWindow();
+    if (reserveUsed + size > JIT_CODE_RESERVE) {
+        fprintf(stderr, "[Vanarize JIT] Fatal: Code cache exhausted (%d MB)\n", JIT_CODE_RESERVE >> 20);
+        exit(1);
+    }
+    uint8_t* base = reserveBase + reserveUsed;
+
+    if (!useHugePages || !mapRegion(base, size, 1)) {
+        if (!mapRegion(base, size, 0)) {
+            perror("[Vanarize JIT] Fatal: Failed to commit code region");
+            exit(1);
+        }
+#ifdef MADV_HUGEPAGE
+        // Transparent huge pages: one iTLB entry per 2 MB if granted
+        madvise(base, size, MADV_HUGEPAGE);
+#endif
+    }
+    reserveUsed += size;
+
+    CodeRegion* region = malloc(sizeof(CodeRegion));
+    if (!region) {
+        fprintf(stderr, "[Vanarize JIT] Fatal: Out of memory for code region\n");
+        exit(1);
+    }
+    region->base = base;
+    region->size = size;
+    region->used = 0;
+    region->next = currentRegion;
+
+    codeStats.regionCount++;
+    codeStats.bytesReserved += size;
+    codeStats.dualMapped = dualMapped;
+    return region;
+}
+
+static void recordEntry(void* start, size_t size, const char* name, int nameLength) {
+    if (codeEntryCount == codeEntryCapacity) {
+        codeEntryCapacity = codeEntryCapacity ? codeEntryCapacity * 2 : 64;
+        codeEntries = realloc(codeEntries, sizeof(JitCodeEntry) * codeEntryCapacity);
+        if (!codeEntries) {
+            fprintf(stderr, "[Vanarize JIT] Fatal: Out of memory for code entries\n");
+            exit(1);
+        }
+    }
+    JitCodeEntry* entry = &codeEntries[codeEntryCount++];
+    entry->start = start;
+    entry->size = size;
+    if (!name) { name = "<anonymous>"; nameLength = 11; }
+    if (nameLength > JIT_CODE_NAME_MAX - 1) nameLength = JIT_CODE_NAME_MAX - 1;
+    memcpy(entry->name, name, nameLength);
+    entry->name[nameLength] = '\0';
+}
+
+void* Jit_InstallCode(const uint8_t* code, size_t size, const char* name, int nameLength) {
+    pthread_mutex_lock(&cacheLock);
+    size_t start = currentRegion ?
+        (currentRegion->used + JIT_CODE_ALIGNMENT - 1) & ~(size_t)(JIT_CODE_ALIGNMENT - 1) : 0;
+
+    // Chain a new region when the function does not fit
+    if (!currentRegion || start + size > currentRegion->size) {
+        currentRegion = newRegion(size);
+        start = 0;
+    }
+
+    uint8_t* dest = currentRegion->base + start;
+    memcpy(Jit_WritableAddress(dest), code, size);
+    currentRegion->used = start + size;
+
+    codeStats.functionCount++;
+    codeStats.bytesUsed += size;
+    recordEntry(dest, size, name, nameLength);
+    pthread_mutex_unlock(&cacheLock);
+    return dest;
+}
+
+const JitCodeEntry* Jit_GetCodeEntries(int* outCount) {
+    pthread_mutex_lock(&cacheLock);
+    *outCount = codeEntryCount;
+    const JitCodeEntry* entries = codeEntries;
+    pthread_mutex_unlock(&cacheLock);
+    return entries;
+}
+
+void Jit_GetCodeStats(JitCodeStats* outStats) {
+    pthread_mutex_lock(&cacheLock);
+    *outStats = codeStats;
+    pthread_mutex_unlock(&cacheLock);
+}
+
+void Jit_PatchRel32(uint8_t* site, const void* target) {
+    int64_t delta = (int64_t)((intptr_t)target - (intptr_t)(site + 4));
+    if (delta < INT32_MIN || delta > INT32_MAX) {
+        fprintf(stderr, "[Vanarize JIT] Fatal: rel32 target out of range\n");
+        exit(1);
+    }
+    int32_t rel = (int32_t)delta;
+    uint8_t* field = Jit_WritableAddress(site);
+
+    pthread_mutex_lock(&cacheLock);
+    size_t shift = (uintptr_t)field & 7;
+    if (shift <= 4) {
+        // Inside one aligned word: an executing thread sees the old or the new rel32
+        uint64_t* word = (uint64_t*)(field - shift);
+        uint64_t value = __atomic_load_n(word, __ATOMIC_RELAXED);
+        memcpy((uint8_t*)&value + shift, &rel, sizeof(rel));
+        __atomic_store_n(word, value, __ATOMIC_RELEASE);
+    } else {
+        memcpy(field, &rel, sizeof(rel));
+    }
+    pthread_mutex_unlock(&cacheLock);
+}
+
+void* Jit_WritableAddress(const void* code) {
+    return (uint8_t*)code + writeDelta;
+}
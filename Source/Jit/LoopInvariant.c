@@ -0,0 +1,383 @@
+#include "Jit/LoopInvariant.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define LICM_MAX_NAMES 64
+
+typedef struct {
+    Token written[LICM_MAX_NAMES];      // Locals assigned or declared in the loop
+    int writtenCount;
+    Token storedFields[LICM_MAX_NAMES]; // Field names of every p.f = v in the loop
+    int storedFieldCount;
+    int overflow;           // Too many names to track: hoist nothing
+    int unknownCalls;       // Calls that may write any memory
+    int resizes;            // push/pop anywhere in the loop
+    AstNode** out;
+    int max;
+    int count;
+} LicmScan;
+
+static int tokenIs(const Token* t, const char* text) {
+    int len = (int)strlen(text);
+    return t->length == len && memcmp(t->start, text, len) == 0;
+}
+
+static int containsName(const Token* names, int count, const Token* name) {
+    for (int i = 0; i < count; i++) {
+        if (names[i].length == name->length && memcmp(names[i].start, name->start, name->length) == 0) return 1;
+    }
+    return 0;
+}
+
+static void addName(LicmScan* scan, Token* names, int* count, Token name) {
+    if (*count < LICM_MAX_NAMES) names[(*count)++] = name;
+    else scan->overflow = 1;
+}
+
+static int isIdentifier(AstNode* node) {
+    return node->type == NODE_LITERAL_EXPR && ((LiteralExpr*)node)->token.type == TOKEN_IDENTIFIER;
+}
+
+// The a.method callee of a method call, NULL for plain calls
+static GetExpr* methodCall(CallExpr* call) {
+    if (call->callee->type != NODE_GET_EXPR) return NULL;
+    return (GetExpr*)call->callee;
+}
+
+// ==================== EFFECTS ====================
+
+static void scanEffects(LicmScan* scan, AstNode* node) {
+    if (!node) return;
+    switch (node->type) {
+        case NODE_BLOCK: {
+            BlockStmt* block = (BlockStmt*)node;
+            for (int i = 0; i < block->count; i++) scanEffects(scan, block->statements[i]);
+            break;
+        }
+        case NODE_VAR_DECL: {
+            VarDecl* decl = (VarDecl*)node;
+            scanEffects(scan, decl->initializer);
+            addName(scan, scan->written, &scan->writtenCount, decl->name);
+            break;
+        }
+        case NODE_ASSIGNMENT_EXPR: {
+            AssignmentExpr* assign = (AssignmentExpr*)node;
+            scanEffects(scan, assign->value);
+            addName(scan, scan->written, &scan->writtenCount, assign->name);
+            break;
+        }
+        case NODE_SET_EXPR: {
+            SetExpr* set = (SetExpr*)node;
+            scanEffects(scan, set->object);
+            scanEffects(scan, set->value);
+            addName(scan, scan->storedFields, &scan->storedFieldCount, set->name);
+            break;
+        }
+        case NODE_GET_EXPR:
+            scanEffects(scan, ((GetExpr*)node)->object);
+            break;
+        case NODE_CALL_EXPR: {
+            CallExpr* call = (CallExpr*)node;
+            GetExpr* method = methodCall(call);
+            if (method) {
+                scanEffects(scan, method->object);
+                if (tokenIs(&method->name, "push") || tokenIs(&method->name, "pop")) scan->resizes = 1;
+                else if (!tokenIs(&method->name, "length")) scan->unknownCalls = 1;
+            } else if (call->callee->type != NODE_LITERAL_EXPR ||
+                       ((LiteralExpr*)call->callee)->token.type != TOKEN_PRINT) {
+                scan->unknownCalls = 1;
+            }
+            for (int i = 0; i < call->argCount; i++) scanEffects(scan, call->args[i]);
+            break;
+        }
+        case NODE_BINARY_EXPR:
+            scanEffects(scan, ((BinaryExpr*)node)->left);
+            scanEffects(scan, ((BinaryExpr*)node)->right);
+            break;
+        case NODE_LOGICAL_EXPR:
+            scanEffects(scan, ((LogicalExpr*)node)->left);
+            scanEffects(scan, ((LogicalExpr*)node)->right);
+            break;
+        case NODE_UNARY_EXPR:
+            scanEffects(scan, ((UnaryExpr*)node)->right);
+            break;
+        case NODE_AWAIT_EXPR:
+            scan->unknownCalls = 1;
+            scanEffects(scan, ((AwaitExpr*)node)->expression);
+            break;
+        case NODE_ARRAY_LITERAL: {
+            ArrayLiteral* lit = (ArrayLiteral*)node;
+            for (int i = 0; i < lit->count; i++) scanEffects(scan, lit->elements[i]);
+            break;
+        }
+        case NODE_INDEX_EXPR:
+            scanEffects(scan, ((IndexExpr*)node)->array);
+            scanEffects(scan, ((IndexExpr*)node)->index);
+            break;
+        case NODE_INDEX_SET_EXPR: {
+            IndexSetExpr* set = (IndexSetExpr*)node;
+            scanEffects(scan, set->array);
+            scanEffects(scan, set->index);
+            scanEffects(scan, set->value);
+            break;
+        }
+        case NODE_STRUCT_INIT: {
+            StructInit* init = (StructInit*)node;
+            for (int i = 0; i < init->fieldCount; i++) scanEffects(scan, init->values[i]);
+            break;
+        }
+        case NODE_IF_STMT: {
+            IfStmt* stmt = (IfStmt*)node;
+            scanEffects(scan, stmt->condition);
+            scanEffects(scan, stmt->thenBranch);
+            scanEffects(scan, stmt->elseBranch);
+            break;
+        }
+        case NODE_FOR_STMT: {
+            ForStmt* loop = (ForStmt*)node;
+            scanEffects(scan, loop->initializer);
+            scanEffects(scan, loop->condition);
+            scanEffects(scan, loop->increment);
+            scanEffects(scan, loop->body);
+            break;
+        }
+        case NODE_RETURN_STMT:
+            scanEffects(scan, ((ReturnStmt*)node)->returnValue);
+            break;
+        case NODE_FUNCTION_DECL:
+            scan->unknownCalls = 1;    // Binds a name at runtime
+            break;
+        default:
+            break;
+    }
+}
+
+// ==================== INVARIANCE ====================
+
+static int isInvariant(LicmScan* scan, AstNode* node) {
+    switch (node->type) {
+        case NODE_LITERAL_EXPR: {
+            LiteralExpr* lit = (LiteralExpr*)node;
+            if (lit->token.type != TOKEN_IDENTIFIER) return lit->token.type != TOKEN_PRINT;
+            return !containsName(scan->written, scan->writtenCount, &lit->token);
+        }
+        case NODE_STRING_LITERAL:
+            return 1;
+        case NODE_BINARY_EXPR:
+            return isInvariant(scan, ((BinaryExpr*)node)->left) && isInvariant(scan, ((BinaryExpr*)node)->right);
+        case NODE_UNARY_EXPR:
+            return isInvariant(scan, ((UnaryExpr*)node)->right);
+        case NODE_GET_EXPR: {
+            GetExpr* get = (GetExpr*)node;
+            return !scan->unknownCalls && isIdentifier(get->object) && isInvariant(scan, get->object) &&
+                   !containsName(scan->storedFields, scan->storedFieldCount, &get->name);
+        }
+        case NODE_CALL_EXPR: {
+            CallExpr* call = (CallExpr*)node;
+            GetExpr* method = methodCall(call);
+            return method && call->argCount == 0 && tokenIs(&method->name, "length") &&
+                   !scan->unknownCalls && !scan->resizes &&
+                   isIdentifier(method->object) && isInvariant(scan, method->object);
+        }
+        default:
+            return 0;
+    }
+}
+
+// Literals and plain locals are already as cheap as a hoisted home
+static int isWorthHoisting(AstNode* node) {
+    return node->type == NODE_BINARY_EXPR || node->type == NODE_UNARY_EXPR ||
+           node->type == NODE_GET_EXPR || node->type == NODE_CALL_EXPR;
+}
+
+// Could evaluating this before the guarding if fault (loads, int division)?
+static int mayFault(AstNode* node) {
+    switch (node->type) {
+        case NODE_BINARY_EXPR: {
+            BinaryExpr* bin = (BinaryExpr*)node;
+            if (bin->op.type == TOKEN_SLASH) {
+                AstNode* divisor = bin->right;
+                int nonZeroLiteral = divisor->type == NODE_LITERAL_EXPR &&
+                                     ((LiteralExpr*)divisor)->token.type == TOKEN_NUMBER &&
+                                     strtod(((LiteralExpr*)divisor)->token.start, NULL) != 0.0;
+                if (!nonZeroLiteral) return 1;
+            }
+            return mayFault(bin->left) || mayFault(bin->right);
+        }
+        case NODE_UNARY_EXPR:
+            return mayFault(((UnaryExpr*)node)->right);
+        case NODE_GET_EXPR:
+        case NODE_CALL_EXPR:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// ==================== CANDIDATES ====================
+
+static void findCandidates(LicmScan* scan, AstNode* node, int conditional) {
+    if (!node || scan->count == scan->max) return;
+
+    if (isWorthHoisting(node) && isInvariant(scan, node) && !(conditional && mayFault(node))) {
+        scan->out[scan->count++] = node;
+        return;
+    }
+
+    switch (node->type) {
+        case NODE_BLOCK: {
+            // Statements after one that can branch or leave may never run
+            BlockStmt* block = (BlockStmt*)node;
+            for (int i = 0; i < block->count; i++) {
+                AstNode* stmt = block->statements[i];
+                findCandidates(scan, stmt, conditional);
+                if (stmt->type == NODE_IF_STMT || stmt->type == NODE_RETURN_STMT ||
+                    stmt->type == NODE_FOR_STMT) conditional = 1;
+            }
+            break;
+        }
+        case NODE_VAR_DECL:
+            findCandidates(scan, ((VarDecl*)node)->initializer, conditional);
+            break;
+        case NODE_ASSIGNMENT_EXPR:
+            findCandidates(scan, ((AssignmentExpr*)node)->value, conditional);
+            break;
+        case NODE_SET_EXPR:
+            findCandidates(scan, ((SetExpr*)node)->object, conditional);
+            findCandidates(scan, ((SetExpr*)node)->value, conditional);
+            break;
+        case NODE_GET_EXPR:
+            findCandidates(scan, ((GetExpr*)node)->object, conditional);
+            break;
+        case NODE_CALL_EXPR: {
+            CallExpr* call = (CallExpr*)node;
+            GetExpr* method = methodCall(call);
+            if (method) findCandidates(scan, method->object, conditional);
+            for (int i = 0; i < call->argCount; i++) findCandidates(scan, call->args[i], conditional);
+            break;
+        }
+        case NODE_BINARY_EXPR:
+            findCandidates(scan, ((BinaryExpr*)node)->left, conditional);
+            findCandidates(scan, ((BinaryExpr*)node)->right, conditional);
+            break;
+        case NODE_LOGICAL_EXPR:
+            // The right side only runs when the left does not decide
+            findCandidates(scan, ((LogicalExpr*)node)->left, conditional);
+            findCandidates(scan, ((LogicalExpr*)node)->right, 1);
+            break;
+        case NODE_UNARY_EXPR:
+            findCandidates(scan, ((UnaryExpr*)node)->right, conditional);
+            break;
+        case NODE_INDEX_EXPR:
+            findCandidates(scan, ((IndexExpr*)node)->array, conditional);
+            findCandidates(scan, ((IndexExpr*)node)->index, conditional);
+            break;
+        case NODE_INDEX_SET_EXPR: {
+            IndexSetExpr* set = (IndexSetExpr*)node;
+            findCandidates(scan, set->array, conditional);
+            findCandidates(scan, set->index, conditional);
+            findCandidates(scan, set->value, conditional);
+            break;
+        }
+        case NODE_STRUCT_INIT: {
+            StructInit* init = (StructInit*)node;
+            for (int i = 0; i < init->fieldCount; i++) findCandidates(scan, init->values[i], conditional);
+            break;
+        }
+        case NODE_ARRAY_LITERAL: {
+            ArrayLiteral* lit = (ArrayLiteral*)node;
+            for (int i = 0; i < lit->count; i++) findCandidates(scan, lit->elements[i], conditional);
+            break;
+        }
+        case NODE_IF_STMT: {
+            IfStmt* stmt = (IfStmt*)node;
+            findCandidates(scan, stmt->condition, conditional);
+            findCandidates(scan, stmt->thenBranch, 1);
+            findCandidates(scan, stmt->elseBranch, 1);
+            break;
+        }
+        case NODE_RETURN_STMT:
+            findCandidates(scan, ((ReturnStmt*)node)->returnValue, conditional);
+            break;
+        case NODE_FOR_STMT:        // Nested loops hoist into their own preheader
+        case NODE_AWAIT_EXPR:
+        case NODE_FUNCTION_DECL:
+        default:
+            break;
+    }
+}
+
+int Licm_FindInvariants(ForStmt* loop, AstNode** out, int max) {
+    LicmScan scan;
+    memset(&scan, 0, sizeof(scan));
+    scan.out = out;
+    scan.max = max;
+
+    scanEffects(&scan, loop->condition);
+    scanEffects(&scan, loop->body);
+    scanEffects(&scan, loop->increment);
+    if (scan.overflow) return 0;
+
+    // The condition runs before every iteration, including the first, so
+    // it is never speculative. The body only runs once the guard passed.
+    findCandidates(&scan, loop->condition, 0);
+    findCandidates(&scan, loop->body, 0);
+    findCandidates(&scan, loop->increment, 0);
+    return scan.count;
+}
+
+// ==================== COUNTED ARRAY LOOPS ====================
+
+// Integral number literal >= minimum
+static int isIntLiteralAtLeast(AstNode* node, double minimum) {
+    if (node->type != NODE_LITERAL_EXPR || ((LiteralExpr*)node)->token.type != TOKEN_NUMBER) return 0;
+    Token* t = &((LiteralExpr*)node)->token;
+    for (int i = 0; i < t->length; i++) {
+        if (t->start[i] == '.' || t->start[i] == 'e' || t->start[i] == 'E') return 0;
+    }
+    return strtod(t->start, NULL) >= minimum;
+}
+
+static int isName(AstNode* node, const Token* name) {
+    return isIdentifier(node) && containsName(name, 1, &((LiteralExpr*)node)->token);
+}
+
+int Licm_FindCountedArrayLoop(ForStmt* loop, Token* induction, Token* array) {
+    // int i = k, k >= 0
+    if (!loop->initializer || loop->initializer->type != NODE_VAR_DECL) return 0;
+    VarDecl* init = (VarDecl*)loop->initializer;
+    if (!tokenIs(&init->typeName, "int") && !tokenIs(&init->typeName, "long")) return 0;
+    if (!init->initializer || !isIntLiteralAtLeast(init->initializer, 0)) return 0;
+
+    // i < a.length()
+    if (!loop->condition || loop->condition->type != NODE_BINARY_EXPR) return 0;
+    BinaryExpr* cond = (BinaryExpr*)loop->condition;
+    if (cond->op.type != TOKEN_LESS || !isName(cond->left, &init->name)) return 0;
+    if (cond->right->type != NODE_CALL_EXPR) return 0;
+    CallExpr* call = (CallExpr*)cond->right;
+    GetExpr* method = methodCall(call);
+    if (!method || call->argCount != 0 || !tokenIs(&method->name, "length") || !isIdentifier(method->object)) return 0;
+    Token* arrayName = &((LiteralExpr*)method->object)->token;
+
+    // i = i + c, c >= 1
+    if (!loop->increment || loop->increment->type != NODE_ASSIGNMENT_EXPR) return 0;
+    AssignmentExpr* inc = (AssignmentExpr*)loop->increment;
+    if (!containsName(&init->name, 1, &inc->name) || inc->value->type != NODE_BINARY_EXPR) return 0;
+    BinaryExpr* step = (BinaryExpr*)inc->value;
+    if (step->op.type != TOKEN_PLUS) return 0;
+    AstNode* amount = isName(step->left, &init->name) ? step->right :
+                      isName(step->right, &init->name) ? step->left : NULL;
+    if (!amount || !isIntLiteralAtLeast(amount, 1)) return 0;
+
+    // The body never moves i, rebinds a or changes its length
+    LicmScan scan;
+    memset(&scan, 0, sizeof(scan));
+    scanEffects(&scan, loop->body);
+    if (scan.overflow || scan.unknownCalls || scan.resizes) return 0;
+    if (containsName(scan.written, scan.writtenCount, &init->name) ||
+        containsName(scan.written, scan.writtenCount, arrayName)) return 0;
+
+    *induction = init->name;
+    *array = *arrayName;
+    return 1;
+}
@@ -0,0 +1,355 @@
+#include "Jit/RegisterMap.h"
+#include "Jit/AssemblerX64.h"
+#include "Jit/LoopInvariant.h"
+#include <string.h>
+
+// Allocation order for each class
+static const int gprPool[REGMAP_GPR_COUNT] = { RBX, R12, R13, R14, R15 };
+static const int xmmPool[REGMAP_XMM_COUNT] = { XMM8, XMM9, XMM10, XMM11, XMM12, XMM13, XMM14, XMM15 };
+
+// Scope tracking during the liveness walk (mirrors CodeGen block scoping)
+typedef struct {
+    Token name;
+    Token typeName;
+    int interval;           // Index into map->intervals, -1 if not allocatable
+} ScopeEntry;
+
+typedef struct {
+    RegisterMap* map;
+    ScopeEntry scope[REGMAP_MAX_INTERVALS];
+    int scopeCount;
+    int position;           // Linear position counter
+} LivenessWalk;
+
+static int tokenIs(const Token* t, const char* text) {
+    int len = (int)strlen(text);
+    return t->length == len && memcmp(t->start, text, len) == 0;
+}
+
+RegisterClass RegMap_ClassForType(const Token* typeName) {
+    if (typeName->start == NULL) return REG_CLASS_NONE;
+    if (tokenIs(typeName, "double") || tokenIs(typeName, "float")) return REG_CLASS_XMM;
+    if (tokenIs(typeName, "int") || tokenIs(typeName, "long") ||
+        tokenIs(typeName, "boolean") || tokenIs(typeName, "byte") ||
+        tokenIs(typeName, "short") || tokenIs(typeName, "char")) return REG_CLASS_GPR;
+    return REG_CLASS_NONE;
+}
+
+static int addInterval(LivenessWalk* walk, const void* key, Token name, RegisterClass cls) {
+    RegisterMap* map = walk->map;
+    if (cls == REG_CLASS_NONE || map->count >= REGMAP_MAX_INTERVALS) return -1;
+
+    int index = map->count++;
+    LiveInterval* it = &map->intervals[index];
+    it->key = key;
+    it->name = name;
+    it->regClass = cls;
+    it->start = walk->position;
+    it->end = walk->position;
+    it->reg = -1;
+    return index;
+}
+
+static void define(LivenessWalk* walk, const void* key, Token name, Token typeName) {
+    int index = addInterval(walk, key, name, RegMap_ClassForType(&typeName));
+
+    if (walk->scopeCount < REGMAP_MAX_INTERVALS) {
+        walk->scope[walk->scopeCount].name = name;
+        walk->scope[walk->scopeCount].typeName = typeName;
+        walk->scope[walk->scopeCount].interval = index;
+        walk->scopeCount++;
+    }
+}
+
+static void use(LivenessWalk* walk, const Token* name) {
+    // Scan backwards to honour shadowing
+    for (int i = walk->scopeCount - 1; i >= 0; i--) {
+        Token* n = &walk->scope[i].name;
+        if (n->length == name->length && memcmp(n->start, name->start, name->length) == 0) {
+            int index = walk->scope[i].interval;
+            if (index >= 0 && walk->map->intervals[index].end < walk->position) {
+                walk->map->intervals[index].end = walk->position;
+            }
+            return;
+        }
+    }
+}
+
+static const Token* lookupType(LivenessWalk* walk, const Token* name) {
+    for (int i = walk->scopeCount - 1; i >= 0; i--) {
+        Token* n = &walk->scope[i].name;
+        if (n->length == name->length && memcmp(n->start, name->start, name->length) == 0) {
+            return &walk->scope[i].typeName;
+        }
+    }
+    return NULL;
+}
+
+// Numeric kind of a hoisted expression, following CodeGen's operation
+// types: 0 = not known here (boxed, struct field, ...), 1 = int, 2 = double
+static int numericKind(LivenessWalk* walk, AstNode* node) {
+    switch (node->type) {
+        case NODE_LITERAL_EXPR: {
+            LiteralExpr* lit = (LiteralExpr*)node;
+            if (lit->token.type == TOKEN_NUMBER) {
+                for (int i = 0; i < lit->token.length; i++) {
+                    char c = lit->token.start[i];
+                    if (c == '.' || c == 'e' || c == 'E') return 2;
+                }
+                return 1;
+            }
+            if (lit->token.type == TOKEN_TRUE || lit->token.type == TOKEN_FALSE) return 1;
+            if (lit->token.type != TOKEN_IDENTIFIER) return 0;
+            const Token* type = lookupType(walk, &lit->token);
+            if (!type) return 0;
+            RegisterClass cls = RegMap_ClassForType(type);
+            return cls == REG_CLASS_GPR ? 1 : cls == REG_CLASS_XMM ? 2 : 0;
+        }
+        case NODE_BINARY_EXPR: {
+            BinaryExpr* bin = (BinaryExpr*)node;
+            int left = numericKind(walk, bin->left);
+            int right = numericKind(walk, bin->right);
+            if (left == 0 || right == 0) return 0;
+            switch (bin->op.type) {
+                case TOKEN_PLUS: case TOKEN_MINUS: case TOKEN_STAR: case TOKEN_SLASH:
+                    return left > right ? left : right;
+                default:
+                    return 1;   // Comparisons give a raw 0/1
+            }
+        }
+        case NODE_UNARY_EXPR: {
+            UnaryExpr* unary = (UnaryExpr*)node;
+            if (unary->op.type == TOKEN_BANG) return 1;
+            return numericKind(walk, unary->right);
+        }
+        case NODE_CALL_EXPR:
+            return 1;           // a.length() is the only hoisted call
+        default:
+            return 0;
+    }
+}
+
+static void walkNode(LivenessWalk* walk, AstNode* node) {
+    if (!node) return;
+    walk->position++;
+
+    switch (node->type) {
+        case NODE_BLOCK: {
+            BlockStmt* block = (BlockStmt*)node;
+            int savedScope = walk->scopeCount;
+            for (int i = 0; i < block->count; i++) {
+                walkNode(walk, block->statements[i]);
+            }
+            walk->scopeCount = savedScope;
+            break;
+        }
+        case NODE_VAR_DECL: {
+            VarDecl* decl = (VarDecl*)node;
+            walkNode(walk, decl->initializer);
+            walk->position++;
+            define(walk, decl, decl->name, decl->typeName);
+            break;
+        }
+        case NODE_LITERAL_EXPR: {
+            LiteralExpr* lit = (LiteralExpr*)node;
+            if (lit->token.type == TOKEN_IDENTIFIER) use(walk, &lit->token);
+            break;
+        }
+        case NODE_ASSIGNMENT_EXPR: {
+            AssignmentExpr* assign = (AssignmentExpr*)node;
+            walkNode(walk, assign->value);
+            walk->position++;
+            use(walk, &assign->name);
+            break;
+        }
+        case NODE_SET_EXPR: {
+            SetExpr* set = (SetExpr*)node;
+            walkNode(walk, set->object);
+            walkNode(walk, set->value);
+            break;
+        }
+        case NODE_GET_EXPR:
+            walkNode(walk, ((GetExpr*)node)->object);
+            break;
+        case NODE_CALL_EXPR: {
+            CallExpr* call = (CallExpr*)node;
+            walkNode(walk, call->callee);
+            for (int i = 0; i < call->argCount; i++) walkNode(walk, call->args[i]);
+            break;
+        }
+        case NODE_BINARY_EXPR:
+            walkNode(walk, ((BinaryExpr*)node)->left);
+            walkNode(walk, ((BinaryExpr*)node)->right);
+            break;
+        case NODE_LOGICAL_EXPR:
+            walkNode(walk, ((LogicalExpr*)node)->left);
+            walkNode(walk, ((LogicalExpr*)node)->right);
+            break;
+        case NODE_UNARY_EXPR:
+            walkNode(walk, ((UnaryExpr*)node)->right);
+            break;
+        case NODE_AWAIT_EXPR:
+            walkNode(walk, ((AwaitExpr*)node)->expression);
+            break;
+        case NODE_ARRAY_LITERAL: {
+            ArrayLiteral* lit = (ArrayLiteral*)node;
+            for (int i = 0; i < lit->count; i++) walkNode(walk, lit->elements[i]);
+            break;
+        }
+        case NODE_INDEX_EXPR:
+            walkNode(walk, ((IndexExpr*)node)->array);
+            walkNode(walk, ((IndexExpr*)node)->index);
+            break;
+        case NODE_INDEX_SET_EXPR: {
+            IndexSetExpr* set = (IndexSetExpr*)node;
+            walkNode(walk, set->array);
+            walkNode(walk, set->index);
+            walkNode(walk, set->value);
+            break;
+        }
+        case NODE_STRUCT_INIT: {
+            StructInit* init = (StructInit*)node;
+            for (int i = 0; i < init->fieldCount; i++) walkNode(walk, init->values[i]);
+            break;
+        }
+        case NODE_IF_STMT: {
+            IfStmt* stmt = (IfStmt*)node;
+            walkNode(walk, stmt->condition);
+            walkNode(walk, stmt->thenBranch);
+            walkNode(walk, stmt->elseBranch);
+            break;
+        }
+        case NODE_FOR_STMT: {
+            ForStmt* loop = (ForStmt*)node;
+            // Initializer lives in the enclosing scope (CodeGen opens no block for it)
+            walkNode(walk, loop->initializer);
+            int header = ++walk->position;
+
+            // Loop invariants are computed once before the loop and held
+            // for its whole duration (keyed by the expression node)
+            AstNode* invariants[LICM_MAX_INVARIANTS];
+            int hoisted[LICM_MAX_INVARIANTS];
+            int invariantCount = Licm_FindInvariants(loop, invariants, LICM_MAX_INVARIANTS);
+            for (int i = 0; i < invariantCount; i++) {
+                int kind = numericKind(walk, invariants[i]);
+                RegisterClass cls = kind == 1 ? REG_CLASS_GPR : kind == 2 ? REG_CLASS_XMM : REG_CLASS_NONE;
+                hoisted[i] = addInterval(walk, invariants[i], (Token){0}, cls);
+            }
+
+            walkNode(walk, loop->condition);
+            walkNode(walk, loop->body);
+            walkNode(walk, loop->increment);
+            int loopEnd = ++walk->position;
+
+            for (int i = 0; i < invariantCount; i++) {
+                if (hoisted[i] >= 0) walk->map->intervals[hoisted[i]].end = loopEnd;
+            }
+
+            // Anything defined before the header and touched inside the loop
+            // must stay resident across the back edge.
+            for (int i = 0; i < walk->map->count; i++) {
+                LiveInterval* it = &walk->map->intervals[i];
+                if (it->start < header && it->end >= header && it->end < loopEnd) {
+                    it->end = loopEnd;
+                }
+            }
+            break;
+        }
+        case NODE_RETURN_STMT:
+            walkNode(walk, ((ReturnStmt*)node)->returnValue);
+            break;
+        case NODE_FUNCTION_DECL:   // Nested declarations are allocated separately
+        case NODE_STRUCT_DECL:
+        case NODE_STRING_LITERAL:
+        default:
+            break;
+    }
+}
+
+// Linear scan over one register class (Poletto & Sarkar).
+// Intervals are already sorted by start since definitions are numbered in walk order.
+static void linearScan(RegisterMap* map, RegisterClass cls, const int* pool, int poolSize, uint32_t* usedMask) {
+    int active[REGMAP_MAX_INTERVALS];  // Sorted by increasing end
+    int activeCount = 0;
+    int freeRegs[16];
+    int freeCount = 0;
+
+    for (int i = poolSize - 1; i >= 0; i--) freeRegs[freeCount++] = pool[i];
+
+    for (int i = 0; i < map->count; i++) {
+        LiveInterval* cur = &map->intervals[i];
+        if (cur->regClass != cls) continue;
+
+        // Expire intervals that ended before this one starts
+        int kept = 0;
+        for (int a = 0; a < activeCount; a++) {
+            LiveInterval* old = &map->intervals[active[a]];
+            if (old->end < cur->start) {
+                freeRegs[freeCount++] = old->reg;
+            } else {
+                active[kept++] = active[a];
+            }
+        }
+        activeCount = kept;
+
+        if (freeCount == 0) {
+            // Spill whichever interval ends last
+            LiveInterval* last = &map->intervals[active[activeCount - 1]];
+            if (last->end > cur->end) {
+                cur->reg = last->reg;
+                last->reg = -1;
+                activeCount--;
+            } else {
+                cur->reg = -1;
+                map->spillCount++;
+                continue;
+            }
+            map->spillCount++;
+        } else {
+            cur->reg = freeRegs[--freeCount];
+        }
+
+        *usedMask |= (1u << cur->reg);
+
+        // Insert keeping active sorted by end
+        int pos = activeCount;
+        while (pos > 0 && map->intervals[active[pos - 1]].end > cur->end) {
+            active[pos] = active[pos - 1];
+            pos--;
+        }
+        active[pos] = i;
+        activeCount++;
+    }
+}
+
+void RegMap_Allocate(RegisterMap* map, FunctionDecl* func) {
+    LivenessWalk walk;
+    map->count = 0;
+    map->usedGprMask = 0;
+    map->usedXmmMask = 0;
+    map->spillCount = 0;
+    walk.map = map;
+    walk.scopeCount = 0;
+    walk.position = 0;
+
+    for (int i = 0; i < func->paramCount; i++) {
+        define(&walk, &func->params[i], func->params[i], func->paramTypes[i]);
+    }
+    walkNode(&walk, func->body);
+
+    linearScan(map, REG_CLASS_GPR, gprPool, REGMAP_GPR_COUNT, &map->usedGprMask);
+    linearScan(map, REG_CLASS_XMM, xmmPool, REGMAP_XMM_COUNT, &map->usedXmmMask);
+}
+
+int RegMap_Lookup(const RegisterMap* map, const void* key, RegisterClass* outClass) {
+    if (map) {
+        for (int i = 0; i < map->count; i++) {
+            if (map->intervals[i].key == key) {
+                if (outClass) *outClass = map->intervals[i].regClass;
+                return map->intervals[i].reg;
+            }
+        }
+    }
+    if (outClass) *outClass = REG_CLASS_NONE;
+    return -1;
+}
@@ -4,7 +4,12 @@
 #include <string.h>
 #include <time.h>
 #include "Compiler/Parser.h"
+#include "Compiler/Optimizer.h"
 #include "Jit/CodeGen.h"
+#include "Jit/ExecutableMemory.h"
+#include "Jit/DiskCache.h"
+#include "Jit/DebugInfo.h"
+#include "Jit/CpuFeatures.h"
 #include "Core/Memory.h"
 #include "Core/GarbageCollector.h"
 #include "Core/EventLoop.h"
@@ -30,9 +35,50 @@ char* readFile(const char* path) {
     return buffer;
 }
 
+// VANARIZE_ISA=sse2|sse4|avx2 (see Jit/CpuFeatures.h). Returns 0 if unset.
+static int applyIsaLevel(void) {
+    const char* name = getenv("VANARIZE_ISA");
+    if (!name) return 0;
+    CpuIsaLevel level;
+    if (!Cpu_ParseIsaLevel(name, &level)) {
+        fprintf(stderr, "Unknown VANARIZE_ISA '%s' (expected sse2, sse4 or avx2).\n", name);
+        exit(64);
+    }
+    Cpu_SetIsaLevel(level);
+    return 1;
+}
+
+// vanarize --emit-obj <path> <output.o>
+static int emitObject(const char* path, const char* output) {
+    char* source = readFile(path);
+    Jit_BeginObject();
+    Parser_SetFile(path);
+    Parser_Init(source);
+    AstNode* root = Parser_ParseProgram();
+    if (!root) {
+        fprintf(stderr, "Parse error.\n");
+        exit(65);
+    }
+    
+    Optimizer_FoldProgram(root);
+    if (!Jit_Compile(root) || !Jit_WriteObject(output)) exit(70);
+    
+    free(source);
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
+    if (argc == 4 && strcmp(argv[1], "--emit-obj") == 0) {
+        VM_InitMemory();
+        GC_Init(&argc);
+        // Objects may run on another machine: baseline x86-64 unless pinned
+        if (!applyIsaLevel()) Cpu_SetIsaLevel(CPU_ISA_SSE2);
+        if (getenv("VANARIZE_COMPILE_THREADS")) Jit_SetCompileThreads(atoi(getenv("VANARIZE_COMPILE_THREADS")));
+        return emitObject(argv[2], argv[3]);
+    }
+    
     if (argc != 2) {
-        fprintf(stderr, "Usage: vanarize [path] or vanarize -v\n");
+        fprintf(stderr, "Usage: vanarize [path], vanarize --emit-obj [path] [output.o] or vanarize -v\n");
         exit(64);
     }
     
@@ -46,21 +92,40 @@ int main(int argc, char* argv[]) {
     GC_Init(&argc); // Initialize GC with stack bottom
     EventLoop_Init();
     // Jit_Init(); // Initialized internally or not needed if stateless
+    if (getenv("VANARIZE_HUGEPAGES")) Jit_SetHugePages(1); // 2 MB code cache pages
+    applyIsaLevel();                                       // VANARIZE_ISA caps CPU features
+    if (getenv("VANARIZE_NO_TIERING")) Jit_SetTiering(0);  // Optimize everything up front
+    if (getenv("VANARIZE_COMPILE_THREADS")) Jit_SetCompileThreads(atoi(getenv("VANARIZE_COMPILE_THREADS"))); // Worker pool for function bodies
+    if (getenv("VANARIZE_CACHE_DIR")) DiskCache_SetDirectory(getenv("VANARIZE_CACHE_DIR"));
+    if (getenv("VANARIZE_PERF_MAP")) Debug_EnablePerfMap();              // /tmp/perf-<pid>.map
+    if (getenv("VANARIZE_JITDUMP")) Debug_EnableJitDump(getenv("VANARIZE_JITDUMP")); // Directory for jit-<pid>.dump
+    if (getenv("VANARIZE_GDB_JIT")) Debug_SetGdbJit(1);                   // Symfiles for GDB
+    if (!getenv("VANARIZE_NO_CRASH_HANDLER")) Debug_InstallCrashHandler(); // JIT backtrace on fatal signals
     
     // Check args
     char* source = readFile(argv[1]);
     
-    Parser_Init(source);
-    AstNode* root = Parser_ParseProgram();  // Parse entire program
-    if (!root) {
-        fprintf(stderr, "Parse error.\n");
-        exit(65);
+    // Warm start: machine code from the persistent cache, no parsing
+    JitFunction func = Jit_LoadCached(source);
+    if (!func) {
+        Parser_SetFile(argv[1]);
+        Parser_Init(source);
+        AstNode* root = Parser_ParseProgram();  // Parse entire program
+        if (!root) {
+            fprintf(stderr, "Parse error.\n");
+            exit(65);
+        }
+        
+        Optimizer_FoldProgram(root);            // Constant folding before emission
+        
+        func = Jit_Compile(root);
+        int importCount;
+        const char* const* imports = Parser_GetImports(&importCount);
+        if (func) Jit_StoreCached(source, imports, importCount);
     }
-    
-    
-    JitFunction func = Jit_Compile(root);
     func();
     
+    Debug_SetGdbJit(0);     // Unregisters and frees the symfiles
     free(source);
     return 0;
 }
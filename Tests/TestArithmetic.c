@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <assert.h>
+#include "Compiler/Parser.h"
+#include "Jit/CodeGen.h"
+#include "Core/VanarizeValue.h"
+#include "Core/Memory.h"
+#include "Core/GarbageCollector.h"
+
+// Compiles a program and returns what Main returns
+static double run(const char* source) {
+    Parser_Init(source);
+    AstNode* root = Parser_ParseProgram();
+    assert(root != NULL);
+    JitFunction func = Jit_Compile(root);
+    assert(func != NULL);
+    return ValueToNumber(func());
+}
+
+// Main() { <declarations> return <expression>; }
+static void check(const char* expression, double expected) {
+    char source[512];
+    snprintf(source, sizeof(source),
+             "function Main() {\n"
+             "    int a = 7;\n"
+             "    int b = -2;\n"
+             "    long l = 9;\n"
+             "    double x = 2.5;\n"
+             "    double y = 0.5;\n"
+             "    return %s;\n"
+             "}\n", expression);
+    double result = run(source);
+    printf("  %-10s = %g (Expected %g)\n", expression, result, expected);
+    assert(result == expected);
+}
+
+int main() {
+    printf("Testing Typed Arithmetic...\n");
+    int stackBottom;
+    VM_InitMemory();
+    GC_Init(&stackBottom);
+
+    // int op int: 64-bit ALU, division truncates toward zero
+    check("a + b", 5);
+    check("a - b", 9);
+    check("a * b", -14);
+    check("a / b", -3);
+    check("b / a", 0);
+    check("l / a", 1);
+    check("a + l", 16);
+
+    // double op double
+    check("x + y", 3);
+    check("x - y", 2);
+    check("x * y", 1.25);
+    check("x / y", 5);
+
+    // Mixed: the int side is converted, in either operand position
+    check("a * x", 17.5);
+    check("x * a", 17.5);
+    check("a - y", 6.5);
+    check("y - a", -6.5);
+    check("a / x", 2.8);
+    check("x / a", 2.5 / 7);
+
+    printf("Typed Arithmetic OK.\n");
+    return 0;
+}
@@ -0,0 +1,114 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "Compiler/Parser.h"
+#include "Jit/CodeGen.h"
+#include "Core/VanarizeValue.h"
+#include "Core/Memory.h"
+#include "Core/GarbageCollector.h"
+
+// Inline element access takes the cold stub when the storage kind is not
+// the static one (the helper converts) or the index is out of range (the
+// helper reports it and exits).
+
+static double run(const char* source) {
+    Parser_Init(source);
+    AstNode* root = Parser_ParseProgram();
+    assert(root != NULL);
+    JitFunction func = Jit_Compile(root);
+    assert(func != NULL);
+    return ValueToNumber(func());
+}
+
+// Check returns the number of the first failed test
+static const char* conversions =
+    "function Sum(double[] v) :: double {\n"
+    "    double s = 0.0;\n"
+    "    for (int i = 0; i < v.length(); i = i + 1) { s = s + v[i]; }\n"
+    "    return s;\n"
+    "}\n"
+    "function Store(double[] v, int i) {\n"
+    "    v[i] = 2.5;\n"
+    "}\n"
+    "function Check() :: int {\n"
+    "    int[] a = [1, 2, 3];\n"
+    "    if (Sum(a) != 6) { return 1; }\n"     // int storage read as double[]
+    "    Store(a, 1);\n"                        // double stored into int storage
+    "    if (a[1] != 2) { return 2; }\n"
+    "    float[] f = [0.5, 1.5];\n"
+    "    if (Sum(f) != 2) { return 3; }\n"
+    "    double[] d = [1.5, 2.5];\n"
+    "    d[1] = 7;\n"
+    "    if (d[0] + d[1] != 8.5) { return 4; }\n"
+    "    return 0;\n"
+    "}\n"
+    "function Main() {\n"
+    "    return Check();\n"
+    "}\n";
+
+// Runs Main() { <body> } in a child and expects it to exit 1 with message
+static void expectOutOfBounds(const char* body, const char* message) {
+    char source[1024];
+    snprintf(source, sizeof(source),
+             "function At(int[] a, int i) :: int { return a[i]; }\n"
+             "function Main() {\n%s\n    return 0;\n}\n", body);
+
+    int pipeFds[2];
+    assert(pipe(pipeFds) == 0);
+    fflush(stdout);
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        dup2(pipeFds[1], STDERR_FILENO);
+        close(pipeFds[0]);
+        run(source);
+        _exit(0);   // Not reached if the access was caught
+    }
+    close(pipeFds[1]);
+
+    char output[256];
+    size_t length = 0;
+    ssize_t n;
+    while ((n = read(pipeFds[0], output + length, sizeof(output) - 1 - length)) > 0) length += n;
+    output[length] = '\0';
+    close(pipeFds[0]);
+
+    int status;
+    waitpid(pid, &status, 0);
+    printf("  %s -> %s", message, output);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 1);
+    assert(strstr(output, message) != NULL);
+}
+
+int main() {
+    printf("Testing Array Access Stubs...\n");
+    int stackBottom;
+    VM_InitMemory();
+    GC_Init(&stackBottom);
+
+    // Baseline tier, then optimized up front
+    for (int tiering = 1; tiering >= 0; tiering--) {
+        Jit_SetTiering(tiering);
+
+        double failed = run(conversions);
+        printf("Tiering %d, first failed check: %g (Expected 0)\n", tiering, failed);
+        assert(failed == 0);
+
+        expectOutOfBounds("    int[] a = [1, 2, 3];\n    print(a[3]);",
+                          "Out of Bounds: 3 (Size: 3)");
+        expectOutOfBounds("    int[] a = [1, 2, 3];\n    print(At(a, -1));",
+                          "Out of Bounds: -1 (Size: 3)");
+        expectOutOfBounds("    double[] d = [1.5];\n    int i = 1;\n    d[i] = 2.0;",
+                          "Out of Bounds: 1 (Size: 1)");
+        expectOutOfBounds("    float[] f = [];\n    f[0] = 1;",
+                          "Out of Bounds: 0 (Size: 0)");
+        expectOutOfBounds("    string[] s = [\"x\"];\n    s[2] = \"y\";",
+                          "Out of Bounds: 2 (Size: 1)");
+    }
+
+    printf("Array Access Stubs OK.\n");
+    return 0;
+}
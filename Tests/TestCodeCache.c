@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "Jit/AssemblerX64.h"
+#include "Jit/ExecutableMemory.h"
+
+typedef uint64_t (*JitFunc)(void);
+
+// Emits "MOV EAX, value; RET" padded with NOPs to the requested size
+// (small values take the 5-byte zero-extending form)
+static void* installConstant(uint64_t value, size_t size, const char* name, int nameLength) {
+    Assembler as;
+    Asm_InitDynamic(&as, 16);
+    while (as.offset + 6 < size) Asm_Emit8(&as, 0x90); // NOP
+    Asm_Mov_Imm64(&as, RAX, value);
+    Asm_Ret(&as);
+    void* code = Jit_InstallCode(as.buffer, as.offset, name, nameLength);
+    Asm_Free(&as);
+    return code;
+}
+
+#define INSTALL_THREADS 4
+#define INSTALLS_PER_THREAD 5000
+
+static void* installMany(void* arg) {
+    uintptr_t id = (uintptr_t)arg;
+    for (int i = 0; i < INSTALLS_PER_THREAD; i++) {
+        uint8_t* code = installConstant(id * 100000 + i, 24, "T", 1);
+        assert(((JitFunc)code)() == id * 100000 + i);
+    }
+    return NULL;
+}
+
+static int byStart(const void* x, const void* y) {
+    uintptr_t p = (uintptr_t)((const JitCodeEntry*)x)->start;
+    uintptr_t q = (uintptr_t)((const JitCodeEntry*)y)->start;
+    return p < q ? -1 : p > q;
+}
+
+static uint8_t* stub;
+static uint8_t* targets[2];
+static volatile int patching = 1;
+
+// Flips the stub's JMP between the targets while main keeps calling it
+static void* flipStub(void* arg) {
+    (void)arg;
+    for (int i = 0; i < 200000; i++) Jit_PatchRel32(stub + 1, targets[i & 1]);
+    patching = 0;
+    return NULL;
+}
+
+int main() {
+    printf("Testing Code Cache...\n");
+
+    // Small functions share one region, back to back
+    uint8_t* a = installConstant(1, 20, "A", 1);
+    uint8_t* b = installConstant(2, 20, "B", 1);
+    assert(((uintptr_t)a % JIT_CODE_ALIGNMENT) == 0);
+    assert(b == a + 32);   // 20 bytes rounded up to the 16-byte alignment
+    assert(((JitFunc)a)() == 1);
+    assert(((JitFunc)b)() == 2);
+
+    // The staging buffer grew from 16 bytes past the old 4 KB limit
+    uint8_t* big = installConstant(3, 3 * JIT_CODE_REGION_SIZE / 2, "Big", 3);
+    assert(((JitFunc)big)() == 3);
+
+    // Did not fit in the first region: a second one was chained in
+    JitCodeStats stats;
+    Jit_GetCodeStats(&stats);
+    assert(stats.functionCount == 3);
+    assert(stats.regionCount == 2);
+    assert(stats.bytesReserved == 3 * (size_t)JIT_CODE_REGION_SIZE);
+
+    int count;
+    const JitCodeEntry* entries = Jit_GetCodeEntries(&count);
+    assert(count == 3);
+    assert(entries[2].start == big && entries[2].size == 3 * JIT_CODE_REGION_SIZE / 2);
+    printf("Entries: %s %s %s\n", entries[0].name, entries[1].name, entries[2].name);
+
+    // Stores through the writable alias show up in the executable view
+    uint8_t* alias = Jit_WritableAddress(b);
+    assert(stats.dualMapped ? alias != b : alias == b);
+    uint32_t two = 22;
+    memcpy(alias + 15, &two, sizeof(two));   // imm32 of the MOV EAX after 14 NOPs
+    assert(((JitFunc)b)() == 22);
+    printf("Dual mapped: %s\n", stats.dualMapped ? "yes" : "no");
+
+    // Concurrent installs get disjoint slots and all are recorded
+    pthread_t threads[INSTALL_THREADS];
+    for (uintptr_t t = 0; t < INSTALL_THREADS; t++) {
+        assert(pthread_create(&threads[t], NULL, installMany, (void*)(t + 1)) == 0);
+    }
+    for (int t = 0; t < INSTALL_THREADS; t++) pthread_join(threads[t], NULL);
+    entries = Jit_GetCodeEntries(&count);
+    assert(count == 3 + INSTALL_THREADS * INSTALLS_PER_THREAD);
+    static JitCodeEntry sorted[3 + INSTALL_THREADS * INSTALLS_PER_THREAD];
+    memcpy(sorted, entries, sizeof(JitCodeEntry) * count);
+    qsort(sorted, count, sizeof(JitCodeEntry), byStart);
+    for (int i = 1; i < count; i++) {
+        assert((uint8_t*)sorted[i - 1].start + sorted[i - 1].size <= (uint8_t*)sorted[i].start);
+    }
+
+    // A running JMP rel32 is retargeted in one store: every call lands
+    // on one of the two functions, never on a torn displacement
+    targets[0] = a;
+    targets[1] = big;    // Another region: the displacements differ in every byte
+    uint8_t jump[5] = { 0xE9 };
+    stub = Jit_InstallCode(jump, sizeof(jump), "Stub", 4);
+    Jit_PatchRel32(stub + 1, a);
+    pthread_t flipper;
+    assert(pthread_create(&flipper, NULL, flipStub, NULL) == 0);
+    long calls = 0;
+    while (patching) {
+        uint64_t value = ((JitFunc)stub)();
+        assert(value == 1 || value == 3);
+        calls++;
+    }
+    pthread_join(flipper, NULL);
+    printf("Calls through the patched stub: %ld\n", calls);
+
+    printf("Code Cache OK.\n");
+    return 0;
+}
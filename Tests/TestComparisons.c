@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <math.h>
+#include "Compiler/Parser.h"
+#include "Jit/CodeGen.h"
+#include "Core/VanarizeValue.h"
+#include "Core/Memory.h"
+#include "Core/GarbageCollector.h"
+
+// All six relational operators, on int, double and mixed operands
+// including NaN (every ordered comparison and == false, != true), in each
+// form a condition compiles to: a fused compare-and-branch taken on false
+// (if), taken on true (under ! and as the left side of ||), as a for-loop
+// condition, and as a materialized boolean. Each (operator, form) sets
+// one bit of the returned mask.
+
+typedef struct {
+    const char* leftType;
+    const char* left;
+    const char* rightType;
+    const char* right;
+    double leftValue;
+    double rightValue;
+} Operands;
+
+#define NAN_TEXT "0.0 / 0.0"
+
+static const Operands operands[] = {
+    { "int", "1", "int", "2", 1, 2 },
+    { "int", "2", "int", "2", 2, 2 },
+    { "int", "3", "int", "2", 3, 2 },
+    { "int", "-5", "int", "3", -5, 3 },
+    { "long", "3000000000", "int", "-3000000000", 3000000000.0, -3000000000.0 },
+    { "double", "1.5", "double", "2.5", 1.5, 2.5 },
+    { "double", "2.5", "double", "2.5", 2.5, 2.5 },
+    { "double", "3.5", "double", "2.5", 3.5, 2.5 },
+    { "double", "-0.0", "double", "0.0", -0.0, 0.0 },
+    { "double", NAN_TEXT, "double", "1.0", NAN, 1.0 },
+    { "double", "1.0", "double", NAN_TEXT, 1.0, NAN },
+    { "double", NAN_TEXT, "double", NAN_TEXT, NAN, NAN },
+    { "int", "2", "double", "2.5", 2, 2.5 },
+    { "int", "2", "double", "2.0", 2, 2.0 },
+    { "int", "3", "double", "2.5", 3, 2.5 },
+    { "int", "1", "double", NAN_TEXT, 1, NAN },
+    { "double", "2.5", "int", "2", 2.5, 2 },
+    { "double", NAN_TEXT, "int", "1", NAN, 1 },
+};
+
+static const char* ops[] = { "<", "<=", ">", ">=", "==", "!=" };
+
+#define FORMS 5
+
+static int holds(int op, double l, double r) {
+    switch (op) {
+        case 0: return l < r;
+        case 1: return l <= r;
+        case 2: return l > r;
+        case 3: return l >= r;
+        case 4: return l == r;
+        default: return l != r;
+    }
+}
+
+static char source[1 << 14];
+
+static double run(const Operands* o) {
+    size_t n = 0;
+    n += sprintf(source + n,
+                 "function Check() :: long {\n"
+                 "    %s l = %s;\n"
+                 "    %s r = %s;\n"
+                 "    boolean no = false;\n"
+                 "    long m = 0;\n", o->leftType, o->left, o->rightType, o->right);
+    long bit = 1;
+    for (int op = 0; op < 6; op++) {
+        const char* c = ops[op];
+        n += sprintf(source + n, "    if (l %s r) { m = m + %ld; }\n", c, bit);
+        n += sprintf(source + n, "    if (!(l %s r)) { m = m + %ld; }\n", c, bit * 2);
+        n += sprintf(source + n, "    if (l %s r || no) { m = m + %ld; }\n", c, bit * 4);
+        n += sprintf(source + n, "    for (int k = 0; k < 1 && l %s r; k = k + 1) { m = m + %ld; }\n", c, bit * 8);
+        n += sprintf(source + n, "    boolean v%d = l %s r;\n    if (v%d) { m = m + %ld; }\n", op, c, op, bit * 16);
+        bit *= 1 << FORMS;
+    }
+    sprintf(source + n,
+            "    return m;\n"
+            "}\n"
+            "function Main() {\n"
+            "    return Check();\n"
+            "}\n");
+
+    Parser_Init(source);
+    AstNode* root = Parser_ParseProgram();
+    assert(root != NULL);
+    JitFunction func = Jit_Compile(root);
+    assert(func != NULL);
+    return ValueToNumber(func());
+}
+
+int main() {
+    printf("Testing Comparisons...\n");
+    int stackBottom;
+    VM_InitMemory();
+    GC_Init(&stackBottom);
+
+    // Baseline tier, then optimized up front
+    for (int tiering = 1; tiering >= 0; tiering--) {
+        Jit_SetTiering(tiering);
+        for (size_t i = 0; i < sizeof(operands) / sizeof(operands[0]); i++) {
+            const Operands* o = &operands[i];
+            long expected = 0;
+            long bit = 1;
+            for (int op = 0; op < 6; op++) {
+                int h = holds(op, o->leftValue, o->rightValue);
+                expected += h ? bit * (1 + 4 + 8 + 16) : bit * 2;
+                bit *= 1 << FORMS;
+            }
+            double result = run(o);
+            if (result != (double)expected) {
+                printf("Tiering %d, %s %s vs %s %s: %.0f (Expected %ld)\n", tiering, o->leftType, o->left,
+                       o->rightType, o->right, result, expected);
+            }
+            assert(result == (double)expected);
+        }
+        printf("Tiering %d OK\n", tiering);
+    }
+
+    printf("Comparisons OK.\n");
+    return 0;
+}
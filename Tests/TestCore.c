@@ -4,6 +4,7 @@
 #include "Core/VanarizeValue.h"
 #include "Core/Memory.h"
 #include "Core/GarbageCollector.h"
+#include "Core/VanarizeObject.h"
 
 void TestNaNBoxing() {
     printf("Testing NaN Boxing...\n");
@@ -67,8 +68,43 @@ void TestMemory() {
     printf("Memory OK.\n");
 }
 
+void TestTypedArrays() {
+    printf("Testing Typed Arrays...\n");
+    VM_InitMemory();
+    
+    // Packed 4-byte elements, grown past the initial capacity
+    ObjArray* ints = Runtime_NewTypedArray(ARRAY_INT32, 4);
+    for (int i = 0; i < 10; i++) {
+        Runtime_ArrayPushRaw(ints, (uint64_t)(int64_t)(i - 5), ARRAY_INT32);
+    }
+    assert(ints->count == 10);
+    assert(((int32_t*)ints->elements)[0] == -5);
+    assert((int64_t)Runtime_ArrayGetRaw(ints, 9, ARRAY_INT32) == 4);
+    
+    // Boxed access converts at the boundary
+    assert(ValueToNumber(Runtime_ArrayGet(ints, 0)) == -5.0);
+    Runtime_ArraySet(ints, 1, NumberToValue(2.9));
+    assert(((int32_t*)ints->elements)[1] == 2);
+    assert(ValueToNumber(Runtime_ArrayPop(ints)) == 4.0);
+    
+    // Raw access through another kind converts too
+    uint64_t bits = Runtime_ArrayGetRaw(ints, 1, ARRAY_FLOAT64);
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    assert(d == 2.0);
+    
+    // long[] keeps all 64 bits
+    ObjArray* longs = Runtime_NewTypedArray(ARRAY_INT64, 4);
+    Runtime_ArrayPushRaw(longs, (1ULL << 53) + 1, ARRAY_INT64);
+    assert(Runtime_ArrayGetRaw(longs, 0, ARRAY_INT64) == (1ULL << 53) + 1);
+    
+    VM_FreeMemory();
+    printf("Typed Arrays OK.\n");
+}
+
 int main() {
     TestNaNBoxing();
     TestMemory();
+    TestTypedArrays();
     return 0;
 }
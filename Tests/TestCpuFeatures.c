@@ -0,0 +1,27 @@
+#include <stdio.h>
+#include <assert.h>
+#include "Jit/CpuFeatures.h"
+
+int main() {
+    printf("Testing CPU Features...\n");
+
+    uint32_t host = Cpu_Features();
+    printf("Host: SSE4.2 %d, AVX2 %d, FMA %d, BMI2 %d\n",
+           !!(host & CPU_SSE4_2), !!(host & CPU_AVX2), !!(host & CPU_FMA), !!(host & CPU_BMI2));
+    if (host & CPU_AVX2) assert(host & CPU_AVX);
+    if (host & CPU_FMA) assert(host & CPU_AVX);   // Both need OS-saved YMM state
+
+    // Levels only ever take features away
+    CpuIsaLevel level;
+    assert(Cpu_ParseIsaLevel("sse4", &level) && level == CPU_ISA_SSE4);
+    assert(!Cpu_ParseIsaLevel("avx512", &level));
+    Cpu_SetIsaLevel(CPU_ISA_SSE2);
+    assert(Cpu_Features() == 0);
+    Cpu_SetIsaLevel(CPU_ISA_SSE4);
+    assert(Cpu_Features() == (host & (CPU_SSE4_1 | CPU_SSE4_2)));
+    Cpu_SetIsaLevel(CPU_ISA_AVX2);
+    assert(Cpu_Features() == host);
+
+    printf("CPU Features OK.\n");
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "Jit/DebugInfo.h"
+
+static uint8_t* readAll(const char* path, size_t* size) {
+    FILE* f = fopen(path, "rb");
+    assert(f);
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    rewind(f);
+    uint8_t* data = malloc(*size);
+    assert(fread(data, 1, *size, f) == *size);
+    fclose(f);
+    return data;
+}
+
+// GDB JIT interface (names fixed by the protocol)
+struct jit_code_entry {
+    struct jit_code_entry* next_entry;
+    struct jit_code_entry* prev_entry;
+    const char* symfile_addr;
+    uint64_t symfile_size;
+};
+
+struct jit_descriptor {
+    uint32_t version;
+    uint32_t action_flag;
+    struct jit_code_entry* relevant_entry;
+    struct jit_code_entry* first_entry;
+};
+
+extern struct jit_descriptor __jit_debug_descriptor;
+
+static uint32_t u32(const uint8_t* p) { uint32_t v; memcpy(&v, p, sizeof(v)); return v; }
+static uint64_t u64(const uint8_t* p) { uint64_t v; memcpy(&v, p, sizeof(v)); return v; }
+
+int main() {
+    printf("Testing Debug Info...\n");
+
+    char dir[] = "/tmp/vanarize-jitdump-XXXXXX";
+    assert(mkdtemp(dir));
+    assert(!Debug_WantsLines());    // Everything off by default
+    Debug_SetGdbJit(1);
+    Debug_EnablePerfMap();
+    assert(Debug_EnableJitDump(dir));
+    assert(Debug_WantsLines());
+
+    static const uint8_t code[] = { 0x55, 0x48, 0x89, 0xE5, 0x90, 0x5D, 0xC3 };
+    DebugLine lines[] = { { 0, 3 }, { 4, 4 } };
+    Debug_RegisterCode(code, sizeof(code), "MainX", 4, "Main.vana", lines, 2);
+
+    // Perf map: "<start> <size> <name>"
+    char path[128];
+    snprintf(path, sizeof(path), "/tmp/perf-%ld.map", (long)getpid());
+    FILE* map = fopen(path, "r");
+    assert(map);
+    unsigned long start, size;
+    char name[16];
+    assert(fscanf(map, "%lx %lx %15s", &start, &size, name) == 3);
+    fclose(map);
+    remove(path);
+    assert(start == (uintptr_t)code && size == sizeof(code) && strcmp(name, "Main") == 0);
+
+    // Jitdump: header, then the line table before the code load
+    size_t fileSize;
+    snprintf(path, sizeof(path), "%s/jit-%ld.dump", dir, (long)getpid());
+    uint8_t* dump = readAll(path, &fileSize);
+    assert(u32(dump) == 0x4A695444 && u32(dump + 12) == 62);
+    size_t pos = u32(dump + 8);
+
+    assert(u32(dump + pos) == 2);                           // JIT_CODE_DEBUG_INFO
+    assert(u64(dump + pos + 16) == (uintptr_t)code && u64(dump + pos + 24) == 2);
+    const uint8_t* entry = dump + pos + 32 + 16 + strlen("Main.vana") + 1;
+    assert(u64(entry) == (uintptr_t)code + 4 && u32(entry + 8) == 4);
+    assert(strcmp((const char*)entry + 16, "Main.vana") == 0);
+    pos += u32(dump + pos + 4);
+
+    assert(u32(dump + pos) == 0);                           // JIT_CODE_LOAD
+    assert(u64(dump + pos + 32) == (uintptr_t)code && u64(dump + pos + 40) == sizeof(code));
+    assert(strcmp((const char*)dump + pos + 56, "Main") == 0);
+    assert(memcmp(dump + pos + 56 + 5, code, sizeof(code)) == 0);
+    pos += u32(dump + pos + 4);
+    assert(pos == fileSize);
+    free(dump);
+    remove(path);
+    rmdir(dir);
+
+    // GDB: one registered symfile, an ELF object whose .text is the code
+    struct jit_code_entry* registered = __jit_debug_descriptor.first_entry;
+    assert(registered && registered == __jit_debug_descriptor.relevant_entry && !registered->next_entry);
+    assert(__jit_debug_descriptor.action_flag == 1);        // JIT_REGISTER_FN
+    const uint8_t* symfile = (const uint8_t*)registered->symfile_addr;
+    assert(memcmp(symfile, "\177ELF", 4) == 0 && registered->symfile_size > 64);
+    uint64_t shoff = u64(symfile + 0x28);
+    assert(u64(symfile + shoff + 64 + 16) == (uintptr_t)code);     // Section 1: .text sh_addr
+    assert(u64(symfile + shoff + 64 + 32) == sizeof(code));        // sh_size
+
+    // Turning registration off withdraws the symfile
+    Debug_SetGdbJit(0);
+    assert(!__jit_debug_descriptor.first_entry && !__jit_debug_descriptor.relevant_entry);
+    assert(__jit_debug_descriptor.action_flag == 0);        // JIT_NOACTION
+
+    printf("Debug Info OK.\n");
+    return 0;
+}
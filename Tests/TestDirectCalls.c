@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include "Compiler/Parser.h"
+#include "Jit/CodeGen.h"
+#include "Jit/ExecutableMemory.h"
+#include "Core/VanarizeValue.h"
+#include "Core/Memory.h"
+#include "Core/GarbageCollector.h"
+
+// Main and IsEven call functions declared after them, Sum calls itself,
+// and IsEven/IsOdd recurse into each other. None is a tail call, so every
+// call site is a CALL rel32 patched once its callee is installed.
+static const char* source =
+    "function Main() {\n"
+    "    return Sum(10) * 1000 + IsEven(10) * 10 + IsEven(7);\n"
+    "}\n"
+    "function Sum(int n) :: int {\n"
+    "    if (n == 0) { return 0; }\n"
+    "    return n + Sum(n - 1);\n"
+    "}\n"
+    "function IsEven(int n) :: int {\n"
+    "    if (n == 0) { return 1; }\n"
+    "    int odd = IsOdd(n - 1);\n"
+    "    return odd;\n"
+    "}\n"
+    "function IsOdd(int n) :: int {\n"
+    "    if (n == 0) { return 0; }\n"
+    "    int even = IsEven(n - 1);\n"
+    "    return even;\n"
+    "}\n";
+
+static const JitCodeEntry* findEntry(const char* name) {
+    int count;
+    const JitCodeEntry* entries = Jit_GetCodeEntries(&count);
+    for (int i = 0; i < count; i++) {
+        if (strcmp(entries[i].name, name) == 0) return &entries[i];
+    }
+    return NULL;
+}
+
+// Does caller contain a CALL rel32 (E8) that lands on callee?
+static int callsDirectly(const char* caller, const char* callee) {
+    const JitCodeEntry* from = findEntry(caller);
+    const JitCodeEntry* to = findEntry(callee);
+    assert(from && to);
+    const uint8_t* code = from->start;
+    for (size_t i = 0; i + 5 <= from->size; i++) {
+        if (code[i] != 0xE8) continue;
+        int32_t rel;
+        memcpy(&rel, code + i + 1, sizeof(rel));
+        if (code + i + 5 + rel != (const uint8_t*)to->start) continue;
+        assert(((uintptr_t)(code + i + 1) & 7) <= 4);     // Patchable in one aligned store
+        return 1;
+    }
+    return 0;
+}
+
+int main() {
+    printf("Testing Direct Calls...\n");
+    int stackBottom;
+    VM_InitMemory();
+    GC_Init(&stackBottom);
+    Jit_SetTiering(0);  // Final code up front, no baseline entries to redirect
+
+    Parser_Init(source);
+    AstNode* root = Parser_ParseProgram();
+    assert(root != NULL);
+    JitFunction func = Jit_Compile(root);
+    assert(func != NULL);
+
+    double result = ValueToNumber(func());
+    printf("Result: %g (Expected 55010)\n", result);
+    assert(result == 55010);
+
+    assert(callsDirectly("Main", "Sum"));       // Forward reference
+    assert(callsDirectly("Main", "IsEven"));
+    assert(callsDirectly("Sum", "Sum"));        // Self recursion
+    assert(callsDirectly("IsEven", "IsOdd"));   // Mutual recursion, forward
+    assert(callsDirectly("IsOdd", "IsEven"));   // and backward
+
+    printf("Direct Calls OK.\n");
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "Jit/DiskCache.h"
+
+static void writeFile(const char* path, const char* text) {
+    FILE* f = fopen(path, "wb");
+    assert(f);
+    fputs(text, f);
+    fclose(f);
+}
+
+int main() {
+    printf("Testing Disk Cache...\n");
+
+    char dir[] = "/tmp/vanarize-cache-XXXXXX";
+    assert(mkdtemp(dir));
+    DiskCache_SetDirectory(dir);
+    assert(DiskCache_Enabled());
+
+    char importPath[64];
+    snprintf(importPath, sizeof(importPath), "%s/Lib.vana", dir);
+    writeFile(importPath, "function F() :: int { return 1; }\n");
+    const char* imports[] = { importPath };
+
+    // One unit: MOV RAX, imm64 (image-relative) followed by a CALL rel32 to itself
+    uint8_t code[] = { 0x48, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0xE8, 0, 0, 0, 0, 0xC3 };
+    CacheReloc relocs[] = {
+        { 2, CACHE_RELOC_IMAGE, -42 },
+        { 11, CACHE_RELOC_CALL, 0 },
+        { 2, CACHE_RELOC_STRING, 0 },
+    };
+    const char* strings[] = { "hello" };
+    uint32_t lengths[] = { 5 };
+    CacheUnit unit = { "Main", 4, 0, code, sizeof(code), relocs, 3 };
+    CacheImage image = { &unit, 1, strings, lengths, 1, NULL, 0 };
+
+    const char* source = "import \"Lib.vana\";\nfunction Main() {}\n";
+    CacheImage loaded;
+    assert(!DiskCache_Load(source, &loaded));      // Cold
+    DiskCache_Store(source, imports, 1, &image);
+
+    assert(DiskCache_Load(source, &loaded));       // Warm
+    assert(loaded.unitCount == 1 && loaded.stringCount == 1);
+    assert(loaded.units[0].nameLength == 4 && memcmp(loaded.units[0].name, "Main", 4) == 0);
+    assert(loaded.units[0].size == sizeof(code) && memcmp(loaded.units[0].code, code, sizeof(code)) == 0);
+    assert(loaded.units[0].relocCount == 3 && loaded.units[0].relocs[0].value == -42);
+    assert(loaded.units[0].relocs[1].kind == CACHE_RELOC_CALL);
+    assert(loaded.stringLengths[0] == 5 && memcmp(loaded.strings[0], "hello", 5) == 0);
+    DiskCache_Release(&loaded);
+
+    // Another main file, or a changed import, misses
+    assert(!DiskCache_Load("function Main() {}\n", &loaded));
+    writeFile(importPath, "function F() :: int { return 2; }\n");
+    assert(!DiskCache_Load(source, &loaded));
+
+    printf("Disk Cache OK.\n");
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <elf.h>
+#include "Jit/ElfWriter.h"
+
+static uint8_t* readAll(const char* path, size_t* size) {
+    FILE* f = fopen(path, "rb");
+    assert(f);
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    rewind(f);
+    uint8_t* data = malloc(*size);
+    assert(fread(data, 1, *size, f) == *size);
+    fclose(f);
+    return data;
+}
+
+int main() {
+    printf("Testing ELF Writer...\n");
+
+    ElfObject elf;
+    Elf_Init(&elf);
+
+    // LEA RAX, [RIP + helper]; CALL RAX; MOV RAX, [RIP + box]; RET
+    uint8_t code[] = { 0x48, 0x8D, 0x05, 0, 0, 0, 0, 0xFF, 0xD0,
+                       0x48, 0x8B, 0x05, 0, 0, 0, 0, 0xC3 };
+    size_t text = Elf_Append(&elf, ELF_SECTION_TEXT, code, sizeof(code), 16);
+    size_t box = Elf_Append(&elf, ELF_SECTION_DATA, NULL, 8, 8);
+    int fn = Elf_DefineSymbol(&elf, "Vana_Main", ELF_SECTION_TEXT, text, sizeof(code));
+    int helper = Elf_ImportSymbol(&elf, "Native_Print");
+    assert(Elf_ImportSymbol(&elf, "Native_Print") == helper);
+    Elf_AddReloc(&elf, ELF_SECTION_TEXT, text + 3, R_X86_64_PLT32, helper, -4);
+    Elf_AddReloc(&elf, ELF_SECTION_TEXT, text + 12, R_X86_64_PC32, ELF_SYMBOL_DATA, (int64_t)box - 4);
+    Elf_AddReloc(&elf, ELF_SECTION_DATA, box, R_X86_64_64, ELF_SYMBOL_TEXT, 0);
+    assert(fn == 3 && helper == 4);
+
+    char path[] = "/tmp/vanarize-elf-XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    assert(Elf_Write(&elf, path));
+    Elf_Free(&elf);
+
+    size_t size;
+    uint8_t* file = readAll(path, &size);
+    remove(path);
+    const Elf64_Ehdr* ehdr = (const Elf64_Ehdr*)file;
+    assert(memcmp(ehdr->e_ident, ELFMAG, SELFMAG) == 0);
+    assert(ehdr->e_type == ET_REL && ehdr->e_machine == EM_X86_64);
+    assert(ehdr->e_shoff + ehdr->e_shnum * sizeof(Elf64_Shdr) <= size);
+
+    const Elf64_Shdr* shdrs = (const Elf64_Shdr*)(file + ehdr->e_shoff);
+    const char* shstrtab = (const char*)file + shdrs[ehdr->e_shstrndx].sh_offset;
+    const Elf64_Shdr* symtab = NULL;
+    const Elf64_Shdr* relaText = NULL;
+    int hasTextCode = 0, hasStackNote = 0;
+    for (int i = 0; i < ehdr->e_shnum; i++) {
+        const char* name = shstrtab + shdrs[i].sh_name;
+        if (shdrs[i].sh_type == SHT_SYMTAB) symtab = &shdrs[i];
+        if (strcmp(name, ".rela.text") == 0) relaText = &shdrs[i];
+        if (strcmp(name, ".note.GNU-stack") == 0) hasStackNote = 1;
+        if (strcmp(name, ".text") == 0) {
+            hasTextCode = shdrs[i].sh_size == sizeof(code) &&
+                          memcmp(file + shdrs[i].sh_offset, code, sizeof(code)) == 0;
+        }
+    }
+    assert(symtab && relaText && hasTextCode && hasStackNote);
+
+    // Locals first, then the globals in the order they were added
+    const Elf64_Sym* syms = (const Elf64_Sym*)(file + symtab->sh_offset);
+    const char* strtab = (const char*)file + shdrs[symtab->sh_link].sh_offset;
+    assert(symtab->sh_size / sizeof(Elf64_Sym) == 5 && symtab->sh_info == 3);
+    assert(ELF64_ST_TYPE(syms[ELF_SYMBOL_TEXT].st_info) == STT_SECTION);
+    assert(strcmp(strtab + syms[3].st_name, "Vana_Main") == 0 && syms[3].st_size == sizeof(code));
+    assert(ELF64_ST_BIND(syms[3].st_info) == STB_GLOBAL && syms[3].st_shndx != SHN_UNDEF);
+    assert(strcmp(strtab + syms[4].st_name, "Native_Print") == 0 && syms[4].st_shndx == SHN_UNDEF);
+
+    const Elf64_Rela* relas = (const Elf64_Rela*)(file + relaText->sh_offset);
+    assert(relaText->sh_size / sizeof(Elf64_Rela) == 2);
+    assert(relas[0].r_offset == 3 && ELF64_R_TYPE(relas[0].r_info) == R_X86_64_PLT32);
+    assert(ELF64_R_SYM(relas[0].r_info) == 4 && relas[0].r_addend == -4);
+    assert(ELF64_R_SYM(relas[1].r_info) == ELF_SYMBOL_DATA);
+    free(file);
+
+    printf("ELF Writer OK.\n");
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <assert.h>
+#include "Compiler/Parser.h"
+#include "Jit/CodeGen.h"
+#include "Core/VanarizeValue.h"
+#include "Core/Memory.h"
+#include "Core/GarbageCollector.h"
+
+// Binary operands run left to right even when the left one is a pure leaf
+// the register stack could load last: an assignment or a call on the
+// right must not be seen by the left.
+static const char* source =
+    "function IntOrder() :: int {\n"
+    "    int x = 1;\n"
+    "    return x + (x = 5);\n"               // 1 + 5
+    "}\n"
+    "function DoubleOrder() :: double {\n"
+    "    double d = 2.0;\n"
+    "    return d * (d = 3.0);\n"             // 2 * 3
+    "}\n"
+    "function Bump(int[] box) :: int {\n"
+    "    box[0] = box[0] + 100;\n"
+    "    return 1;\n"
+    "}\n"
+    "function CallOrder() :: int {\n"
+    "    int[] box = [1];\n"
+    "    return box[0] + Bump(box);\n"        // 1 + 1
+    "}\n"
+    "function CompareOrder() :: int {\n"
+    "    int p = 3;\n"
+    "    if (p < (p = 1)) { return 0; }\n"    // 3 < 1
+    "    return 1;\n"
+    "}\n"
+    "function Main() {\n"
+    "    return IntOrder() * 1000 + DoubleOrder() * 100 + CallOrder() * 10 + CompareOrder();\n"
+    "}\n";
+
+int main() {
+    printf("Testing Evaluation Order...\n");
+    int stackBottom;
+    VM_InitMemory();
+    GC_Init(&stackBottom);
+
+    Parser_Init(source);
+    AstNode* root = Parser_ParseProgram();
+    assert(root != NULL);
+    JitFunction func = Jit_Compile(root);
+    assert(func != NULL);
+
+    double result = ValueToNumber(func());
+    printf("Result: %g (Expected 6621)\n", result);
+    assert(result == 6621);
+
+    printf("Evaluation Order OK.\n");
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include "Compiler/Parser.h"
+#include "Jit/CodeGen.h"
+#include "Core/VanarizeValue.h"
+#include "Core/Memory.h"
+#include "Core/GarbageCollector.h"
+
+// Pure arithmetic trees are evaluated on a stack of 9 scratch GPRs or 8
+// XMM registers. A complete tree of depth d needs d + 1 of them, so depths
+// around the pool size run partly in registers and spill the levels that
+// do not fit. Uneven trees (depth d - 1 beside depth d - 2) exercise the
+// needier-side-first ordering. Each tree is also checked against the same
+// tree evaluated in C, operation by operation.
+
+static char text[1 << 17];
+static size_t textLength;
+
+static void put(const char* s) {
+    while (*s) text[textLength++] = *s++;
+}
+
+static const char* intLeaves[] = { "a", "b", "3", "c", "d", "7" };
+static const int64_t intValues[] = { 3, -2, 3, 7, 5, 7 };
+
+// Appends an int tree and returns its value; '*' only joins leaves so the
+// values stay small
+static int64_t intTree(int depth, int uneven, int* leaf) {
+    if (depth <= 0) {
+        int k = (*leaf)++ % 6;
+        put(intLeaves[k]);
+        return intValues[k];
+    }
+    put("(");
+    int64_t left = intTree(depth - 1, uneven, leaf);
+    char op = depth == 1 ? '*' : (depth + *leaf) % 2 ? '+' : '-';
+    char ops[4] = { ' ', op, ' ', '\0' };
+    put(ops);
+    int64_t right = intTree(uneven ? depth - 2 : depth - 1, uneven, leaf);
+    put(")");
+    return op == '*' ? left * right : op == '+' ? left + right : left - right;
+}
+
+static const char* doubleLeaves[] = { "x", "y", "2.0", "z", "a", "0.5" };
+static const double doubleValues[] = { 1.5, -0.25, 2.0, 3.0, 3, 0.5 };
+
+// Same shape; '*' and '/' join leaves (none is zero) and the levels above
+// alternate '+' and '-', so every value stays finite
+static double doubleTree(int depth, int uneven, int* leaf) {
+    if (depth <= 0) {
+        int k = (*leaf)++ % 6;
+        put(doubleLeaves[k]);
+        return doubleValues[k];
+    }
+    put("(");
+    double left = doubleTree(depth - 1, uneven, leaf);
+    char op = depth == 1 ? "*/"[*leaf % 2] : (depth + *leaf) % 2 ? '+' : '-';
+    char ops[4] = { ' ', op, ' ', '\0' };
+    put(ops);
+    double right = doubleTree(uneven ? depth - 2 : depth - 1, uneven, leaf);
+    put(")");
+    switch (op) {
+        case '+': return left + right;
+        case '-': return left - right;
+        case '*': return left * right;
+        default:  return left / right;
+    }
+}
+
+static const char* prologue =
+    "function Main() {\n"
+    "    int a = 3;\n"
+    "    int b = -2;\n"
+    "    int c = 7;\n"
+    "    long d = 5;\n"
+    "    double x = 1.5;\n"
+    "    double y = -0.25;\n"
+    "    double z = 3.0;\n"
+    "    int[] ints = [0];\n"
+    "    double[] doubles = [0.0];\n";
+
+static double run(void) {
+    Parser_Init(text);
+    AstNode* root = Parser_ParseProgram();
+    assert(root != NULL);
+    JitFunction func = Jit_Compile(root);
+    assert(func != NULL);
+    return ValueToNumber(func());
+}
+
+// Returns the tree directly, and again through an array element store
+// (which starts the register stack above the index)
+static void checkInt(int depth, int uneven) {
+    for (int viaArray = 0; viaArray < 2; viaArray++) {
+        int leaf = 0;
+        textLength = 0;
+        put(prologue);
+        put(viaArray ? "    ints[0] = " : "    return ");
+        int64_t expected = intTree(depth, uneven, &leaf);
+        put(viaArray ? ";\n    return ints[0];\n}\n" : ";\n}\n");
+        text[textLength] = '\0';
+        double result = run();
+        printf("  int depth %d%s%s: %g (Expected %lld)\n", depth, uneven ? " uneven" : "",
+               viaArray ? " stored" : "", result, (long long)expected);
+        assert(result == (double)expected);
+    }
+}
+
+static void checkDouble(int depth, int uneven) {
+    for (int viaArray = 0; viaArray < 2; viaArray++) {
+        int leaf = 0;
+        textLength = 0;
+        put(prologue);
+        put(viaArray ? "    doubles[0] = " : "    return ");
+        double expected = doubleTree(depth, uneven, &leaf);
+        put(viaArray ? ";\n    return doubles[0];\n}\n" : ";\n}\n");
+        text[textLength] = '\0';
+        double result = run();
+        printf("  double depth %d%s%s: %.17g (Expected %.17g)\n", depth, uneven ? " uneven" : "",
+               viaArray ? " stored" : "", result, expected);
+        assert(result == expected);
+    }
+}
+
+int main() {
+    printf("Testing Expression Trees...\n");
+    int stackBottom;
+    VM_InitMemory();
+    GC_Init(&stackBottom);
+
+    // Baseline tier, then optimized up front
+    for (int tiering = 1; tiering >= 0; tiering--) {
+        Jit_SetTiering(tiering);
+        printf("Tiering %d\n", tiering);
+        for (int depth = 6; depth <= 11; depth++) {
+            checkInt(depth, 0);
+            checkDouble(depth, 0);
+        }
+        checkInt(16, 1);
+        checkDouble(16, 1);
+    }
+
+    printf("Expression Trees OK.\n");
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include <stdio.h>
+#include <assert.h>
+#include "Compiler/Parser.h"
+#include "Jit/CodeGen.h"
+#include "Core/VanarizeValue.h"
+#include "Core/Memory.h"
+#include "Core/GarbageCollector.h"
+
+// i++ / i-- are statements only; inside an expression '+' and '-' keep
+// their usual meaning, so a--1 is a - -1.
+static const char* source =
+    "function Statements() :: int {\n"
+    "    int a = 5;\n"
+    "    a++;\n"
+    "    a --;\n"
+    "    a--;\n"
+    "    for (int i = 0; i < 3; i++) { a++; }\n"
+    "    return a;\n"                          // 5 + 1 - 2 + 3
+    "}\n"
+    "function Expressions() :: int {\n"
+    "    int a = 5;\n"
+    "    int b = 2;\n"
+    "    return (a--1) * 10 + (a+-b);\n"       // 6 * 10 + 3
+    "}\n"
+    "function Main() {\n"
+    "    return Statements() * 100 + Expressions();\n"
+    "}\n";
+
+int main() {
+    printf("Testing Increment Statements...\n");
+    int stackBottom;
+    VM_InitMemory();
+    GC_Init(&stackBottom);
+
+    Parser_Init(source);
+    AstNode* root = Parser_ParseProgram();
+    assert(root != NULL);
+    JitFunction func = Jit_Compile(root);
+    assert(func != NULL);
+
+    double result = ValueToNumber(func());
+    printf("Result: %g (Expected 763)\n", result);
+    assert(result == 763);
+
+    printf("Increment Statements OK.\n");
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include "Compiler/Parser.h"
+#include "Jit/CodeGen.h"
+#include "Jit/ExecutableMemory.h"
+#include "Core/VanarizeValue.h"
+#include "Core/Memory.h"
+#include "Core/GarbageCollector.h"
+
+// Every small leaf below is inlined into Check; Triangle has a loop and
+// stays a call. Check returns the number of the first failed test, 0 if
+// all pass.
+static const char* source =
+    "function Twice(int v) :: int { return v + v; }\n"
+    "function Bump(int v) :: int {\n"
+    "    v = v + 1;\n"                      // Written: may not alias the argument
+    "    return v;\n"
+    "}\n"
+    "function Shadow(int a) :: int {\n"
+    "    int t = a * 10;\n"                 // Same names as the caller's locals
+    "    return t;\n"
+    "}\n"
+    "function Magnitude(int v) :: int {\n"
+    "    if (v < 0) { return 0 - v; }\n"
+    "    return v;\n"
+    "}\n"
+    "function Half(double d) :: double { return d / 2; }\n"
+    "function Next(int[] box) :: int {\n"
+    "    box[0] = box[0] + 1;\n"
+    "    return box[0];\n"
+    "}\n"
+    "function Triangle(int n) :: int {\n"
+    "    int s = 0;\n"
+    "    for (int i = 0; i < n; i = i + 1) { s = s + i; }\n"
+    "    return s;\n"
+    "}\n"
+    "function Check() :: int {\n"
+    "    int a = 3;\n"
+    "    int t = 7;\n"
+    "    int[] box = [0];\n"
+    "    if (Twice(a) != 6) { return 1; }\n"
+    "    if (Bump(a) != 4) { return 2; }\n"
+    "    if (a != 3) { return 3; }\n"
+    "    if (Shadow(t) != 70) { return 4; }\n"
+    "    if (t != 7) { return 5; }\n"
+    "    if (Magnitude(0 - a) + Magnitude(a) != 6) { return 6; }\n"
+    "    if (Half(5.0) != 2.5) { return 7; }\n"
+    "    if (Twice(Next(box)) != 2) { return 8; }\n"  // Argument evaluated once
+    "    if (box[0] != 1) { return 9; }\n"
+    "    if (Twice(Bump(a)) != 8) { return 10; }\n"
+    "    if (Triangle(5) != 10) { return 11; }\n"
+    "    return 0;\n"
+    "}\n"
+    "function Main() {\n"
+    "    return Check();\n"
+    "}\n";
+
+static const JitCodeEntry* findEntry(const char* name) {
+    int count;
+    const JitCodeEntry* entries = Jit_GetCodeEntries(&count);
+    for (int i = 0; i < count; i++) {
+        if (strcmp(entries[i].name, name) == 0) return &entries[i];
+    }
+    return NULL;
+}
+
+// Does caller contain a CALL rel32 (E8) that lands on callee?
+static int callsDirectly(const char* caller, const char* callee) {
+    const JitCodeEntry* from = findEntry(caller);
+    const JitCodeEntry* to = findEntry(callee);
+    assert(from && to);
+    const uint8_t* code = from->start;
+    for (size_t i = 0; i + 5 <= from->size; i++) {
+        if (code[i] != 0xE8) continue;
+        int32_t rel;
+        memcpy(&rel, code + i + 1, sizeof(rel));
+        if (code + i + 5 + rel == (const uint8_t*)to->start) return 1;
+    }
+    return 0;
+}
+
+int main() {
+    printf("Testing Inlining...\n");
+    int stackBottom;
+    VM_InitMemory();
+    GC_Init(&stackBottom);
+    Jit_SetTiering(0);  // The baseline tier does not inline
+
+    Parser_Init(source);
+    AstNode* root = Parser_ParseProgram();
+    assert(root != NULL);
+    JitFunction func = Jit_Compile(root);
+    assert(func != NULL);
+
+    double failed = ValueToNumber(func());
+    printf("First failed check: %g (Expected 0)\n", failed);
+    assert(failed == 0);
+
+    const char* inlined[] = { "Twice", "Bump", "Shadow", "Magnitude", "Half", "Next" };
+    for (int i = 0; i < 6; i++) assert(!callsDirectly("Check", inlined[i]));
+    assert(callsDirectly("Check", "Triangle"));     // Loops are not inlined
+
+    printf("Inlining OK.\n");
+    return 0;
+}
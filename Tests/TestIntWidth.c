@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <assert.h>
+#include "Compiler/Parser.h"
+#include "Jit/CodeGen.h"
+#include "Core/VanarizeValue.h"
+#include "Core/Memory.h"
+#include "Core/GarbageCollector.h"
+
+// int is 64-bit wherever it is stored: a value past the 32-bit range reads
+// back unchanged from a local, an int[] element (literal, store or push)
+// and a struct field. Check returns the number of the first failed test.
+static const char* source =
+    "struct Box {\n"
+    "    int value\n"
+    "    float scale\n"
+    "    int other\n"
+    "}\n"
+    "function Check() :: int {\n"
+    "    int big = 2147483647 + 1;\n"
+    "    if (big != 2147483648) { return 1; }\n"
+    "    int low = -2147483648 - 1;\n"
+    "    if (low != -2147483649) { return 2; }\n"
+    "    int[] a = [3000000000, -3000000000];\n"
+    "    if (a[0] != 3000000000) { return 3; }\n"
+    "    if (a[1] != -3000000000) { return 4; }\n"
+    "    a[0] = big;\n"
+    "    if (a[0] != 2147483648) { return 5; }\n"
+    "    a.push(low);\n"
+    "    if (a[2] != -2147483649) { return 6; }\n"
+    "    a[1] = 9223372036854775807;\n"
+    "    if (a[1] - 9223372036854775806 != 1) { return 7; }\n"
+    "    long[] l = [4294967296];\n"
+    "    if (l[0] != 4294967296) { return 8; }\n"
+    "    Box b = { value: 3000000000, scale: 0.5, other: -1 };\n"
+    "    if (b.value != 3000000000) { return 9; }\n"
+    "    b.value = low;\n"
+    "    if (b.value != -2147483649) { return 10; }\n"
+    "    if (b.scale != 0.5 || b.other != -1) { return 11; }\n"
+    "    return 0;\n"
+    "}\n"
+    "function Main() {\n"
+    "    return Check();\n"
+    "}\n";
+
+int main() {
+    printf("Testing Int Width...\n");
+    int stackBottom;
+    VM_InitMemory();
+    GC_Init(&stackBottom);
+
+    // Baseline tier, then optimized up front
+    for (int tiering = 1; tiering >= 0; tiering--) {
+        Jit_SetTiering(tiering);
+        Parser_Init(source);
+        AstNode* root = Parser_ParseProgram();
+        assert(root != NULL);
+        JitFunction func = Jit_Compile(root);
+        assert(func != NULL);
+
+        double failed = ValueToNumber(func());
+        printf("Tiering %d, first failed check: %g (Expected 0)\n", tiering, failed);
+        assert(failed == 0);
+    }
+
+    printf("Int Width OK.\n");
+    return 0;
+}
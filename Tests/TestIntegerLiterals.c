@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <assert.h>
+#include "Compiler/Parser.h"
+#include "Jit/CodeGen.h"
+#include "Core/VanarizeValue.h"
+#include "Core/Memory.h"
+#include "Core/GarbageCollector.h"
+
+// Integer literals are exact int64 values: past 2^53 a double would round
+// them, and INT64_MAX used to wrap to INT64_MIN.
+static const char* source =
+    "function MaxLong() :: int {\n"
+    "    long m = 9223372036854775807;\n"
+    "    if (m - 9223372036854775806 == 1) { return 1; }\n"
+    "    return 0;\n"
+    "}\n"
+    "function PastDouble() :: int {\n"
+    "    long e = 9007199254740993;\n"      // 2^53 + 1
+    "    if (e - 9007199254740992 == 1) { return 1; }\n"
+    "    return 0;\n"
+    "}\n"
+    "function Main() {\n"
+    "    return MaxLong() * 10 + PastDouble();\n"
+    "}\n";
+
+int main() {
+    printf("Testing Integer Literals...\n");
+    int stackBottom;
+    VM_InitMemory();
+    GC_Init(&stackBottom);
+
+    Parser_Init(source);
+    AstNode* root = Parser_ParseProgram();
+    assert(root != NULL);
+    JitFunction func = Jit_Compile(root);
+    assert(func != NULL);
+
+    double result = ValueToNumber(func());
+    printf("Result: %g (Expected 11)\n", result);
+    assert(result == 11);
+
+    printf("Integer Literals OK.\n");
+    return 0;
+}
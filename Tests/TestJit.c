@@ -1,8 +1,10 @@
 #include <stdio.h>
 #include <assert.h>
 #include <stdint.h>
+#include <string.h>
 #include "Jit/ExecutableMemory.h"
 #include "Jit/AssemblerX64.h"
+#include "Jit/CpuFeatures.h"
 
 // Signature of our generated function: () -> uint64_t
 typedef uint64_t (*JitFunc)(void);
@@ -56,7 +58,95 @@ int main() {
     uint64_t sum = func();
     printf("Sum Result: %lu (Expected 30)\n", sum);
     assert(sum == 30);
-    
+
+    // TEST 3: Scalar single precision
+    // CODE:
+    // MOV RAX, 1.0f; MOVD XMM0, EAX; MOV RAX, 3; CVTSI2SS XMM1, RAX
+    // DIVSS XMM0, XMM1; MULSS XMM0, XMM1   ; (1/3)*3 rounds back to 1 in float
+    // MOV RAX, 1.0f; MOVD XMM2, EAX; SUBSS XMM0, XMM2; ADDSS XMM0, XMM2
+    // UCOMISS XMM0, XMM2; SETE AL; MOVZX RAX, AL
+    // RET
+    Asm_Init(&as, (uint8_t*)execMem, memSize);
+
+    float one = 1.0f;
+    uint32_t oneBits;
+    memcpy(&oneBits, &one, sizeof(oneBits));
+    Asm_Mov_Imm64(&as, RAX, oneBits);
+    Asm_Movd_Xmm_Reg(&as, XMM0, RAX);
+    Asm_Mov_Imm64(&as, RAX, 3);
+    Asm_Cvtsi2ss_Xmm_Reg(&as, XMM1, RAX);
+    Asm_Divss(&as, XMM0, XMM1);
+    Asm_Mulss(&as, XMM0, XMM1);
+    Asm_Mov_Imm64(&as, RAX, oneBits);
+    Asm_Movd_Xmm_Reg(&as, XMM2, RAX);
+    Asm_Subss(&as, XMM0, XMM2);
+    Asm_Addss(&as, XMM0, XMM2);
+    Asm_Ucomiss(&as, XMM0, XMM2);
+    Asm_Setcc(&as, COND_E, RAX);
+    Asm_Movzx_Reg_Reg8(&as, RAX, RAX);
+    Asm_Ret(&as);
+
+    uint64_t equal = func();
+    printf("Single Result: %lu (Expected 1)\n", equal);
+    assert(equal == 1);
+
+    // TEST 4: Packed floats over [base + index*4], SSE then AVX
+    // CODE:
+    // MOV R8, floats; MOV R9, 1; MOV RAX, 0.5f; MOVD XMM7, EAX
+    // MOVUPS XMM1, [R8 + R9*4]; SHUFPS XMM7, XMM7, 0
+    // MULPS XMM1, XMM7; ADDPS XMM1, XMM7; MOVUPS [R8 + R9*4], XMM1   ; x * 0.5 + 0.5
+    // RET
+    Asm_Init(&as, (uint8_t*)execMem, memSize);
+
+    float floats[10] = { -1, 2, 4, 6, 8, 10, 12, 14, 16, -1 };
+    float half32 = 0.5f;
+    uint32_t half32Bits;
+    memcpy(&half32Bits, &half32, sizeof(half32Bits));
+    Asm_Mov_Imm64(&as, R8, (uint64_t)(uintptr_t)floats);
+    Asm_Mov_Imm64(&as, R9, 1);
+    Asm_Mov_Imm64(&as, RAX, half32Bits);
+    Asm_Movd_Xmm_Reg(&as, XMM7, RAX);
+    Asm_Movups_Xmm_Mem(&as, XMM1, R8, R9);
+    Asm_Shufps(&as, XMM7, XMM7, 0);
+    Asm_Mulps(&as, XMM1, XMM7);
+    Asm_Addps(&as, XMM1, XMM7);
+    Asm_Movups_Mem_Xmm(&as, R8, R9, XMM1);
+    Asm_Ret(&as);
+
+    func();
+    printf("Float Lanes: %g %g %g %g %g (Expected 1.5 2.5 3.5 4.5 10)\n", floats[1], floats[2], floats[3], floats[4], floats[5]);
+    assert(floats[0] == -1 && floats[9] == -1);
+    assert(floats[1] == 1.5 && floats[2] == 2.5 && floats[3] == 3.5 && floats[4] == 4.5 && floats[5] == 10);
+
+    // CODE (hosts with AVX2, for VBROADCASTSS from a register):
+    // MOV R8, floats; MOV R9, 1; MOV RAX, 0.5f; MOVD XMM7, EAX
+    // VMOVUPS YMM0, [R8 + R9*4]; VBROADCASTSS YMM1, XMM7
+    // VSUBPS YMM0, YMM0, YMM1; VDIVPS YMM0, YMM0, YMM1; VMOVUPS [R8 + R9*4], YMM0   ; (x - 0.5) / 0.5
+    // VZEROUPPER
+    // RET
+    if (Cpu_Features() & CPU_AVX2) {
+        Asm_Init(&as, (uint8_t*)execMem, memSize);
+        Asm_Mov_Imm64(&as, R8, (uint64_t)(uintptr_t)floats);
+        Asm_Mov_Imm64(&as, R9, 1);
+        Asm_Mov_Imm64(&as, RAX, half32Bits);
+        Asm_Movd_Xmm_Reg(&as, XMM7, RAX);
+        Asm_Vmovups_Ymm_Mem(&as, YMM0, R8, R9);
+        Asm_Vbroadcastss_Ymm_Xmm(&as, YMM1, XMM7);
+        Asm_Vsubps_Ymm(&as, YMM0, YMM0, YMM1);
+        Asm_Vdivps_Ymm(&as, YMM0, YMM0, YMM1);
+        Asm_Vmovups_Mem_Ymm(&as, R8, R9, YMM0);
+        Asm_Vzeroupper(&as);
+        Asm_Ret(&as);
+
+        func();
+        printf("YMM Lanes: %g %g %g %g %g (Expected 2 4 6 8 19)\n", floats[1], floats[2], floats[3], floats[4], floats[5]);
+        assert(floats[0] == -1 && floats[9] == -1);
+        assert(floats[1] == 2 && floats[2] == 4 && floats[3] == 6 && floats[4] == 8);
+        assert(floats[5] == 19 && floats[8] == 31);
+    } else {
+        printf("YMM Lanes: skipped (no AVX2)\n");
+    }
+
     Jit_FreeExec(execMem, memSize);
     
     printf("JIT Backend OK.\n");
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include "Compiler/Parser.h"
+#include "Compiler/Optimizer.h"
+
+static FunctionDecl* foldMain(const char* source) {
+    Parser_Init(source);
+    BlockStmt* program = (BlockStmt*)Parser_ParseProgram();
+    assert(program && program->count == 1);
+    Optimizer_FoldProgram((AstNode*)program);
+    assert(program->statements[0]->type == NODE_FUNCTION_DECL);
+    return (FunctionDecl*)program->statements[0];
+}
+
+static AstNode* statement(FunctionDecl* func, int index) {
+    return ((BlockStmt*)func->body)->statements[index];
+}
+
+static int literalIs(AstNode* node, const char* text) {
+    if (node->type != NODE_LITERAL_EXPR && node->type != NODE_STRING_LITERAL) return 0;
+    Token* t = &((LiteralExpr*)node)->token;
+    return t->length == (int)strlen(text) && memcmp(t->start, text, t->length) == 0;
+}
+
+void TestFolding() {
+    printf("Testing Constant Folding...\n");
+
+    FunctionDecl* func = foldMain(
+        "function Main() :: int {\n"
+        "    int a = 1 + 2 * 3 - 10 / 4;\n"
+        "    double b = 1.5 * 2;\n"
+        "    string s = \"ab\" + \"cd\";\n"
+        "    boolean c = !(2 < 1);\n"
+        "    return -a;\n"
+        "}\n");
+
+    assert(literalIs(((VarDecl*)statement(func, 0))->initializer, "5"));   // int division truncates
+    assert(literalIs(((VarDecl*)statement(func, 1))->initializer, "3.0")); // stays a double
+    assert(literalIs(((VarDecl*)statement(func, 2))->initializer, "\"abcd\""));
+    assert(((LiteralExpr*)((VarDecl*)statement(func, 3))->initializer)->token.type == TOKEN_TRUE);
+    assert(literalIs(((ReturnStmt*)statement(func, 4))->returnValue, "-5"));
+
+    printf("Constant Folding OK.\n");
+}
+
+void TestPropagation() {
+    printf("Testing Constant Propagation...\n");
+
+    // 'n' is never written, 'm' is; 'd' keeps its double type
+    FunctionDecl* func = foldMain(
+        "function Main() :: int {\n"
+        "    int n = 8;\n"
+        "    int m = 1;\n"
+        "    double d = 2;\n"
+        "    m = m + n;\n"
+        "    return m + d / 4;\n"
+        "}\n");
+
+    AssignmentExpr* assign = (AssignmentExpr*)statement(func, 3);
+    BinaryExpr* sum = (BinaryExpr*)assign->value;
+    assert(sum->left->type == NODE_LITERAL_EXPR && ((LiteralExpr*)sum->left)->token.type == TOKEN_IDENTIFIER);
+    assert(literalIs(sum->right, "8"));
+
+    BinaryExpr* ret = (BinaryExpr*)((ReturnStmt*)statement(func, 4))->returnValue;
+    assert(literalIs(ret->right, "0.5"));
+
+    printf("Constant Propagation OK.\n");
+}
+
+void TestIdentities() {
+    printf("Testing Algebraic Identities...\n");
+
+    FunctionDecl* func = foldMain(
+        "function Main(int x, string s) :: int {\n"
+        "    int a = x * 1 + 0;\n"
+        "    double b = x * 1.0;\n"
+        "    s = s + 0;\n"
+        "    if (1 > 2) { return 1; }\n"
+        "    return a;\n"
+        "}\n");
+
+    // x * 1 + 0 -> x
+    AstNode* a = ((VarDecl*)statement(func, 0))->initializer;
+    assert(a->type == NODE_LITERAL_EXPR && ((LiteralExpr*)a)->token.type == TOKEN_IDENTIFIER);
+    // A double literal changes the result type, a string operand means concatenation
+    assert(((VarDecl*)statement(func, 1))->initializer->type == NODE_BINARY_EXPR);
+    assert(((AssignmentExpr*)statement(func, 2))->value->type == NODE_BINARY_EXPR);
+    // Dead branch becomes an empty block
+    assert(statement(func, 3)->type == NODE_BLOCK && ((BlockStmt*)statement(func, 3))->count == 0);
+
+    printf("Algebraic Identities OK.\n");
+}
+
+void TestLogical() {
+    printf("Testing Logical Folding...\n");
+
+    FunctionDecl* func = foldMain(
+        "function Main(int x) {\n"
+        "    boolean a = 1 > 2 && x > 0;\n"
+        "    boolean b = 2 > 1 || x > 0;\n"
+        "    boolean c = 2 > 1 && x > 0 || x < -5;\n"
+        "    boolean d = true and 3 < 4;\n"
+        "}\n");
+
+    // A deciding left side drops the right one, which never runs
+    assert(((LiteralExpr*)((VarDecl*)statement(func, 0))->initializer)->token.type == TOKEN_FALSE);
+    assert(((LiteralExpr*)((VarDecl*)statement(func, 1))->initializer)->token.type == TOKEN_TRUE);
+    // && binds tighter than ||; a non-constant right side is kept
+    LogicalExpr* c = (LogicalExpr*)((VarDecl*)statement(func, 2))->initializer;
+    assert(c->main.type == NODE_LOGICAL_EXPR && c->op.type == TOKEN_OR);
+    assert(c->left->type == NODE_LOGICAL_EXPR && ((LogicalExpr*)c->left)->op.type == TOKEN_AND);
+    assert(((LiteralExpr*)((LogicalExpr*)c->left)->left)->token.type == TOKEN_TRUE);
+    assert(((LiteralExpr*)((VarDecl*)statement(func, 3))->initializer)->token.type == TOKEN_TRUE);
+
+    printf("Logical Folding OK.\n");
+}
+
+int main() {
+    TestFolding();
+    TestPropagation();
+    TestIdentities();
+    TestLogical();
+    printf("All Optimizer tests passed.\n");
+    return 0;
+}
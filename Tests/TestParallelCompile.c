@@ -0,0 +1,46 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Compiler/Parser.h"
+#include "Jit/CodeGen.h"
+#include "Jit/ExecutableMemory.h"
+#include "Core/VanarizeValue.h"
+
+#define FUNCTION_COUNT 40
+
+int main() {
+    printf("Testing Parallel Compilation...\n");
+
+    // F0(n) = n, Fi(n) = Fi-1(n + 1) + 1: every call is a forward reference
+    // to a body another worker may still be emitting
+    static char source[FUNCTION_COUNT * 128 + 128];
+    int length = sprintf(source, "function F0(int n) :: int { return n; }\n");
+    for (int i = 1; i < FUNCTION_COUNT; i++) {
+        length += sprintf(source + length,
+                          "function F%d(int n) :: int { return F%d(n + 1) + 1; }\n", i, i - 1);
+    }
+    sprintf(source + length, "function Main() { return F%d(0); }\n", FUNCTION_COUNT - 1);
+
+    Jit_SetCompileThreads(4);
+    Parser_Init(source);
+    AstNode* root = Parser_ParseProgram();
+    assert(root != NULL);
+    JitFunction func = Jit_Compile(root);
+    assert(func != NULL);
+    assert(ValueToNumber(func()) == 2 * (FUNCTION_COUNT - 1));
+
+    // Installed in declaration order whichever worker finished first
+    int count;
+    const JitCodeEntry* entries = Jit_GetCodeEntries(&count);
+    assert(count == FUNCTION_COUNT + 2);    // Plus Main and the top level
+    char name[16];
+    for (int i = 0; i < FUNCTION_COUNT; i++) {
+        snprintf(name, sizeof(name), "F%d", i);
+        assert(strcmp(entries[i].name, name) == 0);
+    }
+    assert(strcmp(entries[FUNCTION_COUNT].name, "Main") == 0);
+
+    printf("Parallel Compilation OK.\n");
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <assert.h>
+#include "Compiler/Parser.h"
+#include "Compiler/Optimizer.h"
+#include "Jit/CodeGen.h"
+#include "Core/VanarizeValue.h"
+#include "Core/Memory.h"
+#include "Core/GarbageCollector.h"
+
+// Code the peephole window rewrites: doubles crossing between GPRs and XMMs
+// (MOVQ pairs), constants that take the short MOV encodings (folded, so the
+// negative ones reach codegen as literals), and branch targets right after
+// such sequences. Add and Twice loop so they are not inlined. Check returns
+// the number of the first failed test.
+static const char* source =
+    "function Add(int a, int b) :: int {\n"
+    "    int s = a;\n"
+    "    for (int i = 0; i < b; i = i + 1) { s = s + 1; }\n"
+    "    return s;\n"
+    "}\n"
+    "function Twice(double d) :: double {\n"
+    "    double r = d;\n"
+    "    for (int i = 0; i < 1; i = i + 1) { r = r * 2.0; }\n"
+    "    return r;\n"
+    "}\n"
+    "function Check() :: int {\n"
+    "    if (Add(1, 2) + Add(3, 4) != 10) { return 1; }\n"
+    "    if (Add(Add(1, 1), Add(2, 2)) - Add(0, 1) != 5) { return 2; }\n"
+    "    double d = Twice(1.5) - Twice(0.25);\n"
+    "    if (d != 2.5) { return 3; }\n"
+    "    long k = 4294967295;\n"                     // MOV r32, imm32
+    "    if (k + 1 != 4294967296) { return 4; }\n"   // imm64
+    "    long m = -2147483648;\n"                    // Sign-extended imm32
+    "    if (m - 1 != -2147483649) { return 5; }\n"
+    "    int n = -1;\n"
+    "    if (n * 2147483648 != m) { return 6; }\n"
+    "    int t = 0;\n"
+    "    for (int i = 0; i < 5; i = i + 1) {\n"
+    "        if (Add(i, 0) < 3) { t = t + 1; } else { t = t - 1; }\n"
+    "    }\n"
+    "    if (t != 1) { return 7; }\n"
+    "    double h = 1.5;\n"
+    "    h++;\n"                                   // XMM home -> GPR -> XMM home
+    "    h = h * 2.0;\n"
+    "    if (h != 5.0) { return 8; }\n"
+    "    float g = 2;\n"
+    "    g--;\n"
+    "    if (g != 1) { return 9; }\n"
+    "    long q = -2147483649;\n"                  // Just past simm32: imm64
+    "    if (q + 1 != m) { return 10; }\n"
+    "    return 0;\n"
+    "}\n"
+    "function Main() {\n"
+    "    return Check();\n"
+    "}\n";
+
+int main() {
+    printf("Testing Peephole Window...\n");
+    int stackBottom;
+    VM_InitMemory();
+    GC_Init(&stackBottom);
+
+    // Baseline tier, then optimized up front
+    for (int tiering = 1; tiering >= 0; tiering--) {
+        Jit_SetTiering(tiering);
+        Parser_Init(source);
+        AstNode* root = Parser_ParseProgram();
+        assert(root != NULL);
+        Optimizer_FoldProgram(root);    // Folded negative constants take the short MOVs
+        JitFunction func = Jit_Compile(root);
+        assert(func != NULL);
+
+        double failed = ValueToNumber(func());
+        printf("Tiering %d, first failed check: %g (Expected 0)\n", tiering, failed);
+        assert(failed == 0);
+    }
+
+    printf("Peephole Window OK.\n");
+    return 0;
+}
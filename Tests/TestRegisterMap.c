@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <assert.h>
+#include "Compiler/Parser.h"
+#include "Jit/AssemblerX64.h"
+#include "Jit/RegisterMap.h"
+#include "Jit/LoopInvariant.h"
+
+static FunctionDecl* parseMain(const char* source) {
+    Parser_Init(source);
+    BlockStmt* program = (BlockStmt*)Parser_ParseProgram();
+    assert(program && program->count == 1);
+    assert(program->statements[0]->type == NODE_FUNCTION_DECL);
+    return (FunctionDecl*)program->statements[0];
+}
+
+void TestClasses() {
+    printf("Testing Register Classes...\n");
+
+    RegisterMap map;
+    RegMap_Allocate(&map, parseMain(
+        "function Main() :: int {\n"
+        "    int a = 1;\n"
+        "    double b = 2.5;\n"
+        "    string s = \"x\";\n"
+        "    return a;\n"
+        "}\n"));
+
+    // The string never gets an interval (GC roots stay on the stack)
+    assert(map.count == 2);
+    assert(map.intervals[0].regClass == REG_CLASS_GPR);
+    assert(map.intervals[0].reg == RBX);
+    assert(map.intervals[1].regClass == REG_CLASS_XMM);
+    assert(map.intervals[1].reg == XMM8);
+    assert(map.usedGprMask == (1u << RBX));
+    assert(map.usedXmmMask == (1u << XMM8));
+
+    printf("Register Classes OK.\n");
+}
+
+void TestSpill() {
+    printf("Testing Spilling...\n");
+
+    // Seven ints live at once, only five GPR homes
+    RegisterMap map;
+    RegMap_Allocate(&map, parseMain(
+        "function Main() :: int {\n"
+        "    int a = 1; int b = 2; int c = 3; int d = 4;\n"
+        "    int e = 5; int f = 6; int g = 7;\n"
+        "    return a + b + c + d + e + f + g;\n"
+        "}\n"));
+
+    assert(map.count == 7);
+    assert(map.spillCount == 2);
+    int inRegs = 0;
+    for (int i = 0; i < map.count; i++) {
+        if (map.intervals[i].reg != -1) inRegs++;
+    }
+    assert(inRegs == 5);
+
+    printf("Spilling OK.\n");
+}
+
+void TestReuse() {
+    printf("Testing Register Reuse...\n");
+
+    // Sibling blocks: the second local can take the first one's register
+    RegisterMap map;
+    RegMap_Allocate(&map, parseMain(
+        "function Main() :: int {\n"
+        "    { int a = 1; a = a + 1; }\n"
+        "    { int b = 2; b = b + 1; }\n"
+        "    return 0;\n"
+        "}\n"));
+
+    assert(map.count == 2);
+    assert(map.intervals[0].reg == map.intervals[1].reg);
+    assert(map.spillCount == 0);
+
+    printf("Register Reuse OK.\n");
+}
+
+void TestLoopExtension() {
+    printf("Testing Loop Liveness...\n");
+
+    // 'a' is last used inside the loop, so it must survive the back edge
+    RegisterMap map;
+    RegMap_Allocate(&map, parseMain(
+        "function Main() :: int {\n"
+        "    int a = 1;\n"
+        "    int s = 0;\n"
+        "    for (int i = 0; i < 10; i = i + 1) {\n"
+        "        s = s + a;\n"
+        "        int t = 2;\n"
+        "        s = s + t;\n"
+        "    }\n"
+        "    return s;\n"
+        "}\n"));
+
+    LiveInterval* a = &map.intervals[0];
+    LiveInterval* t = &map.intervals[3];
+    assert(a->end > t->end);
+    assert(a->reg != t->reg);
+
+    printf("Loop Liveness OK.\n");
+}
+
+void TestLoopInvariants() {
+    printf("Testing Loop Invariants...\n");
+
+    // arr.length() and a * w never change; s + i and the loop-local t do
+    FunctionDecl* func = parseMain(
+        "function Main() :: int {\n"
+        "    int[] arr = [1, 2, 3];\n"
+        "    int a = 2;\n"
+        "    double w = 0.5;\n"
+        "    double s = 0;\n"
+        "    for (int i = 0; i < arr.length(); i = i + 1) {\n"
+        "        int t = i;\n"
+        "        s = s + a * w + t;\n"
+        "    }\n"
+        "    return 0;\n"
+        "}\n");
+    BlockStmt* body = (BlockStmt*)func->body;
+    ForStmt* loop = (ForStmt*)body->statements[4];
+
+    AstNode* invariants[LICM_MAX_INVARIANTS];
+    assert(Licm_FindInvariants(loop, invariants, LICM_MAX_INVARIANTS) == 2);
+    assert(invariants[0] == ((BinaryExpr*)loop->condition)->right);
+    assert(invariants[1]->type == NODE_BINARY_EXPR && ((BinaryExpr*)invariants[1])->op.type == TOKEN_STAR);
+
+    // Both get a home for the whole loop, in the class of their value
+    RegisterMap map;
+    RegMap_Allocate(&map, func);
+    RegisterClass cls;
+    assert(RegMap_Lookup(&map, invariants[0], &cls) != -1 && cls == REG_CLASS_GPR);
+    assert(RegMap_Lookup(&map, invariants[1], &cls) != -1 && cls == REG_CLASS_XMM);
+
+    // A push in the loop keeps length() inside it
+    func = parseMain(
+        "function Main() :: int {\n"
+        "    int[] arr = [1];\n"
+        "    for (int i = 0; i < arr.length(); i = i + 1) {\n"
+        "        if (i < 3) { arr.push(i); }\n"
+        "    }\n"
+        "    return 0;\n"
+        "}\n");
+    loop = (ForStmt*)((BlockStmt*)func->body)->statements[1];
+    assert(Licm_FindInvariants(loop, invariants, LICM_MAX_INVARIANTS) == 0);
+
+    printf("Loop Invariants OK.\n");
+}
+
+int main() {
+    TestClasses();
+    TestSpill();
+    TestReuse();
+    TestLoopExtension();
+    TestLoopInvariants();
+    printf("All RegisterMap tests passed.\n");
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <assert.h>
+#include "Compiler/Parser.h"
+#include "Jit/CodeGen.h"
+#include "Core/VanarizeValue.h"
+#include "Core/Memory.h"
+#include "Core/GarbageCollector.h"
+
+// Tail calls reuse the frame, so a million levels of self, mutual and
+// differing-arity recursion run in constant stack; with a frame per level
+// they would overflow the 8 MB main stack. Check returns the number of the
+// first failed test.
+static const char* source =
+    "function SumTo(int n, long acc) :: long {\n"
+    "    if (n == 0) return acc;\n"
+    "    return SumTo(n - 1, acc + n);\n"
+    "}\n"
+    "function IsEven(int n) :: boolean {\n"
+    "    if (n == 0) return true;\n"
+    "    return IsOdd(n - 1);\n"
+    "}\n"
+    "function IsOdd(int n) :: boolean {\n"
+    "    if (n == 0) return false;\n"
+    "    return IsEven(n - 1);\n"
+    "}\n"
+    // One, three and two parameters around the cycle
+    "function Down(int n) :: int {\n"
+    "    if (n == 0) return 0;\n"
+    "    return Spread(n - 1, 1, 2);\n"
+    "}\n"
+    "function Spread(int n, int a, int b) :: int {\n"
+    "    if (n == 0) return a + b;\n"
+    "    return Pair(n - 1, a + b);\n"
+    "}\n"
+    "function Pair(int n, int s) :: int {\n"
+    "    if (n == 0) return s;\n"
+    "    return Down(n - 1);\n"
+    "}\n"
+    "function Mean(double x, double y, int n) :: double {\n"
+    "    if (n == 0) return x;\n"
+    "    return Mean((x + y) / 2, y, n - 1);\n"
+    "}\n"
+    "function Check() :: int {\n"
+    "    if (SumTo(1000000, 0) != 500000500000) { return 1; }\n"
+    "    if (!IsEven(1000000)) { return 2; }\n"
+    "    if (IsOdd(1000000)) { return 3; }\n"
+    "    if (IsEven(999999)) { return 4; }\n"
+    "    if (Down(999999) != 0) { return 5; }\n"     // Ends in Down
+    "    if (Down(1000000) != 3) { return 6; }\n"    // Ends in Spread: 1 + 2
+    "    if (Down(1000001) != 3) { return 7; }\n"    // Ends in Pair
+    "    if (Mean(0.0, 1.0, 1000000) != 1.0) { return 8; }\n"
+    "    return 0;\n"
+    "}\n"
+    "function Main() {\n"
+    "    return Check();\n"
+    "}\n";
+
+int main() {
+    printf("Testing Tail Calls...\n");
+    int stackBottom;
+    VM_InitMemory();
+    GC_Init(&stackBottom);
+
+    // Baseline tier, then optimized up front
+    for (int tiering = 1; tiering >= 0; tiering--) {
+        Jit_SetTiering(tiering);
+        Parser_Init(source);
+        AstNode* root = Parser_ParseProgram();
+        assert(root != NULL);
+        JitFunction func = Jit_Compile(root);
+        assert(func != NULL);
+
+        double failed = ValueToNumber(func());
+        printf("Tiering %d, first failed check: %g (Expected 0)\n", tiering, failed);
+        assert(failed == 0);
+    }
+
+    printf("Tail Calls OK.\n");
+    return 0;
+}
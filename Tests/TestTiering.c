@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include "Compiler/Parser.h"
+#include "Jit/CodeGen.h"
+#include "Jit/ExecutableMemory.h"
+#include "Core/VanarizeValue.h"
+#include "Core/Memory.h"
+#include "Core/GarbageCollector.h"
+
+// Baseline functions are recompiled optimized once hot: after enough calls,
+// or in the middle of a long loop, where the optimized code takes over the
+// baseline frame (on-stack replacement). Wide has 80 locals in scope at its
+// loop, all of which must arrive intact in the optimized frame; the first
+// call tiers up mid-loop, the remaining calls run optimized.
+
+#define WIDE_LOCALS 80
+
+static char source[1 << 14];
+
+static void buildSource(void) {
+    size_t length = 0;
+    length += sprintf(source + length, "function Wide(int n) :: int {\n");
+    for (int j = 0; j < WIDE_LOCALS; j++) {
+        length += sprintf(source + length, "    int v%d = n + %d;\n", j, j);
+    }
+    length += sprintf(source + length,
+        "    int s = 0;\n"
+        "    for (int i = 0; i < n; i = i + 1) { s = s + v0 + v39 + v79 + i; }\n"
+        "    return s");
+    for (int j = 0; j < WIDE_LOCALS; j++) {
+        length += sprintf(source + length, " + v%d", j);
+    }
+    sprintf(source + length,
+        ";\n"
+        "}\n"
+        "function Main() {\n"
+        "    long t = Wide(5000);\n"
+        "    for (int k = 0; k < 3000; k = k + 1) { t = t + Wide(k - k / 7 * 7); }\n"
+        "    return t;\n"
+        "}\n");
+}
+
+static long long wide(long long n) {
+    long long s = n * (3 * n + 118) + n * (n - 1) / 2;
+    for (int j = 0; j < WIDE_LOCALS; j++) s += n + j;
+    return s;
+}
+
+static int codeEntries(const char* name) {
+    int count, matches = 0;
+    const JitCodeEntry* entries = Jit_GetCodeEntries(&count);
+    for (int i = 0; i < count; i++) {
+        if (strcmp(entries[i].name, name) == 0) matches++;
+    }
+    return matches;
+}
+
+int main() {
+    printf("Testing Tiering...\n");
+    int stackBottom;
+    VM_InitMemory();
+    GC_Init(&stackBottom);
+    Jit_SetTiering(1);
+
+    buildSource();
+    Parser_Init(source);
+    AstNode* root = Parser_ParseProgram();
+    assert(root != NULL);
+    JitFunction func = Jit_Compile(root);
+    assert(func != NULL);
+    assert(codeEntries("Wide") == 1);   // Baseline only
+
+    long long expected = wide(5000);
+    for (int k = 0; k < 3000; k++) expected += wide(k % 7);
+
+    double result = ValueToNumber(func());
+    printf("Result: %.0f (Expected %lld)\n", result, expected);
+    assert(result == (double)expected);
+    assert(codeEntries("Wide") == 2);   // Baseline, then optimized once
+
+    printf("Tiering OK.\n");
+    return 0;
+}